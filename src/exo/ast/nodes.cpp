@@ -114,7 +114,7 @@ namespace exo
 			value = v;
 		};
 
-		DeclClass::DeclClass()
+		DeclClass::DeclClass() : isValue( false )
 		{
 		};
 
@@ -160,14 +160,16 @@ namespace exo
 		DeclFun::DeclFun( std::unique_ptr<Id> i, std::unique_ptr<Type> r, std::unique_ptr<DeclVarList> a, std::unique_ptr<StmtScope> b, bool va ) :
 			DeclFunProto( std::move( i ), std::move( r ), std::move( a ), va ),
 			scope( std::move( b ) ),
-			access( std::make_unique<ModAccess>() )
+			access( std::make_unique<ModAccess>() ),
+			isAsync( false )
 		{
 		};
 
 		DeclFun::DeclFun( std::unique_ptr<Id> i, std::unique_ptr<ModAccess> m, std::unique_ptr<Type> r, std::unique_ptr<DeclVarList> a, std::unique_ptr<StmtScope> b, bool va ) :
 			DeclFunProto( std::move( i ), std::move( r ), std::move( a ), va ),
 			scope( std::move( b ) ),
-			access( std::move( m ) )
+			access( std::move( m ) ),
+			isAsync( false )
 		{
 		};
 
@@ -195,14 +197,16 @@ namespace exo
 			name( n ),
 			type( std::move( t ) ),
 			expression( std::move( e ) ),
-			isRef( r )
+			isRef( r ),
+			isThreadLocal( false )
 		{
 		};
 
 		DeclVar::DeclVar( std::string n, std::unique_ptr<Type> t, bool r ) :
 			name( n ),
 			type( std::move( t ) ),
-			isRef( r )
+			isRef( r ),
+			isThreadLocal( false )
 		{
 		};
 
@@ -225,6 +229,17 @@ namespace exo
 			list.push_back( std::move( d ) );
 		};
 
+		DeclTuple::DeclTuple( std::unique_ptr<DeclVarList> v, std::unique_ptr<Expr> e ) :
+			variables( std::move( v ) ),
+			expression( std::move( e ) )
+		{
+		};
+
+		void DeclTuple::accept( Visitor* visitor )
+		{
+			visitor->visit( *this );
+		};
+
 		ExprCallFun::ExprCallFun( std::unique_ptr<Id> i, std::unique_ptr<ExprList> a ) :
 			id( std::move( i ) ),
 			arguments( std::move( a ) )
@@ -247,6 +262,39 @@ namespace exo
 			visitor->visit( *this );
 		};
 
+		ExprCallValue::ExprCallValue( std::unique_ptr<Expr> e, std::unique_ptr<ExprList> a ) :
+			ExprCallFun( std::make_unique<Id>( "" ), std::move( a ) ),
+			expression( std::move( e ) )
+		{
+		};
+
+		void ExprCallValue::accept( Visitor* visitor )
+		{
+			visitor->visit( *this );
+		};
+
+		ExprClosure::ExprClosure( std::unique_ptr<DeclFun> f ) :
+			function( std::move( f ) )
+		{
+		};
+
+		void ExprClosure::accept( Visitor* visitor )
+		{
+			visitor->visit( *this );
+		};
+
+		ExprIndex::ExprIndex( std::unique_ptr<Expr> e, std::unique_ptr<Expr> i ) :
+			ExprVar( "" ),
+			expression( std::move( e ) ),
+			index( std::move( i ) )
+		{
+		};
+
+		void ExprIndex::accept( Visitor* visitor )
+		{
+			visitor->visit( *this );
+		};
+
 		ExprList::ExprList()
 		{
 		};
@@ -276,6 +324,28 @@ namespace exo
 			visitor->visit( *this );
 		};
 
+		ExprSlice::ExprSlice( std::unique_ptr<Expr> e, std::unique_ptr<Expr> l, std::unique_ptr<Expr> u ) :
+			expression( std::move( e ) ),
+			lower( std::move( l ) ),
+			upper( std::move( u ) )
+		{
+		};
+
+		void ExprSlice::accept( Visitor* visitor )
+		{
+			visitor->visit( *this );
+		};
+
+		ExprTuple::ExprTuple( std::unique_ptr<ExprList> e ) :
+			expressions( std::move( e ) )
+		{
+		};
+
+		void ExprTuple::accept( Visitor* visitor )
+		{
+			visitor->visit( *this );
+		};
+
 		Id::Id( std::string n, std::string ns ) :
 			name( n ),
 			inNamespace( ns )
@@ -472,6 +542,16 @@ namespace exo
 		{
 		};
 
+		OpUnaryAwait::OpUnaryAwait( std::unique_ptr<Expr> e ) :
+			OpUnary( std::move( e ) )
+		{
+		};
+
+		void OpUnaryAwait::accept( Visitor* visitor )
+		{
+			visitor->visit( *this );
+		};
+
 		OpUnaryDel::OpUnaryDel( std::unique_ptr<Expr> e ) :
 			OpUnary( std::move( e ) )
 		{
@@ -482,6 +562,16 @@ namespace exo
 			visitor->visit( *this );
 		};
 
+		OpUnaryJoin::OpUnaryJoin( std::unique_ptr<Expr> e ) :
+			OpUnary( std::move( e ) )
+		{
+		};
+
+		void OpUnaryJoin::accept( Visitor* visitor )
+		{
+			visitor->visit( *this );
+		};
+
 		OpUnaryNew::OpUnaryNew( std::unique_ptr<Expr> e ) :
 			OpUnary( std::move( e ) )
 		{
@@ -492,6 +582,28 @@ namespace exo
 			visitor->visit( *this );
 		};
 
+		OpUnaryNewArray::OpUnaryNewArray( std::unique_ptr<Type> t, std::unique_ptr<Expr> e ) :
+			OpUnary( std::move( e ) ),
+			type( std::move( t ) )
+		{
+		};
+
+		void OpUnaryNewArray::accept( Visitor* visitor )
+		{
+			visitor->visit( *this );
+		};
+
+		OpUnaryNewMap::OpUnaryNewMap( std::unique_ptr<Type> t, std::unique_ptr<Expr> e ) :
+			OpUnary( std::move( e ) ),
+			type( std::move( t ) )
+		{
+		};
+
+		void OpUnaryNewMap::accept( Visitor* visitor )
+		{
+			visitor->visit( *this );
+		};
+
 		OpUnaryRef::OpUnaryRef( std::unique_ptr<Expr> e ) :
 			OpUnary( std::move( e ) )
 		{
@@ -502,6 +614,16 @@ namespace exo
 			visitor->visit( *this );
 		};
 
+		OpUnarySpawn::OpUnarySpawn( std::unique_ptr<Expr> e ) :
+			OpUnary( std::move( e ) )
+		{
+		};
+
+		void OpUnarySpawn::accept( Visitor* visitor )
+		{
+			visitor->visit( *this );
+		};
+
 		void StmtBreak::accept( Visitor* visitor )
 		{
 			visitor->visit( *this );
@@ -537,7 +659,9 @@ namespace exo
 			StmtExpr( std::move( e ) ),
 			initialization( std::move( i ) ),
 			update( std::move( u ) ),
-			scope( std::move( b ) )
+			scope( std::move( b ) ),
+			isParallel( false ),
+			reductions( std::make_unique<ExprList>() )
 		{
 		};
 
@@ -546,6 +670,18 @@ namespace exo
 			visitor->visit( *this );
 		};
 
+		StmtForIn::StmtForIn( std::unique_ptr<DeclVar> v, std::unique_ptr<Expr> e, std::unique_ptr<Stmt> b ) :
+			StmtExpr( std::move( e ) ),
+			variable( std::move( v ) ),
+			scope( std::move( b ) )
+		{
+		};
+
+		void StmtForIn::accept( Visitor* visitor )
+		{
+			visitor->visit( *this );
+		};
+
 		StmtIf::StmtIf( std::unique_ptr<Expr> e, std::unique_ptr<Stmt> t, std::unique_ptr<Stmt> f ) :
 			StmtExpr( std::move( e ) ),
 			onTrue( std::move( t ) ),
@@ -675,10 +811,34 @@ namespace exo
 			visitor->visit( *this );
 		};
 
+		StmtYield::StmtYield( std::unique_ptr<Expr> e ) :
+			StmtExpr( std::move( e ) )
+		{
+		};
+
+		void StmtYield::accept( Visitor* visitor )
+		{
+			visitor->visit( *this );
+		};
+
 		Type::Type( std::unique_ptr<Id> i, bool p ) :
 			id( std::move( i ) ),
-			isPrimitive( p )
+			isPrimitive( p ),
+			size( 0 )
+		{
+		};
+
+		Type::Type( std::unique_ptr<Id> i, std::unique_ptr<Type> e, long long s ) :
+			id( std::move( i ) ),
+			isPrimitive( true ),
+			size( s )
+		{
+			parameters.push_back( std::move( e ) );
+		};
+
+		void Type::addParameter( std::unique_ptr<Type> t )
 		{
+			parameters.push_back( std::move( t ) );
 		};
 	}
 }
@@ -34,13 +34,19 @@ namespace exo
 		class DeclFunProto;
 		class DeclFun;
 		class DeclMod;
+		class DeclTuple;
 		class DeclProp;
 		class DeclVar;
 		class DeclVarList;
 		class ExprCallFun;
 		class ExprCallMethod;
+		class ExprCallValue;
+		class ExprClosure;
+		class ExprIndex;
 		class ExprList;
 		class ExprProp;
+		class ExprSlice;
+		class ExprTuple;
 		class ExprVar;
 		class Id;
 		class ModAccess;
@@ -61,14 +67,20 @@ namespace exo
 		class OpBinaryMul;
 		class OpBinaryNeq;
 		class OpBinarySub;
+		class OpUnaryAwait;
 		class OpUnaryDel;
+		class OpUnaryJoin;
 		class OpUnaryNew;
+		class OpUnaryNewArray;
+		class OpUnaryNewMap;
 		class OpUnaryRef;
+		class OpUnarySpawn;
 		class StmtBreak;
 		class StmtCont;
 		class StmtDo;
 		class StmtExpr;
 		class StmtFor;
+		class StmtForIn;
 		class StmtImport;
 		class StmtIf;
 		class StmtLabel;
@@ -78,6 +90,7 @@ namespace exo
 		class StmtSwitch;
 		class StmtUse;
 		class StmtWhile;
+		class StmtYield;
 		class Type;
 		class Tree;
 
@@ -96,12 +109,18 @@ namespace exo
 				virtual void visit( DeclFunProto& ) = 0;
 				virtual void visit( DeclFun& ) = 0;
 				virtual void visit( DeclMod& ) = 0;
+				virtual void visit( DeclTuple& ) = 0;
 				virtual void visit( DeclVar& ) = 0;
 				virtual void visit( DeclVarList& ) = 0;
 				virtual void visit( ExprCallFun& ) = 0;
 				virtual void visit( ExprCallMethod& ) = 0;
+				virtual void visit( ExprCallValue& ) = 0;
+				virtual void visit( ExprClosure& ) = 0;
+				virtual void visit( ExprIndex& ) = 0;
 				virtual void visit( ExprVar& ) = 0;
 				virtual void visit( ExprProp& ) = 0;
+				virtual void visit( ExprSlice& ) = 0;
+				virtual void visit( ExprTuple& ) = 0;
 				virtual void visit( Node& ) = 0;
 				virtual void visit( OpBinaryAdd& ) = 0;
 				virtual void visit( OpBinaryAssign& ) = 0;
@@ -118,14 +137,20 @@ namespace exo
 				virtual void visit( OpBinaryMul& ) = 0;
 				virtual void visit( OpBinaryNeq& ) = 0;
 				virtual void visit( OpBinarySub& ) = 0;
+				virtual void visit( OpUnaryAwait& ) = 0;
 				virtual void visit( OpUnaryDel& ) = 0;
+				virtual void visit( OpUnaryJoin& ) = 0;
 				virtual void visit( OpUnaryNew& ) = 0;
+				virtual void visit( OpUnaryNewArray& ) = 0;
+				virtual void visit( OpUnaryNewMap& ) = 0;
 				virtual void visit( OpUnaryRef& ) = 0;
+				virtual void visit( OpUnarySpawn& ) = 0;
 				virtual void visit( StmtBreak& ) = 0;
 				virtual void visit( StmtCont& ) = 0;
 				virtual void visit( StmtDo& ) = 0;
 				virtual void visit( StmtExpr& ) = 0;
 				virtual void visit( StmtFor& ) = 0;
+				virtual void visit( StmtForIn& ) = 0;
 				virtual void visit( StmtIf& ) = 0;
 				virtual void visit( StmtImport& ) = 0;
 				virtual void visit( StmtLabel& ) = 0;
@@ -135,6 +160,7 @@ namespace exo
 				virtual void visit( StmtSwitch& ) = 0;
 				virtual void visit( StmtUse& ) = 0;
 				virtual void visit( StmtWhile& ) = 0;
+				virtual void visit( StmtYield& ) = 0;
 				virtual void visit( Tree& ) = 0;
 
 				virtual ~Visitor() {};
@@ -286,6 +312,11 @@ namespace exo
 				 */
 				std::vector< std::unique_ptr<DeclFun> >		methods;
 
+				/**
+				 * structs are values, laid out inline instead of allocated on the heap
+				 */
+				bool										isValue;
+
 				DeclClass();
 				virtual void setId( std::unique_ptr<Id> i, std::unique_ptr<Id> p );
 				virtual void setId( std::unique_ptr<Id> i );
@@ -321,6 +352,11 @@ namespace exo
 				std::unique_ptr<StmtScope>	scope;
 				std::unique_ptr<ModAccess>	access;
 
+				/**
+				 * async functions return a task and may suspend at await
+				 */
+				bool						isAsync;
+
 				DeclFun( std::unique_ptr<Id> i, std::unique_ptr<Type> r, std::unique_ptr<DeclVarList> a, std::unique_ptr<StmtScope> b, bool va = false );
 				DeclFun( std::unique_ptr<Id> i, std::unique_ptr<ModAccess> m, std::unique_ptr<Type> r, std::unique_ptr<DeclVarList> a, std::unique_ptr<StmtScope> b, bool va = false );
 				virtual void accept( Visitor* v );
@@ -360,6 +396,7 @@ namespace exo
 				std::unique_ptr<Type>		type;
 				std::unique_ptr<Expr>		expression;
 				bool						isRef;
+				bool						isThreadLocal; // one copy per thread, visible in all functions declared after it
 
 				DeclVar( std::string n, std::unique_ptr<Type> t, std::unique_ptr<Expr> e, bool r = false );
 				DeclVar( std::string n, std::unique_ptr<Type> t, bool r = false );
@@ -379,6 +416,19 @@ namespace exo
 				virtual void accept( Visitor* v );
 		};
 
+		/**
+		 * a destructuring declaration, each variable receives an element of a tuple
+		 */
+		class DeclTuple : public virtual Stmt
+		{
+			public:
+				std::unique_ptr<DeclVarList>	variables;
+				std::unique_ptr<Expr>			expression;
+
+				DeclTuple( std::unique_ptr<DeclVarList> v, std::unique_ptr<Expr> e );
+				virtual void accept( Visitor* v );
+		};
+
 		/**
 		 * a function call
 		 */
@@ -404,6 +454,30 @@ namespace exo
 				virtual void accept( Visitor* v );
 		};
 
+		/**
+		 * a call of a callable value, i.e. a closure
+		 */
+		class ExprCallValue : public virtual ExprCallFun
+		{
+			public:
+				std::unique_ptr<Expr> expression;
+
+				ExprCallValue( std::unique_ptr<Expr> e, std::unique_ptr<ExprList> a );
+				virtual void accept( Visitor* v );
+		};
+
+		/**
+		 * an anonymous function, capturing the variables it uses from its surrounding function
+		 */
+		class ExprClosure : public virtual Expr
+		{
+			public:
+				std::unique_ptr<DeclFun> function;
+
+				ExprClosure( std::unique_ptr<DeclFun> f );
+				virtual void accept( Visitor* v );
+		};
+
 		/**
 		 * a list of expression
 		 */
@@ -440,6 +514,45 @@ namespace exo
 				virtual void accept( Visitor* v );
 		};
 
+		/**
+		 * an array element access
+		 */
+		class ExprIndex : public virtual ExprVar
+		{
+			public:
+				std::unique_ptr<Expr> expression;
+				std::unique_ptr<Expr> index;
+
+				ExprIndex( std::unique_ptr<Expr> e, std::unique_ptr<Expr> i );
+				virtual void accept( Visitor* v );
+		};
+
+		/**
+		 * a slice (view) of an array, sharing its elements
+		 */
+		class ExprSlice : public virtual Expr
+		{
+			public:
+				std::unique_ptr<Expr> expression;
+				std::unique_ptr<Expr> lower;
+				std::unique_ptr<Expr> upper;
+
+				ExprSlice( std::unique_ptr<Expr> e, std::unique_ptr<Expr> l, std::unique_ptr<Expr> u );
+				virtual void accept( Visitor* v );
+		};
+
+		/**
+		 * a tuple of values, i.e. multiple return values
+		 */
+		class ExprTuple : public virtual Expr
+		{
+			public:
+				std::unique_ptr<ExprList> expressions;
+
+				ExprTuple( std::unique_ptr<ExprList> e );
+				virtual void accept( Visitor* v );
+		};
+
 		/**
 		 * an access modifier
 		 */
@@ -628,6 +741,16 @@ namespace exo
 				OpUnary( std::unique_ptr<Expr> e );
 		};
 
+		/**
+		 * an unary await operation, waits for the task operand to complete and yields its result
+		 */
+		class OpUnaryAwait : public virtual OpUnary
+		{
+			public:
+				OpUnaryAwait( std::unique_ptr<Expr> e );
+				virtual void accept( Visitor* v );
+		};
+
 		/**
 		 * an unary delete operation, has one operand of type object/expression
 		 */
@@ -638,6 +761,16 @@ namespace exo
 				virtual void accept( Visitor* v );
 		};
 
+		/**
+		 * an unary join operation, waits for the spawned future operand to complete and yields its result
+		 */
+		class OpUnaryJoin : public virtual OpUnary
+		{
+			public:
+				OpUnaryJoin( std::unique_ptr<Expr> e );
+				virtual void accept( Visitor* v );
+		};
+
 		/**
 		 * an unary new operation, has one operand of type object/expression
 		 */
@@ -648,6 +781,30 @@ namespace exo
 				virtual void accept( Visitor* v );
 		};
 
+		/**
+		 * an unary new operation for growable arrays, has the initial length as operand
+		 */
+		class OpUnaryNewArray : public virtual OpUnary
+		{
+			public:
+				std::unique_ptr<Type> type;
+
+				OpUnaryNewArray( std::unique_ptr<Type> t, std::unique_ptr<Expr> e );
+				virtual void accept( Visitor* v );
+		};
+
+		/**
+		 * an unary new operation for hash maps and sets, has the expected number of entries as operand
+		 */
+		class OpUnaryNewMap : public virtual OpUnary
+		{
+			public:
+				std::unique_ptr<Type> type;
+
+				OpUnaryNewMap( std::unique_ptr<Type> t, std::unique_ptr<Expr> e );
+				virtual void accept( Visitor* v );
+		};
+
 		/**
 		 * an unary reference operation
 		 */
@@ -658,6 +815,16 @@ namespace exo
 				virtual void accept( Visitor* v );
 		};
 
+		/**
+		 * an unary spawn operation, runs the function call operand in parallel and yields a future of its result
+		 */
+		class OpUnarySpawn : public virtual OpUnary
+		{
+			public:
+				OpUnarySpawn( std::unique_ptr<Expr> e );
+				virtual void accept( Visitor* v );
+		};
+
 		/**
 		 * a break statement
 		 */
@@ -710,10 +877,30 @@ namespace exo
 				std::unique_ptr<DeclVarList>	initialization;
 				std::unique_ptr<ExprList>		update;
 
+				/**
+				 * parallel loops run their iterations on the workers, reductions name an operation and the variable it
+				 * accumulates into, i.e. sum( $total ) or a function with an optional identity like gcd( $divisor, 0 )
+				 */
+				bool							isParallel;
+				std::unique_ptr<ExprList>		reductions;
+
 				StmtFor( std::unique_ptr<Expr> e, std::unique_ptr<DeclVarList> i, std::unique_ptr<ExprList> u, std::unique_ptr<Stmt> b );
 				virtual void accept( Visitor* v );
 		};
 
+		/**
+		 * a for in loop over the values yielded by a generator call
+		 */
+		class StmtForIn : public virtual StmtExpr
+		{
+			public:
+				std::unique_ptr<DeclVar>	variable;
+				std::unique_ptr<Stmt>		scope;
+
+				StmtForIn( std::unique_ptr<DeclVar> v, std::unique_ptr<Expr> e, std::unique_ptr<Stmt> b );
+				virtual void accept( Visitor* v );
+		};
+
 		/**
 		 * a if/else statement
 		 */
@@ -829,6 +1016,16 @@ namespace exo
 				virtual void accept( Visitor* v );
 		};
 
+		/**
+		 * a yield statement, hands a value to the loop iterating the generator
+		 */
+		class StmtYield : public virtual StmtExpr
+		{
+			public:
+				StmtYield( std::unique_ptr<Expr> e );
+				virtual void accept( Visitor* v );
+		};
+
 		/**
 		 * an identifier to identify/name things (functions,classes,variables)
 		 */
@@ -850,7 +1047,19 @@ namespace exo
 				bool isPrimitive;
 				std::unique_ptr<Id> id;
 
+				/**
+				 * type parameters, i.e. the element type of an array or vector, the element types of a tuple
+				 */
+				std::vector< std::unique_ptr<Type> > parameters;
+
+				/**
+				 * fixed amount of elements, 0 if growable (arrays) or as wide as the target allows (vectors)
+				 */
+				long long size;
+
 				Type( std::unique_ptr<Id> i, bool p = false );
+				Type( std::unique_ptr<Id> i, std::unique_ptr<Type> e, long long s = 0 );
+				void addParameter( std::unique_ptr<Type> t );
 		};
 
 		/**
@@ -0,0 +1,390 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "exo/exo.h"
+
+#include "exo/ast/nodes.h"
+#include "exo/ast/walker.h"
+
+namespace exo
+{
+	namespace ast
+	{
+		Walker::~Walker()
+		{
+		}
+
+		void Walker::visit( ConstBool& )
+		{
+		}
+
+		void Walker::visit( ConstFloat& )
+		{
+		}
+
+		void Walker::visit( ConstInt& )
+		{
+		}
+
+		void Walker::visit( ConstNull& )
+		{
+		}
+
+		void Walker::visit( ConstStr& )
+		{
+		}
+
+		void Walker::visit( DeclClass& decl )
+		{
+			for( auto &property : decl.properties ) {
+				property->property->accept( this );
+			}
+			for( auto &method : decl.methods ) {
+				method->accept( this );
+			}
+		}
+
+		void Walker::visit( DeclFunProto& )
+		{
+		}
+
+		void Walker::visit( DeclFun& decl )
+		{
+			decl.arguments->accept( this );
+			decl.scope->accept( this );
+		}
+
+		void Walker::visit( DeclMod& )
+		{
+		}
+
+		void Walker::visit( DeclTuple& decl )
+		{
+			decl.expression->accept( this );
+			decl.variables->accept( this );
+		}
+
+		void Walker::visit( DeclVar& decl )
+		{
+			if( decl.expression ) {
+				decl.expression->accept( this );
+			}
+		}
+
+		void Walker::visit( DeclVarList& decl )
+		{
+			for( auto &declaration : decl.list ) {
+				declaration->accept( this );
+			}
+		}
+
+		void Walker::visit( ExprCallFun& expr )
+		{
+			for( auto &argument : expr.arguments->list ) {
+				argument->accept( this );
+			}
+		}
+
+		void Walker::visit( ExprCallMethod& expr )
+		{
+			expr.expression->accept( this );
+			for( auto &argument : expr.arguments->list ) {
+				argument->accept( this );
+			}
+		}
+
+		void Walker::visit( ExprCallValue& expr )
+		{
+			expr.expression->accept( this );
+			for( auto &argument : expr.arguments->list ) {
+				argument->accept( this );
+			}
+		}
+
+		void Walker::visit( ExprClosure& expr )
+		{
+			expr.function->accept( this );
+		}
+
+		void Walker::visit( ExprIndex& expr )
+		{
+			expr.expression->accept( this );
+			expr.index->accept( this );
+		}
+
+		void Walker::visit( ExprVar& )
+		{
+		}
+
+		void Walker::visit( ExprProp& expr )
+		{
+			expr.expression->accept( this );
+		}
+
+		void Walker::visit( ExprSlice& expr )
+		{
+			expr.expression->accept( this );
+			expr.lower->accept( this );
+			expr.upper->accept( this );
+		}
+
+		void Walker::visit( ExprTuple& expr )
+		{
+			for( auto &expression : expr.expressions->list ) {
+				expression->accept( this );
+			}
+		}
+
+		void Walker::visit( Node& )
+		{
+		}
+
+		void Walker::visit( OpBinaryAdd& op )
+		{
+			op.lhs->accept( this );
+			op.rhs->accept( this );
+		}
+
+		void Walker::visit( OpBinaryAssign& op )
+		{
+			op.lhs->accept( this );
+			op.rhs->accept( this );
+		}
+
+		void Walker::visit( OpBinaryAssignAdd& op )
+		{
+			op.lhs->accept( this );
+			op.rhs->accept( this );
+		}
+
+		void Walker::visit( OpBinaryAssignDiv& op )
+		{
+			op.lhs->accept( this );
+			op.rhs->accept( this );
+		}
+
+		void Walker::visit( OpBinaryAssignMul& op )
+		{
+			op.lhs->accept( this );
+			op.rhs->accept( this );
+		}
+
+		void Walker::visit( OpBinaryAssignSub& op )
+		{
+			op.lhs->accept( this );
+			op.rhs->accept( this );
+		}
+
+		void Walker::visit( OpBinaryDiv& op )
+		{
+			op.lhs->accept( this );
+			op.rhs->accept( this );
+		}
+
+		void Walker::visit( OpBinaryEq& op )
+		{
+			op.lhs->accept( this );
+			op.rhs->accept( this );
+		}
+
+		void Walker::visit( OpBinaryGe& op )
+		{
+			op.lhs->accept( this );
+			op.rhs->accept( this );
+		}
+
+		void Walker::visit( OpBinaryGt& op )
+		{
+			op.lhs->accept( this );
+			op.rhs->accept( this );
+		}
+
+		void Walker::visit( OpBinaryLe& op )
+		{
+			op.lhs->accept( this );
+			op.rhs->accept( this );
+		}
+
+		void Walker::visit( OpBinaryLt& op )
+		{
+			op.lhs->accept( this );
+			op.rhs->accept( this );
+		}
+
+		void Walker::visit( OpBinaryMul& op )
+		{
+			op.lhs->accept( this );
+			op.rhs->accept( this );
+		}
+
+		void Walker::visit( OpBinaryNeq& op )
+		{
+			op.lhs->accept( this );
+			op.rhs->accept( this );
+		}
+
+		void Walker::visit( OpBinarySub& op )
+		{
+			op.lhs->accept( this );
+			op.rhs->accept( this );
+		}
+
+		void Walker::visit( OpUnaryAwait& op )
+		{
+			op.rhs->accept( this );
+		}
+
+		void Walker::visit( OpUnaryDel& op )
+		{
+			op.rhs->accept( this );
+		}
+
+		void Walker::visit( OpUnaryJoin& op )
+		{
+			op.rhs->accept( this );
+		}
+
+		void Walker::visit( OpUnaryNew& op )
+		{
+			op.rhs->accept( this );
+		}
+
+		void Walker::visit( OpUnaryNewArray& op )
+		{
+			op.rhs->accept( this );
+		}
+
+		void Walker::visit( OpUnaryNewMap& op )
+		{
+			op.rhs->accept( this );
+		}
+
+		void Walker::visit( OpUnaryRef& op )
+		{
+			op.rhs->accept( this );
+		}
+
+		void Walker::visit( OpUnarySpawn& op )
+		{
+			op.rhs->accept( this );
+		}
+
+		void Walker::visit( StmtBreak& )
+		{
+		}
+
+		void Walker::visit( StmtCont& )
+		{
+		}
+
+		void Walker::visit( StmtDo& stmt )
+		{
+			stmt.scope->accept( this );
+			stmt.expression->accept( this );
+		}
+
+		void Walker::visit( StmtExpr& stmt )
+		{
+			stmt.expression->accept( this );
+		}
+
+		void Walker::visit( StmtFor& stmt )
+		{
+			stmt.initialization->accept( this );
+			stmt.expression->accept( this );
+			stmt.scope->accept( this );
+			for( auto &update : stmt.update->list ) {
+				update->accept( this );
+			}
+		}
+
+		void Walker::visit( StmtForIn& stmt )
+		{
+			stmt.variable->accept( this );
+			stmt.expression->accept( this );
+			stmt.scope->accept( this );
+		}
+
+		void Walker::visit( StmtIf& stmt )
+		{
+			stmt.expression->accept( this );
+			stmt.onTrue->accept( this );
+			if( stmt.onFalse ) {
+				stmt.onFalse->accept( this );
+			}
+		}
+
+		void Walker::visit( StmtImport& )
+		{
+		}
+
+		void Walker::visit( StmtLabel& stmt )
+		{
+			stmt.stmt->accept( this );
+		}
+
+		void Walker::visit( StmtList& stmt )
+		{
+			for( auto &statement : stmt.list ) {
+				statement->accept( this );
+			}
+		}
+
+		void Walker::visit( StmtReturn& stmt )
+		{
+			if( stmt.expression ) {
+				stmt.expression->accept( this );
+			}
+		}
+
+		void Walker::visit( StmtScope& stmt )
+		{
+			stmt.stmts->accept( this );
+		}
+
+		void Walker::visit( StmtSwitch& stmt )
+		{
+			stmt.expression->accept( this );
+			for( auto &swCase : stmt.cases ) {
+				swCase->accept( this );
+			}
+			if( stmt.defaultCase ) {
+				stmt.defaultCase->accept( this );
+			}
+		}
+
+		void Walker::visit( StmtUse& )
+		{
+		}
+
+		void Walker::visit( StmtWhile& stmt )
+		{
+			stmt.expression->accept( this );
+			stmt.scope->accept( this );
+		}
+
+		void Walker::visit( StmtYield& stmt )
+		{
+			stmt.expression->accept( this );
+		}
+
+		void Walker::visit( Tree& tree )
+		{
+			if( tree.stmts ) {
+				tree.stmts->accept( this );
+			}
+		}
+	}
+}
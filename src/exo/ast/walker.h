@@ -0,0 +1,101 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WALKER_H_
+#define WALKER_H_
+
+#include "exo/exo.h"
+#include "exo/ast/nodes.h"
+
+namespace exo
+{
+	namespace ast
+	{
+		/**
+		 * a visitor which descends into every child node, without doing anything on its own.
+		 * analysis passes derive from it and only override the nodes they are interested in.
+		 */
+		class Walker : public virtual Visitor
+		{
+			public:
+				virtual ~Walker();
+
+				virtual void visit( ConstBool& );
+				virtual void visit( ConstFloat& );
+				virtual void visit( ConstInt& );
+				virtual void visit( ConstNull& );
+				virtual void visit( ConstStr& );
+				virtual void visit( DeclClass& );
+				virtual void visit( DeclFunProto& );
+				virtual void visit( DeclFun& );
+				virtual void visit( DeclMod& );
+				virtual void visit( DeclTuple& );
+				virtual void visit( DeclVar& );
+				virtual void visit( DeclVarList& );
+				virtual void visit( ExprCallFun& );
+				virtual void visit( ExprCallMethod& );
+				virtual void visit( ExprCallValue& );
+				virtual void visit( ExprClosure& );
+				virtual void visit( ExprIndex& );
+				virtual void visit( ExprVar& );
+				virtual void visit( ExprProp& );
+				virtual void visit( ExprSlice& );
+				virtual void visit( ExprTuple& );
+				virtual void visit( Node& );
+				virtual void visit( OpBinaryAdd& );
+				virtual void visit( OpBinaryAssign& );
+				virtual void visit( OpBinaryAssignAdd& );
+				virtual void visit( OpBinaryAssignDiv& );
+				virtual void visit( OpBinaryAssignMul& );
+				virtual void visit( OpBinaryAssignSub& );
+				virtual void visit( OpBinaryDiv& );
+				virtual void visit( OpBinaryEq& );
+				virtual void visit( OpBinaryGe& );
+				virtual void visit( OpBinaryGt& );
+				virtual void visit( OpBinaryLe& );
+				virtual void visit( OpBinaryLt& );
+				virtual void visit( OpBinaryMul& );
+				virtual void visit( OpBinaryNeq& );
+				virtual void visit( OpBinarySub& );
+				virtual void visit( OpUnaryAwait& );
+				virtual void visit( OpUnaryDel& );
+				virtual void visit( OpUnaryJoin& );
+				virtual void visit( OpUnaryNew& );
+				virtual void visit( OpUnaryNewArray& );
+				virtual void visit( OpUnaryNewMap& );
+				virtual void visit( OpUnaryRef& );
+				virtual void visit( OpUnarySpawn& );
+				virtual void visit( StmtBreak& );
+				virtual void visit( StmtCont& );
+				virtual void visit( StmtDo& );
+				virtual void visit( StmtExpr& );
+				virtual void visit( StmtFor& );
+				virtual void visit( StmtForIn& );
+				virtual void visit( StmtIf& );
+				virtual void visit( StmtImport& );
+				virtual void visit( StmtLabel& );
+				virtual void visit( StmtList& );
+				virtual void visit( StmtReturn& );
+				virtual void visit( StmtScope& );
+				virtual void visit( StmtSwitch& );
+				virtual void visit( StmtUse& );
+				virtual void visit( StmtWhile& );
+				virtual void visit( StmtYield& );
+				virtual void visit( Tree& );
+		};
+	}
+}
+
+#endif /* WALKER_H_ */
@@ -23,6 +23,7 @@
 #endif
 
 #ifndef EXO_GC_DISABLE
+# define GC_THREADS // workers running spawned jobs register themselves
 # include <gc/gc.h>
 # include <gc/gc_cpp.h>
 #endif
@@ -16,6 +16,7 @@
 #include "exo/exo.h"
 #include "exo/init/init.h"
 #include "exo/jit/llvm.h"
+#include "exo/runtime/runtime.h"
 #include "exo/signals/signals.h"
 
 namespace exo
@@ -49,6 +50,7 @@ namespace exo
 
 #ifndef EXO_GC_DISABLE
 			GC_INIT();
+			GC_allow_register_threads();
 			//GC_enable_incremental();
 #endif
 			// initialize llvm
@@ -57,6 +59,9 @@ namespace exo
 			llvm::InitializeAllAsmPrinters();
 			llvm::InitializeAllAsmParsers();
 
+			// make our native runtime visible to jitted code
+			exo::runtime::Runtime::Register();
+
 			// register signal handler
 			exo::signals::registerHandlers();
 
@@ -0,0 +1,492 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "exo/exo.h"
+
+#include "exo/jit/llvm.h"
+#include "exo/jit/analysis.h"
+
+#include <climits>
+
+namespace exo
+{
+	namespace jit
+	{
+		CountedLoop::CountedLoop( exo::ast::StmtFor& loop ) :
+			isCounted( false ),
+			memory( nullptr ),
+			bound( 0 ),
+			arrayMemory( nullptr ),
+			hasReferences( false ),
+			hasAwaits( false )
+		{
+			// condition needs to be $i < constant, $i <= constant or $i < $array->length()
+			exo::ast::OpBinary* condition = dynamic_cast<exo::ast::OpBinaryLt*>( loop.expression.get() );
+			long long inclusive = 0;
+			if( condition == nullptr ) {
+				condition = dynamic_cast<exo::ast::OpBinaryLe*>( loop.expression.get() );
+				inclusive = 1;
+			}
+			if( condition == nullptr ) {
+				return;
+			}
+
+			variable = variableName( condition->lhs.get() );
+			if( variable.empty() ) {
+				return;
+			}
+
+			exo::ast::ConstInt* limit = dynamic_cast<exo::ast::ConstInt*>( condition->rhs.get() );
+			exo::ast::ExprCallMethod* length = dynamic_cast<exo::ast::ExprCallMethod*>( condition->rhs.get() );
+			if( limit != nullptr && limit->value < LLONG_MAX && limit->value + inclusive > 0 ) {
+				bound = limit->value + inclusive;
+			} else if( length != nullptr && !inclusive && length->id->name == "length" && length->arguments->list.empty() ) {
+				array = variableName( length->expression.get() );
+				if( array.empty() ) {
+					return;
+				}
+			} else {
+				return;
+			}
+
+			// initialization needs to start at a non negative constant
+			bool isInitialized = false;
+			for( auto &declaration : loop.initialization->list ) {
+				if( declaration->name != variable ) {
+					continue;
+				}
+
+				exo::ast::ConstInt* start = dynamic_cast<exo::ast::ConstInt*>( declaration->expression.get() );
+				if( declaration->isRef || declaration->type->id->name != "int" || ( declaration->expression && ( start == nullptr || start->value < 0 ) ) ) {
+					return;
+				}
+				isInitialized = true;
+			}
+			if( !isInitialized ) {
+				return;
+			}
+
+			/*
+			 * update needs to be exactly one $i += positive constant, the rest may not touch our variable. $i is below the bound
+			 * before the step, which may not take it past INT64_MAX. array lengths are limited by the address space, below 2^62
+			 */
+			long long maximum = LLONG_MAX - ( bound > 0 ? bound : 1LL << 62 );
+			int increments = 0;
+			for( auto &update : loop.update->list ) {
+				exo::ast::OpBinaryAssignAdd* increment = dynamic_cast<exo::ast::OpBinaryAssignAdd*>( update.get() );
+
+				if( increment != nullptr && variableName( increment->lhs.get() ) == variable ) {
+					exo::ast::ConstInt* step = dynamic_cast<exo::ast::ConstInt*>( increment->rhs.get() );
+					if( step == nullptr || step->value <= 0 || step->value > maximum ) {
+						return;
+					}
+
+					increment->rhs->accept( this );
+					increments++;
+				} else {
+					update->accept( this );
+				}
+			}
+
+			// the body may neither write our variable nor (re)declare it
+			loop.scope->accept( this );
+
+			isCounted = ( increments == 1 && assigned.count( variable ) == 0 );
+		}
+
+		std::string CountedLoop::variableName( exo::ast::Expr* expression )
+		{
+			if( expression != nullptr && typeid( *expression ) == typeid( exo::ast::ExprVar ) ) {
+				return( dynamic_cast<exo::ast::ExprVar*>( expression )->name );
+			}
+
+			return( "" );
+		}
+
+		void CountedLoop::write( exo::ast::Expr* expression )
+		{
+			std::string name = variableName( expression );
+			if( !name.empty() ) {
+				assigned.insert( name );
+			}
+		}
+
+		void CountedLoop::visit( exo::ast::DeclVar& decl )
+		{
+			assigned.insert( decl.name );
+			hasReferences |= decl.isRef;
+			exo::ast::Walker::visit( decl );
+		}
+
+		void CountedLoop::visit( exo::ast::ExprCallFun& expr )
+		{
+			calls.push_back( &expr );
+			exo::ast::Walker::visit( expr );
+		}
+
+		void CountedLoop::visit( exo::ast::ExprCallMethod& expr )
+		{
+			calls.push_back( &expr );
+			exo::ast::Walker::visit( expr );
+		}
+
+		// calling a closure may do anything
+		void CountedLoop::visit( exo::ast::ExprCallValue& expr )
+		{
+			calls.push_back( &expr );
+			exo::ast::Walker::visit( expr );
+		}
+
+		void CountedLoop::visit( exo::ast::OpBinaryAssign& op )
+		{
+			write( op.lhs.get() );
+			exo::ast::Walker::visit( op );
+		}
+
+		void CountedLoop::visit( exo::ast::OpBinaryAssignAdd& op )
+		{
+			write( op.lhs.get() );
+			exo::ast::Walker::visit( op );
+		}
+
+		void CountedLoop::visit( exo::ast::OpBinaryAssignDiv& op )
+		{
+			write( op.lhs.get() );
+			exo::ast::Walker::visit( op );
+		}
+
+		void CountedLoop::visit( exo::ast::OpBinaryAssignMul& op )
+		{
+			write( op.lhs.get() );
+			exo::ast::Walker::visit( op );
+		}
+
+		void CountedLoop::visit( exo::ast::OpBinaryAssignSub& op )
+		{
+			write( op.lhs.get() );
+			exo::ast::Walker::visit( op );
+		}
+
+		// other tasks run while we are suspended
+		void CountedLoop::visit( exo::ast::OpUnaryAwait& op )
+		{
+			hasAwaits = true;
+			exo::ast::Walker::visit( op );
+		}
+
+		// taking a reference may write the variable later on
+		void CountedLoop::visit( exo::ast::OpUnaryRef& op )
+		{
+			write( op.rhs.get() );
+			exo::ast::Walker::visit( op );
+		}
+
+		ClosureCaptures::ClosureCaptures( exo::ast::ExprClosure& closure )
+		{
+			closure.function->arguments->accept( this );
+			closure.function->scope->accept( this );
+			capture();
+		}
+
+		// the range is evaluated up front, only the loop variable and the body are part of the outlined function
+		ClosureCaptures::ClosureCaptures( exo::ast::StmtFor& loop )
+		{
+			for( auto &declaration : loop.initialization->list ) {
+				declared.insert( declaration->name );
+			}
+			loop.scope->accept( this );
+			capture();
+		}
+
+		// anything not declared inside, in order of first use
+		void ClosureCaptures::capture()
+		{
+			for( auto &name : used ) {
+				if( declared.count( name ) == 0 && std::find( captured.begin(), captured.end(), name ) == captured.end() ) {
+					captured.push_back( name );
+				}
+			}
+		}
+
+		void ClosureCaptures::write( exo::ast::Expr* expression )
+		{
+			std::string name = CountedLoop::variableName( expression );
+			if( !name.empty() ) {
+				assigned.insert( name );
+			}
+		}
+
+		void ClosureCaptures::visit( exo::ast::DeclVar& decl )
+		{
+			declared.insert( decl.name );
+			exo::ast::Walker::visit( decl );
+		}
+
+		void ClosureCaptures::visit( exo::ast::ExprVar& expr )
+		{
+			used.push_back( expr.name );
+		}
+
+		void ClosureCaptures::visit( exo::ast::OpBinaryAssign& op )
+		{
+			write( op.lhs.get() );
+			exo::ast::Walker::visit( op );
+		}
+
+		void ClosureCaptures::visit( exo::ast::OpBinaryAssignAdd& op )
+		{
+			write( op.lhs.get() );
+			exo::ast::Walker::visit( op );
+		}
+
+		void ClosureCaptures::visit( exo::ast::OpBinaryAssignDiv& op )
+		{
+			write( op.lhs.get() );
+			exo::ast::Walker::visit( op );
+		}
+
+		void ClosureCaptures::visit( exo::ast::OpBinaryAssignMul& op )
+		{
+			write( op.lhs.get() );
+			exo::ast::Walker::visit( op );
+		}
+
+		void ClosureCaptures::visit( exo::ast::OpBinaryAssignSub& op )
+		{
+			write( op.lhs.get() );
+			exo::ast::Walker::visit( op );
+		}
+
+		void ClosureCaptures::visit( exo::ast::OpUnaryRef& op )
+		{
+			write( op.rhs.get() );
+			exo::ast::Walker::visit( op );
+		}
+
+		ClosureEscapes::ClosureEscapes( exo::ast::StmtList& stmts )
+		{
+			stmts.accept( this );
+
+			// follow escaping values thru the variables they were assigned to and the variables captured by escaping closures
+			std::set<std::string> names;
+			while( !escapes.empty() ) {
+				exo::ast::Expr* expression = escapes.back();
+				escapes.pop_back();
+
+				std::vector<std::string> escaped;
+
+				exo::ast::ExprClosure* closure = dynamic_cast<exo::ast::ExprClosure*>( expression );
+				exo::ast::ExprTuple* tuple = dynamic_cast<exo::ast::ExprTuple*>( expression );
+				if( closure != nullptr ) {
+					if( escaping.insert( closure ).second ) {
+						escaped.insert( escaped.end(), uses[ closure ].begin(), uses[ closure ].end() );
+					}
+				} else if( tuple != nullptr ) {
+					for( auto &element : tuple->expressions->list ) {
+						escapes.push_back( element.get() );
+					}
+				} else if( !CountedLoop::variableName( expression ).empty() ) {
+					escaped.push_back( CountedLoop::variableName( expression ) );
+				}
+
+				for( auto &name : escaped ) {
+					if( !names.insert( name ).second ) {
+						continue;
+					}
+
+					auto assignments = flows.equal_range( name );
+					for( auto assignment = assignments.first; assignment != assignments.second; assignment++ ) {
+						escapes.push_back( assignment->second );
+					}
+				}
+			}
+		}
+
+		// functions get analyzed on their own
+		void ClosureEscapes::visit( exo::ast::DeclFun& )
+		{
+		}
+
+		void ClosureEscapes::visit( exo::ast::DeclTuple& decl )
+		{
+			for( auto &variable : decl.variables->list ) {
+				flows.insert( std::make_pair( variable->name, decl.expression.get() ) );
+			}
+			exo::ast::Walker::visit( decl );
+		}
+
+		void ClosureEscapes::visit( exo::ast::DeclVar& decl )
+		{
+			if( decl.expression ) {
+				flows.insert( std::make_pair( decl.name, decl.expression.get() ) );
+			}
+			exo::ast::Walker::visit( decl );
+		}
+
+		void ClosureEscapes::visit( exo::ast::ExprClosure& expr )
+		{
+			closures.push_back( &expr );
+			uses[ &expr ];
+
+			expr.function->arguments->accept( this );
+			expr.function->scope->accept( this );
+
+			closures.pop_back();
+		}
+
+		// a variable used inside closures is captured by all of them
+		void ClosureEscapes::visit( exo::ast::ExprVar& expr )
+		{
+			for( auto closure : closures ) {
+				uses[ closure ].insert( expr.name );
+			}
+		}
+
+		// storing into properties or array elements escapes, assigning a variable only if the variable does
+		void ClosureEscapes::visit( exo::ast::OpBinaryAssign& op )
+		{
+			std::string name = CountedLoop::variableName( op.lhs.get() );
+			if( name.empty() ) {
+				escapes.push_back( op.rhs.get() );
+			} else {
+				flows.insert( std::make_pair( name, op.rhs.get() ) );
+			}
+			exo::ast::Walker::visit( op );
+		}
+
+		void ClosureEscapes::visit( exo::ast::StmtReturn& stmt )
+		{
+			if( stmt.expression ) {
+				escapes.push_back( stmt.expression.get() );
+			}
+			exo::ast::Walker::visit( stmt );
+		}
+
+		// the loop body receiving the value may store it anywhere
+		void ClosureEscapes::visit( exo::ast::StmtYield& stmt )
+		{
+			escapes.push_back( stmt.expression.get() );
+			exo::ast::Walker::visit( stmt );
+		}
+
+		GeneratorYields::GeneratorYields( exo::ast::DeclFun& function )
+		{
+			function.scope->accept( this );
+		}
+
+		void GeneratorYields::visit( exo::ast::DeclFun& )
+		{
+		}
+
+		void GeneratorYields::visit( exo::ast::ExprClosure& )
+		{
+		}
+
+		void GeneratorYields::visit( exo::ast::StmtYield& stmt )
+		{
+			yields.push_back( &stmt );
+			exo::ast::Walker::visit( stmt );
+		}
+
+		ParallelBody::ParallelBody( exo::ast::StmtFor& loop )
+		{
+			loop.scope->accept( this );
+		}
+
+		void ParallelBody::visit( exo::ast::DeclFun& )
+		{
+		}
+
+		void ParallelBody::visit( exo::ast::ExprClosure& )
+		{
+		}
+
+		void ParallelBody::visit( exo::ast::OpUnaryAwait& op )
+		{
+			exits.push_back( &op );
+			exo::ast::Walker::visit( op );
+		}
+
+		void ParallelBody::visit( exo::ast::StmtBreak& stmt )
+		{
+			if( breakable == 0 ) {
+				exits.push_back( &stmt );
+			}
+		}
+
+		void ParallelBody::visit( exo::ast::StmtDo& stmt )
+		{
+			breakable++;
+			exo::ast::Walker::visit( stmt );
+			breakable--;
+		}
+
+		void ParallelBody::visit( exo::ast::StmtFor& stmt )
+		{
+			breakable++;
+			exo::ast::Walker::visit( stmt );
+			breakable--;
+		}
+
+		void ParallelBody::visit( exo::ast::StmtForIn& stmt )
+		{
+			breakable++;
+			exo::ast::Walker::visit( stmt );
+			breakable--;
+		}
+
+		void ParallelBody::visit( exo::ast::StmtReturn& stmt )
+		{
+			exits.push_back( &stmt );
+			exo::ast::Walker::visit( stmt );
+		}
+
+		void ParallelBody::visit( exo::ast::StmtSwitch& stmt )
+		{
+			breakable++;
+			exo::ast::Walker::visit( stmt );
+			breakable--;
+		}
+
+		void ParallelBody::visit( exo::ast::StmtWhile& stmt )
+		{
+			breakable++;
+			exo::ast::Walker::visit( stmt );
+			breakable--;
+		}
+
+		void ParallelBody::visit( exo::ast::StmtYield& stmt )
+		{
+			exits.push_back( &stmt );
+			exo::ast::Walker::visit( stmt );
+		}
+
+		StringAppends::StringAppends( exo::ast::StmtList& stmts )
+		{
+			stmts.accept( this );
+		}
+
+		void StringAppends::visit( exo::ast::StmtExpr& stmt )
+		{
+			exo::ast::OpBinaryAssignAdd* append = dynamic_cast<exo::ast::OpBinaryAssignAdd*>( stmt.expression.get() );
+			if( append != nullptr && !CountedLoop::variableName( append->lhs.get() ).empty() ) {
+				variables.insert( CountedLoop::variableName( append->lhs.get() ) );
+				appends.insert( append );
+			}
+
+			exo::ast::Walker::visit( stmt );
+		}
+	}
+}
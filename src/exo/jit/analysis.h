@@ -0,0 +1,204 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ANALYSIS_H_
+#define ANALYSIS_H_
+
+#include "exo/exo.h"
+#include "exo/jit/llvm.h"
+#include "exo/ast/nodes.h"
+#include "exo/ast/walker.h"
+
+namespace exo
+{
+	namespace jit
+	{
+		/**
+		 * recognizes counted for loops, i.e. for( int $i = 0; $i < 16; $i += 1 ) or for( int $i = 0; $i < $a->length(); $i += 1 )
+		 * and collects everything inside the loop that could invalidate the induction variable or the array bound.
+		 */
+		class CountedLoop : public virtual exo::ast::Walker
+		{
+			public:
+				/**
+				 * wether the loop header matches the counted pattern and its variable is never written in the body
+				 */
+				bool		isCounted;
+
+				/**
+				 * name and memory of the induction variable, only valid after its initialization has been generated
+				 */
+				std::string		variable;
+				llvm::Value*	memory;
+
+				/**
+				 * exclusive constant upper bound, or 0 if bounded by the length of an array variable
+				 */
+				long long		bound;
+				std::string		array;
+				llvm::Value*	arrayMemory;
+
+				/**
+				 * variables written, references declared, calls made and tasks awaited inside the loop
+				 */
+				std::set<std::string>					assigned;
+				bool									hasReferences;
+				std::vector<exo::ast::ExprCallFun*>		calls;
+				bool									hasAwaits;
+
+				CountedLoop( exo::ast::StmtFor& loop );
+
+				virtual void visit( exo::ast::DeclVar& );
+				virtual void visit( exo::ast::ExprCallFun& );
+				virtual void visit( exo::ast::ExprCallMethod& );
+				virtual void visit( exo::ast::ExprCallValue& );
+				virtual void visit( exo::ast::OpBinaryAssign& );
+				virtual void visit( exo::ast::OpBinaryAssignAdd& );
+				virtual void visit( exo::ast::OpBinaryAssignDiv& );
+				virtual void visit( exo::ast::OpBinaryAssignMul& );
+				virtual void visit( exo::ast::OpBinaryAssignSub& );
+				virtual void visit( exo::ast::OpUnaryAwait& );
+				virtual void visit( exo::ast::OpUnaryRef& );
+
+				/**
+				 * returns the variable name if expression is a plain variable access, an empty string otherwise
+				 */
+				static std::string	variableName( exo::ast::Expr* expression );
+
+			private:
+				void	write( exo::ast::Expr* expression );
+		};
+
+		/**
+		 * collects the variables a closure uses without declaring them, they are captured from the surrounding function.
+		 * captures are copies, so the closure may not write them. the body of a parallel loop captures the same way
+		 */
+		class ClosureCaptures : public virtual exo::ast::Walker
+		{
+			public:
+				std::vector<std::string>	captured;
+				std::set<std::string>		assigned;
+
+				ClosureCaptures( exo::ast::ExprClosure& closure );
+				ClosureCaptures( exo::ast::StmtFor& loop );
+
+				virtual void visit( exo::ast::DeclVar& );
+				virtual void visit( exo::ast::ExprVar& );
+				virtual void visit( exo::ast::OpBinaryAssign& );
+				virtual void visit( exo::ast::OpBinaryAssignAdd& );
+				virtual void visit( exo::ast::OpBinaryAssignDiv& );
+				virtual void visit( exo::ast::OpBinaryAssignMul& );
+				virtual void visit( exo::ast::OpBinaryAssignSub& );
+				virtual void visit( exo::ast::OpUnaryRef& );
+
+			private:
+				std::vector<std::string>	used;
+				std::set<std::string>		declared;
+
+				void	capture();
+				void	write( exo::ast::Expr* expression );
+		};
+
+		/**
+		 * finds the closures of a function body that may outlive it, because they are returned, stored anywhere but in local variables
+		 * or captured by another escaping closure. all others keep their environment on the stack of the function
+		 */
+		class ClosureEscapes : public virtual exo::ast::Walker
+		{
+			public:
+				std::set<exo::ast::ExprClosure*>	escaping;
+
+				ClosureEscapes( exo::ast::StmtList& stmts );
+
+				virtual void visit( exo::ast::DeclFun& );
+				virtual void visit( exo::ast::DeclTuple& );
+				virtual void visit( exo::ast::DeclVar& );
+				virtual void visit( exo::ast::ExprClosure& );
+				virtual void visit( exo::ast::ExprVar& );
+				virtual void visit( exo::ast::OpBinaryAssign& );
+				virtual void visit( exo::ast::StmtReturn& );
+				virtual void visit( exo::ast::StmtYield& );
+
+			private:
+				/**
+				 * expressions assigned to variables, variables used by closures and expressions whose value escapes
+				 */
+				std::multimap<std::string, exo::ast::Expr*>								flows;
+				std::unordered_map<exo::ast::ExprClosure*, std::set<std::string>>		uses;
+				std::vector<exo::ast::ExprClosure*>										closures;
+				std::vector<exo::ast::Expr*>											escapes;
+		};
+
+		/**
+		 * collects the yields of a function body, any yield makes the function a generator. nested functions and closures
+		 * yield for themselves
+		 */
+		class GeneratorYields : public virtual exo::ast::Walker
+		{
+			public:
+				std::vector<exo::ast::StmtYield*>	yields;
+
+				GeneratorYields( exo::ast::DeclFun& function );
+
+				virtual void visit( exo::ast::DeclFun& );
+				virtual void visit( exo::ast::ExprClosure& );
+				virtual void visit( exo::ast::StmtYield& );
+		};
+
+		/**
+		 * collects what keeps a loop body from running as independent parts, i.e. breaks leaving the loop, returns, awaits
+		 * and yields. breaks of nested loops and switches stay inside, closures return for themselves
+		 */
+		class ParallelBody : public virtual exo::ast::Walker
+		{
+			public:
+				std::vector<exo::ast::Node*>	exits;
+
+				ParallelBody( exo::ast::StmtFor& loop );
+
+				virtual void visit( exo::ast::DeclFun& );
+				virtual void visit( exo::ast::ExprClosure& );
+				virtual void visit( exo::ast::OpUnaryAwait& );
+				virtual void visit( exo::ast::StmtBreak& );
+				virtual void visit( exo::ast::StmtDo& );
+				virtual void visit( exo::ast::StmtFor& );
+				virtual void visit( exo::ast::StmtForIn& );
+				virtual void visit( exo::ast::StmtReturn& );
+				virtual void visit( exo::ast::StmtSwitch& );
+				virtual void visit( exo::ast::StmtWhile& );
+				virtual void visit( exo::ast::StmtYield& );
+
+			private:
+				int		breakable = 0;
+		};
+
+		/**
+		 * collects the += statements on variables, their value is never used so strings may be appended to in place. the
+		 * variables appended to are finished wherever else they are read
+		 */
+		class StringAppends : public virtual exo::ast::Walker
+		{
+			public:
+				std::set<std::string>						variables;
+				std::set<exo::ast::OpBinaryAssignAdd*>		appends;
+
+				StringAppends( exo::ast::StmtList& stmts );
+
+				virtual void visit( exo::ast::StmtExpr& );
+		};
+	}
+}
+
+#endif /* ANALYSIS_H_ */
@@ -48,10 +48,80 @@ namespace exo
 					return( llvm::Type::getDoubleTy( module->getContext() ) );
 				} else if( type->id->name == "bool" ) {
 					return( llvm::Type::getInt1Ty( module->getContext() ) );
+				} else if( type->id->name == "byte" ) { // unsigned
+					return( llvm::Type::getInt8Ty( module->getContext() ) );
 				} else if( type->id->name == "string" ) {
 					return( llvm::Type::getInt8PtrTy( module->getContext() ) );
 				} else if( type->id->name == "null" ) {
 					return( llvm::Type::getVoidTy( module->getContext() ) );
+				} else if( type->id->name == "array" ) {
+					llvm::Type* elementType = getType( type->parameters.at( 0 ).get() );
+					if( elementType->isVoidTy() ) {
+						EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Invalid array element type" ), (*type) );
+					}
+
+					// fixed size arrays are values, growable arrays live on the heap behind a header
+					if( type->size > 0 ) {
+						return( llvm::ArrayType::get( elementType, type->size ) );
+					}
+
+					return( getArrayType( elementType )->getPointerTo() );
+				} else if( type->id->name == "vec" ) {
+					llvm::Type* elementType = getType( type->parameters.at( 0 ).get() );
+					if( !elementType->isIntegerTy() && !elementType->isFloatingPointTy() ) {
+						EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Invalid vector element type" ), (*type) );
+					}
+
+					// without explicit lanes, fill a vector register of our target
+					return( llvm::VectorType::get( elementType, type->size > 0 ? type->size : target->getVectorLanes( elementType ) ) );
+				} else if( type->id->name == "tuple" ) {
+					std::vector<llvm::Type*> elementTypes;
+					for( auto &parameter : type->parameters ) {
+						elementTypes.push_back( getType( parameter.get() ) );
+						if( elementTypes.back()->isVoidTy() ) {
+							EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Invalid tuple element type" ), (*type) );
+						}
+					}
+
+					// literal structs are first class aggregates, small ones are returned in registers
+					return( llvm::StructType::get( module->getContext(), elementTypes ) );
+				} else if( type->id->name == "callable" ) {
+					// the environment is passed ahead of the parameters
+					std::vector<llvm::Type*> parameters = { llvm::Type::getInt8PtrTy( module->getContext() ) };
+					for( size_t i = 1; i < type->parameters.size(); i++ ) {
+						parameters.push_back( getType( type->parameters.at( i ).get() ) );
+					}
+
+					llvm::Type* returnType = type->parameters.empty() ? llvm::Type::getVoidTy( module->getContext() ) : getType( type->parameters.at( 0 ).get() );
+					return( getCallableType( llvm::FunctionType::get( returnType, parameters, false ) ) );
+				} else if( type->id->name == "task" ) {
+					llvm::Type* resultType = type->parameters.empty() ? llvm::Type::getVoidTy( module->getContext() ) : getType( type->parameters.at( 0 ).get() );
+					return( getTaskType( resultType )->getPointerTo() );
+				} else if( type->id->name == "future" ) {
+					llvm::Type* resultType = type->parameters.empty() ? llvm::Type::getVoidTy( module->getContext() ) : getType( type->parameters.at( 0 ).get() );
+					return( getFutureType( resultType )->getPointerTo() );
+				} else if( type->id->name == "atomic" ) {
+					llvm::Type* valueType = getType( type->parameters.at( 0 ).get() );
+					if( !valueType->isIntegerTy() && !valueType->isPointerTy() ) {
+						EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Invalid atomic type" ), (*type) );
+					}
+
+					return( getAtomicType( valueType ) );
+				} else if( type->id->name == "map" || type->id->name == "set" ) {
+					llvm::Type* keyType = getType( type->parameters.at( 0 ).get() );
+					if( !keyType->isIntegerTy() && !keyType->isFloatingPointTy() && !keyType->isPointerTy() ) {
+						EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Invalid key type" ), (*type) );
+					}
+
+					llvm::Type* valueType = nullptr;
+					if( type->id->name == "map" ) {
+						valueType = getType( type->parameters.at( 1 ).get() );
+						if( valueType->isVoidTy() ) {
+							EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Invalid value type" ), (*type) );
+						}
+					}
+
+					return( getMapType( keyType, valueType )->getPointerTo() );
 				}
 
 				EXO_THROW( UnknownPrimitive() );
@@ -62,6 +132,28 @@ namespace exo
 				return( complex->getPointerTo() );
 			}
 
+			// structs are values
+			complex = module->getTypeByName( EXO_STRUCT( type->id->name ) );
+			if( complex != nullptr ) {
+				return( complex );
+			}
+
+			// vector aliases, the element type followed by the lane count (float4, byte16) or x for native width (intx)
+			for( std::string element : { "bool", "byte", "int", "float" } ) {
+				std::string lanes = type->id->name.substr( std::min( element.size(), type->id->name.size() ) );
+
+				if( type->id->name.compare( 0, element.size(), element ) != 0 || lanes.empty() ) {
+					continue;
+				}
+
+				if( lanes == "x" || ( lanes.size() < 5 && lanes.find_first_not_of( "0123456789" ) == std::string::npos && std::stoll( lanes ) > 0 ) ) {
+					exo::ast::Type vector( std::make_unique<exo::ast::Id>( "vec" ), std::make_unique<exo::ast::Type>( std::make_unique<exo::ast::Id>( element ), true ), lanes == "x" ? 0 : std::stoll( lanes ) );
+					vector.lineNo = type->lineNo;
+					vector.columnNo = type->columnNo;
+					return( getType( &vector ) );
+				}
+			}
+
 			EXO_THROW( UnknownClass() << exo::exceptions::ClassName( type->id->name ) );
 			return( nullptr );
 		}
@@ -72,7 +164,7 @@ namespace exo
 			currentResult = val.value ? llvm::ConstantInt::getTrue( type ) : llvm::ConstantInt::getFalse( type );
 
 			if( generateInMem ) {
-				llvm::AllocaInst* memory = builder.CreateAlloca( type );
+				llvm::AllocaInst* memory = allocateLocal( type );
 				builder.CreateStore( currentResult, memory );
 				currentResult = memory;
 			}
@@ -84,7 +176,7 @@ namespace exo
 			currentResult = llvm::ConstantFP::get( type, val.value );
 
 			if( generateInMem ) {
-				llvm::AllocaInst* memory = builder.CreateAlloca( type );
+				llvm::AllocaInst* memory = allocateLocal( type );
 				builder.CreateStore( currentResult, memory );
 				currentResult = memory;
 			}
@@ -96,7 +188,7 @@ namespace exo
 			currentResult = llvm::ConstantInt::get( type, val.value );
 
 			if( generateInMem ) {
-				llvm::AllocaInst* memory = builder.CreateAlloca( type );
+				llvm::AllocaInst* memory = allocateLocal( type );
 				builder.CreateStore( currentResult, memory );
 				currentResult = memory;
 			}
@@ -108,7 +200,7 @@ namespace exo
 			currentResult = llvm::Constant::getNullValue( type );
 
 			if( generateInMem ) {
-				llvm::AllocaInst* memory = builder.CreateAlloca( type );
+				llvm::AllocaInst* memory = allocateLocal( type );
 				builder.CreateStore( currentResult, memory );
 				currentResult = memory;
 			}
@@ -116,7 +208,7 @@ namespace exo
 
 		void Codegen::visit( exo::ast::ConstStr& val )
 		{
-			currentResult = builder.CreateGlobalStringPtr( val.value );
+			currentResult = createString( val.value );
 		}
 
 		/*
@@ -126,7 +218,11 @@ namespace exo
 		{
 			EXO_CODEGEN_LOG( decl, "Declaring class " << decl.id->name );
 
-			std::string name = EXO_CLASS( decl.id->name );
+			std::string name = decl.isValue ? EXO_STRUCT( decl.id->name ) : EXO_CLASS( decl.id->name );
+
+			if( module->getTypeByName( decl.isValue ? EXO_CLASS( decl.id->name ) : EXO_STRUCT( decl.id->name ) ) != nullptr ) {
+				EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "A class and a struct can not share a name" ), decl );
+			}
 
 			llvm::StructType* structr = llvm::StructType::create( module->getContext(), name );
 			llvm::StructType* vstructr = llvm::StructType::create( module->getContext(), EXO_VTABLE( decl.id->name ) );
@@ -162,12 +258,16 @@ namespace exo
 				llvm::Type* type = getType( property->property->type.get() );
 				llvm::Value* value;
 
+				if( type == structr ) {
+					EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "A struct can not contain itself" ), (*property) );
+				}
+
 				if( property->property->expression ) {
 					generateInMem = false;
 					property->property->expression->accept( this );
 					value = currentResult;
 				} else {
-					value = llvm::Constant::getNullValue( type );
+					value = createDefault( type );
 				}
 
 				int position;
@@ -193,10 +293,15 @@ namespace exo
 			vstructr->setBody( vtbl ); // populate opaque type or gep instructions will fail
 			*/
 			for( auto &method : decl.methods ) {
+				if( !GeneratorYields( *method ).yields.empty() ) {
+					EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Methods can not be generators" ), (*method) );
+				}
+
 				std::string methodName = method->id->name;
 				method->id->name = EXO_METHOD( decl.id->name, method->id->name );
 
-				method->arguments->list.insert( method->arguments->list.begin(), std::make_unique<exo::ast::DeclVar>( "this", std::make_unique<exo::ast::Type>( std::make_unique<exo::ast::Id>( decl.id->name, decl.id->inNamespace ) ) ) );
+				// methods of structs work on the value in place
+				method->arguments->list.insert( method->arguments->list.begin(), std::make_unique<exo::ast::DeclVar>( "this", std::make_unique<exo::ast::Type>( std::make_unique<exo::ast::Id>( decl.id->name, decl.id->inNamespace ) ), decl.isValue ) );
 				method->accept( this );
 
 				int position;
@@ -236,18 +341,35 @@ namespace exo
 				arguments.push_back( getType( argument->type.get() ) );
 			}
 
-			llvm::Function* function = llvm::Function::Create(
-				llvm::FunctionType::get( getType( decl.returnType.get() ), arguments, decl.hasVaArg ),
-				llvm::GlobalValue::ExternalLinkage,
-				decl.id->name,
-				module.get()
-			);
+			llvm::FunctionType* type = llvm::FunctionType::get( getType( decl.returnType.get() ), arguments, decl.hasVaArg );
+
+			bool isLowered = isStructABI( type->getReturnType() ) || ( isString( type->getReturnType() ) && !isRuntimeFun( decl.id->name ) );
+			for( auto argument : arguments ) {
+				isLowered |= isStructABI( argument );
+			}
+
+			if( !isLowered ) {
+				llvm::Function::Create( type, llvm::GlobalValue::ExternalLinkage, decl.id->name, module.get() );
+				return;
+			}
+
+			createABIWrapper( type, decl.id->name );
 		}
 
 		void Codegen::visit( exo::ast::DeclFun& decl )
 		{
 			EXO_CODEGEN_LOG( decl, "Declaring function " << decl.id->name );
 
+			// generators have no function of their own, every for in loop iterating one inlines its body
+			if( !GeneratorYields( decl ).yields.empty() ) {
+				if( decl.isAsync ) {
+					EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Async functions can not yield" ), decl );
+				}
+
+				generators[ decl.id->name ] = &decl;
+				return;
+			}
+
 			// build up the function argument list
 			std::vector<llvm::Type*> arguments;
 			for( auto &argument : decl.arguments->list ) {
@@ -261,6 +383,12 @@ namespace exo
 				}
 			}
 
+			// async functions are split into a ramp returning the task and a function resuming it
+			if( decl.isAsync ) {
+				generateAsync( decl, arguments );
+				return;
+			}
+
 			// create a function block for our local variables
 			llvm::Function* function = llvm::Function::Create(
 					llvm::FunctionType::get( getType( decl.returnType.get() ),	arguments, decl.hasVaArg ),
@@ -270,19 +398,47 @@ namespace exo
 			);
 			llvm::BasicBlock* block = llvm::BasicBlock::Create( module->getContext(), decl.id->name, function );
 
+			ClosureEscapes escapes( *decl.scope->stmts );
+			escapingClosures.insert( escapes.escaping.begin(), escapes.escaping.end() );
+
 			// track our scope, exit block
-			builder.SetInsertPoint( stack->Push( block, stack->Block() ) );
+			builder.SetInsertPoint( stack->PushFunction( block, stack->Block() ) );
+
+			generateFunction( decl, function, 0 );
+
+			// pop our block, void local variables
+			builder.SetInsertPoint( stack->Pop() );
+		}
+
+		/*
+		 * binds the arguments, starting at the given one, and generates the statements of a function
+		 */
+		void Codegen::generateFunction( exo::ast::DeclFun& decl, llvm::Function* function, unsigned firstArgument )
+		{
+			// loops around the declaration do not reach into the function, neither does an async function around it
+			std::vector<CountedLoop*> loops;
+			loops.swap( countedLoops );
+			llvm::Value* frame = asyncFrame;
+			asyncFrame = nullptr;
+			InlinedGenerator* inlined = generator;
+			generator = nullptr;
 
 			// create loads for the arguments passed to our function
 			int i = 0;
 			for( auto &argument : function->args() ) {
+				if( argument.getArgNo() < firstArgument ) {
+					continue;
+				}
+
 				exo::ast::DeclVar* var = decl.arguments->list.at( i ).get();
 
-				// if argument is passed by reference, it should be already allocated
+				// if argument is passed by reference, it should be already allocated. keep the pointer like a declared reference
 				if( var->isRef ) {
-					stack->Set( var->name, &argument, true );
+					llvm::AllocaInst* memory = allocateLocal( argument.getType() );
+					builder.CreateStore( &argument, memory );
+					stack->Set( var->name, memory, true );
 				} else {
-					llvm::AllocaInst* memory = builder.CreateAlloca( argument.getType() );
+					llvm::AllocaInst* memory = allocateLocal( argument.getType() );
 					builder.CreateStore( &argument, memory );
 					stack->Set( var->name, memory );
 				}
@@ -306,8 +462,420 @@ namespace exo
 				}
 			}
 
-			// pop our block, void local variables
+			loops.swap( countedLoops );
+			asyncFrame = frame;
+			generator = inlined;
+		}
+
+		/*
+		 * an async function is split in three. the function itself allocates the frame on the heap and hands it to the start
+		 * function, which initializes the frame and resumes it once. the resume function holds the body and continues at
+		 * the await the frame was suspended at. since every await returns from it, all locals live in the frame
+		 */
+		void Codegen::generateAsync( exo::ast::DeclFun& decl, std::vector<llvm::Type*> arguments )
+		{
+			EXO_CODEGEN_LOG( decl, "Declaring async function " << decl.id->name );
+
+			llvm::IntegerType* intType = llvm::Type::getInt64Ty( module->getContext() );
+			llvm::Type* ptrType = llvm::Type::getInt8PtrTy( module->getContext() );
+			llvm::Type* voidType = llvm::Type::getVoidTy( module->getContext() );
+
+			// a reference could point into the stack of our caller, which is long gone once we resume
+			for( auto &argument : decl.arguments->list ) {
+				if( argument->isRef ) {
+					EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Async functions can not take references" ), (*argument) );
+				}
+			}
+
+			llvm::StructType* taskType = getTaskType( getType( decl.returnType.get() ) );
+			llvm::StructType* frameType = llvm::StructType::create( module->getContext(), EXO_ASYNC_FRAME( decl.id->name ) );
+			llvm::GlobalValue::LinkageTypes linkage = decl.access->isPublic ? llvm::GlobalValue::ExternalLinkage : llvm::GlobalValue::InternalLinkage;
+
+			std::vector<llvm::Type*> startArguments = { ptrType };
+			startArguments.insert( startArguments.end(), arguments.begin(), arguments.end() );
+
+			llvm::Function* function = llvm::Function::Create( llvm::FunctionType::get( taskType->getPointerTo(), arguments, false ), linkage, decl.id->name, module.get() );
+			llvm::Function* start = llvm::Function::Create( llvm::FunctionType::get( taskType->getPointerTo(), startArguments, false ), linkage, EXO_ASYNC_START( decl.id->name ), module.get() );
+			llvm::Function* resume = llvm::Function::Create( llvm::FunctionType::get( voidType, { ptrType }, false ), llvm::GlobalValue::InternalLinkage, EXO_ASYNC_RESUME( decl.id->name ), module.get() );
+
+			// the entry block dispatches on the state, it is completed once we know all awaits
+			llvm::BasicBlock* dispatch = llvm::BasicBlock::Create( module->getContext(), "dispatch", resume );
+			llvm::BasicBlock* block = llvm::BasicBlock::Create( module->getContext(), decl.id->name, resume );
+			llvm::IRBuilder<> entry( dispatch );
+			llvm::Instruction* header = llvm::cast<llvm::Instruction>( entry.CreateBitCast( &*resume->arg_begin(), taskType->getPointerTo(), "task" ) );
+
+			ClosureEscapes escapes( *decl.scope->stmts );
+			escapingClosures.insert( escapes.escaping.begin(), escapes.escaping.end() );
+
+			std::vector<CountedLoop*> loops;
+			loops.swap( countedLoops );
+			std::vector<llvm::BasicBlock*> resumes;
+			resumes.swap( asyncResumes );
+			llvm::Value* frame = asyncFrame;
+			asyncFrame = header;
+			InlinedGenerator* inlined = generator;
+			generator = nullptr;
+
+			builder.SetInsertPoint( stack->PushFunction( block, stack->Block() ) );
+
+			// the start function stores the arguments
+			std::vector<llvm::AllocaInst*> parameters;
+			for( auto &argument : decl.arguments->list ) {
+				parameters.push_back( allocateLocal( getType( argument->type.get() ), argument->name ) );
+				stack->Set( argument->name, parameters.back() );
+			}
+
+			generateInMem = false;
+			decl.scope->stmts->accept( this );
+
+			llvm::TerminatorInst* retVal = stack->Block()->getTerminator();
+			if( retVal == nullptr || !llvm::isa<llvm::ReturnInst>(retVal) ) {
+				EXO_CODEGEN_LOG( decl, "Generating completion" );
+				completeTask( taskType->getNumElements() > EXO_TASK_RESULT ? createDefault( taskType->getElementType( EXO_TASK_RESULT ) ) : nullptr );
+			}
+
+			builder.SetInsertPoint( stack->Pop() );
+
+			// state 0 starts the body, any other continues after its await
+			llvm::SwitchInst* dispatcher = entry.CreateSwitch( entry.CreateLoad( entry.CreateStructGEP( taskType, header, EXO_TASK_STATE ), "state" ), block, asyncResumes.size() );
+			for( unsigned i = 0; i < asyncResumes.size(); i++ ) {
+				dispatcher->addCase( llvm::ConstantInt::get( intType, i + 1 ), asyncResumes.at( i ) );
+			}
+
+			loops.swap( countedLoops );
+			resumes.swap( asyncResumes );
+			asyncFrame = frame;
+			generator = inlined;
+
+			// every local becomes a field of the frame, behind the task header
+			std::vector<llvm::AllocaInst*> locals;
+			std::vector<llvm::Type*> fields( taskType->element_begin(), taskType->element_end() );
+			for( auto &instruction : *dispatch ) {
+				if( llvm::isa<llvm::AllocaInst>( instruction ) ) {
+					locals.push_back( llvm::cast<llvm::AllocaInst>( &instruction ) );
+					fields.push_back( locals.back()->getAllocatedType() );
+				}
+			}
+			frameType->setBody( fields );
+
+			std::vector<unsigned> slots;
+			for( auto parameter : parameters ) {
+				slots.push_back( taskType->getNumElements() + ( std::find( locals.begin(), locals.end(), parameter ) - locals.begin() ) );
+			}
+
+			llvm::IRBuilder<> spill( header );
+			llvm::Value* memory = spill.CreateBitCast( &*resume->arg_begin(), frameType->getPointerTo(), "frame" );
+			for( unsigned i = 0; i < locals.size(); i++ ) {
+				locals.at( i )->replaceAllUsesWith( spill.CreateStructGEP( frameType, memory, taskType->getNumElements() + i, locals.at( i )->getName() ) );
+				locals.at( i )->eraseFromParent();
+			}
+
+			// initialize the frame and run up to the first await, just like a plain call would
+			llvm::IRBuilder<> ramp( llvm::BasicBlock::Create( module->getContext(), decl.id->name, start ) );
+			llvm::Function::arg_iterator argument = start->arg_begin();
+			llvm::Value* task = &*argument++;
+
+			memory = ramp.CreateBitCast( task, frameType->getPointerTo() );
+			ramp.CreateStore( llvm::ConstantInt::get( intType, 0 ), ramp.CreateStructGEP( frameType, memory, EXO_TASK_STATE ) );
+			ramp.CreateStore( resume, ramp.CreateStructGEP( frameType, memory, EXO_TASK_RESUME ) );
+			ramp.CreateStore( llvm::ConstantPointerNull::get( llvm::cast<llvm::PointerType>( ptrType ) ), ramp.CreateStructGEP( frameType, memory, EXO_TASK_WAITER ) );
+			for( unsigned i = 0; i < slots.size(); i++, argument++ ) {
+				ramp.CreateStore( &*argument, ramp.CreateStructGEP( frameType, memory, slots.at( i ) ) );
+			}
+			ramp.CreateCall( resume, { task } );
+			ramp.CreateRet( ramp.CreateBitCast( task, taskType->getPointerTo() ) );
+
+			// the task may outlive our caller, unless it is awaited right away
+			ramp.SetInsertPoint( llvm::BasicBlock::Create( module->getContext(), decl.id->name, function ) );
+			std::vector<llvm::Value*> values = { ramp.CreateCall( getFunction( EXO_ALLOC ), { llvm::ConstantExpr::getSizeOf( frameType ) } ) };
+			for( auto &argument : function->args() ) {
+				values.push_back( &argument );
+			}
+			ramp.CreateRet( ramp.CreateCall( start, values ) );
+		}
+
+		/*
+		 * stores the result of the async function we are generating, wakes up its waiter and returns to whoever resumed us
+		 */
+		void Codegen::completeTask( llvm::Value* result )
+		{
+			llvm::Type* ptrType = llvm::Type::getInt8PtrTy( module->getContext() );
+			llvm::StructType* taskType = llvm::cast<llvm::StructType>( asyncFrame->getType()->getPointerElementType() );
+
+			if( result != nullptr && taskType->getNumElements() > EXO_TASK_RESULT ) {
+				llvm::Type* type = taskType->getElementType( EXO_TASK_RESULT );
+				createStore( promoteCallable( convertValue( result, type ) ), builder.CreateStructGEP( taskType, asyncFrame, EXO_TASK_RESULT ) );
+			}
+
+			builder.CreateCall( getRuntimeFun( "exo_task_complete", llvm::Type::getVoidTy( module->getContext() ), { ptrType } ), { builder.CreateBitCast( asyncFrame, ptrType ) } );
+			builder.CreateRetVoid();
+		}
+
+		/*
+		 * the body is outlined into a function running a range of iterations, the runtime splits the iterations among the
+		 * workers. variables around the loop are shared read only, reductions accumulate into partials of each range which
+		 * are merged in iteration order. for associative operations the result matches the sequential loop
+		 */
+		void Codegen::generateParallelFor( exo::ast::StmtFor& stmt )
+		{
+			EXO_CODEGEN_LOG( stmt, "Parallel for loop" );
+
+			llvm::IntegerType* intType = llvm::Type::getInt64Ty( module->getContext() );
+			llvm::Type* ptrType = llvm::Type::getInt8PtrTy( module->getContext() );
+			llvm::Type* voidType = llvm::Type::getVoidTy( module->getContext() );
+
+			// for( int $i = start; $i < end; $i += step ), the range is evaluated once up front
+			exo::ast::DeclVar* variable = stmt.initialization->list.size() == 1 ? stmt.initialization->list.front().get() : nullptr;
+			exo::ast::OpBinary* condition = dynamic_cast<exo::ast::OpBinaryLt*>( stmt.expression.get() );
+			int64_t inclusive = 0;
+			if( condition == nullptr ) {
+				condition = dynamic_cast<exo::ast::OpBinaryLe*>( stmt.expression.get() );
+				inclusive = 1;
+			}
+			exo::ast::OpBinaryAssignAdd* update = stmt.update->list.size() == 1 ? dynamic_cast<exo::ast::OpBinaryAssignAdd*>( stmt.update->list.front().get() ) : nullptr;
+			exo::ast::ConstInt* step = update != nullptr ? dynamic_cast<exo::ast::ConstInt*>( update->rhs.get() ) : nullptr;
+
+			if( variable == nullptr || variable->isRef || !variable->expression || variable->type->id->name != "int" || condition == nullptr || CountedLoop::variableName( condition->lhs.get() ) != variable->name
+				|| step == nullptr || step->value <= 0 || CountedLoop::variableName( update->lhs.get() ) != variable->name ) {
+				EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Parallel for loops need the form for( int $i = start; $i < end; $i += step )" ), stmt );
+			}
+
+			// iterations have to be independent of each other
+			ParallelBody body( stmt );
+			if( !body.exits.empty() ) {
+				EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Can not break, return, await or yield in a parallel for" ), (*body.exits.front()) );
+			}
+
+			ClosureCaptures captures( stmt );
+			if( captures.assigned.count( variable->name ) ) {
+				EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Parallel for loops may not write their variable" ), stmt );
+			}
+
+			// reductions, a private copy for every range starts at the identity of the operation
+			std::vector<std::string> reductions;
+			std::vector<std::string> operations;
+			std::vector<llvm::Value*> results;
+			std::vector<llvm::Value*> identities;
+			for( auto &expression : stmt.reductions->list ) {
+				exo::ast::ExprCallFun* reduction = dynamic_cast<exo::ast::ExprCallFun*>( expression.get() );
+				if( reduction == nullptr || dynamic_cast<exo::ast::ExprCallMethod*>( reduction ) != nullptr || reduction->arguments->list.empty() || reduction->arguments->list.size() > 2
+					|| CountedLoop::variableName( reduction->arguments->list.front().get() ).empty() ) {
+					EXO_THROW_AT( InvalidExpr() << exo::exceptions::Message( "Expecting reduction, i.e. sum( $variable )" ), (*expression) );
+				}
+
+				std::string name = CountedLoop::variableName( reduction->arguments->list.front().get() );
+				std::string operation = reduction->id->name;
+
+				llvm::Value* memory = stack->isGlobal( name ) ? getThreadLocal( name ) : stack->Get( name );
+				if( stack->isRef( name ) ) {
+					memory = builder.CreateLoad( memory );
+				}
+				llvm::Type* type = memory->getType()->getPointerElementType();
+
+				llvm::Value* identity;
+				if( operation == "sum" || operation == "min" || operation == "max" ) {
+					if( !type->isIntegerTy() && !type->isFloatingPointTy() ) {
+						EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Invalid reduction type" ), (*reduction) );
+					}
+
+					if( operation == "sum" ) {
+						identity = llvm::Constant::getNullValue( type );
+					} else if( type->isFloatingPointTy() ) {
+						identity = llvm::ConstantFP::getInfinity( type, operation == "max" );
+					} else if( isUnsigned( type ) ) {
+						identity = llvm::ConstantInt::get( type, operation == "min" ? llvm::APInt::getMaxValue( type->getIntegerBitWidth() ) : llvm::APInt::getMinValue( type->getIntegerBitWidth() ) );
+					} else {
+						identity = llvm::ConstantInt::get( type, operation == "min" ? llvm::APInt::getSignedMaxValue( type->getIntegerBitWidth() ) : llvm::APInt::getSignedMinValue( type->getIntegerBitWidth() ) );
+					}
+				} else if( operation == "any" || operation == "all" ) {
+					if( !type->isIntegerTy( 1 ) ) {
+						EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Invalid reduction type" ), (*reduction) );
+					}
+
+					identity = llvm::ConstantInt::get( type, operation == "all" );
+				} else {
+					llvm::FunctionType* function = getFunction( operation )->getFunctionType();
+					if( function->getReturnType() != type || function->getNumParams() != 2 || function->getParamType( 0 ) != type || function->getParamType( 1 ) != type ) {
+						EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Reduction functions need to combine two values of the reduced type" ), (*reduction) );
+					}
+
+					// without an explicit identity, the default value of the type has to be one
+					if( reduction->arguments->list.size() > 1 ) {
+						generateInMem = false;
+						reduction->arguments->list.at( 1 )->accept( this );
+						identity = convertValue( currentResult, type );
+					} else {
+						identity = createDefault( type );
+					}
+				}
+
+				reductions.push_back( name );
+				operations.push_back( operation );
+				results.push_back( memory );
+				identities.push_back( identity );
+			}
+
+			// everything else is shared, the ranges only read it
+			std::vector<std::string> names;
+			std::vector<llvm::Value*> shared;
+			std::vector<llvm::Type*> fields = { intType };
+			for( auto &name : captures.captured ) {
+				if( std::find( reductions.begin(), reductions.end(), name ) != reductions.end() || stack->isGlobal( name ) ) {
+					continue;
+				}
+
+				llvm::Value* memory;
+				try {
+					memory = stack->Get( name );
+				} catch( boost::exception &exception ) { // unknown variables fail inside the loop
+					continue;
+				}
+
+				if( captures.assigned.count( name ) ) {
+					EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Variable $" + name + " is shared by the iterations of a parallel for, only reductions may be written" ), stmt );
+				}
+
+				names.push_back( name );
+				shared.push_back( memory );
+				fields.push_back( memory->getType() );
+			}
+
+			llvm::StructType* contextType = llvm::StructType::get( module->getContext(), fields );
+			std::vector<llvm::Type*> types;
+			for( auto &identity : identities ) {
+				types.push_back( identity->getType() );
+			}
+			llvm::StructType* partialsType = llvm::StructType::get( module->getContext(), types );
+
+			llvm::Function* combine = llvm::Function::Create( llvm::FunctionType::get( voidType, { ptrType, ptrType }, false ), llvm::GlobalValue::InternalLinkage, "parallel-combine", module.get() );
+			llvm::Function* outlined = llvm::Function::Create( llvm::FunctionType::get( voidType, { ptrType, ptrType, intType, intType }, false ), llvm::GlobalValue::InternalLinkage, "parallel-for", module.get() );
+
+			// merges the partials of the following range into ours
+			builder.SetInsertPoint( stack->PushFunction( llvm::BasicBlock::Create( module->getContext(), "parallel-combine", combine ), stack->Block() ) );
+			llvm::Function::arg_iterator argument = combine->arg_begin();
+			llvm::Value* partials = builder.CreateBitCast( &*argument++, partialsType->getPointerTo() );
+			llvm::Value* other = builder.CreateBitCast( &*argument++, partialsType->getPointerTo() );
+			for( unsigned i = 0; i < reductions.size(); i++ ) {
+				llvm::Value* memory = builder.CreateStructGEP( partialsType, partials, i );
+				createStore( combineValues( operations.at( i ), createLoad( memory ), createLoad( builder.CreateStructGEP( partialsType, other, i ) ), stmt ), memory );
+			}
+			builder.CreateRetVoid();
+			builder.SetInsertPoint( stack->Pop() );
+
+			// runs the iterations from up to to, $i = start + iteration * step
+			llvm::BasicBlock* forBlock		= llvm::BasicBlock::Create( module->getContext(), "parallel-for", outlined );
+			llvm::BasicBlock* forCondition	= llvm::BasicBlock::Create( module->getContext(), "parallel-for-condition", outlined );
+			llvm::BasicBlock* forLoop		= llvm::BasicBlock::Create( module->getContext(), "parallel-for-loop", outlined );
+			llvm::BasicBlock* forUpdate		= llvm::BasicBlock::Create( module->getContext(), "parallel-for-update", outlined );
+			llvm::BasicBlock* forExit		= llvm::BasicBlock::Create( module->getContext(), "parallel-for-exit", outlined );
+
+			std::vector<CountedLoop*> loops;
+			loops.swap( countedLoops );
+			llvm::Value* frame = asyncFrame;
+			asyncFrame = nullptr;
+			InlinedGenerator* inlined = generator;
+			generator = nullptr;
+
+			builder.SetInsertPoint( stack->PushFunction( forBlock, stack->Block() ) );
+			argument = outlined->arg_begin();
+			llvm::Value* context = builder.CreateBitCast( &*argument++, contextType->getPointerTo() );
+			partials = builder.CreateBitCast( &*argument++, partialsType->getPointerTo() );
+			llvm::Value* from = &*argument++;
+			llvm::Value* to = &*argument++;
+
+			llvm::Value* start = builder.CreateLoad( builder.CreateStructGEP( contextType, context, 0 ), "start" );
+			for( unsigned i = 0; i < names.size(); i++ ) {
+				stack->Set( names.at( i ), builder.CreateLoad( builder.CreateStructGEP( contextType, context, i + 1 ) ), stack->isRef( names.at( i ) ) );
+			}
+			for( unsigned i = 0; i < reductions.size(); i++ ) {
+				stack->Set( reductions.at( i ), builder.CreateStructGEP( partialsType, partials, i ) );
+			}
+
+			llvm::AllocaInst* iteration = allocateLocal( intType, "iteration" );
+			llvm::AllocaInst* counter = allocateLocal( intType, variable->name );
+			stack->Set( variable->name, counter );
+			builder.CreateStore( from, iteration );
+			builder.CreateBr( forCondition );
+
+			builder.SetInsertPoint( stack->Join( forCondition ) );
+			builder.CreateCondBr( builder.CreateICmpSLT( builder.CreateLoad( iteration ), to ), forLoop, forExit );
+
+			// continue goes on with the next iteration, breaking out has been ruled out
+			builder.SetInsertPoint( stack->Push( forLoop, forExit, forUpdate ) );
+			builder.CreateStore( builder.CreateAdd( start, builder.CreateMul( builder.CreateLoad( iteration ), llvm::ConstantInt::get( intType, step->value ) ) ), counter );
+
+			// shared strings are finished up front, the ranges must not write them
+			std::set<std::string> appended = appendedStrings;
+			for( auto &name : names ) {
+				appendedStrings.erase( name );
+			}
+
+			generateInMem = false;
+			stmt.scope->accept( this );
+			if( stack->Block()->getTerminator() == nullptr ) {
+				builder.CreateBr( forUpdate );
+			}
+			stack->Pop();
+
+			appendedStrings.swap( appended );
+
+			builder.SetInsertPoint( forUpdate );
+			builder.CreateStore( builder.CreateAdd( builder.CreateLoad( iteration ), llvm::ConstantInt::get( intType, 1 ) ), iteration );
+			builder.CreateBr( forCondition );
+
+			builder.SetInsertPoint( forExit );
+			builder.CreateRetVoid();
+
+			loops.swap( countedLoops );
+			asyncFrame = frame;
+			generator = inlined;
+
 			builder.SetInsertPoint( stack->Pop() );
+
+			// the range is evaluated in the scope of the loop variable, just like the sequential loop would
+			generateInMem = false;
+			variable->expression->accept( this );
+			start = convertValue( currentResult, intType );
+			condition->rhs->accept( this );
+			llvm::Value* end = convertValue( currentResult, intType );
+
+			llvm::Value* span = builder.CreateSub( builder.CreateAdd( end, llvm::ConstantInt::get( intType, inclusive ) ), start, "span" );
+			llvm::Value* iterations = builder.CreateSelect( builder.CreateICmpSGT( span, llvm::ConstantInt::get( intType, 0 ) ),
+				builder.CreateSDiv( builder.CreateAdd( span, llvm::ConstantInt::get( intType, step->value - 1 ) ), llvm::ConstantInt::get( intType, step->value ) ),
+				llvm::ConstantInt::get( intType, 0 ), "iterations" );
+
+			// we wait for the loop, so everything it needs can live on our stack
+			context = allocateLocal( contextType, "parallel-context" );
+			builder.CreateStore( start, builder.CreateStructGEP( contextType, context, 0 ) );
+			for( unsigned i = 0; i < shared.size(); i++ ) {
+				if( isAppended( names.at( i ), shared.at( i ) ) ) {
+					finishString( shared.at( i ) );
+				}
+				builder.CreateStore( shared.at( i ), builder.CreateStructGEP( contextType, context, i + 1 ) );
+			}
+
+			llvm::Value* identity = allocateLocal( partialsType, "parallel-identity" );
+			partials = allocateLocal( partialsType, "parallel-partials" );
+			for( unsigned i = 0; i < identities.size(); i++ ) {
+				builder.CreateStore( identities.at( i ), builder.CreateStructGEP( partialsType, identity, i ) );
+				builder.CreateStore( identities.at( i ), builder.CreateStructGEP( partialsType, partials, i ) );
+			}
+
+			// the layout matches exo_loop in the runtime
+			llvm::StructType* loopType = llvm::StructType::get( module->getContext(), { ptrType, ptrType, ptrType, ptrType, intType } );
+			llvm::Value* loop = allocateLocal( loopType, "parallel-loop" );
+			builder.CreateStore( builder.CreateBitCast( outlined, ptrType ), builder.CreateStructGEP( loopType, loop, 0 ) );
+			builder.CreateStore( builder.CreateBitCast( combine, ptrType ), builder.CreateStructGEP( loopType, loop, 1 ) );
+			builder.CreateStore( builder.CreateBitCast( context, ptrType ), builder.CreateStructGEP( loopType, loop, 2 ) );
+			builder.CreateStore( builder.CreateBitCast( identity, ptrType ), builder.CreateStructGEP( loopType, loop, 3 ) );
+			builder.CreateStore( llvm::ConstantExpr::getSizeOf( partialsType ), builder.CreateStructGEP( loopType, loop, 4 ) );
+
+			builder.CreateCall( getRuntimeFun( "exo_parallel_for", voidType, { ptrType, intType, ptrType } ), { builder.CreateBitCast( loop, ptrType ), iterations, builder.CreateBitCast( partials, ptrType ) } );
+
+			// the value before the loop comes first
+			for( unsigned i = 0; i < reductions.size(); i++ ) {
+				createStore( combineValues( operations.at( i ), createLoad( results.at( i ) ), createLoad( builder.CreateStructGEP( partialsType, partials, i ) ), stmt ), results.at( i ) );
+			}
 		}
 
 		// this is basically a NOP
@@ -330,15 +898,21 @@ namespace exo
 
 			bool inMem = generateInMem;
 
+			if( decl.isThreadLocal ) {
+				generateThreadLocal( decl, type );
+				return;
+			}
+
 			if( decl.isRef ) {
 				type = type->getPointerTo(); // only needed for primitives?
 			}
 
 			try {
-				memory = builder.CreateAlloca( type );
+				memory = allocateLocal( type );
 
 				if( decl.expression ) {
 					generateInMem = false;
+					isSuspendable = dynamic_cast<exo::ast::OpUnaryAwait*>( decl.expression.get() ) != nullptr;
 					decl.expression->accept( this );
 
 					value = currentResult;
@@ -346,7 +920,11 @@ namespace exo
 						EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Can only assign variables by reference" ), decl );
 					}
 				} else {
-					value = llvm::Constant::getNullValue( type );
+					value = createDefault( type );
+				}
+
+				if( !decl.isRef ) {
+					value = convertValue( value, type );
 				}
 
 				builder.CreateStore( value, memory );
@@ -363,6 +941,54 @@ namespace exo
 			}
 		}
 
+		/*
+		 * thread locals have an initial value every thread gets a copy of. MCJIT can't relocate TLS, so the copies are kept
+		 * by the runtime, the global only holds the slot it assigned to the variable
+		 */
+		void Codegen::generateThreadLocal( exo::ast::DeclVar& decl, llvm::Type* type )
+		{
+			EXO_CODEGEN_LOG( decl, "Thread local $" << decl.name );
+
+			bool inMem = generateInMem;
+
+			if( decl.isRef ) {
+				EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Thread local variables can not be references" ), decl );
+			}
+
+			llvm::Value* value = createDefault( type );
+			if( decl.expression ) {
+				generateInMem = false;
+				decl.expression->accept( this );
+				value = convertValue( currentResult, type );
+			}
+
+			llvm::Constant* initializer = llvm::dyn_cast<llvm::Constant>( value );
+			if( initializer == nullptr || value->getType() != type ) {
+				EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Thread local variables need a constant initial value" ), decl );
+			}
+
+			llvm::IntegerType* intType = llvm::Type::getInt64Ty( module->getContext() );
+			threadLocals[ decl.name ] = new llvm::GlobalVariable( *module, type, true, llvm::GlobalValue::InternalLinkage, initializer, decl.name + ".initial" );
+			stack->SetGlobal( decl.name, new llvm::GlobalVariable( *module, intType, false, llvm::GlobalValue::InternalLinkage, llvm::ConstantInt::get( intType, -1 ) ) );
+
+			currentResult = inMem ? getThreadLocal( decl.name ) : value;
+		}
+
+		// looked up on every access, async functions may resume on another thread
+		llvm::Value* Codegen::getThreadLocal( std::string name )
+		{
+			llvm::GlobalVariable* initial = threadLocals.at( name );
+			llvm::Type* type = initial->getValueType();
+			llvm::IntegerType* intType = llvm::Type::getInt64Ty( module->getContext() );
+			llvm::Type* ptrType = llvm::Type::getInt8PtrTy( module->getContext() );
+
+			llvm::Value* memory = builder.CreateCall(
+				getRuntimeFun( "exo_thread_local", ptrType, { intType->getPointerTo(), ptrType, intType } ),
+				{ stack->Get( name ), builder.CreateBitCast( initial, ptrType ), llvm::ConstantInt::get( intType, module->getDataLayout().getTypeAllocSize( type ) ) } );
+
+			return( builder.CreateBitCast( memory, type->getPointerTo() ) );
+		}
+
 		void Codegen::visit( exo::ast::DeclVarList& decl )
 		{
 			for( auto &argument : decl.list ) {
@@ -370,13 +996,79 @@ namespace exo
 			}
 		}
 
+		void Codegen::visit( exo::ast::DeclTuple& decl )
+		{
+			EXO_CODEGEN_LOG( decl, "Destructuring into " << decl.variables->list.size() << " variable(s)" );
+
+			generateInMem = false;
+			decl.expression->accept( this );
+
+			llvm::Value* tuple = currentResult;
+			llvm::Type* type = tuple->getType();
+			if( !isTuple( type ) ) {
+				EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Expecting tuple" ), decl );
+			}
+			if( type->getStructNumElements() != decl.variables->list.size() ) {
+				EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Tuple size mismatch" ), decl );
+			}
+
+			for( unsigned i = 0; i < decl.variables->list.size(); i++ ) {
+				exo::ast::DeclVar* variable = decl.variables->list.at( i ).get();
+				if( variable->isRef || variable->expression ) {
+					EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Can only destructure into plain variables" ), (*variable) );
+				}
+
+				// auto takes over the element type
+				llvm::Type* elementType = variable->type->id->name == "auto" ? type->getStructElementType( i ) : getType( variable->type.get() );
+				llvm::AllocaInst* memory = allocateLocal( elementType );
+
+				builder.CreateStore( convertValue( builder.CreateExtractValue( tuple, i, variable->name ), elementType ), memory );
+				stack->Set( variable->name, memory, false );
+			}
+
+			currentResult = tuple;
+		}
+
 		void Codegen::visit( exo::ast::ExprCallFun& call )
 		{
 			EXO_LOG( debug, "Call function " << call.id->name );
 
+			if( generators.count( call.id->name ) ) {
+				EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Generators can only be iterated by for in" ), call );
+			}
+
+			// calling a struct constructs a value
+			llvm::StructType* structr = module->getTypeByName( EXO_STRUCT( call.id->name ) );
+			if( structr != nullptr && module->getFunction( call.id->name ) == nullptr ) {
+				currentResult = constructStruct( structr, call.arguments.get(), call, generateInMem );
+				return;
+			}
+
+			// fences are builtin, unless a function of that name is declared
+			if( call.id->name == "fence" && module->getFunction( call.id->name ) == nullptr ) {
+				if( call.arguments->list.size() > 1 ) {
+					EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Expected parameters mismatch" ), call );
+				}
+
+				llvm::AtomicOrdering ordering = getOrdering( call.arguments.get(), 0, llvm::AtomicOrdering::SequentiallyConsistent, call );
+				if( ordering == llvm::AtomicOrdering::Monotonic ) {
+					EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Fences can not be relaxed" ), call );
+				}
+
+				currentResult = builder.CreateFence( ordering );
+				return;
+			}
+
 			llvm::Function* function = getFunction( call.id->name );
 
 			try {
+				// the C printf with a constant format
+				if( call.id->name == "printf" && function->isDeclaration() && function->isVarArg() && function->getFunctionType()->getNumParams() == 1 && function->getReturnType()->isIntegerTy()
+					&& !call.arguments->list.empty() && dynamic_cast<exo::ast::ConstStr*>( call.arguments->list.front().get() ) != nullptr ) {
+					currentResult = invokePrintf( function, call, generateInMem );
+					return;
+				}
+
 				currentResult = invokeFunction( function, function->getFunctionType(), {}, call.arguments.get(), generateInMem );
 			} catch( boost::exception &exception ) {
 				exception << exo::exceptions::FunctionName( call.id->name );
@@ -391,24 +1083,234 @@ namespace exo
 
 			generateInMem = false;
 			call.expression->accept( this );
-			currentResult = invokeMethod( currentResult, call.id->name, call.arguments.get(), false, inMem );
-		}
-
-		// FIXME: track if instance property is actually initialized (needs exception handling)
-		void Codegen::visit( exo::ast::ExprProp& expr )
-		{
-			bool inMem = generateInMem;
-
-			generateInMem = false;
-			expr.expression->accept( this );
 
+			// builtin vector and array methods
 			llvm::Type* type = currentResult->getType();
-			if( !type->isPointerTy() ) {
-				//EXO_DEBUG_LOG( trace, toString( currentResult ) );
-				EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Expecting object" ), expr );
+			if( type->isVectorTy() ) {
+				currentResult = invokeVectorMethod( currentResult, call.id->name, call.arguments.get(), call, inMem );
+				return;
 			}
 
-			type = type->getPointerElementType();
+			if( type->isArrayTy() || isArray( type ) ) {
+				currentResult = invokeArrayMethod( getArrayAddress( currentResult, call ), call.id->name, call.arguments.get(), call, inMem );
+				return;
+			}
+
+			if( isAtomic( type ) ) {
+				currentResult = invokeAtomicMethod( getAddress( currentResult ), call.id->name, call.arguments.get(), call, inMem );
+				return;
+			}
+
+			if( isMap( type ) ) {
+				currentResult = invokeMapMethod( currentResult, call.id->name, call.arguments.get(), call, inMem );
+				return;
+			}
+
+			if( isString( type ) ) {
+				currentResult = invokeStringMethod( currentResult, call.id->name, call.arguments.get(), call, inMem );
+				return;
+			}
+
+			if( isStruct( type ) ) {
+				currentResult = getAddress( currentResult );
+			}
+
+			currentResult = invokeMethod( currentResult, call.id->name, call.arguments.get(), false, inMem );
+		}
+
+		void Codegen::visit( exo::ast::ExprCallValue& call )
+		{
+			EXO_CODEGEN_LOG( call, "Call closure" );
+
+			bool inMem = generateInMem;
+
+			generateInMem = false;
+			call.expression->accept( this );
+
+			llvm::Value* callable = currentResult;
+			if( !isCallable( callable->getType() ) ) {
+				EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Expecting callable" ), call );
+			}
+
+			// a closure created in place is called directly, so it can be inlined
+			llvm::Value* function = llvm::FindInsertedValue( callable, { EXO_CALLABLE_FUNCTION } );
+			if( function == nullptr || !llvm::isa<llvm::Function>( function ) ) {
+				function = builder.CreateExtractValue( callable, EXO_CALLABLE_FUNCTION, "function" );
+			}
+			llvm::Value* environment = builder.CreateExtractValue( callable, EXO_CALLABLE_ENV, "env" );
+
+			currentResult = invokeFunction( function, llvm::cast<llvm::FunctionType>( function->getType()->getPointerElementType() ), { environment }, call.arguments.get(), inMem );
+		}
+
+		/*
+		 * closures copy the variables they capture into an environment, which lives on the stack unless the closure escapes.
+		 * a callable is the function, its environment and the size of the environment if it still needs to be moved to the heap
+		 */
+		void Codegen::visit( exo::ast::ExprClosure& expr )
+		{
+			exo::ast::DeclFun& decl = *expr.function;
+			llvm::Type* intType = llvm::Type::getInt64Ty( module->getContext() );
+			llvm::Type* ptrType = llvm::Type::getInt8PtrTy( module->getContext() );
+
+			bool inMem = generateInMem;
+			bool isEscaping = escapingClosures.count( &expr ) > 0;
+
+			EXO_CODEGEN_LOG( expr, "Closure" << ( isEscaping ? ", environment on the heap" : ", environment on the stack" ) );
+
+			ClosureCaptures captures( expr );
+
+			std::vector<std::string> names;
+			std::vector<llvm::Value*> values;
+			std::vector<llvm::Type*> types;
+			for( auto &name : captures.captured ) {
+				// globals are not captured, the closure addresses them directly
+				if( stack->isGlobal( name ) ) {
+					continue;
+				}
+
+				llvm::Value* value;
+				try {
+					value = isAppended( name, stack->Get( name ) ) ? finishString( stack->Get( name ) ) : createLoad( stack->Get( name ) );
+					if( stack->isRef( name ) ) {
+						value = builder.CreateLoad( value );
+					}
+				} catch( boost::exception &exception ) { // unknown variables fail inside the closure
+					continue;
+				}
+
+				if( captures.assigned.count( name ) ) {
+					EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Captured variable $" + name + " is read-only" ), expr );
+				}
+
+				names.push_back( name );
+				values.push_back( isEscaping ? promoteCallable( value ) : value );
+				types.push_back( value->getType() );
+			}
+
+			std::vector<llvm::Type*> arguments = { ptrType };
+			for( auto &argument : decl.arguments->list ) {
+				llvm::Type* type = getType( argument->type.get() );
+				arguments.push_back( argument->isRef ? type->getPointerTo() : type );
+			}
+
+			llvm::FunctionType* type = llvm::FunctionType::get( getType( decl.returnType.get() ), arguments, false );
+			llvm::StructType* callableType = getCallableType( type );
+			llvm::Function* function = llvm::Function::Create( type, llvm::GlobalValue::InternalLinkage, decl.id->name, module.get() );
+			if( !isEscaping ) {
+				function->addFnAttr( llvm::Attribute::AlwaysInline );
+			}
+
+			// copy the captured variables
+			llvm::StructType* envType = llvm::StructType::get( module->getContext(), types );
+			llvm::Value* environment = llvm::ConstantPointerNull::get( llvm::cast<llvm::PointerType>( ptrType ) );
+			llvm::Value* size = llvm::ConstantInt::get( intType, 0 );
+			if( !values.empty() ) {
+				llvm::Value* memory;
+				if( isEscaping ) {
+					memory = builder.CreateBitCast( builder.CreateCall( getFunction( EXO_ALLOC ), { llvm::ConstantExpr::getSizeOf( envType ) } ), envType->getPointerTo() );
+				} else {
+					memory = allocateLocal( envType, "env" );
+					size = llvm::ConstantInt::get( intType, module->getDataLayout().getTypeAllocSize( envType ) );
+				}
+
+				for( unsigned i = 0; i < values.size(); i++ ) {
+					createStore( values.at( i ), builder.CreateStructGEP( envType, memory, i ) );
+				}
+				environment = builder.CreateBitCast( memory, ptrType );
+			}
+
+			// the body sees its captures thru the environment
+			llvm::BasicBlock* block = llvm::BasicBlock::Create( module->getContext(), decl.id->name, function );
+			builder.SetInsertPoint( stack->PushFunction( block, stack->Block() ) );
+
+			if( !values.empty() ) {
+				llvm::Value* captured = builder.CreateBitCast( &*function->arg_begin(), envType->getPointerTo() );
+				for( unsigned i = 0; i < names.size(); i++ ) {
+					stack->Set( names.at( i ), builder.CreateStructGEP( envType, captured, i ) );
+				}
+			}
+
+			generateFunction( decl, function, 1 );
+
+			builder.SetInsertPoint( stack->Pop() );
+
+			currentResult = llvm::UndefValue::get( callableType );
+			currentResult = builder.CreateInsertValue( currentResult, function, EXO_CALLABLE_FUNCTION );
+			currentResult = builder.CreateInsertValue( currentResult, environment, EXO_CALLABLE_ENV );
+			currentResult = builder.CreateInsertValue( currentResult, size, EXO_CALLABLE_SIZE );
+
+			if( inMem ) {
+				currentResult = getAddress( currentResult );
+			}
+		}
+
+		void Codegen::visit( exo::ast::ExprIndex& expr )
+		{
+			bool inMem = generateInMem;
+
+			generateInMem = false;
+			expr.expression->accept( this );
+
+			// reading a vector lane needs no memory
+			llvm::Value* vector = !inMem && currentResult->getType()->isVectorTy() ? currentResult : nullptr;
+			if( isTuple( currentResult->getType() ) ) {
+				currentResult = getTupleElement( currentResult, expr, inMem );
+				return;
+			}
+
+			llvm::Value* array = vector == nullptr ? getArrayAddress( currentResult, expr ) : nullptr;
+			llvm::Type* type = vector == nullptr ? array->getType()->getPointerElementType() : vector->getType();
+
+			// booleans are packed into bits
+			if( type->isVectorTy() && type->getVectorElementType()->isIntegerTy( 1 ) && vector == nullptr ) {
+				EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Mask lanes are not addressable" ), expr );
+			}
+
+			expr.index->accept( this );
+			if( !currentResult->getType()->isIntegerTy() ) {
+				EXO_THROW_AT( InvalidExpr() << exo::exceptions::Message( "Expecting integer index" ), expr );
+			}
+			llvm::Value* index = convertValue( currentResult, llvm::Type::getInt64Ty( module->getContext() ) );
+
+			bool isChecked = !isInBounds( expr, type );
+			EXO_CODEGEN_LOG( expr, "Array element access" << ( isChecked ? "" : ", bounds check elided" ) );
+
+			if( vector != nullptr ) {
+				if( isChecked ) {
+					createBoundsCheck( index, llvm::ConstantInt::get( index->getType(), getFixedLength( type ) ), expr );
+				}
+
+				currentResult = builder.CreateExtractElement( vector, index, "lane" );
+				return;
+			}
+
+			currentResult = getArrayElement( array, index, expr, isChecked );
+
+			if( !inMem ) {
+				currentResult = createLoad( currentResult );
+			}
+		}
+
+		// FIXME: track if instance property is actually initialized (needs exception handling)
+		void Codegen::visit( exo::ast::ExprProp& expr )
+		{
+			bool inMem = generateInMem;
+
+			generateInMem = false;
+			expr.expression->accept( this );
+
+			// address struct properties in place
+			if( isStruct( currentResult->getType() ) ) {
+				currentResult = getAddress( currentResult );
+			}
+
+			llvm::Type* type = currentResult->getType();
+			if( !type->isPointerTy() ) {
+				//EXO_DEBUG_LOG( trace, toString( currentResult ) );
+				EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Expecting object" ), expr );
+			}
+
+			type = type->getPointerElementType();
 			if( !type->isStructTy() ) {
 				//EXO_DEBUG_LOG( trace, toString( currentResult ) );
 				EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Invalid object" ), expr );
@@ -431,10 +1333,96 @@ namespace exo
 			}
 		}
 
+		// a slice gets its own header but shares the elements with its origin, unless that is a fixed array
+		void Codegen::visit( exo::ast::ExprSlice& expr )
+		{
+			EXO_CODEGEN_LOG( expr, "Array slice" );
+
+			bool inMem = generateInMem;
+			llvm::Type* intType = llvm::Type::getInt64Ty( module->getContext() );
+			llvm::Type* ptrType = llvm::Type::getInt8PtrTy( module->getContext() );
+
+			generateInMem = false;
+			expr.expression->accept( this );
+			if( currentResult->getType()->isVectorTy() ) {
+				EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Expecting array" ), expr );
+			}
+			llvm::Value* array = getArrayAddress( currentResult, expr );
+
+			std::vector<llvm::Value*> bounds;
+			for( auto bound : { expr.lower.get(), expr.upper.get() } ) {
+				bound->accept( this );
+				if( !currentResult->getType()->isIntegerTy() ) {
+					EXO_THROW_AT( InvalidExpr() << exo::exceptions::Message( "Expecting integer slice bounds" ), expr );
+				}
+				bounds.push_back( convertValue( currentResult, intType ) );
+			}
+
+			llvm::Type* type = array->getType()->getPointerElementType();
+			llvm::Type* elementType;
+			llvm::Value* header;
+
+			if( type->isArrayTy() ) { // fixed arrays may be on the stack, which the slice can outlive, so it gets a copy on the heap
+				elementType = type->getArrayElementType();
+				header = builder.CreateCall(
+					getRuntimeFun( "exo_array_new", ptrType, { ptrType, intType, intType, intType, intType } ),
+					{
+						getFileName(),
+						llvm::ConstantInt::get( intType, expr.lineNo ),
+						llvm::ConstantInt::get( intType, type->getArrayNumElements() ),
+						llvm::ConstantInt::get( intType, module->getDataLayout().getTypeAllocSize( elementType ) ),
+						llvm::ConstantInt::get( intType, !containsPointers( elementType ) )
+					}
+				);
+				llvm::Value* data = getArrayField( builder.CreateBitCast( header, getArrayType( elementType )->getPointerTo() ), EXO_ARRAY_DATA, "data" );
+				builder.CreateMemCpy( data, array, module->getDataLayout().getTypeAllocSize( type ), module->getDataLayout().getABITypeAlignment( elementType ) );
+			} else {
+				elementType = getArrayElementType( type );
+				header = builder.CreateBitCast( array, ptrType );
+			}
+
+			llvm::Value* slice = builder.CreateCall(
+				getRuntimeFun( "exo_array_slice", ptrType, { ptrType, intType, ptrType, intType, intType, intType } ),
+				{ getFileName(), llvm::ConstantInt::get( intType, expr.lineNo ), header, llvm::ConstantInt::get( intType, module->getDataLayout().getTypeAllocSize( elementType ) ), bounds.at( 0 ), bounds.at( 1 ) }
+			);
+			currentResult = builder.CreateBitCast( slice, getArrayType( elementType )->getPointerTo(), "slice" );
+
+			if( inMem ) {
+				llvm::AllocaInst* memory = allocateLocal( currentResult->getType() );
+				builder.CreateStore( currentResult, memory );
+				currentResult = memory;
+			}
+		}
+
+		void Codegen::visit( exo::ast::ExprTuple& expr )
+		{
+			EXO_CODEGEN_LOG( expr, "Tuple of " << expr.expressions->list.size() << " value(s)" );
+
+			bool inMem = generateInMem;
+
+			std::vector<llvm::Value*> values;
+			std::vector<llvm::Type*> types;
+			for( auto &expression : expr.expressions->list ) {
+				generateInMem = false;
+				expression->accept( this );
+				values.push_back( currentResult );
+				types.push_back( currentResult->getType() );
+			}
+
+			currentResult = llvm::UndefValue::get( llvm::StructType::get( module->getContext(), types ) );
+			for( unsigned i = 0; i < values.size(); i++ ) {
+				currentResult = builder.CreateInsertValue( currentResult, values.at( i ), i );
+			}
+
+			if( inMem ) {
+				currentResult = getAddress( currentResult );
+			}
+		}
+
 		void Codegen::visit( exo::ast::ExprVar& expr )
 		{
 			try {
-				currentResult = stack->Get( expr.name );
+				currentResult = stack->isGlobal( expr.name ) ? getThreadLocal( expr.name ) : stack->Get( expr.name );
 
 				if( stack->isRef( expr.name ) && !generateInMem ) { //TODO: this is ambiguous, but ok i guess. if variable is a reference and we want register access deref it
 					EXO_CODEGEN_LOG( expr, "Dereferencing $" << expr.name );
@@ -446,6 +1434,14 @@ namespace exo
 				throw;
 			}
 
+			if( &expr != overwritten && isAppended( expr.name, currentResult ) ) {
+				llvm::Value* string = finishString( currentResult );
+				if( !generateInMem ) {
+					currentResult = string;
+					return;
+				}
+			}
+
 			if( !generateInMem ) {
 				currentResult = builder.CreateLoad( currentResult );
 			}
@@ -469,10 +1465,15 @@ namespace exo
 			op.rhs->accept( this );
 			llvm::Value* rhs = currentResult;
 
-			currentResult = builder.CreateAdd( lhs, rhs, "add" );
+			if( isString( lhs->getType() ) && isString( rhs->getType() ) ) {
+				currentResult = createConcat( { lhs, rhs } );
+			} else {
+				unifyTypes( lhs, rhs );
+				currentResult = createArithmetic( llvm::Instruction::Add, lhs, rhs, op, "add" );
+			}
 
 			if( inMem ) {
-				llvm::AllocaInst* memory = builder.CreateAlloca( currentResult->getType() );
+				llvm::AllocaInst* memory = allocateLocal( currentResult->getType() );
 				builder.CreateStore( currentResult, memory );
 				currentResult = memory;
 			}
@@ -488,13 +1489,26 @@ namespace exo
 
 			bool inMem = generateInMem;
 
+			// an await may suspend, nothing evaluated before it would survive
+			llvm::Value* value = nullptr;
+			if( dynamic_cast<exo::ast::OpUnaryAwait*>( assign.rhs.get() ) != nullptr ) {
+				generateInMem = false;
+				isSuspendable = true;
+				assign.rhs->accept( this );
+				value = currentResult;
+			}
+
 			generateInMem = true;
+			overwritten = assign.lhs.get();
 			assign.lhs->accept( this );
+			overwritten = nullptr;
 			llvm::Value* variable = currentResult;
 
-			generateInMem = false;
-			assign.rhs->accept( this );
-			llvm::Value* value = currentResult;
+			if( value == nullptr ) {
+				generateInMem = false;
+				assign.rhs->accept( this );
+				value = currentResult;
+			}
 
 			if( variable->getType()->getPointerElementType()->isPointerTy() ) { // dealing with references
 				if( !value->getType()->isPointerTy() ) { //TODO: this is ambiguous, but ok i guess. dereference our reference in assigments.
@@ -502,7 +1516,14 @@ namespace exo
 				}
 			}
 
-			builder.CreateStore( value, variable );
+			value = convertValue( value, variable->getType()->getPointerElementType() );
+
+			// anything but a local variable may outlive a closure environment on the stack
+			if( !llvm::isa<llvm::AllocaInst>( variable ) ) {
+				value = promoteCallable( value );
+			}
+
+			createStore( value, variable );
 
 			currentResult = inMem ? variable : value;
 		}
@@ -517,15 +1538,34 @@ namespace exo
 
 			bool inMem = generateInMem;
 
+			// strings of variables that are not references are appended to in place
+			exo::ast::ExprVar* target = dynamic_cast<exo::ast::ExprVar*>( assign.lhs.get() );
+			bool isAppend = target != nullptr && stringAppends.count( &assign ) > 0 && !stack->isRef( target->name );
+
 			generateInMem = true;
+			overwritten = isAppend ? target : nullptr;
 			assign.lhs->accept( this );
+			overwritten = nullptr;
 			llvm::Value* variable = currentResult;
 
+			if( variable->getType()->getPointerElementType()->isPointerTy() && !isString( variable->getType()->getPointerElementType() ) ) { // dealing with references
+				variable = builder.CreateLoad( variable );
+			}
+
 			generateInMem = false;
 			assign.rhs->accept( this );
 
-			llvm::Value* result = builder.CreateAdd( builder.CreateLoad( variable ), currentResult, "add" );
-			builder.CreateStore( result, variable );
+			llvm::Value* lhs = createLoad( variable );
+			llvm::Value* rhs = currentResult;
+
+			llvm::Value* result;
+			if( isString( lhs->getType() ) && isString( rhs->getType() ) ) {
+				result = isAppend ? createAppend( lhs, rhs ) : createConcat( { lhs, rhs } );
+			} else {
+				unifyTypes( lhs, rhs );
+				result = createArithmetic( llvm::Instruction::Add, lhs, rhs, assign, "add" );
+			}
+			createStore( convertValue( result, variable->getType()->getPointerElementType() ), variable );
 
 			currentResult = inMem ? variable : result;
 		}
@@ -544,11 +1584,19 @@ namespace exo
 			assign.lhs->accept( this );
 			llvm::Value* variable = currentResult;
 
+			if( variable->getType()->getPointerElementType()->isPointerTy() ) { // dealing with references
+				variable = builder.CreateLoad( variable );
+			}
+
 			generateInMem = false;
 			assign.rhs->accept( this );
 
-			llvm::Value* result = builder.CreateMul( builder.CreateLoad( variable ), currentResult, "mul" );
-			builder.CreateStore( result, variable );
+			llvm::Value* lhs = createLoad( variable );
+			llvm::Value* rhs = currentResult;
+			unifyTypes( lhs, rhs );
+
+			llvm::Value* result = createArithmetic( llvm::Instruction::Mul, lhs, rhs, assign, "mul" );
+			createStore( convertValue( result, variable->getType()->getPointerElementType() ), variable );
 
 			currentResult = inMem ? variable : result;
 		}
@@ -567,11 +1615,19 @@ namespace exo
 			assign.lhs->accept( this );
 			llvm::Value* variable = currentResult;
 
+			if( variable->getType()->getPointerElementType()->isPointerTy() ) { // dealing with references
+				variable = builder.CreateLoad( variable );
+			}
+
 			generateInMem = false;
 			assign.rhs->accept( this );
 
-			llvm::Value* result = builder.CreateSDiv( builder.CreateLoad( variable ), currentResult, "mul" );
-			builder.CreateStore( result, variable );
+			llvm::Value* lhs = createLoad( variable );
+			llvm::Value* rhs = currentResult;
+			unifyTypes( lhs, rhs );
+
+			llvm::Value* result = createArithmetic( llvm::Instruction::SDiv, lhs, rhs, assign, "div" );
+			createStore( convertValue( result, variable->getType()->getPointerElementType() ), variable );
 
 			currentResult = inMem ? variable : result;
 		}
@@ -590,11 +1646,19 @@ namespace exo
 			assign.lhs->accept( this );
 			llvm::Value* variable = currentResult;
 
+			if( variable->getType()->getPointerElementType()->isPointerTy() ) { // dealing with references
+				variable = builder.CreateLoad( variable );
+			}
+
 			generateInMem = false;
 			assign.rhs->accept( this );
 
-			llvm::Value* result = builder.CreateSub( builder.CreateLoad( variable ), currentResult, "sub" );
-			builder.CreateStore( result, variable );
+			llvm::Value* lhs = createLoad( variable );
+			llvm::Value* rhs = currentResult;
+			unifyTypes( lhs, rhs );
+
+			llvm::Value* result = createArithmetic( llvm::Instruction::Sub, lhs, rhs, assign, "sub" );
+			createStore( convertValue( result, variable->getType()->getPointerElementType() ), variable );
 
 			currentResult = inMem ? variable : result;
 		}
@@ -612,10 +1676,12 @@ namespace exo
 			op.rhs->accept( this );
 			llvm::Value* rhs = currentResult;
 
-			currentResult = builder.CreateSDiv( lhs, rhs, "div" );
+			unifyTypes( lhs, rhs );
+
+			currentResult = createArithmetic( llvm::Instruction::SDiv, lhs, rhs, op, "div" );
 
 			if( inMem ) {
-				llvm::AllocaInst* memory = builder.CreateAlloca( currentResult->getType() );
+				llvm::AllocaInst* memory = allocateLocal( currentResult->getType() );
 				builder.CreateStore( currentResult, memory );
 				currentResult = memory;
 			}
@@ -634,10 +1700,12 @@ namespace exo
 			op.rhs->accept( this );
 			llvm::Value* rhs = currentResult;
 
-			currentResult = builder.CreateICmpEQ( lhs, rhs, "cmp" );;
+			unifyTypes( lhs, rhs );
+
+			currentResult = createCompare( llvm::CmpInst::ICMP_EQ, lhs, rhs, op );
 
 			if( inMem ) {
-				llvm::AllocaInst* memory = builder.CreateAlloca( currentResult->getType() );
+				llvm::AllocaInst* memory = allocateLocal( currentResult->getType() );
 				builder.CreateStore( currentResult, memory );
 				currentResult = memory;
 			}
@@ -656,10 +1724,12 @@ namespace exo
 			op.rhs->accept( this );
 			llvm::Value* rhs = currentResult;
 
-			currentResult = builder.CreateICmpSGE( lhs, rhs, "cmp" );
+			unifyTypes( lhs, rhs );
+
+			currentResult = createCompare( llvm::CmpInst::ICMP_SGE, lhs, rhs, op );
 
 			if( inMem ) {
-				llvm::AllocaInst* memory = builder.CreateAlloca( currentResult->getType() );
+				llvm::AllocaInst* memory = allocateLocal( currentResult->getType() );
 				builder.CreateStore( currentResult, memory );
 				currentResult = memory;
 			}
@@ -678,10 +1748,12 @@ namespace exo
 			op.rhs->accept( this );
 			llvm::Value* rhs = currentResult;
 
-			currentResult = builder.CreateICmpSGT( lhs, rhs, "cmp" );;
+			unifyTypes( lhs, rhs );
+
+			currentResult = createCompare( llvm::CmpInst::ICMP_SGT, lhs, rhs, op );
 
 			if( inMem ) {
-				llvm::AllocaInst* memory = builder.CreateAlloca( currentResult->getType() );
+				llvm::AllocaInst* memory = allocateLocal( currentResult->getType() );
 				builder.CreateStore( currentResult, memory );
 				currentResult = memory;
 			}
@@ -700,10 +1772,12 @@ namespace exo
 			op.rhs->accept( this );
 			llvm::Value* rhs = currentResult;
 
-			currentResult = builder.CreateICmpSLE( lhs, rhs, "cmp" );
+			unifyTypes( lhs, rhs );
+
+			currentResult = createCompare( llvm::CmpInst::ICMP_SLE, lhs, rhs, op );
 
 			if( inMem ) {
-				llvm::AllocaInst* memory = builder.CreateAlloca( currentResult->getType() );
+				llvm::AllocaInst* memory = allocateLocal( currentResult->getType() );
 				builder.CreateStore( currentResult, memory );
 				currentResult = memory;
 			}
@@ -722,10 +1796,12 @@ namespace exo
 			op.rhs->accept( this );
 			llvm::Value* rhs = currentResult;
 
-			currentResult = builder.CreateICmpSLT( lhs, rhs, "cmp" );
+			unifyTypes( lhs, rhs );
+
+			currentResult = createCompare( llvm::CmpInst::ICMP_SLT, lhs, rhs, op );
 
 			if( inMem ) {
-				llvm::AllocaInst* memory = builder.CreateAlloca( currentResult->getType() );
+				llvm::AllocaInst* memory = allocateLocal( currentResult->getType() );
 				builder.CreateStore( currentResult, memory );
 				currentResult = memory;
 			}
@@ -744,10 +1820,12 @@ namespace exo
 			op.rhs->accept( this );
 			llvm::Value* rhs = currentResult;
 
-			currentResult = builder.CreateMul( lhs, rhs, "mul" );
+			unifyTypes( lhs, rhs );
+
+			currentResult = createArithmetic( llvm::Instruction::Mul, lhs, rhs, op, "mul" );
 
 			if( inMem ) {
-				llvm::AllocaInst* memory = builder.CreateAlloca( currentResult->getType() );
+				llvm::AllocaInst* memory = allocateLocal( currentResult->getType() );
 				builder.CreateStore( currentResult, memory );
 				currentResult = memory;
 			}
@@ -766,10 +1844,12 @@ namespace exo
 			op.rhs->accept( this );
 			llvm::Value* rhs = currentResult;
 
-			currentResult = builder.CreateICmpNE( lhs, rhs, "cmp" );
+			unifyTypes( lhs, rhs );
+
+			currentResult = createCompare( llvm::CmpInst::ICMP_NE, lhs, rhs, op );
 
 			if( inMem ) {
-				llvm::AllocaInst* memory = builder.CreateAlloca( currentResult->getType() );
+				llvm::AllocaInst* memory = allocateLocal( currentResult->getType() );
 				builder.CreateStore( currentResult, memory );
 				currentResult = memory;
 			}
@@ -788,15 +1868,97 @@ namespace exo
 			op.rhs->accept( this );
 			llvm::Value* rhs = currentResult;
 
-			currentResult = builder.CreateSub( lhs, rhs, "sub" );
+			unifyTypes( lhs, rhs );
+
+			currentResult = createArithmetic( llvm::Instruction::Sub, lhs, rhs, op, "sub" );
 
 			if( inMem ) {
-				llvm::AllocaInst* memory = builder.CreateAlloca( currentResult->getType() );
+				llvm::AllocaInst* memory = allocateLocal( currentResult->getType() );
 				builder.CreateStore( currentResult, memory );
 				currentResult = memory;
 			}
 		}
 
+		void Codegen::visit( exo::ast::OpUnaryAwait& op )
+		{
+			EXO_CODEGEN_LOG( op, "Await" );
+
+			llvm::Type* intType = llvm::Type::getInt64Ty( module->getContext() );
+			llvm::Type* ptrType = llvm::Type::getInt8PtrTy( module->getContext() );
+			llvm::Type* voidType = llvm::Type::getVoidTy( module->getContext() );
+
+			bool inMem = generateInMem;
+			bool isSuspension = isSuspendable;
+			isSuspendable = false;
+
+			// only the frame survives a suspension, not the temporaries of a surrounding expression
+			if( asyncFrame != nullptr && !isSuspension ) {
+				EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Await can only be used as statement, initializer, assigned or returned value" ), op );
+			}
+
+			// an async call awaited right away is done before we continue, its frame can live in ours
+			llvm::Value* task = nullptr;
+			exo::ast::ExprCallFun* call = dynamic_cast<exo::ast::ExprCallFun*>( op.rhs.get() );
+			if( call != nullptr && dynamic_cast<exo::ast::ExprCallMethod*>( call ) == nullptr ) {
+				llvm::Function* start = module->getFunction( EXO_ASYNC_START( call->id->name ) );
+				llvm::StructType* frameType = module->getTypeByName( EXO_ASYNC_FRAME( call->id->name ) );
+
+				if( start != nullptr && frameType != nullptr && !frameType->isOpaque() ) { // recursion still has no complete frame
+					EXO_CODEGEN_LOG( op, "Embedding frame of " << call->id->name );
+					llvm::Value* frame = builder.CreateBitCast( allocateLocal( frameType, "frame" ), ptrType );
+					task = invokeFunction( start, start->getFunctionType(), { frame }, call->arguments.get(), false );
+				}
+			}
+
+			if( task == nullptr ) {
+				generateInMem = false;
+				op.rhs->accept( this );
+				task = currentResult;
+			}
+
+			if( !isTask( task->getType() ) ) {
+				EXO_THROW_AT( InvalidExpr() << exo::exceptions::Message( "Expecting task" ), op );
+			}
+			llvm::StructType* taskType = llvm::cast<llvm::StructType>( task->getType()->getPointerElementType() );
+
+			if( asyncFrame == nullptr ) {
+				// outside of async functions we drive the executor until the task is done
+				builder.CreateCall( getRuntimeFun( "exo_task_run", voidType, { ptrType } ), { builder.CreateBitCast( task, ptrType ) } );
+			} else {
+				llvm::Function* scope			= stack->Block()->getParent();
+				llvm::BasicBlock* suspendBlock	= llvm::BasicBlock::Create( module->getContext(), "await-suspend", scope );
+				llvm::BasicBlock* resumeBlock	= llvm::BasicBlock::Create( module->getContext(), "await-resume", scope );
+
+				llvm::AllocaInst* memory = allocateLocal( task->getType(), "awaiting" );
+				builder.CreateStore( task, memory );
+
+				llvm::Value* state = builder.CreateLoad( builder.CreateStructGEP( taskType, task, EXO_TASK_STATE ), "state" );
+				builder.CreateCondBr( builder.CreateICmpEQ( state, llvm::ConstantInt::get( intType, EXO_TASK_DONE ) ), resumeBlock, suspendBlock );
+
+				// remember where to continue, then return to whoever resumed us
+				asyncResumes.push_back( resumeBlock );
+				llvm::StructType* frameType = llvm::cast<llvm::StructType>( asyncFrame->getType()->getPointerElementType() );
+
+				builder.SetInsertPoint( suspendBlock );
+				builder.CreateStore( llvm::ConstantInt::get( intType, asyncResumes.size() ), builder.CreateStructGEP( frameType, asyncFrame, EXO_TASK_STATE ) );
+				builder.CreateCall( getRuntimeFun( "exo_task_await", voidType, { ptrType, ptrType } ), { builder.CreateBitCast( task, ptrType ), builder.CreateBitCast( asyncFrame, ptrType ) } );
+				builder.CreateRetVoid();
+
+				builder.SetInsertPoint( stack->Join( resumeBlock ) );
+				task = builder.CreateLoad( memory );
+			}
+
+			if( taskType->getNumElements() > EXO_TASK_RESULT ) {
+				llvm::Value* result = builder.CreateStructGEP( taskType, task, EXO_TASK_RESULT );
+				currentResult = inMem ? result : createLoad( result );
+			} else {
+				currentResult = llvm::ConstantInt::getFalse( llvm::Type::getInt1Ty( module->getContext() ) );
+				if( inMem ) {
+					currentResult = getAddress( currentResult );
+				}
+			}
+		}
+
 		/*
 		 * FIXME: we expect a variable, thats bad since expression can return memory on their own so track memory addresses instead of var names
 		 * FIXME: deallocation should occur on/thru the stack
@@ -824,6 +1986,35 @@ namespace exo
 			}
 		}
 
+		void Codegen::visit( exo::ast::OpUnaryJoin& op )
+		{
+			EXO_CODEGEN_LOG( op, "Join" );
+
+			llvm::Type* ptrType = llvm::Type::getInt8PtrTy( module->getContext() );
+
+			bool inMem = generateInMem;
+			generateInMem = false;
+			op.rhs->accept( this );
+			llvm::Value* future = currentResult;
+
+			if( !isFuture( future->getType() ) ) {
+				EXO_THROW_AT( InvalidExpr() << exo::exceptions::Message( "Expecting future" ), op );
+			}
+			llvm::StructType* futureType = llvm::cast<llvm::StructType>( future->getType()->getPointerElementType() );
+
+			builder.CreateCall( getRuntimeFun( "exo_job_join", llvm::Type::getVoidTy( module->getContext() ), { ptrType } ), { builder.CreateBitCast( future, ptrType ) } );
+
+			if( futureType->getNumElements() > EXO_FUTURE_RESULT ) {
+				llvm::Value* result = builder.CreateStructGEP( futureType, future, EXO_FUTURE_RESULT );
+				currentResult = inMem ? result : createLoad( result );
+			} else {
+				currentResult = llvm::ConstantInt::getFalse( llvm::Type::getInt1Ty( module->getContext() ) );
+				if( inMem ) {
+					currentResult = getAddress( currentResult );
+				}
+			}
+		}
+
 		/*
 		 * TODO: we should track heap allocations
 		 * TODO: get rid of cast
@@ -838,6 +2029,10 @@ namespace exo
 
 			EXO_CODEGEN_LOG( op, "Allocating heap memory for " << constructor->id->name );
 
+			if( module->getTypeByName( EXO_STRUCT( constructor->id->name ) ) != nullptr ) {
+				EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Structs are values, construct them without new" ), op );
+			}
+
 			std::string className = EXO_CLASS( constructor->id->name );
 			llvm::Type* type = module->getTypeByName( className );
 			if( type == nullptr ) {
@@ -866,26 +2061,168 @@ namespace exo
 			invokeMethod( currentResult, "__construct", constructor->arguments.get(), true, false );
 		}
 
-		void Codegen::visit( exo::ast::OpUnaryRef& op )
+		void Codegen::visit( exo::ast::OpUnaryNewArray& op )
 		{
-			EXO_CODEGEN_LOG( op, "Creating reference" );
+			llvm::Type* intType = llvm::Type::getInt64Ty( module->getContext() );
+			llvm::Type* ptrType = llvm::Type::getInt8PtrTy( module->getContext() );
+			llvm::Type* elementType = getType( op.type.get() );
+
+			EXO_CODEGEN_LOG( op, "Allocating array of " << toString( elementType ) );
 
 			bool inMem = generateInMem;
-			generateInMem = true;
+			generateInMem = false;
 			op.rhs->accept( this );
-			generateInMem = inMem;
-		}
+			if( !currentResult->getType()->isIntegerTy() ) {
+				EXO_THROW_AT( InvalidExpr() << exo::exceptions::Message( "Expecting integer array length" ), op );
+			}
 
-		void Codegen::visit( exo::ast::StmtBreak& stmt )
-		{
-			EXO_CODEGEN_LOG( stmt, "Break" );
+			// elements without pointers can be allocated as atomic (unscanned) memory
+			llvm::Value* array = builder.CreateCall(
+				getRuntimeFun( "exo_array_new", ptrType, { ptrType, intType, intType, intType, intType } ),
+				{
+					getFileName(),
+					llvm::ConstantInt::get( intType, op.lineNo ),
+					convertValue( currentResult, intType ),
+					llvm::ConstantInt::get( intType, module->getDataLayout().getTypeAllocSize( elementType ) ),
+					llvm::ConstantInt::get( intType, !containsPointers( elementType ) )
+				}
+			);
+			currentResult = builder.CreateBitCast( array, getArrayType( elementType )->getPointerTo(), "array" );
 
-			llvm::BasicBlock* exitBlock = stack->Break();
-			if( exitBlock == nullptr ) {
-				EXO_THROW_AT( InvalidBreak(), stmt );
+			if( inMem ) {
+				llvm::AllocaInst* memory = allocateLocal( currentResult->getType() );
+				builder.CreateStore( currentResult, memory );
+				currentResult = memory;
 			}
-
-			builder.CreateBr( exitBlock );
+		}
+
+		void Codegen::visit( exo::ast::OpUnaryNewMap& op )
+		{
+			llvm::Type* intType = llvm::Type::getInt64Ty( module->getContext() );
+			llvm::Type* ptrType = llvm::Type::getInt8PtrTy( module->getContext() );
+			llvm::Type* type = getType( op.type.get() );
+			llvm::Type* slotType = type->getPointerElementType()->getStructElementType( EXO_MAP_SLOTS )->getPointerElementType();
+			llvm::Type* keyType = slotType->getStructElementType( 0 );
+
+			EXO_CODEGEN_LOG( op, "Allocating " << toString( type ) );
+
+			bool inMem = generateInMem;
+			generateInMem = false;
+			op.rhs->accept( this );
+			if( !currentResult->getType()->isIntegerTy() ) {
+				EXO_THROW_AT( InvalidExpr() << exo::exceptions::Message( "Expecting integer capacity" ), op );
+			}
+
+			// a key size of 0 tells the runtime to hash strings by their contents
+			llvm::Value* map = builder.CreateCall(
+				getRuntimeFun( "exo_hash_new", ptrType, { intType, intType, intType, intType } ),
+				{
+					convertValue( currentResult, intType ),
+					llvm::ConstantInt::get( intType, module->getDataLayout().getTypeAllocSize( slotType ) ),
+					llvm::ConstantInt::get( intType, isString( keyType ) ? 0 : module->getDataLayout().getTypeAllocSize( keyType ) ),
+					llvm::ConstantInt::get( intType, !containsPointers( slotType ) )
+				}
+			);
+			currentResult = builder.CreateBitCast( map, type, "map" );
+
+			if( inMem ) {
+				llvm::AllocaInst* memory = allocateLocal( currentResult->getType() );
+				builder.CreateStore( currentResult, memory );
+				currentResult = memory;
+			}
+		}
+
+		void Codegen::visit( exo::ast::OpUnaryRef& op )
+		{
+			EXO_CODEGEN_LOG( op, "Creating reference" );
+
+			bool inMem = generateInMem;
+			generateInMem = true;
+			op.rhs->accept( this );
+			generateInMem = inMem;
+		}
+
+		/*
+		 * the arguments are evaluated right away and stored behind the future, a thunk calls the function with them on
+		 * whichever worker takes the job
+		 */
+		void Codegen::visit( exo::ast::OpUnarySpawn& op )
+		{
+			EXO_CODEGEN_LOG( op, "Spawn" );
+
+			llvm::Type* ptrType = llvm::Type::getInt8PtrTy( module->getContext() );
+			llvm::Type* voidType = llvm::Type::getVoidTy( module->getContext() );
+
+			bool inMem = generateInMem;
+
+			exo::ast::ExprCallFun* call = dynamic_cast<exo::ast::ExprCallFun*>( op.rhs.get() );
+			if( call == nullptr || dynamic_cast<exo::ast::ExprCallMethod*>( call ) != nullptr || generators.count( call->id->name ) ) {
+				EXO_THROW_AT( InvalidExpr() << exo::exceptions::Message( "Expecting function call" ), op );
+			}
+
+			llvm::Function* function = getFunction( call->id->name );
+
+			// tasks belong to the executor of the thread starting them
+			if( isTask( function->getReturnType() ) ) {
+				EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Async functions can not be spawned" ), (*call) );
+			}
+
+			std::vector<llvm::Value*> arguments;
+			try {
+				arguments = evaluateArguments( function->getFunctionType(), {}, call->arguments.get() );
+			} catch( boost::exception &exception ) {
+				exception << exo::exceptions::FunctionName( call->id->name );
+				throw;
+			}
+
+			llvm::StructType* futureType = getFutureType( function->getReturnType() );
+			std::vector<llvm::Type*> fields = { futureType };
+			for( auto &argument : arguments ) {
+				argument = promoteCallable( argument );
+				fields.push_back( argument->getType() );
+			}
+			llvm::StructType* jobType = llvm::StructType::create( module->getContext(), fields, EXO_SPAWN( call->id->name ) );
+
+			llvm::Function* run = llvm::Function::Create( llvm::FunctionType::get( voidType, { ptrType }, false ), llvm::GlobalValue::InternalLinkage, EXO_SPAWN( call->id->name ), module.get() );
+			llvm::IRBuilder<> thunk( llvm::BasicBlock::Create( module->getContext(), call->id->name, run ) );
+			llvm::Value* job = thunk.CreateBitCast( &*run->arg_begin(), jobType->getPointerTo(), "job" );
+
+			std::vector<llvm::Value*> values;
+			for( unsigned i = 0; i < arguments.size(); i++ ) {
+				values.push_back( thunk.CreateLoad( thunk.CreateStructGEP( jobType, job, i + 1 ) ) );
+			}
+
+			llvm::Value* result = thunk.CreateCall( function, values );
+			if( futureType->getNumElements() > EXO_FUTURE_RESULT ) {
+				thunk.CreateStore( result, thunk.CreateStructGEP( futureType, thunk.CreateStructGEP( jobType, job, 0 ), EXO_FUTURE_RESULT ) );
+			}
+			thunk.CreateRetVoid();
+
+			// the job may run after we returned, so it lives on the heap
+			job = builder.CreateBitCast( builder.CreateCall( getFunction( EXO_ALLOC ), { llvm::ConstantExpr::getSizeOf( jobType ) } ), jobType->getPointerTo() );
+			llvm::Value* future = builder.CreateStructGEP( jobType, job, 0, "future" );
+
+			builder.CreateStore( run, builder.CreateStructGEP( futureType, future, EXO_FUTURE_RUN ) );
+			builder.CreateStore( llvm::ConstantInt::get( llvm::Type::getInt64Ty( module->getContext() ), 0 ), builder.CreateStructGEP( futureType, future, EXO_FUTURE_STATE ) );
+			for( unsigned i = 0; i < arguments.size(); i++ ) {
+				builder.CreateStore( arguments.at( i ), builder.CreateStructGEP( jobType, job, i + 1 ) );
+			}
+
+			builder.CreateCall( getRuntimeFun( "exo_job_spawn", voidType, { ptrType } ), { builder.CreateBitCast( future, ptrType ) } );
+
+			currentResult = inMem ? getAddress( future ) : future;
+		}
+
+		void Codegen::visit( exo::ast::StmtBreak& stmt )
+		{
+			EXO_CODEGEN_LOG( stmt, "Break" );
+
+			llvm::BasicBlock* exitBlock = stack->Break();
+			if( exitBlock == nullptr ) {
+				EXO_THROW_AT( InvalidBreak(), stmt );
+			}
+
+			builder.CreateBr( exitBlock );
 		}
 
 		void Codegen::visit( exo::ast::StmtCont& stmt )
@@ -941,11 +2278,17 @@ namespace exo
 		void Codegen::visit( exo::ast::StmtExpr& stmt )
 		{
 			EXO_CODEGEN_LOG( stmt, "Expression statement" );
+			isSuspendable = dynamic_cast<exo::ast::OpUnaryAwait*>( stmt.expression.get() ) != nullptr;
 			stmt.expression->accept( this );
 		}
 
 		void Codegen::visit( exo::ast::StmtFor& stmt )
 		{
+			if( stmt.isParallel ) {
+				generateParallelFor( stmt );
+				return;
+			}
+
 			EXO_CODEGEN_LOG( stmt, "For loop" );
 
 			// setup basic blocks for loop statments and exit
@@ -969,6 +2312,14 @@ namespace exo
 				statement->accept( this );
 			}
 
+			// counted loops over a constant or an array length do not need to check their array accesses
+			CountedLoop loop( stmt );
+			if( loop.isCounted ) {
+				loop.memory = stack->Get( loop.variable );
+				loop.isCounted = loop.array.empty() || isLengthStable( loop );
+			}
+			countedLoops.push_back( &loop );
+
 			// evaluate loop condition
 			builder.CreateBr( forCondition );
 			builder.SetInsertPoint( stack->Push( forCondition ) );
@@ -995,6 +2346,8 @@ namespace exo
 				stack->Pop();
 			}
 
+			countedLoops.pop_back();
+
 			stack->Pop();
 			stack->Pop();
 			stack->Pop();
@@ -1002,6 +2355,118 @@ namespace exo
 			builder.SetInsertPoint( stack->Join( forExit ) );
 		}
 
+		/*
+		 * the generator body is inlined with its arguments bound like a call would. its yields run the loop body, continuing
+		 * the loop resumes after the last yield. without a call or an allocation per value, this becomes a single loop
+		 */
+		void Codegen::visit( exo::ast::StmtForIn& stmt )
+		{
+			EXO_CODEGEN_LOG( stmt, "For in" );
+
+			llvm::IntegerType* intType = llvm::Type::getInt64Ty( module->getContext() );
+
+			exo::ast::ExprCallFun* call = dynamic_cast<exo::ast::ExprCallFun*>( stmt.expression.get() );
+			if( call == nullptr || dynamic_cast<exo::ast::ExprCallMethod*>( call ) != nullptr || !generators.count( call->id->name ) ) {
+				EXO_THROW_AT( InvalidExpr() << exo::exceptions::Message( "Expecting generator call" ), stmt );
+			}
+
+			// inlining a generator into itself would never end
+			if( inlinedGenerators.count( call->id->name ) ) {
+				EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Recursive generator " + call->id->name ), stmt );
+			}
+
+			exo::ast::DeclFun& decl = *generators.at( call->id->name );
+			if( call->arguments->list.size() != decl.arguments->list.size() ) {
+				EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Expected parameters mismatch" ), (*call) );
+			}
+
+			// evaluated in our scope, before entering the generator
+			std::vector<llvm::Value*> arguments;
+			for( unsigned i = 0; i < decl.arguments->list.size(); i++ ) {
+				exo::ast::DeclVar* parameter = decl.arguments->list.at( i ).get();
+				llvm::Type* type = getType( parameter->type.get() );
+				if( parameter->isRef ) {
+					type = type->getPointerTo();
+				}
+
+				generateInMem = false;
+				call->arguments->list.at( i )->accept( this );
+				if( currentResult->getType()->getTypeID() != type->getTypeID() ) {
+					EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Parameter:" + std::to_string( i + 1 ) + " type mismatch" ), (*call) );
+				}
+
+				arguments.push_back( convertValue( currentResult, type ) );
+			}
+
+			llvm::Type* type = stmt.variable->type->id->name == "auto" ? getType( decl.returnType.get() ) : getType( stmt.variable->type.get() );
+			if( type->isVoidTy() ) {
+				EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Invalid loop variable type" ), (*stmt.variable) );
+			}
+
+			llvm::Function* scope				= stack->Block()->getParent();
+			llvm::BasicBlock* generatorBlock	= llvm::BasicBlock::Create( module->getContext(), "forin-generator", scope );
+			llvm::BasicBlock* loopBlock			= llvm::BasicBlock::Create( module->getContext(), "forin-loop", scope );
+			llvm::BasicBlock* nextBlock			= llvm::BasicBlock::Create( module->getContext(), "forin-next", scope );
+			llvm::BasicBlock* exitBlock			= llvm::BasicBlock::Create( module->getContext(), "forin-exit", scope );
+
+			generatorBlock->moveAfter( stack->Block() );
+			loopBlock->moveAfter( generatorBlock );
+			nextBlock->moveAfter( loopBlock );
+			exitBlock->moveAfter( nextBlock );
+
+			InlinedGenerator inlined = { allocateLocal( type, stmt.variable->name ), allocateLocal( intType, "generator-state" ), loopBlock, exitBlock, {} };
+
+			ClosureEscapes escapes( *decl.scope->stmts );
+			escapingClosures.insert( escapes.escaping.begin(), escapes.escaping.end() );
+
+			// the generator only sees its parameters, like a function
+			builder.CreateBr( generatorBlock );
+			builder.SetInsertPoint( stack->PushFunction( generatorBlock, exitBlock ) );
+
+			for( unsigned i = 0; i < arguments.size(); i++ ) {
+				llvm::AllocaInst* memory = allocateLocal( arguments.at( i )->getType() );
+				builder.CreateStore( arguments.at( i ), memory );
+				stack->Set( decl.arguments->list.at( i )->name, memory, decl.arguments->list.at( i )->isRef );
+			}
+
+			std::vector<CountedLoop*> loops;
+			loops.swap( countedLoops );
+			InlinedGenerator* outer = generator;
+			generator = &inlined;
+			inlinedGenerators.insert( call->id->name );
+
+			generateInMem = false;
+			decl.scope->stmts->accept( this );
+			if( stack->Block()->getTerminator() == nullptr ) {
+				builder.CreateBr( exitBlock );
+			}
+
+			inlinedGenerators.erase( call->id->name );
+			generator = outer;
+			loops.swap( countedLoops );
+			stack->Pop();
+
+			// the loop body, a yield inside belongs to the generator around us
+			builder.SetInsertPoint( stack->Push( loopBlock, exitBlock, nextBlock ) );
+			stack->Set( stmt.variable->name, inlined.variable );
+
+			stmt.scope->accept( this );
+			if( stack->Block()->getTerminator() == nullptr ) {
+				builder.CreateBr( nextBlock );
+			}
+
+			stack->Pop();
+
+			// resume after the yield we came from
+			builder.SetInsertPoint( nextBlock );
+			llvm::SwitchInst* resume = builder.CreateSwitch( builder.CreateLoad( inlined.state, "generator-state" ), exitBlock, inlined.resumes.size() );
+			for( unsigned i = 0; i < inlined.resumes.size(); i++ ) {
+				resume->addCase( llvm::ConstantInt::get( intType, i + 1 ), inlined.resumes.at( i ) );
+			}
+
+			builder.SetInsertPoint( stack->Join( exitBlock ) );
+		}
+
 		void Codegen::visit( exo::ast::StmtIf& stmt )
 		{
 			EXO_CODEGEN_LOG( stmt, "If statement" );
@@ -1162,7 +2627,27 @@ namespace exo
 				EXO_LOG( debug, "Block already terminated" );
 			}
 
+			isSuspendable = dynamic_cast<exo::ast::OpUnaryAwait*>( stmt.expression.get() ) != nullptr;
 			stmt.expression->accept( this );
+
+			// returning from a generator ends the loop iterating it
+			if( generator != nullptr ) {
+				builder.CreateBr( generator->exit );
+				return;
+			}
+
+			// async functions hand their result over to the task
+			if( asyncFrame != nullptr ) {
+				completeTask( currentResult );
+				return;
+			}
+
+			// i.e. tuple literals or integers returned as floats
+			llvm::Type* type = stack->Block()->getParent()->getReturnType();
+			if( !type->isVoidTy() ) {
+				currentResult = promoteCallable( convertValue( currentResult, type ) );
+			}
+
 			builder.CreateRet( currentResult );
 		}
 
@@ -1274,6 +2759,7 @@ namespace exo
 			ast->Parse( moduleFile.string() );
 
 			ast->stmts->accept( this );
+			modules.push_back( std::move( ast ) );
 		}
 
 		void Codegen::visit( exo::ast::StmtWhile& stmt )
@@ -1311,6 +2797,29 @@ namespace exo
 			builder.SetInsertPoint( stack->Join( whileExit ) );
 		}
 
+		void Codegen::visit( exo::ast::StmtYield& stmt )
+		{
+			EXO_CODEGEN_LOG( stmt, "Yield" );
+
+			if( generator == nullptr ) {
+				EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Can only yield from a generator" ), stmt );
+			}
+
+			generateInMem = false;
+			stmt.expression->accept( this );
+			createStore( convertValue( currentResult, generator->variable->getAllocatedType() ), generator->variable );
+
+			// run the loop body, which comes back here when it continues
+			llvm::BasicBlock* resumeBlock = llvm::BasicBlock::Create( module->getContext(), "yield-resume", stack->Block()->getParent() );
+			resumeBlock->moveAfter( stack->Block() );
+
+			generator->resumes.push_back( resumeBlock );
+			builder.CreateStore( llvm::ConstantInt::get( llvm::Type::getInt64Ty( module->getContext() ), generator->resumes.size() ), generator->state );
+			builder.CreateBr( generator->body );
+
+			builder.SetInsertPoint( stack->Join( resumeBlock ) );
+		}
+
 		void Codegen::visit( exo::ast::Tree& tree )
 		{
 			llvm::Type* intType = module->getDataLayout().getIntPtrType( module->getContext() );
@@ -1334,6 +2843,13 @@ namespace exo
 
 				target = tree.target;
 				if( tree.stmts ) {
+					ClosureEscapes escapes( *tree.stmts );
+					escapingClosures.insert( escapes.escaping.begin(), escapes.escaping.end() );
+
+					StringAppends appends( *tree.stmts );
+					stringAppends.insert( appends.appends.begin(), appends.appends.end() );
+					appendedStrings.insert( appends.variables.begin(), appends.variables.end() );
+
 					tree.stmts->accept( this );
 				}
 			} catch( boost::exception &exception ) {
@@ -1383,151 +2899,629 @@ namespace exo
 			return( bStream.str() );
 		}
 
-		llvm::Function* Codegen::registerExternFun( std::string name, llvm::Type* retType, std::vector<llvm::Type*> fArgs )
+		llvm::Function* Codegen::registerExternFun( std::string name, llvm::Type* retType, std::vector<llvm::Type*> fArgs, bool isVarArg )
 		{
-			return( llvm::Function::Create( llvm::FunctionType::get( retType, fArgs, false ), llvm::GlobalValue::ExternalLinkage, name, module.get() ) );
+			return( llvm::Function::Create( llvm::FunctionType::get( retType, fArgs, isVarArg ), llvm::GlobalValue::ExternalLinkage, name, module.get() ) );
 		}
 
-		llvm::Function* Codegen::getFunction( std::string functionName )
+		llvm::Function* Codegen::getRuntimeFun( std::string name, llvm::Type* retType, std::vector<llvm::Type*> fArgs, bool isVarArg )
 		{
-			llvm::Function* callee = module->getFunction( functionName );
+			llvm::Function* function = module->getFunction( name );
 
-			if( callee == nullptr ) {
-				EXO_THROW( UnknownFunction() << exo::exceptions::FunctionName( functionName ) );
+			if( function == nullptr ) {
+				function = registerExternFun( name, retType, fArgs, isVarArg );
 			}
 
-			return( callee );
+			return( function );
 		}
 
-		llvm::Value* Codegen::invokeFunction( llvm::Value* callee, llvm::FunctionType* function, std::vector<llvm::Value*> arguments, exo::ast::ExprList* expressions, bool inMem )
+		// functions of the runtime are named exo_*, the strings they return already have a header
+		bool Codegen::isRuntimeFun( std::string name )
 		{
-			if( !function->isVarArg() && function->getNumParams() != ( expressions->list.size() + arguments.size() ) ) {
-				EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Expected parameters mismatch" ), (*expressions) );
+			return( name.compare( 0, 4, "exo_" ) == 0 );
+		}
+
+		llvm::Value* Codegen::getFileName()
+		{
+			auto fileName = fileNames.find( currentFile );
+
+			if( fileName != fileNames.end() ) {
+				return( fileName->second );
 			}
 
-			std::vector<llvm::Value*> call;
+			return( fileNames[ currentFile ] = builder.CreateGlobalStringPtr( currentFile, "__FILE__" ) );
+		}
 
-			generateInMem = false;
+		// allocate in the entry block, so the optimizer can promote our variables to registers
+		llvm::AllocaInst* Codegen::allocateLocal( llvm::Type* type, std::string name )
+		{
+			llvm::BasicBlock& entry = stack->Block()->getParent()->getEntryBlock();
+			llvm::IRBuilder<> allocator( &entry, entry.begin() );
 
-			int i = 0;
-			for( auto &argument : function->params() ) {
-				llvm::Value* value = nullptr;
+			return( allocator.CreateAlloca( type, nullptr, name ) );
+		}
 
-				if( arguments.size() ) {
-					value = arguments.front();
-					arguments.erase( arguments.begin() );
-				} else if( expressions->list.size() ) {
-					expressions->list.front()->accept( this );
-					value = currentResult;
-					expressions->list.erase( expressions->list.begin() );
-				}
+		/*
+		 * implicit conversions between integer widths, from integers to floats, from scalars to vectors (splat)
+		 * and between fixed arrays and vectors of the same length, tuples element wise. bytes and booleans are unsigned, narrower
+		 * integers keep the low bits like in C, so an int 256 assigned to a byte is 0
+		 */
+		llvm::Value* Codegen::convertValue( llvm::Value* value, llvm::Type* type )
+		{
+			llvm::Type* from = value->getType();
 
-				if( value == nullptr || value->getType()->getTypeID() != argument->getTypeID() ) {
-					//EXO_DEBUG_LOG( trace, toString( value ) );
-					//EXO_DEBUG_LOG( trace, toString( argument ) );
-					EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Parameter:" + std::to_string( ++i ) + " type mismatch" ), (*expressions) );
+			if( from == type ) {
+				return( value );
+			}
+
+			if( isTuple( type ) && isTuple( from ) && type->getStructNumElements() == from->getStructNumElements() ) {
+				llvm::Value* tuple = llvm::UndefValue::get( type );
+				for( unsigned i = 0; i < type->getStructNumElements(); i++ ) {
+					tuple = builder.CreateInsertValue( tuple, convertValue( builder.CreateExtractValue( value, i ), type->getStructElementType( i ) ), i );
 				}
+				return( tuple );
+			}
 
-				// TODO: check hierarchy
-				if( argument->isPointerTy() ) {
-					if( argument->getPointerElementType()->isStructTy() ) {
-						if( !value->getType()->getPointerElementType()->isStructTy() ) {
-							EXO_DEBUG_LOG( trace, toString( value->getType() ) );
-							EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Expecting object" ), (*expressions) );
-						}
+			if( type->isVectorTy() ) {
+				llvm::Type* elementType = type->getVectorElementType();
 
-						if( argument->getPointerElementType()->getStructName() != value->getType()->getPointerElementType()->getStructName() ) {
-							value = builder.CreateBitCast( value, argument );
-						}
+				if( from->isArrayTy() && from->getArrayNumElements() == type->getVectorNumElements() ) {
+					llvm::Value* vector = llvm::UndefValue::get( type );
+					for( unsigned i = 0; i < type->getVectorNumElements(); i++ ) {
+						vector = builder.CreateInsertElement( vector, convertValue( builder.CreateExtractValue( value, i ), elementType ), builder.getInt32( i ) );
 					}
+					return( vector );
 				}
 
-				call.push_back( value );
+				if( from->isIntegerTy() || from->isFloatingPointTy() ) {
+					return( builder.CreateVectorSplat( type->getVectorNumElements(), convertValue( value, elementType ), "splat" ) );
+				}
+
+				return( value );
 			}
 
-			// if we have a vararg function, assume by value
-			generateInMem = false;
+			// plain values initialize atomics
+			if( isAtomic( type ) && !isAtomic( from ) ) {
+				llvm::Type* valueType = getAtomicValueType( type );
 
-			if( function->isVarArg() && ( arguments.size() || expressions->list.size() ) ) {
-				while( arguments.size() ) {
-					call.push_back( arguments.front() );
-					arguments.erase( arguments.begin() );
+				if( llvm::isa<llvm::Constant>( value ) && llvm::cast<llvm::Constant>( value )->isNullValue() ) {
+					return( llvm::Constant::getNullValue( type ) );
+				}
+				if( from->isPointerTy() && valueType->isPointerTy() ) {
+					value = builder.CreateBitCast( value, valueType );
 				}
 
-				while( expressions->list.size() ) {
-					expressions->list.front()->accept( this );
-					call.push_back( currentResult );
-					expressions->list.erase( expressions->list.begin() );
+				return( builder.CreateInsertValue( llvm::UndefValue::get( type ), convertValue( convertValue( value, valueType ), type->getStructElementType( 0 ) ), 0 ) );
+			}
+
+			if( type->isArrayTy() && from->isVectorTy() && from->getVectorNumElements() == type->getArrayNumElements() ) {
+				llvm::Value* array = llvm::UndefValue::get( type );
+				for( unsigned i = 0; i < type->getArrayNumElements(); i++ ) {
+					array = builder.CreateInsertValue( array, convertValue( builder.CreateExtractElement( value, builder.getInt32( i ) ), type->getArrayElementType() ), i );
 				}
+				return( array );
 			}
 
-			llvm::Value* retval = builder.CreateCall( callee, call );
-			if( retval->getType()->isVoidTy() ) {
-				return( nullptr );
+			if( from->isIntegerTy() && type->isFloatingPointTy() ) {
+				return( isUnsigned( from ) ? builder.CreateUIToFP( value, type ) : builder.CreateSIToFP( value, type ) );
 			}
 
-			if( retval->getType()->isEmptyTy() ) {
-				retval = llvm::Constant::getNullValue( llvm::Type::getInt1Ty( module->getContext() ) );
+			if( !from->isIntegerTy() || !type->isIntegerTy() ) {
+				return( value );
 			}
 
-			if( !inMem ) {
-				return( retval );
+			if( type->isIntegerTy( 1 ) ) {
+				return( builder.CreateICmpNE( value, llvm::Constant::getNullValue( from ), "bool" ) );
 			}
 
-			llvm::Value* memory = builder.CreateAlloca( retval->getType() );
-			builder.CreateStore( retval, memory );
-			return( memory );
+			return( builder.CreateZExtOrTrunc( value, type ) );
 		}
 
-		// TODO: check if the invoker is actually a type / sub type
-		llvm::Value* Codegen::invokeMethod( llvm::Value* object, std::string methodName, exo::ast::ExprList* expressions, bool isOptional, bool inMem )
+		void Codegen::unifyTypes( llvm::Value*& lhs, llvm::Value*& rhs )
 		{
-			if( expressions == nullptr ) {
-				EXO_THROW( InvalidCall() << exo::exceptions::Message( "Invalid arguments" ) );
+			llvm::Type* lType = lhs->getType();
+			llvm::Type* rType = rhs->getType();
+
+			if( lType == rType ) {
+				return;
 			}
 
-			llvm::Type* type = object->getType();
-			if( !type->isPointerTy() ) {
-				EXO_DEBUG_LOG( trace, toString( type ) );
-				EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Expecting object" ), (*expressions) );
+			// scalars are splat across the lanes of the vector operand
+			if( lType->isVectorTy() != rType->isVectorTy() ) {
+				if( lType->isVectorTy() ) {
+					rhs = convertValue( rhs, lType );
+				} else {
+					lhs = convertValue( lhs, rType );
+				}
+				return;
 			}
 
-			type = type->getPointerElementType();
-			if( !type->isStructTy() ) {
-				EXO_DEBUG_LOG( trace, toString( type ) );
-				EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Invalid object" ), (*expressions) );
+			if( lType->isFloatingPointTy() && rType->isIntegerTy() ) {
+				rhs = convertValue( rhs, lType );
+				return;
+			} else if( lType->isIntegerTy() && rType->isFloatingPointTy() ) {
+				lhs = convertValue( lhs, rType );
+				return;
 			}
 
-			std::string className = type->getStructName();
+			if( !lType->isIntegerTy() || !rType->isIntegerTy() ) {
+				return;
+			}
 
-			llvm::Function* callee;
-			try {
-				callee = methods.at( className ).at( methodName ).second;
-			} catch( ... ) {
-				if( !isOptional ) {
-					throw;
-				} else {
-					return( nullptr );
-				}
+			if( lType->getIntegerBitWidth() < rType->getIntegerBitWidth() ) {
+				lhs = builder.CreateZExt( lhs, rType );
+			} else {
+				rhs = builder.CreateZExt( rhs, lType );
 			}
+		}
 
-			return( invokeFunction( callee, callee->getFunctionType(), { object }, expressions, inMem ) );
-			/*
-			int position;
-			try {
-				position = methods.at( className ).at( methodName ).first;
-			} catch( ... ) {
-				if( !isOptional ) {
-					throw;
-				} else {
-					return( nullptr );
+		bool Codegen::isUnsigned( llvm::Type* type )
+		{
+			type = type->getScalarType();
+			return( type->isIntegerTy() && type->getIntegerBitWidth() <= 8 );
+		}
+
+		/*
+		 * element wise arithmetic on integers, floats and vectors of them. operands have to be unified before
+		 */
+		llvm::Value* Codegen::createArithmetic( llvm::Instruction::BinaryOps op, llvm::Value* lhs, llvm::Value* rhs, exo::ast::Node& node, std::string name )
+		{
+			llvm::Type* type = lhs->getType()->getScalarType();
+
+			if( lhs->getType() != rhs->getType() || !( type->isIntegerTy() || type->isFloatingPointTy() ) ) {
+				EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Invalid operand types " + toString( lhs->getType() ) + " and " + toString( rhs->getType() ) ), node );
+			}
+
+			if( type->isFloatingPointTy() ) {
+				switch( op ) {
+					case llvm::Instruction::Add:	op = llvm::Instruction::FAdd; break;
+					case llvm::Instruction::Sub:	op = llvm::Instruction::FSub; break;
+					case llvm::Instruction::Mul:	op = llvm::Instruction::FMul; break;
+					case llvm::Instruction::SDiv:	op = llvm::Instruction::FDiv; break;
+					default: break;
 				}
+			} else if( op == llvm::Instruction::SDiv && isUnsigned( type ) ) {
+				op = llvm::Instruction::UDiv;
 			}
 
-			EXO_DEBUG_LOG( trace, "Call method " << className << "->" << methodName << "@" << position );
+			return( builder.CreateBinOp( op, lhs, rhs, name ) );
+		}
 
-			//load function pointer from vtbl
-			llvm::Value* vtbl = builder.CreateGEP( object, { llvm::ConstantInt::get( llvm::Type::getInt32Ty( module->getContext() ), 0 ), llvm::ConstantInt::get( llvm::Type::getInt32Ty( module->getContext() ), 0 ) } );
+		/*
+		 * comparisons are given as signed integer predicates, vector operands produce a mask of booleans
+		 */
+		llvm::Value* Codegen::createCompare( llvm::CmpInst::Predicate predicate, llvm::Value* lhs, llvm::Value* rhs, exo::ast::Node& node )
+		{
+			llvm::Type* type = lhs->getType()->getScalarType();
+
+			if( lhs->getType() != rhs->getType() || lhs->getType()->isAggregateType() ) {
+				EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Invalid operand types " + toString( lhs->getType() ) + " and " + toString( rhs->getType() ) ), node );
+			}
+
+			// strings are equal if they are the same, only otherwise their contents are compared
+			if( isString( lhs->getType() ) ) {
+				llvm::Type* boolType = llvm::Type::getInt1Ty( module->getContext() );
+				llvm::Type* intType = llvm::Type::getInt64Ty( module->getContext() );
+				llvm::Type* ptrType = llvm::Type::getInt8PtrTy( module->getContext() );
+
+				if( predicate != llvm::CmpInst::ICMP_EQ && predicate != llvm::CmpInst::ICMP_NE ) {
+					llvm::Value* order = builder.CreateCall( getRuntimeFun( "exo_string_compare", intType, { ptrType, ptrType } ), { lhs, rhs }, "order" );
+					return( builder.CreateICmp( predicate, order, llvm::ConstantInt::get( intType, 0 ), "cmp" ) );
+				}
+
+				llvm::Function* scope		= stack->Block()->getParent();
+				llvm::BasicBlock* same		= builder.GetInsertBlock();
+				llvm::BasicBlock* contents	= llvm::BasicBlock::Create( module->getContext(), "string-compare", scope );
+				llvm::BasicBlock* done		= llvm::BasicBlock::Create( module->getContext(), "string-compared", scope );
+
+				contents->moveAfter( same );
+				done->moveAfter( contents );
+
+				builder.CreateCondBr( builder.CreateICmpEQ( lhs, rhs ), done, contents );
+
+				builder.SetInsertPoint( contents );
+				llvm::Value* equal = builder.CreateCall( getRuntimeFun( "exo_string_equals", boolType, { ptrType, ptrType } ), { lhs, rhs } );
+				builder.CreateBr( done );
+
+				builder.SetInsertPoint( stack->Join( done ) );
+				llvm::PHINode* result = builder.CreatePHI( boolType, 2, "equal" );
+				result->addIncoming( builder.getTrue(), same );
+				result->addIncoming( equal, contents );
+
+				return( predicate == llvm::CmpInst::ICMP_EQ ? result : builder.CreateNot( result, "cmp" ) );
+			}
+
+			if( type->isFloatingPointTy() ) {
+				switch( predicate ) {
+					case llvm::CmpInst::ICMP_EQ:	predicate = llvm::CmpInst::FCMP_OEQ; break;
+					case llvm::CmpInst::ICMP_NE:	predicate = llvm::CmpInst::FCMP_UNE; break;
+					case llvm::CmpInst::ICMP_SGE:	predicate = llvm::CmpInst::FCMP_OGE; break;
+					case llvm::CmpInst::ICMP_SGT:	predicate = llvm::CmpInst::FCMP_OGT; break;
+					case llvm::CmpInst::ICMP_SLE:	predicate = llvm::CmpInst::FCMP_OLE; break;
+					case llvm::CmpInst::ICMP_SLT:	predicate = llvm::CmpInst::FCMP_OLT; break;
+					default: break;
+				}
+
+				return( builder.CreateFCmp( predicate, lhs, rhs, "cmp" ) );
+			}
+
+			if( isUnsigned( type ) ) {
+				predicate = llvm::ICmpInst::getUnsignedPredicate( predicate );
+			}
+
+			return( builder.CreateICmp( predicate, lhs, rhs, "cmp" ) );
+		}
+
+		// wether the garbage collector needs to scan memory of this type
+		bool Codegen::containsPointers( llvm::Type* type )
+		{
+			if( type->isPointerTy() ) {
+				return( true );
+			} else if( type->isArrayTy() || type->isVectorTy() ) {
+				return( containsPointers( type->getSequentialElementType() ) );
+			} else if( type->isStructTy() ) {
+				for( auto element : llvm::cast<llvm::StructType>( type )->elements() ) {
+					if( containsPointers( element ) ) {
+						return( true );
+					}
+				}
+			}
+
+			return( false );
+		}
+
+		llvm::MDNode* Codegen::getTBAA( std::string name )
+		{
+			auto tag = tbaaTags.find( name );
+
+			if( tag != tbaaTags.end() ) {
+				return( tag->second );
+			}
+
+			llvm::MDBuilder md( module->getContext() );
+			if( tbaaRoot == nullptr ) {
+				tbaaRoot = md.createTBAARoot( "exolang" );
+			}
+
+			llvm::MDNode* type = md.createTBAAScalarTypeNode( name, tbaaRoot );
+			return( tbaaTags[ name ] = md.createTBAAStructTagNode( type, type, 0 ) );
+		}
+
+		llvm::Value* Codegen::createLoad( llvm::Value* address, std::string name )
+		{
+			llvm::LoadInst* value = builder.CreateLoad( address, name );
+
+			auto tag = accessTags.find( address );
+			if( tag != accessTags.end() ) {
+				value->setMetadata( llvm::LLVMContext::MD_tbaa, tag->second );
+			}
+
+			return( value );
+		}
+
+		llvm::Value* Codegen::createStore( llvm::Value* value, llvm::Value* address )
+		{
+			// assigning to an atomic is a sequentially consistent store
+			if( isAtomic( value->getType() ) ) {
+				llvm::Value* stored = builder.CreateExtractValue( value, 0 );
+				llvm::StoreInst* store = builder.CreateStore( stored, builder.CreateStructGEP( value->getType(), address, 0 ) );
+				store->setAtomic( llvm::AtomicOrdering::SequentiallyConsistent );
+				store->setAlignment( module->getDataLayout().getTypeStoreSize( stored->getType() ) );
+
+				return( store );
+			}
+
+			llvm::StoreInst* store = builder.CreateStore( value, address );
+
+			auto tag = accessTags.find( address );
+			if( tag != accessTags.end() ) {
+				store->setMetadata( llvm::LLVMContext::MD_tbaa, tag->second );
+			}
+
+			return( store );
+		}
+
+		llvm::Function* Codegen::getFunction( std::string functionName )
+		{
+			// prefer the wrapper of an external function taking or returning structs
+			llvm::Function* callee = module->getFunction( EXO_ABI( functionName ) );
+
+			if( callee == nullptr ) {
+				callee = module->getFunction( functionName );
+			}
+
+			if( callee == nullptr ) {
+				EXO_THROW( UnknownFunction() << exo::exceptions::FunctionName( functionName ) );
+			}
+
+			return( callee );
+		}
+
+		/*
+		 * evaluates and converts the arguments of a call, the given values are passed ahead of the expressions
+		 */
+		std::vector<llvm::Value*> Codegen::evaluateArguments( llvm::FunctionType* function, std::vector<llvm::Value*> arguments, exo::ast::ExprList* expressions )
+		{
+			if( !function->isVarArg() && function->getNumParams() != ( expressions->list.size() + arguments.size() ) ) {
+				EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Expected parameters mismatch" ), (*expressions) );
+			}
+
+			std::vector<llvm::Value*> call;
+
+			generateInMem = false;
+
+			// the expressions stay untouched, generator bodies are generated for every loop iterating them
+			int i = 0;
+			size_t next = 0;
+			for( auto &argument : function->params() ) {
+				llvm::Value* value = nullptr;
+
+				if( arguments.size() ) {
+					value = arguments.front();
+					arguments.erase( arguments.begin() );
+				} else if( next < expressions->list.size() ) {
+					expressions->list.at( next++ )->accept( this );
+					value = currentResult;
+				}
+
+				if( value == nullptr || value->getType()->getTypeID() != argument->getTypeID() ) {
+					//EXO_DEBUG_LOG( trace, toString( value ) );
+					//EXO_DEBUG_LOG( trace, toString( argument ) );
+					EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Parameter:" + std::to_string( ++i ) + " type mismatch" ), (*expressions) );
+				}
+
+				value = convertValue( value, argument );
+
+				if( ( isArray( argument ) || isStruct( argument ) || isCallable( argument ) ) && value->getType() != argument ) {
+					EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Parameter:" + std::to_string( ++i ) + " type mismatch" ), (*expressions) );
+				}
+
+				// TODO: check hierarchy
+				if( argument->isPointerTy() ) {
+					if( argument->getPointerElementType()->isStructTy() ) {
+						if( !value->getType()->getPointerElementType()->isStructTy() ) {
+							EXO_DEBUG_LOG( trace, toString( value->getType() ) );
+							EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Expecting object" ), (*expressions) );
+						}
+
+						if( argument->getPointerElementType()->getStructName() != value->getType()->getPointerElementType()->getStructName() ) {
+							value = builder.CreateBitCast( value, argument );
+						}
+					}
+				}
+
+				call.push_back( value );
+			}
+
+			// if we have a vararg function, assume by value
+			generateInMem = false;
+
+			if( function->isVarArg() && ( arguments.size() || next < expressions->list.size() ) ) {
+				while( arguments.size() ) {
+					call.push_back( arguments.front() );
+					arguments.erase( arguments.begin() );
+				}
+
+				while( next < expressions->list.size() ) {
+					expressions->list.at( next++ )->accept( this );
+
+					// default argument promotion, as C expects it
+					if( currentResult->getType()->isIntegerTy() && currentResult->getType()->getIntegerBitWidth() < 32 ) {
+						currentResult = builder.CreateZExt( currentResult, llvm::Type::getInt32Ty( module->getContext() ) );
+					}
+
+					call.push_back( currentResult );
+				}
+			}
+
+			return( call );
+		}
+
+		llvm::Value* Codegen::invokeFunction( llvm::Value* callee, llvm::FunctionType* function, std::vector<llvm::Value*> arguments, exo::ast::ExprList* expressions, bool inMem )
+		{
+			llvm::Value* retval = builder.CreateCall( callee, evaluateArguments( function, arguments, expressions ) );
+			if( retval->getType()->isVoidTy() ) {
+				return( nullptr );
+			}
+
+			if( retval->getType()->isEmptyTy() ) {
+				retval = llvm::Constant::getNullValue( llvm::Type::getInt1Ty( module->getContext() ) );
+			}
+
+			if( !inMem ) {
+				return( retval );
+			}
+
+			llvm::Value* memory = allocateLocal( retval->getType() );
+			builder.CreateStore( retval, memory );
+			return( memory );
+		}
+
+		/*
+		 * the format is parsed once here instead of on every call, each conversion calls the runtime directly. formats with
+		 * flags, widths or arguments not matching their conversion are left to printf
+		 */
+		llvm::Value* Codegen::invokePrintf( llvm::Function* function, exo::ast::ExprCallFun& call, bool inMem )
+		{
+			llvm::Type* intType = llvm::Type::getInt64Ty( module->getContext() );
+			llvm::Type* int32Type = llvm::Type::getInt32Ty( module->getContext() );
+			llvm::Type* byteType = llvm::Type::getInt8Ty( module->getContext() );
+			llvm::Type* ptrType = llvm::Type::getInt8PtrTy( module->getContext() );
+			llvm::Type* voidType = llvm::Type::getVoidTy( module->getContext() );
+
+			std::string format = dynamic_cast<exo::ast::ConstStr*>( call.arguments->list.front().get() )->value;
+
+			// evaluated and promoted just like for the call
+			std::vector<llvm::Value*> values;
+			generateInMem = false;
+			for( auto &expression : call.arguments->list ) {
+				expression->accept( this );
+				if( currentResult->getType()->isIntegerTy() && currentResult->getType()->getIntegerBitWidth() < 32 ) {
+					currentResult = builder.CreateZExt( currentResult, int32Type );
+				}
+				values.push_back( currentResult );
+			}
+
+			// text up to a conversion, the last one has none
+			struct Piece
+			{
+				std::string		text;
+				char			conversion = 0;
+				int64_t			precision = -1;
+				bool			isLong = false;
+			};
+
+			std::vector<Piece> pieces( 1 );
+			bool isSpecialized = true;
+			for( size_t i = 0; i < format.size() && isSpecialized; i++ ) {
+				if( format[ i ] != '%' ) {
+					pieces.back().text += format[ i ];
+					continue;
+				} else if( i + 1 < format.size() && format[ i + 1 ] == '%' ) {
+					pieces.back().text += format[ ++i ];
+					continue;
+				}
+
+				Piece& piece = pieces.back();
+				if( i + 1 < format.size() && format[ i + 1 ] == '.' ) {
+					piece.precision = 0;
+					for( i += 2; i < format.size() && std::isdigit( format[ i ] ); i++ ) {
+						piece.precision = piece.precision * 10 + ( format[ i ] - '0' );
+					}
+					i--;
+				}
+				while( i + 1 < format.size() && ( format[ i + 1 ] == 'l' || format[ i + 1 ] == 'z' || format[ i + 1 ] == 'j' ) ) {
+					piece.isLong = true;
+					i++;
+				}
+
+				i++;
+				size_t value = pieces.size();
+				if( i >= format.size() || value >= values.size() ) {
+					isSpecialized = false;
+				} else if( std::string( "diuxXoc" ).find( format[ i ] ) != std::string::npos ) {
+					isSpecialized = values.at( value )->getType()->isIntegerTy() && piece.precision < 0;
+				} else if( format[ i ] == 's' ) {
+					isSpecialized = isString( values.at( value )->getType() ) && piece.precision < 0;
+				} else if( std::string( "fFeEgG" ).find( format[ i ] ) != std::string::npos ) {
+					isSpecialized = values.at( value )->getType()->isFloatingPointTy();
+				} else {
+					isSpecialized = false;
+				}
+
+				piece.conversion = format[ i ];
+				pieces.emplace_back();
+			}
+
+			if( !isSpecialized ) {
+				EXO_CODEGEN_LOG( call, "printf format not specialized" );
+				llvm::Value* result = builder.CreateCall( function, values );
+				return( inMem ? getAddress( result ) : result );
+			}
+
+			EXO_CODEGEN_LOG( call, "Specialized printf, " << pieces.size() - 1 << " conversions" );
+
+			// without a length modifier integers are passed as int
+			builder.CreateCall( getRuntimeFun( "exo_print_lock", voidType, {} ) );
+			llvm::Value* count = llvm::ConstantInt::get( intType, 0 );
+			for( size_t i = 0; i < pieces.size(); i++ ) {
+				Piece& piece = pieces.at( i );
+				llvm::Value* value = i + 1 < values.size() ? values.at( i + 1 ) : nullptr;
+				llvm::Value* written = nullptr;
+
+				if( !piece.text.empty() ) {
+					written = builder.CreateCall( getRuntimeFun( "exo_print_text", intType, { ptrType, intType } ), { createString( piece.text ), llvm::ConstantInt::get( intType, piece.text.size() ) } );
+					count = builder.CreateAdd( count, written );
+				}
+
+				switch( piece.conversion ) {
+					case 0:
+						continue;
+					case 'd':
+					case 'i':
+						value = piece.isLong ? builder.CreateSExtOrTrunc( value, intType ) : builder.CreateSExt( builder.CreateTrunc( value, int32Type ), intType );
+						written = builder.CreateCall( getRuntimeFun( "exo_print_int", intType, { intType } ), { value } );
+						break;
+					case 'u':
+					case 'x':
+					case 'X':
+					case 'o':
+						value = piece.isLong ? builder.CreateZExtOrTrunc( value, intType ) : builder.CreateZExt( builder.CreateTrunc( value, int32Type ), intType );
+						written = builder.CreateCall( getRuntimeFun( "exo_print_unsigned", intType, { intType, intType, intType } ), {
+							value, llvm::ConstantInt::get( intType, piece.conversion == 'u' ? 10 : piece.conversion == 'o' ? 8 : 16 ), llvm::ConstantInt::get( intType, piece.conversion == 'X' )
+						} );
+						break;
+					case 'c':
+						value = builder.CreateZExt( builder.CreateTrunc( value, byteType ), intType );
+						written = builder.CreateCall( getRuntimeFun( "exo_print_char", intType, { intType } ), { value } );
+						break;
+					case 's':
+						written = builder.CreateCall( getRuntimeFun( "exo_print_string", intType, { ptrType } ), { value } );
+						break;
+					default:
+						value = builder.CreateFPCast( value, llvm::Type::getDoubleTy( module->getContext() ) );
+						written = builder.CreateCall( getRuntimeFun( "exo_print_float", intType, { llvm::Type::getDoubleTy( module->getContext() ), intType, intType } ), {
+							value, llvm::ConstantInt::get( intType, piece.precision ), llvm::ConstantInt::get( intType, piece.conversion )
+						} );
+				}
+
+				count = builder.CreateAdd( count, written );
+			}
+			builder.CreateCall( getRuntimeFun( "exo_print_unlock", voidType, {} ) );
+
+			count = builder.CreateIntCast( count, function->getReturnType(), true );
+			return( inMem ? getAddress( count ) : count );
+		}
+
+		// TODO: check if the invoker is actually a type / sub type
+		llvm::Value* Codegen::invokeMethod( llvm::Value* object, std::string methodName, exo::ast::ExprList* expressions, bool isOptional, bool inMem )
+		{
+			if( expressions == nullptr ) {
+				EXO_THROW( InvalidCall() << exo::exceptions::Message( "Invalid arguments" ) );
+			}
+
+			llvm::Type* type = object->getType();
+			if( !type->isPointerTy() ) {
+				EXO_DEBUG_LOG( trace, toString( type ) );
+				EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Expecting object" ), (*expressions) );
+			}
+
+			type = type->getPointerElementType();
+			if( !type->isStructTy() ) {
+				EXO_DEBUG_LOG( trace, toString( type ) );
+				EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Invalid object" ), (*expressions) );
+			}
+
+			std::string className = type->getStructName();
+
+			llvm::Function* callee;
+			try {
+				callee = methods.at( className ).at( methodName ).second;
+			} catch( ... ) {
+				if( !isOptional ) {
+					throw;
+				} else {
+					return( nullptr );
+				}
+			}
+
+			return( invokeFunction( callee, callee->getFunctionType(), { object }, expressions, inMem ) );
+			/*
+			int position;
+			try {
+				position = methods.at( className ).at( methodName ).first;
+			} catch( ... ) {
+				if( !isOptional ) {
+					throw;
+				} else {
+					return( nullptr );
+				}
+			}
+
+			EXO_DEBUG_LOG( trace, "Call method " << className << "->" << methodName << "@" << position );
+
+			//load function pointer from vtbl
+			llvm::Value* vtbl = builder.CreateGEP( object, { llvm::ConstantInt::get( llvm::Type::getInt32Ty( module->getContext() ), 0 ), llvm::ConstantInt::get( llvm::Type::getInt32Ty( module->getContext() ), 0 ) } );
 			llvm::LoadInst* callee = builder.CreateLoad( builder.CreateGEP( vtbl, { llvm::ConstantInt::get( llvm::Type::getInt32Ty( module->getContext() ), 0 ), llvm::ConstantInt::get( llvm::Type::getInt32Ty( module->getContext() ), position ) }, methodName ) );
 
 			type = callee->getOperand(0)->getType();
@@ -1549,6 +3543,2263 @@ namespace exo
 			*/
 		}
 
+		/*
+		 * strings point at their characters, the header { length, hash, flags } is right in front of them. see
+		 * exo/runtime/runtime.h
+		 */
+		llvm::StructType* Codegen::getStringType()
+		{
+			llvm::StructType* type = module->getTypeByName( EXO_STRING );
+
+			if( type == nullptr ) {
+				llvm::Type* intType = llvm::Type::getInt64Ty( module->getContext() );
+				type = llvm::StructType::create( module->getContext(), { intType, intType, intType, llvm::ArrayType::get( llvm::Type::getInt8Ty( module->getContext() ), 0 ) }, EXO_STRING );
+			}
+
+			return( type );
+		}
+
+		bool Codegen::isString( llvm::Type* type )
+		{
+			return( type == llvm::Type::getInt8PtrTy( module->getContext() ) );
+		}
+
+		llvm::Value* Codegen::getStringHeader( llvm::Value* string )
+		{
+			llvm::StructType* type = getStringType();
+			int64_t offset = module->getDataLayout().getStructLayout( type )->getElementOffset( EXO_STRING_DATA );
+
+			return( builder.CreateBitCast( builder.CreateInBoundsGEP( string, builder.getInt64( -offset ) ), type->getPointerTo(), "header" ) );
+		}
+
+		/*
+		 * equal constants share one, its hash is computed the same way as by the runtime
+		 */
+		llvm::Constant* Codegen::createString( std::string value )
+		{
+			auto constant = strings.find( value );
+			if( constant != strings.end() ) {
+				return( constant->second );
+			}
+
+			uint64_t hash = 0xcbf29ce484222325ull;
+			for( char character : value ) {
+				hash ^= static_cast<uint8_t>( character );
+				hash *= 0x100000001b3ull;
+			}
+
+			llvm::Type* intType = llvm::Type::getInt64Ty( module->getContext() );
+			llvm::Constant* string = llvm::ConstantStruct::getAnon( {
+				llvm::ConstantInt::get( intType, value.size() ),
+				llvm::ConstantInt::get( intType, hash ),
+				llvm::ConstantInt::get( intType, 0 ),
+				llvm::ConstantDataArray::getString( module->getContext(), value )
+			} );
+
+			llvm::GlobalVariable* global = new llvm::GlobalVariable( *module, string->getType(), true, llvm::GlobalValue::PrivateLinkage, string, "string" );
+			global->setUnnamedAddr( llvm::GlobalValue::UnnamedAddr::Global );
+			global->setAlignment( 8 );
+
+			llvm::Constant* indices[] = { builder.getInt32( 0 ), builder.getInt32( EXO_STRING_DATA ), builder.getInt32( 0 ) };
+			return( strings[ value ] = llvm::ConstantExpr::getInBoundsGetElementPtr( string->getType(), global, indices ) );
+		}
+
+		/*
+		 * concatenations nothing used yet are replaced by their parts, so a chain of + ends up in a single call
+		 */
+		std::vector<llvm::Value*> Codegen::getStringParts( std::vector<llvm::Value*> strings )
+		{
+			std::vector<llvm::Value*> parts;
+
+			for( auto string : strings ) {
+				llvm::CallInst* call = llvm::dyn_cast<llvm::CallInst>( string );
+				if( call != nullptr && call->use_empty() && call->getCalledFunction() != nullptr && call->getCalledFunction()->getName() == "exo_string_concat" ) {
+					parts.insert( parts.end(), call->arg_begin() + 1, call->arg_end() );
+					call->eraseFromParent();
+				} else {
+					parts.push_back( string );
+				}
+			}
+
+			return( parts );
+		}
+
+		llvm::Value* Codegen::createConcat( std::vector<llvm::Value*> strings )
+		{
+			llvm::Type* intType = llvm::Type::getInt64Ty( module->getContext() );
+			llvm::Type* ptrType = llvm::Type::getInt8PtrTy( module->getContext() );
+
+			std::vector<llvm::Value*> parts = getStringParts( strings );
+			parts.insert( parts.begin(), llvm::ConstantInt::get( intType, parts.size() ) );
+
+			return( builder.CreateCall( getRuntimeFun( "exo_string_concat", ptrType, { intType }, true ), parts, "concat" ) );
+		}
+
+		/*
+		 * appends in place while the builder has room, what is appended is concatenated by the same call
+		 */
+		llvm::Value* Codegen::createAppend( llvm::Value* string, llvm::Value* suffix )
+		{
+			llvm::Type* intType = llvm::Type::getInt64Ty( module->getContext() );
+			llvm::Type* ptrType = llvm::Type::getInt8PtrTy( module->getContext() );
+
+			std::vector<llvm::Value*> parts = getStringParts( { suffix } );
+			parts.insert( parts.begin(), { string, llvm::ConstantInt::get( intType, parts.size() ) } );
+
+			return( builder.CreateCall( getRuntimeFun( "exo_string_append", ptrType, { ptrType, intType }, true ), parts, "append" ) );
+		}
+
+		// string variables some statement appends to
+		bool Codegen::isAppended( std::string name, llvm::Value* variable )
+		{
+			return( appendedStrings.count( name ) > 0 && isString( variable->getType()->getPointerElementType() ) );
+		}
+
+		/*
+		 * builders are finished before anything but an append reads them. ropes are copied into one string, which replaces
+		 * them so that happens once
+		 */
+		llvm::Value* Codegen::finishString( llvm::Value* variable )
+		{
+			llvm::Type* ptrType = llvm::Type::getInt8PtrTy( module->getContext() );
+
+			llvm::Value* string = builder.CreateCall( getRuntimeFun( "exo_string_finish", ptrType, { ptrType } ), { createLoad( variable ) }, "finished" );
+			createStore( string, variable );
+			return( string );
+		}
+
+		bool Codegen::isStruct( llvm::Type* type )
+		{
+			if( type->isStructTy() ) {
+				llvm::StructType* structr = llvm::cast<llvm::StructType>( type );
+				return( structr->hasName() && structr->getName().startswith( "__struct_" ) );
+			}
+
+			return( false );
+		}
+
+		// tuples are anonymous structs
+		bool Codegen::isTuple( llvm::Type* type )
+		{
+			return( type->isStructTy() && llvm::cast<llvm::StructType>( type )->isLiteral() );
+		}
+
+		llvm::StructType* Codegen::getCallableType( llvm::FunctionType* type )
+		{
+			std::string name = EXO_CALLABLE( toString( type ) );
+			llvm::StructType* callable = module->getTypeByName( name );
+
+			if( callable == nullptr ) {
+				callable = llvm::StructType::create( module->getContext(), { type->getPointerTo(), llvm::Type::getInt8PtrTy( module->getContext() ), llvm::Type::getInt64Ty( module->getContext() ) }, name );
+			}
+
+			return( callable );
+		}
+
+		bool Codegen::isCallable( llvm::Type* type )
+		{
+			if( type->isStructTy() ) {
+				llvm::StructType* structr = llvm::cast<llvm::StructType>( type );
+				return( structr->hasName() && structr->getName().startswith( "__callable<" ) );
+			}
+
+			return( false );
+		}
+
+		/*
+		 * the header shared by async function frames and native tasks, followed by the result if there is one
+		 */
+		llvm::StructType* Codegen::getTaskType( llvm::Type* resultType )
+		{
+			std::string name = EXO_TASK( toString( resultType ) );
+			llvm::StructType* task = module->getTypeByName( name );
+
+			if( task == nullptr ) {
+				llvm::Type* ptrType = llvm::Type::getInt8PtrTy( module->getContext() );
+				llvm::Type* resumeType = llvm::FunctionType::get( llvm::Type::getVoidTy( module->getContext() ), { ptrType }, false )->getPointerTo();
+
+				std::vector<llvm::Type*> fields = { llvm::Type::getInt64Ty( module->getContext() ), resumeType, ptrType };
+				if( !resultType->isVoidTy() ) {
+					fields.push_back( resultType );
+				}
+
+				task = llvm::StructType::create( module->getContext(), fields, name );
+			}
+
+			return( task );
+		}
+
+		bool Codegen::isTask( llvm::Type* type )
+		{
+			if( type->isPointerTy() && type->getPointerElementType()->isStructTy() ) {
+				llvm::StructType* structr = llvm::cast<llvm::StructType>( type->getPointerElementType() );
+				return( structr->hasName() && structr->getName().startswith( "__task<" ) );
+			}
+
+			return( false );
+		}
+
+		/*
+		 * the header of a spawned job, followed by the result if there is one. the arguments of the call come after it
+		 */
+		llvm::StructType* Codegen::getFutureType( llvm::Type* resultType )
+		{
+			std::string name = EXO_FUTURE( toString( resultType ) );
+			llvm::StructType* future = module->getTypeByName( name );
+
+			if( future == nullptr ) {
+				llvm::Type* ptrType = llvm::Type::getInt8PtrTy( module->getContext() );
+				llvm::Type* runType = llvm::FunctionType::get( llvm::Type::getVoidTy( module->getContext() ), { ptrType }, false )->getPointerTo();
+
+				std::vector<llvm::Type*> fields = { runType, llvm::Type::getInt64Ty( module->getContext() ) };
+				if( !resultType->isVoidTy() ) {
+					fields.push_back( resultType );
+				}
+
+				future = llvm::StructType::create( module->getContext(), fields, name );
+			}
+
+			return( future );
+		}
+
+		bool Codegen::isFuture( llvm::Type* type )
+		{
+			if( type->isPointerTy() && type->getPointerElementType()->isStructTy() ) {
+				llvm::StructType* structr = llvm::cast<llvm::StructType>( type->getPointerElementType() );
+				return( structr->hasName() && structr->getName().startswith( "__future<" ) );
+			}
+
+			return( false );
+		}
+
+		/*
+		 * atomics wrap their value, so loads and stores can be told apart from plain ones. bools are stored as bytes, the
+		 * smallest width atomic instructions take
+		 */
+		llvm::StructType* Codegen::getAtomicType( llvm::Type* valueType )
+		{
+			std::string name = EXO_ATOMIC( toString( valueType ) );
+			llvm::StructType* atomic = module->getTypeByName( name );
+
+			if( atomic == nullptr ) {
+				atomic = llvm::StructType::create( module->getContext(), { valueType->isIntegerTy( 1 ) ? llvm::Type::getInt8Ty( module->getContext() ) : valueType }, name );
+			}
+
+			return( atomic );
+		}
+
+		llvm::Type* Codegen::getAtomicValueType( llvm::Type* type )
+		{
+			if( type->getStructName() == EXO_ATOMIC( toString( llvm::Type::getInt1Ty( module->getContext() ) ) ) ) {
+				return( llvm::Type::getInt1Ty( module->getContext() ) );
+			}
+
+			return( type->getStructElementType( 0 ) );
+		}
+
+		bool Codegen::isAtomic( llvm::Type* type )
+		{
+			if( type->isStructTy() ) {
+				llvm::StructType* structr = llvm::cast<llvm::StructType>( type );
+				return( structr->hasName() && structr->getName().startswith( "__atomic<" ) );
+			}
+
+			return( false );
+		}
+
+		/*
+		 * hash maps and sets are a header shared by reference, see exo/runtime/runtime.h. their slots hold the key, followed
+		 * by the value for maps
+		 */
+		llvm::StructType* Codegen::getMapType( llvm::Type* keyType, llvm::Type* valueType )
+		{
+			std::vector<llvm::Type*> elements = { keyType };
+			if( valueType != nullptr ) {
+				elements.push_back( valueType );
+			}
+
+			llvm::StructType* slotType = llvm::StructType::get( module->getContext(), elements );
+			std::string name = valueType != nullptr ? EXO_MAP( toString( slotType ) ) : EXO_SET( toString( slotType ) );
+			llvm::StructType* type = module->getTypeByName( name );
+
+			if( type == nullptr ) {
+				llvm::Type* intType = llvm::Type::getInt64Ty( module->getContext() );
+				type = llvm::StructType::create(
+					module->getContext(),
+					{ llvm::Type::getInt8PtrTy( module->getContext() ), slotType->getPointerTo(), intType, intType, intType, intType, intType, intType, intType },
+					name
+				);
+			}
+
+			return( type );
+		}
+
+		bool Codegen::isMap( llvm::Type* type )
+		{
+			if( type->isPointerTy() && type->getPointerElementType()->isStructTy() ) {
+				llvm::StructType* structr = llvm::cast<llvm::StructType>( type->getPointerElementType() );
+				return( structr->hasName() && ( structr->getName().startswith( "__map<" ) || structr->getName().startswith( "__set<" ) ) );
+			}
+
+			return( false );
+		}
+
+		/*
+		 * seeded multiplicative hashing, strings mix in the hash cached in their header. the runtime hashes the same way when
+		 * a table grows
+		 */
+		llvm::Value* Codegen::createHash( llvm::Value* key, llvm::Value* seed )
+		{
+			llvm::Type* intType = llvm::Type::getInt64Ty( module->getContext() );
+			llvm::Type* ptrType = llvm::Type::getInt8PtrTy( module->getContext() );
+			llvm::Type* type = key->getType();
+
+			if( isString( type ) ) {
+				return( builder.CreateCall( getRuntimeFun( "exo_hash_string", intType, { ptrType, intType } ), { key, seed }, "hash" ) );
+			}
+
+			llvm::Value* bits;
+			if( type->isPointerTy() ) {
+				bits = builder.CreatePtrToInt( key, intType );
+			} else if( type->isFloatingPointTy() ) {
+				bits = builder.CreateBitCast( key, intType );
+			} else {
+				bits = builder.CreateZExtOrBitCast( key, intType );
+			}
+
+			llvm::Value* hash = builder.CreateMul( builder.CreateXor( bits, seed ), llvm::ConstantInt::get( intType, 0x9E3779B97F4A7C15ull ) );
+			return( builder.CreateXor( hash, builder.CreateLShr( hash, 32 ), "hash" ) );
+		}
+
+		/*
+		 * moves the environment of a closure to the heap before it escapes, does nothing if it already lives there
+		 */
+		llvm::Value* Codegen::promoteCallable( llvm::Value* value )
+		{
+			llvm::Type* type = value->getType();
+
+			if( isTuple( type ) ) {
+				for( unsigned i = 0; i < type->getStructNumElements(); i++ ) {
+					if( isCallable( type->getStructElementType( i ) ) ) {
+						value = builder.CreateInsertValue( value, promoteCallable( builder.CreateExtractValue( value, i ) ), i );
+					}
+				}
+				return( value );
+			}
+
+			if( !isCallable( type ) ) {
+				return( value );
+			}
+
+			llvm::Value* size = builder.CreateExtractValue( value, EXO_CALLABLE_SIZE, "env-size" );
+			if( llvm::isa<llvm::ConstantInt>( size ) && llvm::cast<llvm::ConstantInt>( size )->isZero() ) {
+				return( value );
+			}
+
+			llvm::Type* intType = llvm::Type::getInt64Ty( module->getContext() );
+			llvm::Type* ptrType = llvm::Type::getInt8PtrTy( module->getContext() );
+
+			llvm::Function* scope		= stack->Block()->getParent();
+			llvm::BasicBlock* current	= stack->Block();
+			llvm::BasicBlock* promote	= llvm::BasicBlock::Create( module->getContext(), "env-promote", scope );
+			llvm::BasicBlock* promoted	= llvm::BasicBlock::Create( module->getContext(), "env-promoted", scope );
+
+			builder.CreateCondBr( builder.CreateICmpNE( size, llvm::ConstantInt::get( intType, 0 ) ), promote, promoted );
+
+			builder.SetInsertPoint( promote );
+			llvm::Value* memory = builder.CreateBitCast( builder.CreateCall( getFunction( EXO_ALLOC ), { size } ), ptrType );
+			builder.CreateMemCpy( memory, builder.CreateExtractValue( value, EXO_CALLABLE_ENV ), size, 1 );
+			llvm::Value* moved = builder.CreateInsertValue( builder.CreateInsertValue( value, memory, EXO_CALLABLE_ENV ), llvm::ConstantInt::get( intType, 0 ), EXO_CALLABLE_SIZE );
+			builder.CreateBr( promoted );
+
+			builder.SetInsertPoint( stack->Join( promoted ) );
+			llvm::PHINode* result = builder.CreatePHI( type, 2, "callable" );
+			result->addIncoming( value, current );
+			result->addIncoming( moved, promote );
+
+			return( result );
+		}
+
+		/*
+		 * a tuple element by its constant index, the index is part of the type
+		 */
+		llvm::Value* Codegen::getTupleElement( llvm::Value* tuple, exo::ast::ExprIndex& expr, bool inMem )
+		{
+			expr.index->accept( this );
+			llvm::ConstantInt* index = llvm::dyn_cast<llvm::ConstantInt>( currentResult );
+			if( index == nullptr ) {
+				EXO_THROW_AT( InvalidExpr() << exo::exceptions::Message( "Expecting constant tuple index" ), expr );
+			}
+
+			uint64_t position = index->getZExtValue();
+			if( position >= tuple->getType()->getStructNumElements() ) {
+				EXO_THROW_AT( InvalidExpr() << exo::exceptions::Message( "Tuple index out of range" ), expr );
+			}
+
+			if( !inMem ) {
+				return( builder.CreateExtractValue( tuple, position ) );
+			}
+
+			return( builder.CreateStructGEP( tuple->getType(), getAddress( tuple ), position ) );
+		}
+
+		/*
+		 * the value of an uninitialized variable, structs get their property defaults
+		 */
+		llvm::Value* Codegen::createDefault( llvm::Type* type )
+		{
+			if( isTuple( type ) ) {
+				llvm::Value* tuple = llvm::UndefValue::get( type );
+				for( unsigned i = 0; i < type->getStructNumElements(); i++ ) {
+					tuple = builder.CreateInsertValue( tuple, createDefault( type->getStructElementType( i ) ), i );
+				}
+				return( tuple );
+			}
+
+			if( type->isArrayTy() ) {
+				llvm::Constant* element = llvm::dyn_cast<llvm::Constant>( createDefault( type->getArrayElementType() ) );
+
+				if( element != nullptr && !element->isNullValue() ) {
+					return( llvm::ConstantArray::get( llvm::cast<llvm::ArrayType>( type ), std::vector<llvm::Constant*>( type->getArrayNumElements(), element ) ) );
+				}
+			}
+
+			if( !isStruct( type ) ) {
+				return( llvm::Constant::getNullValue( type ) );
+			}
+
+			std::vector<llvm::Value*> fields( type->getStructNumElements() );
+			for( auto &property : properties[ std::string( type->getStructName() ) ] ) {
+				fields.at( property.second.first ) = property.second.second;
+			}
+
+			std::vector<llvm::Constant*> constants;
+			for( auto field : fields ) {
+				if( llvm::isa<llvm::Constant>( field ) ) {
+					constants.push_back( llvm::cast<llvm::Constant>( field ) );
+				}
+			}
+
+			if( constants.size() == fields.size() ) {
+				return( llvm::ConstantStruct::get( llvm::cast<llvm::StructType>( type ), constants ) );
+			}
+
+			llvm::Value* value = llvm::UndefValue::get( type );
+			for( unsigned i = 0; i < fields.size(); i++ ) {
+				value = builder.CreateInsertValue( value, fields.at( i ), i );
+			}
+
+			return( value );
+		}
+
+		/*
+		 * structs are constructed in place on the stack, no heap allocation involved
+		 */
+		llvm::Value* Codegen::constructStruct( llvm::StructType* type, exo::ast::ExprList* expressions, exo::ast::Node& node, bool inMem )
+		{
+			EXO_CODEGEN_LOG( node, "Constructing " << std::string( type->getName() ) );
+
+			llvm::AllocaInst* memory = allocateLocal( type );
+			builder.CreateStore( createDefault( type ), memory );
+
+			if( methods[ std::string( type->getName() ) ].count( "__construct" ) == 0 && !expressions->list.empty() ) {
+				EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Expected parameters mismatch" ), node );
+			}
+
+			invokeMethod( memory, "__construct", expressions, true, false );
+
+			if( inMem ) {
+				return( memory );
+			}
+
+			return( builder.CreateLoad( memory ) );
+		}
+
+		/*
+		 * structs crossing into C follow the System V x86-64 calling convention, other targets rely on how llvm lowers aggregates
+		 */
+		bool Codegen::isStructABI( llvm::Type* type )
+		{
+			llvm::Triple triple( module->getTargetTriple() );
+
+			if( !isStruct( type ) || triple.getArch() != llvm::Triple::x86_64 || triple.isOSWindows() ) {
+				return( false );
+			}
+
+			std::function<bool( llvm::Type* )> hasVectors = [&]( llvm::Type* t ) -> bool {
+				if( t->isVectorTy() ) {
+					return( true );
+				} else if( t->isArrayTy() ) {
+					return( hasVectors( t->getArrayElementType() ) );
+				} else if( t->isStructTy() ) {
+					for( auto element : llvm::cast<llvm::StructType>( t )->elements() ) {
+						if( hasVectors( element ) ) {
+							return( true );
+						}
+					}
+				}
+
+				return( false );
+			};
+
+			return( !hasVectors( type ) );
+		}
+
+		/*
+		 * classifies a struct into the eightbytes passed in registers, an empty result means it is passed in memory
+		 */
+		std::vector<llvm::Type*> Codegen::classifyStruct( llvm::Type* type )
+		{
+			const llvm::DataLayout& layout = module->getDataLayout();
+			uint64_t size = layout.getTypeAllocSize( type );
+
+			if( size > 16 ) {
+				return( std::vector<llvm::Type*>() );
+			}
+
+			std::vector<std::pair<uint64_t, llvm::Type*>> fields;
+			std::function<void( llvm::Type*, uint64_t )> flatten = [&]( llvm::Type* t, uint64_t offset ) {
+				if( t->isStructTy() ) {
+					const llvm::StructLayout* structLayout = layout.getStructLayout( llvm::cast<llvm::StructType>( t ) );
+					for( unsigned i = 0; i < t->getStructNumElements(); i++ ) {
+						flatten( t->getStructElementType( i ), offset + structLayout->getElementOffset( i ) );
+					}
+				} else if( t->isArrayTy() ) {
+					for( uint64_t i = 0; i < t->getArrayNumElements(); i++ ) {
+						flatten( t->getArrayElementType(), offset + i * layout.getTypeAllocSize( t->getArrayElementType() ) );
+					}
+				} else {
+					fields.push_back( { offset, t } );
+				}
+			};
+			flatten( type, 0 );
+
+			// an eightbyte of floating point values goes into a sse register, anything else into a general purpose one
+			std::vector<llvm::Type*> chunks;
+			for( uint64_t chunk = 0; chunk < size; chunk += 8 ) {
+				bool isSSE = true;
+				bool isDouble = false;
+				unsigned floats = 0;
+
+				for( auto &field : fields ) {
+					if( field.first < chunk || field.first >= chunk + 8 ) {
+						continue;
+					}
+
+					if( field.second->isDoubleTy() ) {
+						isDouble = true;
+					} else if( field.second->isFloatTy() ) {
+						floats++;
+					} else {
+						isSSE = false;
+					}
+				}
+
+				if( isSSE && isDouble ) {
+					chunks.push_back( llvm::Type::getDoubleTy( module->getContext() ) );
+				} else if( isSSE && floats > 1 ) {
+					chunks.push_back( llvm::VectorType::get( llvm::Type::getFloatTy( module->getContext() ), 2 ) );
+				} else if( isSSE && floats == 1 ) {
+					chunks.push_back( llvm::Type::getFloatTy( module->getContext() ) );
+				} else {
+					chunks.push_back( llvm::IntegerType::get( module->getContext(), std::min<uint64_t>( 8, size - chunk ) * 8 ) );
+				}
+			}
+
+			return( chunks );
+		}
+
+		/*
+		 * declares the external function with its structs lowered to registers or memory, and an always inlined
+		 * wrapper with our own signature that translates between both. strings returned get a header, unless they come from
+		 * the runtime
+		 */
+		llvm::Function* Codegen::createABIWrapper( llvm::FunctionType* type, std::string name )
+		{
+			llvm::LLVMContext& context = module->getContext();
+			const llvm::DataLayout& layout = module->getDataLayout();
+
+			llvm::Type* returnType = type->getReturnType();
+			std::vector<llvm::Type*> returnChunks = isStructABI( returnType ) ? classifyStruct( returnType ) : std::vector<llvm::Type*>();
+			bool isIndirect = isStructABI( returnType ) && returnChunks.empty();
+
+			std::vector<llvm::Type*> arguments;
+			if( isIndirect ) {
+				arguments.push_back( returnType->getPointerTo() );
+				returnType = llvm::Type::getVoidTy( context );
+			} else if( !returnChunks.empty() ) {
+				returnType = returnChunks.size() == 1 ? returnChunks.front() : llvm::StructType::get( context, returnChunks );
+			}
+
+			std::vector<unsigned> byValue;
+			for( auto argument : type->params() ) {
+				std::vector<llvm::Type*> chunks = isStructABI( argument ) ? classifyStruct( argument ) : std::vector<llvm::Type*>();
+
+				if( isStructABI( argument ) && chunks.empty() ) {
+					byValue.push_back( arguments.size() + 1 );
+					arguments.push_back( argument->getPointerTo() );
+				} else if( !chunks.empty() ) {
+					arguments.insert( arguments.end(), chunks.begin(), chunks.end() );
+				} else {
+					arguments.push_back( argument );
+				}
+			}
+
+			llvm::Function* external = llvm::Function::Create( llvm::FunctionType::get( returnType, arguments, type->isVarArg() ), llvm::GlobalValue::ExternalLinkage, name, module.get() );
+			if( isIndirect ) {
+				external->addAttribute( 1, llvm::Attribute::StructRet );
+			}
+			for( auto index : byValue ) {
+				external->addAttribute( index, llvm::Attribute::ByVal );
+			}
+
+			llvm::Function* wrapper = llvm::Function::Create( type, llvm::GlobalValue::InternalLinkage, EXO_ABI( name ), module.get() );
+			wrapper->addFnAttr( llvm::Attribute::AlwaysInline );
+
+			llvm::IRBuilder<> abi( llvm::BasicBlock::Create( context, "entry", wrapper ) );
+
+			// memory large and aligned enough to reinterpret a struct as its eightbytes
+			auto createTemporary = [&]( llvm::Type* a, llvm::Type* b ) -> llvm::Value* {
+				llvm::AllocaInst* memory = abi.CreateAlloca( llvm::ArrayType::get( abi.getInt8Ty(), std::max( layout.getTypeAllocSize( a ), layout.getTypeAllocSize( b ) ) ) );
+				memory->setAlignment( std::max( layout.getABITypeAlignment( a ), layout.getABITypeAlignment( b ) ) );
+				return( memory );
+			};
+
+			std::vector<llvm::Value*> call;
+			llvm::Value* result = nullptr;
+
+			if( isIndirect ) {
+				result = abi.CreateAlloca( type->getReturnType() );
+				call.push_back( result );
+			}
+
+			for( auto &argument : wrapper->args() ) {
+				if( !isStructABI( argument.getType() ) ) {
+					call.push_back( &argument );
+					continue;
+				}
+
+				std::vector<llvm::Type*> chunks = classifyStruct( argument.getType() );
+				if( chunks.empty() ) {
+					llvm::AllocaInst* memory = abi.CreateAlloca( argument.getType() );
+					abi.CreateStore( &argument, memory );
+					call.push_back( memory );
+					continue;
+				}
+
+				llvm::StructType* eightbytes = llvm::StructType::get( context, chunks );
+				llvm::Value* memory = createTemporary( argument.getType(), eightbytes );
+				abi.CreateStore( &argument, abi.CreateBitCast( memory, argument.getType()->getPointerTo() ) );
+
+				llvm::Value* eightbyte = abi.CreateBitCast( memory, eightbytes->getPointerTo() );
+				for( unsigned i = 0; i < chunks.size(); i++ ) {
+					call.push_back( abi.CreateLoad( abi.CreateStructGEP( eightbytes, eightbyte, i ) ) );
+				}
+			}
+
+			llvm::Value* value = abi.CreateCall( external, call );
+
+			if( isIndirect ) {
+				abi.CreateRet( abi.CreateLoad( result ) );
+			} else if( !returnChunks.empty() ) {
+				llvm::Value* memory = createTemporary( type->getReturnType(), returnType );
+				abi.CreateStore( value, abi.CreateBitCast( memory, returnType->getPointerTo() ) );
+				abi.CreateRet( abi.CreateLoad( abi.CreateBitCast( memory, type->getReturnType()->getPointerTo() ) ) );
+			} else if( returnType->isVoidTy() ) {
+				abi.CreateRetVoid();
+			} else if( isString( returnType ) && !isRuntimeFun( name ) ) {
+				abi.CreateRet( abi.CreateCall( getRuntimeFun( "exo_string_wrap", returnType, { returnType } ), { value } ) );
+			} else {
+				abi.CreateRet( value );
+			}
+
+			return( wrapper );
+		}
+
+		/*
+		 * growable arrays are a header { length, capacity, data } shared by reference, see exo/runtime/runtime.h
+		 */
+		llvm::StructType* Codegen::getArrayType( llvm::Type* elementType )
+		{
+			std::string name = EXO_ARRAY( toString( elementType ) );
+			llvm::StructType* type = module->getTypeByName( name );
+
+			if( type == nullptr ) {
+				llvm::Type* intType = llvm::Type::getInt64Ty( module->getContext() );
+				type = llvm::StructType::create( module->getContext(), { intType, intType, elementType->getPointerTo() }, name );
+			}
+
+			return( type );
+		}
+
+		llvm::Type* Codegen::getArrayElementType( llvm::Type* type )
+		{
+			return( llvm::cast<llvm::StructType>( type->getPointerElementType() )->getElementType( EXO_ARRAY_DATA )->getPointerElementType() );
+		}
+
+		bool Codegen::isArray( llvm::Type* type )
+		{
+			if( type->isPointerTy() && type->getPointerElementType()->isStructTy() ) {
+				llvm::StructType* structr = llvm::cast<llvm::StructType>( type->getPointerElementType() );
+				return( structr->hasName() && structr->getName().startswith( "__array<" ) );
+			}
+
+			return( false );
+		}
+
+		/*
+		 * address of a value, for values we just loaded its origin instead of the copy. anything else is spilled
+		 */
+		llvm::Value* Codegen::getAddress( llvm::Value* value )
+		{
+			llvm::LoadInst* load = llvm::dyn_cast<llvm::LoadInst>( value );
+			if( load != nullptr ) {
+				llvm::Value* address = load->getPointerOperand();
+
+				if( load->use_empty() ) {
+					load->eraseFromParent();
+				}
+
+				return( address );
+			}
+
+			llvm::AllocaInst* memory = allocateLocal( value->getType() );
+			builder.CreateStore( value, memory );
+			return( memory );
+		}
+
+		// element count of fixed arrays and vectors
+		uint64_t Codegen::getFixedLength( llvm::Type* type )
+		{
+			return( type->isVectorTy() ? type->getVectorNumElements() : type->getArrayNumElements() );
+		}
+
+		/*
+		 * returns the header of growable arrays or the memory of fixed arrays and vectors, so elements can be addressed in place
+		 */
+		llvm::Value* Codegen::getArrayAddress( llvm::Value* value, exo::ast::Node& node )
+		{
+			llvm::Type* type = value->getType();
+
+			if( isArray( type ) ) {
+				return( value );
+			}
+
+			if( !type->isArrayTy() && !type->isVectorTy() ) {
+				EXO_THROW_AT( InvalidOp() << exo::exceptions::Message( "Expecting array" ), node );
+			}
+
+			return( getAddress( value ) );
+		}
+
+		llvm::Value* Codegen::getArrayField( llvm::Value* array, int field, std::string name )
+		{
+			llvm::LoadInst* value = builder.CreateLoad( builder.CreateStructGEP( nullptr, array, field ), name );
+			value->setMetadata( llvm::LLVMContext::MD_tbaa, getTBAA( "array header" ) );
+
+			// lengths and capacities are never negative
+			if( field != EXO_ARRAY_DATA ) {
+				llvm::MDBuilder md( module->getContext() );
+				value->setMetadata( llvm::LLVMContext::MD_range, md.createRange( llvm::APInt( 64, 0 ), llvm::APInt::getSignedMaxValue( 64 ) ) );
+			}
+
+			return( value );
+		}
+
+		void Codegen::setArrayField( llvm::Value* array, int field, llvm::Value* value )
+		{
+			llvm::StoreInst* store = builder.CreateStore( value, builder.CreateStructGEP( nullptr, array, field ) );
+			store->setMetadata( llvm::LLVMContext::MD_tbaa, getTBAA( "array header" ) );
+		}
+
+		llvm::Value* Codegen::getArrayElement( llvm::Value* array, llvm::Value* index, exo::ast::Node& node, bool isChecked )
+		{
+			llvm::Type* intType = llvm::Type::getInt64Ty( module->getContext() );
+			llvm::Type* type = array->getType()->getPointerElementType();
+
+			if( type->isArrayTy() || type->isVectorTy() ) {
+				if( isChecked ) {
+					createBoundsCheck( index, llvm::ConstantInt::get( intType, getFixedLength( type ) ), node );
+				}
+
+				return( builder.CreateInBoundsGEP( array, { llvm::ConstantInt::get( intType, 0 ), index }, "element" ) );
+			}
+
+			if( isChecked ) {
+				createBoundsCheck( index, getArrayField( array, EXO_ARRAY_LENGTH, "length" ), node );
+			}
+
+			// elements never alias the header, tell the optimizer so it can hoist the header loads out of loops
+			llvm::Value* element = builder.CreateInBoundsGEP( getArrayField( array, EXO_ARRAY_DATA, "data" ), index, "element" );
+			accessTags[ element ] = getTBAA( "array element " + toString( getArrayElementType( array->getType() ) ) );
+
+			return( element );
+		}
+
+		void Codegen::createBoundsCheck( llvm::Value* index, llvm::Value* length, exo::ast::Node& node )
+		{
+			llvm::Type* intType = llvm::Type::getInt64Ty( module->getContext() );
+			llvm::Type* voidType = llvm::Type::getVoidTy( module->getContext() );
+			llvm::Type* ptrType = llvm::Type::getInt8PtrTy( module->getContext() );
+
+			llvm::Function* scope		= stack->Block()->getParent();
+			llvm::BasicBlock* inBounds	= llvm::BasicBlock::Create( module->getContext(), "bounds-ok", scope );
+			llvm::BasicBlock* outBounds	= llvm::BasicBlock::Create( module->getContext(), "bounds-fail", scope );
+
+			inBounds->moveAfter( stack->Block() );
+
+			// negative indices wrap around, so a single unsigned comparison covers both ends
+			llvm::MDBuilder md( module->getContext() );
+			builder.CreateCondBr( builder.CreateICmpULT( index, length, "bounds" ), inBounds, outBounds, md.createBranchWeights( 2000, 1 ) );
+
+			builder.SetInsertPoint( outBounds );
+			llvm::Function* failure = getRuntimeFun( "exo_array_bounds", voidType, { ptrType, intType, intType, intType } );
+			failure->setDoesNotReturn();
+			failure->addFnAttr( llvm::Attribute::Cold );
+			builder.CreateCall( failure, { getFileName(), llvm::ConstantInt::get( intType, node.lineNo ), index, length } );
+			builder.CreateUnreachable();
+
+			builder.SetInsertPoint( stack->Join( inBounds ) );
+		}
+
+		/*
+		 * an access is in bounds if it uses a constant index into a fixed array or vector,
+		 * or the induction variable of a surrounding counted loop which is bound by the array size
+		 */
+		bool Codegen::isInBounds( exo::ast::ExprIndex& expr, llvm::Type* type )
+		{
+			bool isFixed = type->isArrayTy() || type->isVectorTy();
+
+			exo::ast::ConstInt* constant = dynamic_cast<exo::ast::ConstInt*>( expr.index.get() );
+			if( constant != nullptr && isFixed ) {
+				if( constant->value < 0 || (uint64_t) constant->value >= getFixedLength( type ) ) {
+					EXO_THROW_AT( InvalidExpr() << exo::exceptions::Message( "Array index out of bounds" ), expr );
+				}
+
+				return( true );
+			}
+
+			std::string index = CountedLoop::variableName( expr.index.get() );
+			if( index.empty() ) {
+				return( false );
+			}
+
+			llvm::Value* memory = stack->Get( index );
+			for( auto loop : countedLoops ) {
+				if( !loop->isCounted || loop->memory != memory ) {
+					continue;
+				}
+
+				if( loop->array.empty() ) {
+					if( isFixed && (uint64_t) loop->bound <= getFixedLength( type ) ) {
+						return( true );
+					}
+				} else if( CountedLoop::variableName( expr.expression.get() ) == loop->array && stack->Get( loop->array ) == loop->arrayMemory ) {
+					return( true );
+				}
+			}
+
+			return( false );
+		}
+
+		/*
+		 * a loop bound by $array->length() may only elide checks if nothing inside the loop can shrink or replace the array
+		 */
+		bool Codegen::isLengthStable( CountedLoop& loop )
+		{
+			if( loop.hasReferences || loop.hasAwaits || loop.assigned.count( loop.array ) ) {
+				return( false );
+			}
+
+			try {
+				llvm::Value* array = stack->Get( loop.array );
+				if( stack->isRef( loop.array ) || !isArray( array->getType()->getPointerElementType() ) ) {
+					return( false );
+				}
+				loop.arrayMemory = array;
+
+				// writes thru references could alias our array
+				for( auto &name : loop.assigned ) {
+					try {
+						if( stack->isRef( name ) ) {
+							return( false );
+						}
+					} catch( boost::exception &exception ) { // declared inside the loop
+					}
+				}
+
+				// only external functions and non shrinking methods of array variables are harmless
+				for( auto call : loop.calls ) {
+					exo::ast::ExprCallMethod* method = dynamic_cast<exo::ast::ExprCallMethod*>( call );
+
+					if( method != nullptr ) {
+						std::string receiver = CountedLoop::variableName( method->expression.get() );
+						if( receiver.empty() || !isArray( stack->Get( receiver )->getType()->getPointerElementType() ) ) {
+							return( false );
+						}
+
+						if( method->id->name == "pop" || method->id->name == "resize" || method->id->name == "clear" || method->id->name == "unique" ) {
+							return( false );
+						}
+
+						// comparators and predicates may run anything
+						size_t arguments = method->arguments->list.size();
+						if( method->id->name == "partition" || ( arguments > 0 && ( method->id->name == "sort" || method->id->name == "stableSort" ) )
+							|| ( arguments > 1 && ( method->id->name == "nthElement" || method->id->name == "binarySearch" ) ) ) {
+							return( false );
+						}
+					} else {
+						llvm::Function* function = module->getFunction( call->id->name );
+						if( function == nullptr || !function->isDeclaration() ) {
+							return( false );
+						}
+					}
+				}
+			} catch( boost::exception &exception ) {
+				return( false );
+			}
+
+			return( true );
+		}
+
+		llvm::Value* Codegen::invokeArrayMethod( llvm::Value* array, std::string methodName, exo::ast::ExprList* expressions, exo::ast::Node& node, bool inMem )
+		{
+			llvm::Type* intType = llvm::Type::getInt64Ty( module->getContext() );
+			llvm::Type* voidType = llvm::Type::getVoidTy( module->getContext() );
+			llvm::Type* ptrType = llvm::Type::getInt8PtrTy( module->getContext() );
+
+			llvm::Type* type = array->getType()->getPointerElementType();
+			bool isFixed = type->isArrayTy();
+			llvm::Type* elementType = isFixed ? type->getArrayElementType() : getArrayElementType( array->getType() );
+
+			EXO_CODEGEN_LOG( node, "Call array method " << methodName );
+
+			std::vector<llvm::Value*> arguments;
+			generateInMem = false;
+			for( auto &expression : expressions->list ) {
+				expression->accept( this );
+				arguments.push_back( currentResult );
+			}
+
+			// minimum and maximum amount of parameters
+			std::map<std::string, std::pair<size_t, size_t>> signatures = {
+				{ "length", { 0, 0 } }, { "capacity", { 0, 0 } }, { "push", { 1, 1 } }, { "pop", { 0, 0 } }, { "clear", { 0, 0 } },
+				{ "resize", { 1, 1 } }, { "reserve", { 1, 1 } }, { "load", { 1, 2 } }, { "store", { 2, 3 } },
+				{ "sort", { 0, 1 } }, { "stableSort", { 0, 1 } }, { "nthElement", { 1, 2 } }, { "binarySearch", { 1, 2 } },
+				{ "partition", { 1, 1 } }, { "unique", { 0, 1 } }
+			};
+			std::set<std::string> algorithms = { "sort", "stableSort", "nthElement", "binarySearch", "partition", "unique" };
+			auto signature = signatures.find( methodName );
+			if( signature == signatures.end() || ( isFixed && methodName != "length" && methodName != "capacity" && methodName != "load" && methodName != "store" ) ) {
+				EXO_THROW_AT( InvalidMethod() << exo::exceptions::ClassName( toString( type ) ) << exo::exceptions::FunctionName( methodName ), node );
+			}
+			if( arguments.size() < signature->second.first || arguments.size() > signature->second.second ) {
+				EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Expected parameters mismatch" ), node );
+			}
+
+			if( methodName == "load" || methodName == "store" ) {
+				return( invokeVectorAccess( array, methodName, arguments, node, inMem ) );
+			} else if( algorithms.count( methodName ) ) {
+				return( invokeArrayAlgorithm( array, methodName, arguments, node, inMem ) );
+			}
+
+			for( auto &argument : arguments ) {
+				argument = convertValue( argument, methodName == "push" ? elementType : intType );
+				if( argument->getType() != ( methodName == "push" ? elementType : intType ) ) {
+					EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Parameter:1 type mismatch" ), node );
+				}
+				if( methodName == "push" ) {
+					argument = promoteCallable( argument );
+				}
+			}
+
+			llvm::Value* elementSize = llvm::ConstantInt::get( intType, module->getDataLayout().getTypeAllocSize( elementType ) );
+			llvm::Value* isAtomic = llvm::ConstantInt::get( intType, !containsPointers( elementType ) );
+			llvm::Value* result = nullptr;
+
+			if( methodName == "length" || methodName == "capacity" ) {
+				if( isFixed ) {
+					result = llvm::ConstantInt::get( intType, type->getArrayNumElements() );
+				} else {
+					result = getArrayField( array, methodName == "length" ? EXO_ARRAY_LENGTH : EXO_ARRAY_CAPACITY, methodName );
+				}
+			} else if( methodName == "push" ) {
+				llvm::Value* length = getArrayField( array, EXO_ARRAY_LENGTH, "length" );
+				llvm::Value* capacity = getArrayField( array, EXO_ARRAY_CAPACITY, "capacity" );
+
+				llvm::Function* scope		= stack->Block()->getParent();
+				llvm::BasicBlock* grow		= llvm::BasicBlock::Create( module->getContext(), "array-grow", scope );
+				llvm::BasicBlock* append	= llvm::BasicBlock::Create( module->getContext(), "array-push", scope );
+
+				append->moveAfter( stack->Block() );
+
+				// growing is rare (geometric), keep it out of the hot path
+				llvm::MDBuilder md( module->getContext() );
+				builder.CreateCondBr( builder.CreateICmpEQ( length, capacity, "full" ), grow, append, md.createBranchWeights( 1, 64 ) );
+
+				builder.SetInsertPoint( grow );
+				builder.CreateCall(
+					getRuntimeFun( "exo_array_reserve", voidType, { ptrType, intType, intType, intType } ),
+					{ builder.CreateBitCast( array, ptrType ), builder.CreateAdd( length, llvm::ConstantInt::get( intType, 1 ) ), elementSize, isAtomic }
+				);
+				builder.CreateBr( append );
+
+				builder.SetInsertPoint( stack->Join( append ) );
+				createStore( arguments.at( 0 ), getArrayElement( array, length, node, false ) );
+				setArrayField( array, EXO_ARRAY_LENGTH, builder.CreateNUWAdd( length, llvm::ConstantInt::get( intType, 1 ), "length" ) );
+			} else if( methodName == "pop" ) {
+				llvm::Value* index = builder.CreateSub( getArrayField( array, EXO_ARRAY_LENGTH, "length" ), llvm::ConstantInt::get( intType, 1 ) );
+
+				result = createLoad( getArrayElement( array, index, node, true ), "pop" );
+				setArrayField( array, EXO_ARRAY_LENGTH, index );
+			} else if( methodName == "clear" ) {
+				setArrayField( array, EXO_ARRAY_LENGTH, llvm::ConstantInt::get( intType, 0 ) );
+			} else if( methodName == "resize" ) {
+				builder.CreateCall(
+					getRuntimeFun( "exo_array_resize", voidType, { ptrType, intType, ptrType, intType, intType, intType } ),
+					{ getFileName(), llvm::ConstantInt::get( intType, node.lineNo ), builder.CreateBitCast( array, ptrType ), arguments.at( 0 ), elementSize, isAtomic }
+				);
+			} else if( methodName == "reserve" ) {
+				builder.CreateCall(
+					getRuntimeFun( "exo_array_reserve", voidType, { ptrType, intType, intType, intType } ),
+					{ builder.CreateBitCast( array, ptrType ), arguments.at( 0 ), elementSize, isAtomic }
+				);
+			}
+
+			if( !inMem || result == nullptr ) {
+				return( result );
+			}
+
+			llvm::AllocaInst* memory = allocateLocal( result->getType() );
+			builder.CreateStore( result, memory );
+			return( memory );
+		}
+
+		/*
+		 * sort, stableSort, nthElement, binarySearch, partition and unique, optionally taking a comparator or predicate last.
+		 * integers, floats, bytes and strings are sorted and selected by their natural order in the runtime. anything given a
+		 * comparator, and the rest of the algorithms, are generated in place for the element type, so the comparator is called
+		 * directly and can be inlined
+		 */
+		llvm::Value* Codegen::invokeArrayAlgorithm( llvm::Value* array, std::string methodName, std::vector<llvm::Value*> arguments, exo::ast::Node& node, bool inMem )
+		{
+			llvm::Type* intType = llvm::Type::getInt64Ty( module->getContext() );
+			llvm::Type* voidType = llvm::Type::getVoidTy( module->getContext() );
+			llvm::Type* ptrType = llvm::Type::getInt8PtrTy( module->getContext() );
+			llvm::Type* boolType = llvm::Type::getInt1Ty( module->getContext() );
+
+			llvm::Type* elementType = getArrayElementType( array->getType() );
+
+			llvm::Value* callable = nullptr;
+			if( !arguments.empty() && isCallable( arguments.back()->getType() ) ) {
+				callable = arguments.back();
+				arguments.pop_back();
+			}
+
+			size_t expected = methodName == "nthElement" || methodName == "binarySearch" ? 1 : 0;
+			if( arguments.size() != expected || ( methodName == "partition" && callable == nullptr ) ) {
+				EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Expected parameters mismatch" ), node );
+			}
+
+			llvm::Value* function = nullptr;
+			llvm::Value* environment = nullptr;
+			if( callable != nullptr ) {
+				// a closure created in place is called directly, so it can be inlined
+				function = llvm::FindInsertedValue( callable, { EXO_CALLABLE_FUNCTION } );
+				if( function == nullptr || !llvm::isa<llvm::Function>( function ) ) {
+					function = builder.CreateExtractValue( callable, EXO_CALLABLE_FUNCTION, "function" );
+				}
+				environment = builder.CreateExtractValue( callable, EXO_CALLABLE_ENV, "env" );
+
+				// predicates take one element, comparators two
+				std::vector<llvm::Type*> parameters = { ptrType, elementType };
+				if( methodName != "partition" ) {
+					parameters.push_back( elementType );
+				}
+
+				if( function->getType()->getPointerElementType() != llvm::FunctionType::get( boolType, parameters, false ) ) {
+					EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Parameter:" + std::to_string( expected + 1 ) + " type mismatch" ), node );
+				}
+			}
+
+			llvm::Value* argument = nullptr;
+			if( expected > 0 ) {
+				llvm::Type* argumentType = methodName == "nthElement" ? intType : elementType;
+				argument = convertValue( arguments.at( 0 ), argumentType );
+				if( argument->getType() != argumentType ) {
+					EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Parameter:1 type mismatch" ), node );
+				}
+
+				if( methodName == "nthElement" ) {
+					createBoundsCheck( argument, getArrayField( array, EXO_ARRAY_LENGTH, "length" ), node );
+				}
+			}
+
+			llvm::Value* result = nullptr;
+
+			if( methodName == "binarySearch" ) {
+				result = createLowerBound( array, argument, function, environment, node );
+			} else if( methodName == "partition" ) {
+				result = createPartition( array, function, environment );
+			} else if( methodName == "unique" ) {
+				result = createUnique( array, function, environment, node );
+			} else if( function != nullptr ) {
+				if( methodName == "nthElement" ) {
+					createSelect( array, argument, function, environment, node );
+				} else {
+					createMergeSort( array, function, environment, node );
+				}
+			} else {
+				int64_t kind;
+				if( isString( elementType ) ) {
+					kind = EXO_SORT_STRING;
+				} else if( elementType->isDoubleTy() ) {
+					kind = EXO_SORT_FLOAT;
+				} else if( elementType->isIntegerTy( 64 ) ) {
+					kind = EXO_SORT_INT;
+				} else if( elementType->isIntegerTy( 8 ) || elementType->isIntegerTy( 1 ) ) {
+					kind = EXO_SORT_BYTE;
+				} else {
+					EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Expecting comparator, " + toString( elementType ) + " has no order" ), node );
+				}
+
+				if( methodName == "nthElement" ) {
+					builder.CreateCall(
+						getRuntimeFun( "exo_array_select", voidType, { ptrType, intType, intType } ),
+						{ builder.CreateBitCast( array, ptrType ), llvm::ConstantInt::get( intType, kind ), argument }
+					);
+				} else {
+					builder.CreateCall(
+						getRuntimeFun( "exo_array_sort", voidType, { ptrType, intType } ),
+						{ builder.CreateBitCast( array, ptrType ), llvm::ConstantInt::get( intType, kind ) }
+					);
+				}
+			}
+
+			if( !inMem || result == nullptr ) {
+				return( result );
+			}
+
+			llvm::AllocaInst* memory = allocateLocal( result->getType() );
+			builder.CreateStore( result, memory );
+			return( memory );
+		}
+
+		// whether lhs goes before rhs or, given the equality predicate, equals it
+		llvm::Value* Codegen::createOrder( llvm::CmpInst::Predicate predicate, llvm::Value* lhs, llvm::Value* rhs, llvm::Value* function, llvm::Value* environment, exo::ast::Node& node )
+		{
+			if( function == nullptr ) {
+				return( createCompare( predicate, lhs, rhs, node ) );
+			}
+
+			return( builder.CreateCall( function, { environment, lhs, rhs }, "order" ) );
+		}
+
+		/*
+		 * bottom up merge sort. runs of 16 are insertion sorted in place, then merged back and forth between the array and a
+		 * buffer, doubling their width on each pass. stable, and whatever the comparator returns it stays within bounds
+		 */
+		void Codegen::createMergeSort( llvm::Value* array, llvm::Value* function, llvm::Value* environment, exo::ast::Node& node )
+		{
+			llvm::Type* intType = llvm::Type::getInt64Ty( module->getContext() );
+			llvm::Type* elementType = getArrayElementType( array->getType() );
+
+			llvm::Value* one = llvm::ConstantInt::get( intType, 1 );
+			llvm::Value* run = llvm::ConstantInt::get( intType, EXO_ARRAY_SORT_RUN );
+			llvm::Value* length = getArrayField( array, EXO_ARRAY_LENGTH, "length" );
+			llvm::Value* data = getArrayField( array, EXO_ARRAY_DATA, "data" );
+			llvm::Value* size = builder.CreateMul( length, llvm::ConstantInt::get( intType, module->getDataLayout().getTypeAllocSize( elementType ) ), "size" );
+
+			llvm::AllocaInst* next = allocateLocal( intType, "next" );
+			llvm::AllocaInst* left = allocateLocal( intType, "left" );
+			llvm::AllocaInst* right = allocateLocal( intType, "right" );
+			llvm::AllocaInst* from = allocateLocal( intType, "from" );
+			llvm::AllocaInst* width = allocateLocal( intType, "width" );
+			llvm::AllocaInst* source = allocateLocal( elementType->getPointerTo(), "source" );
+			llvm::AllocaInst* target = allocateLocal( elementType->getPointerTo(), "target" );
+
+			llvm::Function* scope			= stack->Block()->getParent();
+			llvm::BasicBlock* insertLoop	= llvm::BasicBlock::Create( module->getContext(), "sort-insert", scope );
+			llvm::BasicBlock* insertBody	= llvm::BasicBlock::Create( module->getContext(), "sort-insert-body", scope );
+			llvm::BasicBlock* shiftLoop		= llvm::BasicBlock::Create( module->getContext(), "sort-shift", scope );
+			llvm::BasicBlock* shiftCompare	= llvm::BasicBlock::Create( module->getContext(), "sort-shift-compare", scope );
+			llvm::BasicBlock* shiftBody		= llvm::BasicBlock::Create( module->getContext(), "sort-shift-body", scope );
+			llvm::BasicBlock* shiftDone		= llvm::BasicBlock::Create( module->getContext(), "sort-shift-done", scope );
+			llvm::BasicBlock* mergeStart	= llvm::BasicBlock::Create( module->getContext(), "sort-merge", scope );
+			llvm::BasicBlock* allocate		= llvm::BasicBlock::Create( module->getContext(), "sort-buffer", scope );
+			llvm::BasicBlock* passLoop		= llvm::BasicBlock::Create( module->getContext(), "sort-pass", scope );
+			llvm::BasicBlock* runLoop		= llvm::BasicBlock::Create( module->getContext(), "sort-run", scope );
+			llvm::BasicBlock* runBody		= llvm::BasicBlock::Create( module->getContext(), "sort-run-body", scope );
+			llvm::BasicBlock* elementLoop	= llvm::BasicBlock::Create( module->getContext(), "sort-element", scope );
+			llvm::BasicBlock* elementBody	= llvm::BasicBlock::Create( module->getContext(), "sort-element-body", scope );
+			llvm::BasicBlock* leftCheck		= llvm::BasicBlock::Create( module->getContext(), "sort-left-check", scope );
+			llvm::BasicBlock* compare		= llvm::BasicBlock::Create( module->getContext(), "sort-compare", scope );
+			llvm::BasicBlock* takeLeft		= llvm::BasicBlock::Create( module->getContext(), "sort-take-left", scope );
+			llvm::BasicBlock* takeRight		= llvm::BasicBlock::Create( module->getContext(), "sort-take-right", scope );
+			llvm::BasicBlock* runDone		= llvm::BasicBlock::Create( module->getContext(), "sort-run-done", scope );
+			llvm::BasicBlock* passDone		= llvm::BasicBlock::Create( module->getContext(), "sort-pass-done", scope );
+			llvm::BasicBlock* copyCheck		= llvm::BasicBlock::Create( module->getContext(), "sort-copy-check", scope );
+			llvm::BasicBlock* copy			= llvm::BasicBlock::Create( module->getContext(), "sort-copy", scope );
+			llvm::BasicBlock* done			= llvm::BasicBlock::Create( module->getContext(), "sort-done", scope );
+
+			builder.CreateStore( one, next );
+			builder.CreateBr( insertLoop );
+
+			// the first element of a run stays where it is
+			builder.SetInsertPoint( stack->Join( insertLoop ) );
+			llvm::Value* index = builder.CreateLoad( next, "index" );
+			builder.CreateCondBr( builder.CreateICmpSLT( index, length ), insertBody, mergeStart );
+
+			builder.SetInsertPoint( stack->Join( insertBody ) );
+			llvm::Value* value = builder.CreateLoad( builder.CreateInBoundsGEP( data, index ), "value" );
+			llvm::Value* runStart = builder.CreateAnd( index, llvm::ConstantInt::get( intType, -EXO_ARRAY_SORT_RUN ), "run-start" );
+			builder.CreateStore( index, left );
+			builder.CreateBr( shiftLoop );
+
+			builder.SetInsertPoint( stack->Join( shiftLoop ) );
+			llvm::Value* position = builder.CreateLoad( left, "position" );
+			builder.CreateCondBr( builder.CreateICmpSGT( position, runStart ), shiftCompare, shiftDone );
+
+			builder.SetInsertPoint( stack->Join( shiftCompare ) );
+			llvm::Value* previous = builder.CreateLoad( builder.CreateInBoundsGEP( data, builder.CreateSub( position, one ) ), "previous" );
+			builder.CreateCondBr( createOrder( llvm::CmpInst::ICMP_SLT, value, previous, function, environment, node ), shiftBody, shiftDone );
+
+			builder.SetInsertPoint( stack->Join( shiftBody ) );
+			builder.CreateStore( previous, builder.CreateInBoundsGEP( data, position ) );
+			builder.CreateStore( builder.CreateSub( position, one ), left );
+			builder.CreateBr( shiftLoop );
+
+			builder.SetInsertPoint( stack->Join( shiftDone ) );
+			builder.CreateStore( value, builder.CreateInBoundsGEP( data, builder.CreateLoad( left ) ) );
+			builder.CreateStore( builder.CreateAdd( index, one ), next );
+			builder.CreateBr( insertLoop );
+
+			// a single run is sorted already
+			builder.SetInsertPoint( stack->Join( mergeStart ) );
+			builder.CreateCondBr( builder.CreateICmpSGT( length, run ), allocate, done );
+
+			builder.SetInsertPoint( stack->Join( allocate ) );
+			llvm::Value* buffer = builder.CreateCall( getFunction( EXO_ALLOC ), { size }, "buffer" );
+			builder.CreateStore( data, source );
+			builder.CreateStore( builder.CreateBitCast( buffer, elementType->getPointerTo() ), target );
+			builder.CreateStore( run, width );
+			builder.CreateStore( llvm::ConstantInt::get( intType, 0 ), from );
+			builder.CreateBr( passLoop );
+
+			builder.SetInsertPoint( stack->Join( passLoop ) );
+			llvm::Value* step = builder.CreateLoad( width, "width" );
+			builder.CreateCondBr( builder.CreateICmpSLT( step, length ), runLoop, copyCheck );
+
+			builder.SetInsertPoint( stack->Join( runLoop ) );
+			llvm::Value* low = builder.CreateLoad( from, "low" );
+			builder.CreateCondBr( builder.CreateICmpSLT( low, length ), runBody, passDone );
+
+			// merges the run from low up to middle with the one from middle up to high, the last ones may be shorter
+			builder.SetInsertPoint( stack->Join( runBody ) );
+			llvm::Value* middle = builder.CreateAdd( low, step );
+			middle = builder.CreateSelect( builder.CreateICmpSLT( middle, length ), middle, length, "middle" );
+			llvm::Value* high = builder.CreateAdd( middle, step );
+			high = builder.CreateSelect( builder.CreateICmpSLT( high, length ), high, length, "high" );
+			llvm::Value* input = builder.CreateLoad( source, "input" );
+			llvm::Value* output = builder.CreateLoad( target, "output" );
+			builder.CreateStore( low, left );
+			builder.CreateStore( middle, right );
+			builder.CreateStore( low, next );
+			builder.CreateBr( elementLoop );
+
+			builder.SetInsertPoint( stack->Join( elementLoop ) );
+			llvm::Value* written = builder.CreateLoad( next, "written" );
+			builder.CreateCondBr( builder.CreateICmpSLT( written, high ), elementBody, runDone );
+
+			builder.SetInsertPoint( stack->Join( elementBody ) );
+			llvm::Value* leftIndex = builder.CreateLoad( left, "left" );
+			llvm::Value* rightIndex = builder.CreateLoad( right, "right" );
+			builder.CreateCondBr( builder.CreateICmpSLT( rightIndex, high ), leftCheck, takeLeft );
+
+			builder.SetInsertPoint( stack->Join( leftCheck ) );
+			builder.CreateCondBr( builder.CreateICmpSLT( leftIndex, middle ), compare, takeRight );
+
+			// equal elements are taken from the left, which keeps the sort stable
+			builder.SetInsertPoint( stack->Join( compare ) );
+			llvm::Value* leftValue = builder.CreateLoad( builder.CreateInBoundsGEP( input, leftIndex ), "left-value" );
+			llvm::Value* rightValue = builder.CreateLoad( builder.CreateInBoundsGEP( input, rightIndex ), "right-value" );
+			builder.CreateCondBr( createOrder( llvm::CmpInst::ICMP_SLT, rightValue, leftValue, function, environment, node ), takeRight, takeLeft );
+
+			builder.SetInsertPoint( stack->Join( takeLeft ) );
+			builder.CreateStore( builder.CreateLoad( builder.CreateInBoundsGEP( input, leftIndex ) ), builder.CreateInBoundsGEP( output, written ) );
+			builder.CreateStore( builder.CreateAdd( leftIndex, one ), left );
+			builder.CreateStore( builder.CreateAdd( written, one ), next );
+			builder.CreateBr( elementLoop );
+
+			builder.SetInsertPoint( stack->Join( takeRight ) );
+			builder.CreateStore( builder.CreateLoad( builder.CreateInBoundsGEP( input, rightIndex ) ), builder.CreateInBoundsGEP( output, written ) );
+			builder.CreateStore( builder.CreateAdd( rightIndex, one ), right );
+			builder.CreateStore( builder.CreateAdd( written, one ), next );
+			builder.CreateBr( elementLoop );
+
+			builder.SetInsertPoint( stack->Join( runDone ) );
+			builder.CreateStore( high, from );
+			builder.CreateBr( runLoop );
+
+			builder.SetInsertPoint( stack->Join( passDone ) );
+			llvm::Value* merged = builder.CreateLoad( target, "merged" );
+			builder.CreateStore( builder.CreateLoad( source ), target );
+			builder.CreateStore( merged, source );
+			builder.CreateStore( builder.CreateShl( step, one ), width );
+			builder.CreateStore( llvm::ConstantInt::get( intType, 0 ), from );
+			builder.CreateBr( passLoop );
+
+			// an odd number of passes leaves the elements in the buffer
+			builder.SetInsertPoint( stack->Join( copyCheck ) );
+			llvm::Value* sorted = builder.CreateLoad( source, "sorted" );
+			builder.CreateCondBr( builder.CreateICmpNE( sorted, data ), copy, done );
+
+			builder.SetInsertPoint( stack->Join( copy ) );
+			builder.CreateMemCpy( data, sorted, size, module->getDataLayout().getABITypeAlignment( elementType ) );
+			builder.CreateBr( done );
+
+			builder.SetInsertPoint( stack->Join( done ) );
+		}
+
+		/*
+		 * hoare's find, only the part holding nth is partitioned around the element at nth until it is in place. the scans
+		 * stop at the ends of the part, so a comparator which is no strict order can not run out of the array
+		 */
+		void Codegen::createSelect( llvm::Value* array, llvm::Value* nth, llvm::Value* function, llvm::Value* environment, exo::ast::Node& node )
+		{
+			llvm::Type* intType = llvm::Type::getInt64Ty( module->getContext() );
+
+			llvm::Value* one = llvm::ConstantInt::get( intType, 1 );
+			llvm::Value* data = getArrayField( array, EXO_ARRAY_DATA, "data" );
+
+			llvm::AllocaInst* low = allocateLocal( intType, "low" );
+			llvm::AllocaInst* high = allocateLocal( intType, "high" );
+			llvm::AllocaInst* left = allocateLocal( intType, "left" );
+			llvm::AllocaInst* right = allocateLocal( intType, "right" );
+
+			llvm::Function* scope				= stack->Block()->getParent();
+			llvm::BasicBlock* partLoop			= llvm::BasicBlock::Create( module->getContext(), "select-part", scope );
+			llvm::BasicBlock* partBody			= llvm::BasicBlock::Create( module->getContext(), "select-part-body", scope );
+			llvm::BasicBlock* leftLoop			= llvm::BasicBlock::Create( module->getContext(), "select-left", scope );
+			llvm::BasicBlock* leftCompare		= llvm::BasicBlock::Create( module->getContext(), "select-left-compare", scope );
+			llvm::BasicBlock* leftAdvance		= llvm::BasicBlock::Create( module->getContext(), "select-left-advance", scope );
+			llvm::BasicBlock* rightLoop			= llvm::BasicBlock::Create( module->getContext(), "select-right", scope );
+			llvm::BasicBlock* rightCompare		= llvm::BasicBlock::Create( module->getContext(), "select-right-compare", scope );
+			llvm::BasicBlock* rightAdvance		= llvm::BasicBlock::Create( module->getContext(), "select-right-advance", scope );
+			llvm::BasicBlock* exchangeCheck		= llvm::BasicBlock::Create( module->getContext(), "select-exchange-check", scope );
+			llvm::BasicBlock* exchange			= llvm::BasicBlock::Create( module->getContext(), "select-exchange", scope );
+			llvm::BasicBlock* narrow			= llvm::BasicBlock::Create( module->getContext(), "select-narrow", scope );
+			llvm::BasicBlock* done				= llvm::BasicBlock::Create( module->getContext(), "select-done", scope );
+
+			builder.CreateStore( llvm::ConstantInt::get( intType, 0 ), low );
+			builder.CreateStore( builder.CreateSub( getArrayField( array, EXO_ARRAY_LENGTH, "length" ), one ), high );
+			builder.CreateBr( partLoop );
+
+			builder.SetInsertPoint( stack->Join( partLoop ) );
+			llvm::Value* first = builder.CreateLoad( low, "first" );
+			llvm::Value* last = builder.CreateLoad( high, "last" );
+			builder.CreateCondBr( builder.CreateICmpSLT( first, last ), partBody, done );
+
+			builder.SetInsertPoint( stack->Join( partBody ) );
+			llvm::Value* pivot = builder.CreateLoad( builder.CreateInBoundsGEP( data, nth ), "pivot" );
+			builder.CreateStore( first, left );
+			builder.CreateStore( last, right );
+			builder.CreateBr( leftLoop );
+
+			builder.SetInsertPoint( stack->Join( leftLoop ) );
+			llvm::Value* leftIndex = builder.CreateLoad( left, "left" );
+			builder.CreateCondBr( builder.CreateICmpSLT( leftIndex, last ), leftCompare, rightLoop );
+
+			builder.SetInsertPoint( stack->Join( leftCompare ) );
+			llvm::Value* leftValue = builder.CreateLoad( builder.CreateInBoundsGEP( data, leftIndex ), "left-value" );
+			builder.CreateCondBr( createOrder( llvm::CmpInst::ICMP_SLT, leftValue, pivot, function, environment, node ), leftAdvance, rightLoop );
+
+			builder.SetInsertPoint( stack->Join( leftAdvance ) );
+			builder.CreateStore( builder.CreateAdd( leftIndex, one ), left );
+			builder.CreateBr( leftLoop );
+
+			builder.SetInsertPoint( stack->Join( rightLoop ) );
+			llvm::Value* rightIndex = builder.CreateLoad( right, "right" );
+			builder.CreateCondBr( builder.CreateICmpSGT( rightIndex, first ), rightCompare, exchangeCheck );
+
+			builder.SetInsertPoint( stack->Join( rightCompare ) );
+			llvm::Value* rightValue = builder.CreateLoad( builder.CreateInBoundsGEP( data, rightIndex ), "right-value" );
+			builder.CreateCondBr( createOrder( llvm::CmpInst::ICMP_SLT, pivot, rightValue, function, environment, node ), rightAdvance, exchangeCheck );
+
+			builder.SetInsertPoint( stack->Join( rightAdvance ) );
+			builder.CreateStore( builder.CreateSub( rightIndex, one ), right );
+			builder.CreateBr( rightLoop );
+
+			builder.SetInsertPoint( stack->Join( exchangeCheck ) );
+			llvm::Value* leftStop = builder.CreateLoad( left, "left-stop" );
+			llvm::Value* rightStop = builder.CreateLoad( right, "right-stop" );
+			builder.CreateCondBr( builder.CreateICmpSLE( leftStop, rightStop ), exchange, narrow );
+
+			builder.SetInsertPoint( stack->Join( exchange ) );
+			llvm::Value* leftElement = builder.CreateInBoundsGEP( data, leftStop );
+			llvm::Value* rightElement = builder.CreateInBoundsGEP( data, rightStop );
+			llvm::Value* swapped = builder.CreateLoad( leftElement, "swapped" );
+			builder.CreateStore( builder.CreateLoad( rightElement ), leftElement );
+			builder.CreateStore( swapped, rightElement );
+			llvm::Value* leftNext = builder.CreateAdd( leftStop, one );
+			llvm::Value* rightNext = builder.CreateSub( rightStop, one );
+			builder.CreateStore( leftNext, left );
+			builder.CreateStore( rightNext, right );
+			builder.CreateCondBr( builder.CreateICmpSLE( leftNext, rightNext ), leftLoop, narrow );
+
+			// nth is either left of the part lower than the pivot, right of the part greater than it or in between and done
+			builder.SetInsertPoint( stack->Join( narrow ) );
+			llvm::Value* leftEnd = builder.CreateLoad( left, "left-end" );
+			llvm::Value* rightEnd = builder.CreateLoad( right, "right-end" );
+			builder.CreateStore( builder.CreateSelect( builder.CreateICmpSLT( rightEnd, nth ), leftEnd, first ), low );
+			builder.CreateStore( builder.CreateSelect( builder.CreateICmpSLT( nth, leftEnd ), rightEnd, last ), high );
+			builder.CreateBr( partLoop );
+
+			builder.SetInsertPoint( stack->Join( done ) );
+		}
+
+		// the first position whose element does not go before value, or the length if there is none
+		llvm::Value* Codegen::createLowerBound( llvm::Value* array, llvm::Value* value, llvm::Value* function, llvm::Value* environment, exo::ast::Node& node )
+		{
+			llvm::Type* intType = llvm::Type::getInt64Ty( module->getContext() );
+
+			llvm::Value* one = llvm::ConstantInt::get( intType, 1 );
+			llvm::Value* data = getArrayField( array, EXO_ARRAY_DATA, "data" );
+
+			llvm::AllocaInst* first = allocateLocal( intType, "first" );
+			llvm::AllocaInst* count = allocateLocal( intType, "count" );
+
+			llvm::Function* scope		= stack->Block()->getParent();
+			llvm::BasicBlock* loop		= llvm::BasicBlock::Create( module->getContext(), "search", scope );
+			llvm::BasicBlock* body		= llvm::BasicBlock::Create( module->getContext(), "search-body", scope );
+			llvm::BasicBlock* done		= llvm::BasicBlock::Create( module->getContext(), "search-done", scope );
+
+			builder.CreateStore( llvm::ConstantInt::get( intType, 0 ), first );
+			builder.CreateStore( getArrayField( array, EXO_ARRAY_LENGTH, "length" ), count );
+			builder.CreateBr( loop );
+
+			builder.SetInsertPoint( stack->Join( loop ) );
+			llvm::Value* remaining = builder.CreateLoad( count, "remaining" );
+			builder.CreateCondBr( builder.CreateICmpSGT( remaining, llvm::ConstantInt::get( intType, 0 ) ), body, done );
+
+			// halving without a branch on the comparison
+			builder.SetInsertPoint( stack->Join( body ) );
+			llvm::Value* start = builder.CreateLoad( first, "start" );
+			llvm::Value* half = builder.CreateLShr( remaining, one, "half" );
+			llvm::Value* middle = builder.CreateAdd( start, half, "middle" );
+			llvm::Value* element = builder.CreateLoad( builder.CreateInBoundsGEP( data, middle ), "element" );
+			llvm::Value* isBefore = createOrder( llvm::CmpInst::ICMP_SLT, element, value, function, environment, node );
+			builder.CreateStore( builder.CreateSelect( isBefore, builder.CreateAdd( middle, one ), start ), first );
+			builder.CreateStore( builder.CreateSelect( isBefore, builder.CreateSub( builder.CreateSub( remaining, half ), one ), half ), count );
+			builder.CreateBr( loop );
+
+			builder.SetInsertPoint( stack->Join( done ) );
+			return( builder.CreateLoad( first, "position" ) );
+		}
+
+		// moves the elements the predicate holds for to the front, keeping their order, and returns how many there are
+		llvm::Value* Codegen::createPartition( llvm::Value* array, llvm::Value* function, llvm::Value* environment )
+		{
+			llvm::Type* intType = llvm::Type::getInt64Ty( module->getContext() );
+
+			llvm::Value* one = llvm::ConstantInt::get( intType, 1 );
+			llvm::Value* length = getArrayField( array, EXO_ARRAY_LENGTH, "length" );
+			llvm::Value* data = getArrayField( array, EXO_ARRAY_DATA, "data" );
+
+			llvm::AllocaInst* next = allocateLocal( intType, "next" );
+			llvm::AllocaInst* count = allocateLocal( intType, "count" );
+
+			llvm::Function* scope		= stack->Block()->getParent();
+			llvm::BasicBlock* loop		= llvm::BasicBlock::Create( module->getContext(), "partition", scope );
+			llvm::BasicBlock* body		= llvm::BasicBlock::Create( module->getContext(), "partition-body", scope );
+			llvm::BasicBlock* move		= llvm::BasicBlock::Create( module->getContext(), "partition-move", scope );
+			llvm::BasicBlock* advance	= llvm::BasicBlock::Create( module->getContext(), "partition-next", scope );
+			llvm::BasicBlock* done		= llvm::BasicBlock::Create( module->getContext(), "partition-done", scope );
+
+			builder.CreateStore( llvm::ConstantInt::get( intType, 0 ), next );
+			builder.CreateStore( llvm::ConstantInt::get( intType, 0 ), count );
+			builder.CreateBr( loop );
+
+			builder.SetInsertPoint( stack->Join( loop ) );
+			llvm::Value* index = builder.CreateLoad( next, "index" );
+			builder.CreateCondBr( builder.CreateICmpSLT( index, length ), body, done );
+
+			builder.SetInsertPoint( stack->Join( body ) );
+			llvm::Value* element = builder.CreateInBoundsGEP( data, index );
+			llvm::Value* value = builder.CreateLoad( element, "value" );
+			builder.CreateCondBr( builder.CreateCall( function, { environment, value }, "holds" ), move, advance );
+
+			builder.SetInsertPoint( stack->Join( move ) );
+			llvm::Value* matched = builder.CreateLoad( count, "matched" );
+			llvm::Value* slot = builder.CreateInBoundsGEP( data, matched );
+			builder.CreateStore( builder.CreateLoad( slot ), element );
+			builder.CreateStore( value, slot );
+			builder.CreateStore( builder.CreateAdd( matched, one ), count );
+			builder.CreateBr( advance );
+
+			builder.SetInsertPoint( stack->Join( advance ) );
+			builder.CreateStore( builder.CreateAdd( index, one ), next );
+			builder.CreateBr( loop );
+
+			builder.SetInsertPoint( stack->Join( done ) );
+			return( builder.CreateLoad( count, "count" ) );
+		}
+
+		// drops every element equal to the one kept before it, shrinking the array, and returns the new length
+		llvm::Value* Codegen::createUnique( llvm::Value* array, llvm::Value* function, llvm::Value* environment, exo::ast::Node& node )
+		{
+			llvm::Type* intType = llvm::Type::getInt64Ty( module->getContext() );
+
+			llvm::Value* zero = llvm::ConstantInt::get( intType, 0 );
+			llvm::Value* one = llvm::ConstantInt::get( intType, 1 );
+			llvm::Value* length = getArrayField( array, EXO_ARRAY_LENGTH, "length" );
+			llvm::Value* data = getArrayField( array, EXO_ARRAY_DATA, "data" );
+
+			llvm::AllocaInst* next = allocateLocal( intType, "next" );
+			llvm::AllocaInst* kept = allocateLocal( intType, "kept" );
+
+			llvm::Function* scope		= stack->Block()->getParent();
+			llvm::BasicBlock* loop		= llvm::BasicBlock::Create( module->getContext(), "unique", scope );
+			llvm::BasicBlock* body		= llvm::BasicBlock::Create( module->getContext(), "unique-body", scope );
+			llvm::BasicBlock* keep		= llvm::BasicBlock::Create( module->getContext(), "unique-keep", scope );
+			llvm::BasicBlock* advance	= llvm::BasicBlock::Create( module->getContext(), "unique-next", scope );
+			llvm::BasicBlock* done		= llvm::BasicBlock::Create( module->getContext(), "unique-done", scope );
+
+			// the first element is always kept
+			builder.CreateStore( one, next );
+			builder.CreateStore( builder.CreateSelect( builder.CreateICmpSGT( length, zero ), one, zero ), kept );
+			builder.CreateBr( loop );
+
+			builder.SetInsertPoint( stack->Join( loop ) );
+			llvm::Value* index = builder.CreateLoad( next, "index" );
+			builder.CreateCondBr( builder.CreateICmpSLT( index, length ), body, done );
+
+			builder.SetInsertPoint( stack->Join( body ) );
+			llvm::Value* count = builder.CreateLoad( kept, "count" );
+			llvm::Value* value = builder.CreateLoad( builder.CreateInBoundsGEP( data, index ), "value" );
+			llvm::Value* last = builder.CreateLoad( builder.CreateInBoundsGEP( data, builder.CreateSub( count, one ) ), "last" );
+			builder.CreateCondBr( createOrder( llvm::CmpInst::ICMP_EQ, last, value, function, environment, node ), advance, keep );
+
+			builder.SetInsertPoint( stack->Join( keep ) );
+			builder.CreateStore( value, builder.CreateInBoundsGEP( data, count ) );
+			builder.CreateStore( builder.CreateAdd( count, one ), kept );
+			builder.CreateBr( advance );
+
+			builder.SetInsertPoint( stack->Join( advance ) );
+			builder.CreateStore( builder.CreateAdd( index, one ), next );
+			builder.CreateBr( loop );
+
+			builder.SetInsertPoint( stack->Join( done ) );
+			llvm::Value* result = builder.CreateLoad( kept, "unique" );
+			setArrayField( array, EXO_ARRAY_LENGTH, result );
+
+			return( result );
+		}
+
+		/*
+		 * loads or stores a vector of elements at an offset, lanes of masked accesses past the end of the array are skipped
+		 */
+		llvm::Value* Codegen::invokeVectorAccess( llvm::Value* array, std::string methodName, std::vector<llvm::Value*> arguments, exo::ast::Node& node, bool inMem )
+		{
+			llvm::Type* intType = llvm::Type::getInt64Ty( module->getContext() );
+
+			llvm::Type* type = array->getType()->getPointerElementType();
+			bool isFixed = type->isArrayTy();
+			llvm::Type* elementType = isFixed ? type->getArrayElementType() : getArrayElementType( array->getType() );
+
+			if( !elementType->isIntegerTy() && !elementType->isFloatingPointTy() ) {
+				EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Array elements can not be vectorized" ), node );
+			}
+
+			llvm::Value* offset = convertValue( arguments.at( 0 ), intType );
+			if( offset->getType() != intType ) {
+				EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Parameter:1 type mismatch" ), node );
+			}
+
+			llvm::Value* value = methodName == "store" ? arguments.at( 1 ) : nullptr;
+			llvm::Value* mask = arguments.size() > ( methodName == "store" ? 2 : 1 ) ? arguments.back() : nullptr;
+
+			if( mask != nullptr && ( !mask->getType()->isVectorTy() || !mask->getType()->getVectorElementType()->isIntegerTy( 1 ) ) ) {
+				EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Parameter:" + std::to_string( arguments.size() ) + " expecting mask" ), node );
+			}
+
+			// the stored vector or the mask dictate the width, loads default to the native width
+			unsigned lanes = target->getVectorLanes( elementType );
+			if( value != nullptr && value->getType()->isVectorTy() ) {
+				lanes = value->getType()->getVectorNumElements();
+			} else if( mask != nullptr ) {
+				lanes = mask->getType()->getVectorNumElements();
+			}
+
+			if( mask != nullptr && mask->getType()->getVectorNumElements() != lanes ) {
+				EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Mask lanes mismatch" ), node );
+			}
+
+			llvm::VectorType* vectorType = llvm::VectorType::get( elementType, lanes );
+			if( value != nullptr ) {
+				value = convertValue( value, vectorType );
+				if( value->getType() != vectorType ) {
+					EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Parameter:2 type mismatch" ), node );
+				}
+			}
+
+			llvm::Value* length = isFixed ? llvm::ConstantInt::get( intType, type->getArrayNumElements() ) : getArrayField( array, EXO_ARRAY_LENGTH, "length" );
+			unsigned alignment = module->getDataLayout().getABITypeAlignment( elementType );
+			llvm::Value* result = nullptr;
+
+			if( mask == nullptr ) {
+				// the first and the last lane have to be in bounds
+				createBoundsCheck( offset, length, node );
+				createBoundsCheck( builder.CreateAdd( offset, llvm::ConstantInt::get( intType, lanes - 1 ) ), length, node );
+
+				llvm::Value* element = getArrayElement( array, offset, node, false );
+				llvm::Value* address = builder.CreateBitCast( element, vectorType->getPointerTo() );
+				llvm::Instruction* access;
+
+				if( methodName == "load" ) {
+					access = builder.CreateAlignedLoad( address, alignment, "load" );
+					result = access;
+				} else {
+					access = builder.CreateAlignedStore( value, address, alignment );
+				}
+
+				auto tag = accessTags.find( element );
+				if( tag != accessTags.end() ) {
+					access->setMetadata( llvm::LLVMContext::MD_tbaa, tag->second );
+				}
+			} else {
+				std::vector<llvm::Constant*> steps;
+				for( unsigned i = 0; i < lanes; i++ ) {
+					steps.push_back( llvm::ConstantInt::get( intType, i ) );
+				}
+
+				llvm::Value* indices = builder.CreateAdd( builder.CreateVectorSplat( lanes, offset ), llvm::ConstantVector::get( steps ), "indices" );
+				mask = builder.CreateAnd( mask, builder.CreateICmpULT( indices, builder.CreateVectorSplat( lanes, length ) ), "mask" );
+
+				// the offset may be out of bounds here, so no inbounds addressing
+				llvm::Value* element;
+				if( isFixed ) {
+					element = builder.CreateGEP( array, { llvm::ConstantInt::get( intType, 0 ), offset }, "element" );
+				} else {
+					element = builder.CreateGEP( getArrayField( array, EXO_ARRAY_DATA, "data" ), offset, "element" );
+				}
+				llvm::Value* address = builder.CreateBitCast( element, vectorType->getPointerTo() );
+
+				if( methodName == "load" ) {
+					result = builder.CreateMaskedLoad( address, alignment, mask, llvm::Constant::getNullValue( vectorType ), "load" );
+				} else {
+					builder.CreateMaskedStore( value, address, alignment, mask );
+				}
+			}
+
+			if( !inMem || result == nullptr ) {
+				return( result );
+			}
+
+			llvm::AllocaInst* memory = allocateLocal( result->getType() );
+			builder.CreateStore( result, memory );
+			return( memory );
+		}
+
+		llvm::Value* Codegen::invokeVectorMethod( llvm::Value* vector, std::string methodName, exo::ast::ExprList* expressions, exo::ast::Node& node, bool inMem )
+		{
+			llvm::Type* intType = llvm::Type::getInt64Ty( module->getContext() );
+			llvm::Type* type = vector->getType();
+			unsigned lanes = type->getVectorNumElements();
+			bool isMask = type->getVectorElementType()->isIntegerTy( 1 );
+			llvm::Value* result = nullptr;
+
+			EXO_CODEGEN_LOG( node, "Call vector method " << methodName );
+
+			generateInMem = false;
+
+			if( methodName == "shuffle" ) {
+				// lane indices have to be constant, a leading vector is the second source
+				llvm::Value* second = llvm::UndefValue::get( type );
+				unsigned sources = 1;
+				std::vector<llvm::Constant*> indices;
+
+				for( auto &expression : expressions->list ) {
+					exo::ast::ConstInt* index = dynamic_cast<exo::ast::ConstInt*>( expression.get() );
+
+					if( index == nullptr ) {
+						if( !indices.empty() || sources > 1 ) {
+							EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Expecting constant lane index" ), node );
+						}
+
+						expression->accept( this );
+						if( currentResult->getType() != type ) {
+							EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Parameter:1 type mismatch" ), node );
+						}
+
+						second = currentResult;
+						sources = 2;
+						continue;
+					}
+
+					if( index->value < 0 || index->value >= lanes * sources ) {
+						EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Lane index out of range" ), node );
+					}
+
+					indices.push_back( builder.getInt32( index->value ) );
+				}
+
+				if( indices.empty() ) {
+					EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Expected parameters mismatch" ), node );
+				}
+
+				result = builder.CreateShuffleVector( vector, second, llvm::ConstantVector::get( indices ), "shuffle" );
+			} else {
+				std::vector<llvm::Value*> arguments;
+				for( auto &expression : expressions->list ) {
+					expression->accept( this );
+					arguments.push_back( currentResult );
+				}
+
+				// reductions work on numbers, any/all/select on masks
+				std::map<std::string, size_t> signatures = { { "length", 0 }, { "sum", 0 }, { "min", 0 }, { "max", 0 }, { "any", 0 }, { "all", 0 }, { "select", 2 } };
+				auto signature = signatures.find( methodName );
+				bool isMaskMethod = methodName == "any" || methodName == "all" || methodName == "select";
+
+				if( signature == signatures.end() || ( methodName != "length" && isMask != isMaskMethod ) ) {
+					EXO_THROW_AT( InvalidMethod() << exo::exceptions::ClassName( toString( type ) ) << exo::exceptions::FunctionName( methodName ), node );
+				}
+				if( signature->second != arguments.size() ) {
+					EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Expected parameters mismatch" ), node );
+				}
+
+				if( methodName == "length" ) {
+					result = llvm::ConstantInt::get( intType, lanes );
+				} else if( methodName == "select" ) {
+					llvm::Value* lhs = arguments.at( 0 );
+					llvm::Value* rhs = arguments.at( 1 );
+
+					unifyTypes( lhs, rhs );
+					if( !lhs->getType()->isVectorTy() ) {
+						lhs = convertValue( lhs, llvm::VectorType::get( lhs->getType(), lanes ) );
+						rhs = convertValue( rhs, lhs->getType() );
+					}
+
+					if( lhs->getType() != rhs->getType() || lhs->getType()->getVectorNumElements() != lanes ) {
+						EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Parameter type mismatch" ), node );
+					}
+
+					result = builder.CreateSelect( vector, lhs, rhs, "select" );
+				} else {
+					result = createReduction( vector, methodName, node );
+				}
+			}
+
+			if( !inMem ) {
+				return( result );
+			}
+
+			llvm::AllocaInst* memory = allocateLocal( result->getType() );
+			builder.CreateStore( result, memory );
+			return( memory );
+		}
+
+		/*
+		 * horizontal reductions, power of two widths are folded in halves (log2 shuffles), others lane by lane
+		 */
+		llvm::Value* Codegen::createReduction( llvm::Value* vector, std::string operation, exo::ast::Node& node )
+		{
+			unsigned width = vector->getType()->getVectorNumElements();
+
+			if( ( width & ( width - 1 ) ) == 0 ) {
+				for( unsigned lanes = width / 2; lanes > 0; lanes /= 2 ) {
+					std::vector<llvm::Constant*> upper;
+					for( unsigned i = 0; i < width; i++ ) {
+						upper.push_back( i < lanes ? llvm::cast<llvm::Constant>( builder.getInt32( i + lanes ) ) : llvm::UndefValue::get( builder.getInt32Ty() ) );
+					}
+
+					vector = combineValues( operation, vector, builder.CreateShuffleVector( vector, llvm::UndefValue::get( vector->getType() ), llvm::ConstantVector::get( upper ) ), node );
+				}
+
+				return( builder.CreateExtractElement( vector, builder.getInt32( 0 ) ) );
+			}
+
+			llvm::Value* result = builder.CreateExtractElement( vector, builder.getInt32( 0 ) );
+			for( unsigned i = 1; i < width; i++ ) {
+				result = combineValues( operation, result, builder.CreateExtractElement( vector, builder.getInt32( i ) ), node );
+			}
+
+			return( result );
+		}
+
+		/*
+		 * the operations shared by vector and loop reductions, anything else names a function taking both values
+		 */
+		llvm::Value* Codegen::combineValues( std::string operation, llvm::Value* lhs, llvm::Value* rhs, exo::ast::Node& node )
+		{
+			if( operation == "sum" ) {
+				return( createArithmetic( llvm::Instruction::Add, lhs, rhs, node, "sum" ) );
+			} else if( operation == "min" ) {
+				return( builder.CreateSelect( createCompare( llvm::CmpInst::ICMP_SLT, lhs, rhs, node ), lhs, rhs, "min" ) );
+			} else if( operation == "max" ) {
+				return( builder.CreateSelect( createCompare( llvm::CmpInst::ICMP_SGT, lhs, rhs, node ), lhs, rhs, "max" ) );
+			} else if( operation == "any" ) {
+				return( builder.CreateOr( lhs, rhs, "any" ) );
+			} else if( operation == "all" ) {
+				return( builder.CreateAnd( lhs, rhs, "all" ) );
+			}
+
+			return( builder.CreateCall( getFunction( operation ), { lhs, rhs }, operation ) );
+		}
+
+		/*
+		 * operations on atomics lower to atomic instructions, the memory order is an optional trailing string and defaults
+		 * to sequentially consistent. compareExchange returns whether it succeeded along with the value it found
+		 */
+		llvm::Value* Codegen::invokeAtomicMethod( llvm::Value* atomic, std::string methodName, exo::ast::ExprList* expressions, exo::ast::Node& node, bool inMem )
+		{
+			llvm::Type* type = atomic->getType()->getPointerElementType();
+			llvm::Type* valueType = getAtomicValueType( type );
+			llvm::Type* storedType = type->getStructElementType( 0 );
+			unsigned alignment = module->getDataLayout().getTypeStoreSize( storedType );
+			llvm::Value* address = builder.CreateStructGEP( type, atomic, 0 );
+			llvm::Value* result = nullptr;
+
+			EXO_CODEGEN_LOG( node, "Call atomic method " << methodName );
+
+			// amount of values and maximum amount of parameters, the orderings follow the values
+			std::map<std::string, std::pair<size_t, size_t>> signatures = {
+				{ "load", { 0, 1 } }, { "store", { 1, 2 } }, { "exchange", { 1, 2 } }, { "compareExchange", { 2, 4 } },
+				{ "fetchAdd", { 1, 2 } }, { "fetchSub", { 1, 2 } }, { "fetchAnd", { 1, 2 } }, { "fetchOr", { 1, 2 } }, { "fetchXor", { 1, 2 } }
+			};
+			auto signature = signatures.find( methodName );
+			if( signature == signatures.end() ) {
+				EXO_THROW_AT( InvalidMethod() << exo::exceptions::ClassName( std::string( type->getStructName() ) ) << exo::exceptions::FunctionName( methodName ), node );
+			}
+			if( expressions->list.size() < signature->second.first || expressions->list.size() > signature->second.second ) {
+				EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Expected parameters mismatch" ), node );
+			}
+
+			std::vector<llvm::Value*> arguments;
+			generateInMem = false;
+			for( size_t i = 0; i < signature->second.first; i++ ) {
+				expressions->list.at( i )->accept( this );
+				llvm::Value* argument = convertValue( currentResult, type );
+				if( argument->getType() != type ) {
+					EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Parameter:" + std::to_string( i + 1 ) + " type mismatch" ), node );
+				}
+
+				arguments.push_back( builder.CreateExtractValue( argument, 0 ) );
+			}
+
+			llvm::AtomicOrdering ordering = getOrdering( expressions, signature->second.first, llvm::AtomicOrdering::SequentiallyConsistent, node );
+
+			if( methodName == "load" ) {
+				if( ordering == llvm::AtomicOrdering::Release || ordering == llvm::AtomicOrdering::AcquireRelease ) {
+					EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Invalid memory order for a load" ), node );
+				}
+
+				llvm::LoadInst* load = builder.CreateLoad( address, "load" );
+				load->setAtomic( ordering );
+				load->setAlignment( alignment );
+				result = convertValue( load, valueType );
+			} else if( methodName == "store" ) {
+				if( ordering == llvm::AtomicOrdering::Acquire || ordering == llvm::AtomicOrdering::AcquireRelease ) {
+					EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Invalid memory order for a store" ), node );
+				}
+
+				llvm::StoreInst* store = builder.CreateStore( arguments.at( 0 ), address );
+				store->setAtomic( ordering );
+				store->setAlignment( alignment );
+			} else if( methodName == "compareExchange" ) {
+				llvm::AtomicOrdering failure = getOrdering( expressions, 3, llvm::AtomicCmpXchgInst::getStrongestFailureOrdering( ordering ), node );
+				if( failure == llvm::AtomicOrdering::Release || failure == llvm::AtomicOrdering::AcquireRelease || llvm::isStrongerThan( failure, ordering ) ) {
+					EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Invalid memory order for a failed compareExchange" ), node );
+				}
+
+				llvm::Value* exchange = builder.CreateAtomicCmpXchg( address, arguments.at( 0 ), arguments.at( 1 ), ordering, failure );
+
+				llvm::Type* tupleType = llvm::StructType::get( module->getContext(), { llvm::Type::getInt1Ty( module->getContext() ), valueType } );
+				result = builder.CreateInsertValue( llvm::UndefValue::get( tupleType ), builder.CreateExtractValue( exchange, 1, "success" ), 0 );
+				result = builder.CreateInsertValue( result, convertValue( builder.CreateExtractValue( exchange, 0, "found" ), valueType ), 1 );
+			} else {
+				std::map<std::string, llvm::AtomicRMWInst::BinOp> operations = {
+					{ "exchange", llvm::AtomicRMWInst::Xchg }, { "fetchAdd", llvm::AtomicRMWInst::Add }, { "fetchSub", llvm::AtomicRMWInst::Sub },
+					{ "fetchAnd", llvm::AtomicRMWInst::And }, { "fetchOr", llvm::AtomicRMWInst::Or }, { "fetchXor", llvm::AtomicRMWInst::Xor }
+				};
+
+				if( methodName != "exchange" && ( !valueType->isIntegerTy() || ( valueType->isIntegerTy( 1 ) && ( methodName == "fetchAdd" || methodName == "fetchSub" ) ) ) ) {
+					EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Invalid atomic type for " + methodName ), node );
+				}
+
+				// read-modify-write instructions only take integers
+				llvm::Value* value = arguments.at( 0 );
+				if( storedType->isPointerTy() ) {
+					llvm::Type* intType = module->getDataLayout().getIntPtrType( module->getContext() );
+					address = builder.CreateBitCast( address, intType->getPointerTo() );
+					value = builder.CreatePtrToInt( value, intType );
+				}
+
+				result = builder.CreateAtomicRMW( operations.at( methodName ), address, value, ordering );
+				if( storedType->isPointerTy() ) {
+					result = builder.CreateIntToPtr( result, storedType );
+				}
+				result = convertValue( result, valueType );
+			}
+
+			if( !inMem || result == nullptr ) {
+				return( result );
+			}
+
+			llvm::AllocaInst* memory = allocateLocal( result->getType() );
+			builder.CreateStore( result, memory );
+			return( memory );
+		}
+
+		llvm::AtomicOrdering Codegen::getOrdering( exo::ast::ExprList* expressions, size_t position, llvm::AtomicOrdering ordering, exo::ast::Node& node )
+		{
+			if( expressions->list.size() <= position ) {
+				return( ordering );
+			}
+
+			std::map<std::string, llvm::AtomicOrdering> orderings = {
+				{ "relaxed", llvm::AtomicOrdering::Monotonic }, { "acquire", llvm::AtomicOrdering::Acquire }, { "release", llvm::AtomicOrdering::Release },
+				{ "acq_rel", llvm::AtomicOrdering::AcquireRelease }, { "seq_cst", llvm::AtomicOrdering::SequentiallyConsistent }
+			};
+
+			exo::ast::ConstStr* name = dynamic_cast<exo::ast::ConstStr*>( expressions->list.at( position ).get() );
+			if( name == nullptr || orderings.count( name->value ) == 0 ) {
+				EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Expecting memory order: relaxed, acquire, release, acq_rel or seq_cst" ), node );
+			}
+
+			return( orderings.at( name->value ) );
+		}
+
+		/*
+		 * strings never change, so their lengths may be loaded once for a whole loop. strings default to null, which has no
+		 * header and a length of 0
+		 */
+		llvm::Value* Codegen::invokeStringMethod( llvm::Value* string, std::string methodName, exo::ast::ExprList* expressions, exo::ast::Node& node, bool inMem )
+		{
+			llvm::Type* ptrType = llvm::Type::getInt8PtrTy( module->getContext() );
+			llvm::Value* result = nullptr;
+
+			EXO_CODEGEN_LOG( node, "Call string method " << methodName );
+
+			if( methodName != "length" && methodName != "intern" ) {
+				EXO_THROW_AT( InvalidMethod() << exo::exceptions::ClassName( "string" ) << exo::exceptions::FunctionName( methodName ), node );
+			}
+			if( !expressions->list.empty() ) {
+				EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Expected parameters mismatch" ), node );
+			}
+
+			if( methodName == "length" ) {
+				llvm::Type* intType = llvm::Type::getInt64Ty( module->getContext() );
+
+				llvm::Function* scope		= stack->Block()->getParent();
+				llvm::BasicBlock* current	= stack->Block();
+				llvm::BasicBlock* header	= llvm::BasicBlock::Create( module->getContext(), "length-header", scope );
+				llvm::BasicBlock* done		= llvm::BasicBlock::Create( module->getContext(), "length-done", scope );
+
+				builder.CreateCondBr( builder.CreateIsNotNull( string ), header, done );
+
+				builder.SetInsertPoint( header );
+				llvm::LoadInst* length = builder.CreateLoad( builder.CreateStructGEP( getStringType(), getStringHeader( string ), EXO_STRING_LENGTH ), "length" );
+				length->setMetadata( llvm::LLVMContext::MD_invariant_load, llvm::MDNode::get( module->getContext(), {} ) );
+				builder.CreateBr( done );
+
+				builder.SetInsertPoint( stack->Join( done ) );
+				llvm::PHINode* phi = builder.CreatePHI( intType, 2, "length" );
+				phi->addIncoming( llvm::ConstantInt::get( intType, 0 ), current );
+				phi->addIncoming( length, header );
+				result = phi;
+			} else if( methodName == "intern" ) {
+				result = builder.CreateCall( getRuntimeFun( "exo_string_intern", ptrType, { ptrType } ), { string }, "interned" );
+			}
+
+			if( !inMem ) {
+				return( result );
+			}
+
+			llvm::AllocaInst* memory = allocateLocal( result->getType() );
+			builder.CreateStore( result, memory );
+			return( memory );
+		}
+
+		/*
+		 * swiss table lookup, the 7 bit tag of the hash is compared with a group of sixteen control bytes at once. only slots
+		 * with a matching tag compare their key, and a group with an empty slot ends the probe sequence. the slot holding the
+		 * key or null
+		 */
+		llvm::Value* Codegen::findSlot( llvm::Value* map, llvm::Value* key, llvm::Value* hash )
+		{
+			llvm::IntegerType* intType = llvm::Type::getInt64Ty( module->getContext() );
+			llvm::IntegerType* byteType = llvm::Type::getInt8Ty( module->getContext() );
+			llvm::IntegerType* maskType = llvm::Type::getIntNTy( module->getContext(), EXO_MAP_GROUP );
+			llvm::Type* boolType = llvm::Type::getInt1Ty( module->getContext() );
+			llvm::Type* ptrType = llvm::Type::getInt8PtrTy( module->getContext() );
+			llvm::Type* groupType = llvm::VectorType::get( byteType, EXO_MAP_GROUP );
+
+			llvm::StructType* type = llvm::cast<llvm::StructType>( map->getType()->getPointerElementType() );
+			llvm::PointerType* slotsType = llvm::cast<llvm::PointerType>( type->getElementType( EXO_MAP_SLOTS ) );
+
+			llvm::Value* control = createLoad( builder.CreateStructGEP( type, map, EXO_MAP_CONTROL ), "control" );
+			llvm::Value* slots = createLoad( builder.CreateStructGEP( type, map, EXO_MAP_SLOTS ), "slots" );
+			llvm::Value* mask = createLoad( builder.CreateStructGEP( type, map, EXO_MAP_MASK ), "mask" );
+			llvm::Value* tag = builder.CreateVectorSplat( EXO_MAP_GROUP, builder.CreateTrunc( builder.CreateAnd( hash, 0x7F ), byteType ), "tag" );
+			llvm::Value* emptyTag = llvm::ConstantVector::getSplat( EXO_MAP_GROUP, llvm::ConstantInt::get( byteType, EXO_MAP_EMPTY, true ) );
+			llvm::Value* start = builder.CreateAnd( builder.CreateLShr( hash, 7 ), mask, "start" );
+
+			llvm::Function* scope		= stack->Block()->getParent();
+			llvm::BasicBlock* entry		= builder.GetInsertBlock();
+			llvm::BasicBlock* probe		= llvm::BasicBlock::Create( module->getContext(), "map-probe", scope );
+			llvm::BasicBlock* match		= llvm::BasicBlock::Create( module->getContext(), "map-match", scope );
+			llvm::BasicBlock* compare	= llvm::BasicBlock::Create( module->getContext(), "map-compare", scope );
+			llvm::BasicBlock* next		= llvm::BasicBlock::Create( module->getContext(), "map-next", scope );
+			llvm::BasicBlock* end		= llvm::BasicBlock::Create( module->getContext(), "map-end", scope );
+			llvm::BasicBlock* found		= llvm::BasicBlock::Create( module->getContext(), "map-found", scope );
+
+			probe->moveAfter( entry );
+			match->moveAfter( probe );
+			compare->moveAfter( match );
+			next->moveAfter( compare );
+			end->moveAfter( next );
+			found->moveAfter( end );
+
+			builder.CreateBr( probe );
+
+			// groups are probed at triangular offsets, which visits each of them once as there is a power of two
+			builder.SetInsertPoint( probe );
+			llvm::PHINode* position = builder.CreatePHI( intType, 2, "position" );
+			llvm::PHINode* stride = builder.CreatePHI( intType, 2, "stride" );
+			position->addIncoming( start, entry );
+			stride->addIncoming( llvm::ConstantInt::get( intType, 0 ), entry );
+
+			llvm::Value* group = builder.CreateAlignedLoad( builder.CreateBitCast( builder.CreateGEP( control, position ), groupType->getPointerTo() ), 1, "group" );
+			llvm::Value* matches = builder.CreateBitCast( builder.CreateICmpEQ( group, tag ), maskType, "matches" );
+			builder.CreateBr( match );
+
+			builder.SetInsertPoint( match );
+			llvm::PHINode* candidates = builder.CreatePHI( maskType, 2, "candidates" );
+			candidates->addIncoming( matches, probe );
+			builder.CreateCondBr( builder.CreateICmpEQ( candidates, llvm::ConstantInt::get( maskType, 0 ) ), end, compare );
+
+			builder.SetInsertPoint( compare );
+			llvm::Function* cttz = llvm::Intrinsic::getDeclaration( module.get(), llvm::Intrinsic::cttz, { maskType } );
+			llvm::Value* offset = builder.CreateZExt( builder.CreateCall( cttz, { candidates, builder.getTrue() } ), intType );
+			llvm::Value* slot = builder.CreateGEP( slots, builder.CreateAnd( builder.CreateAdd( position, offset ), mask ), "slot" );
+			llvm::Value* stored = createLoad( builder.CreateStructGEP( slotsType->getElementType(), slot, 0 ), "key" );
+
+			// strings are equal if they are the same, only otherwise their contents are compared. floats by their bits
+			std::vector<llvm::BasicBlock*> matched;
+			if( isString( key->getType() ) ) {
+				llvm::BasicBlock* contents = llvm::BasicBlock::Create( module->getContext(), "map-compare-string", scope );
+				contents->moveAfter( compare );
+
+				builder.CreateCondBr( builder.CreateICmpEQ( stored, key ), found, contents );
+				matched.push_back( compare );
+
+				builder.SetInsertPoint( contents );
+				llvm::Value* equal = builder.CreateCall( getRuntimeFun( "exo_string_equals", boolType, { ptrType, ptrType } ), { stored, key } );
+				builder.CreateCondBr( equal, found, next );
+				matched.push_back( contents );
+			} else {
+				if( key->getType()->isFloatingPointTy() ) {
+					stored = builder.CreateBitCast( stored, intType );
+					key = builder.CreateBitCast( key, intType );
+				}
+
+				builder.CreateCondBr( builder.CreateICmpEQ( stored, key ), found, next );
+				matched.push_back( compare );
+			}
+
+			builder.SetInsertPoint( next );
+			candidates->addIncoming( builder.CreateAnd( candidates, builder.CreateSub( candidates, llvm::ConstantInt::get( maskType, 1 ) ) ), next );
+			builder.CreateBr( match );
+
+			// tables always keep empty slots, so this ends
+			builder.SetInsertPoint( end );
+			llvm::Value* empties = builder.CreateBitCast( builder.CreateICmpEQ( group, emptyTag ), maskType, "empties" );
+			llvm::Value* nextStride = builder.CreateAdd( stride, llvm::ConstantInt::get( intType, EXO_MAP_GROUP ), "stride" );
+			position->addIncoming( builder.CreateAnd( builder.CreateAdd( position, nextStride ), mask ), end );
+			stride->addIncoming( nextStride, end );
+			builder.CreateCondBr( builder.CreateICmpNE( empties, llvm::ConstantInt::get( maskType, 0 ) ), found, probe );
+
+			builder.SetInsertPoint( stack->Join( found ) );
+			llvm::PHINode* result = builder.CreatePHI( slotsType, matched.size() + 1, "found" );
+			for( auto block : matched ) {
+				result->addIncoming( slot, block );
+			}
+			result->addIncoming( llvm::ConstantPointerNull::get( slotsType ), end );
+
+			return( result );
+		}
+
+		/*
+		 * lookups and inserting new keys are inlined, growing, erasing and copying out the keys or values is left to the
+		 * runtime. see exo/runtime/hash.cpp
+		 */
+		llvm::Value* Codegen::invokeMapMethod( llvm::Value* map, std::string methodName, exo::ast::ExprList* expressions, exo::ast::Node& node, bool inMem )
+		{
+			llvm::Type* intType = llvm::Type::getInt64Ty( module->getContext() );
+			llvm::Type* boolType = llvm::Type::getInt1Ty( module->getContext() );
+			llvm::Type* voidType = llvm::Type::getVoidTy( module->getContext() );
+			llvm::Type* ptrType = llvm::Type::getInt8PtrTy( module->getContext() );
+
+			llvm::StructType* type = llvm::cast<llvm::StructType>( map->getType()->getPointerElementType() );
+			llvm::PointerType* slotsType = llvm::cast<llvm::PointerType>( type->getElementType( EXO_MAP_SLOTS ) );
+			llvm::StructType* slotType = llvm::cast<llvm::StructType>( slotsType->getElementType() );
+			bool isSet = type->getName().startswith( "__set<" );
+
+			EXO_CODEGEN_LOG( node, "Call " << ( isSet ? "set" : "map" ) << " method " << methodName );
+
+			// minimum and maximum amount of parameters, the key comes first. get takes a default for missing keys
+			std::map<std::string, std::pair<size_t, size_t>> signatures = {
+				{ "has", { 1, 1 } }, { "remove", { 1, 1 } }, { "size", { 0, 0 } }, { "clear", { 0, 0 } }, { "keys", { 0, 0 } }
+			};
+			if( isSet ) {
+				signatures.insert( { "add", { 1, 1 } } );
+			} else {
+				signatures.insert( { { "get", { 1, 2 } }, { "put", { 2, 2 } }, { "values", { 0, 0 } } } );
+			}
+
+			auto signature = signatures.find( methodName );
+			if( signature == signatures.end() ) {
+				EXO_THROW_AT( InvalidMethod() << exo::exceptions::ClassName( std::string( type->getName() ) ) << exo::exceptions::FunctionName( methodName ), node );
+			}
+			if( expressions->list.size() < signature->second.first || expressions->list.size() > signature->second.second ) {
+				EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Expected parameters mismatch" ), node );
+			}
+
+			std::vector<llvm::Value*> arguments;
+			generateInMem = false;
+			for( size_t i = 0; i < expressions->list.size(); i++ ) {
+				llvm::Type* argumentType = slotType->getElementType( i == 0 ? 0 : 1 );
+
+				expressions->list.at( i )->accept( this );
+				arguments.push_back( convertValue( currentResult, argumentType ) );
+				if( arguments.back()->getType() != argumentType ) {
+					EXO_THROW_AT( InvalidCall() << exo::exceptions::Message( "Parameter:" + std::to_string( i + 1 ) + " type mismatch" ), node );
+				}
+			}
+
+			llvm::Function* scope = stack->Block()->getParent();
+			llvm::Value* null = llvm::ConstantPointerNull::get( slotsType );
+			llvm::Value* result = nullptr;
+			llvm::Value* hash = nullptr;
+			llvm::Value* slot = nullptr;
+
+			if( !arguments.empty() ) {
+				hash = createHash( arguments.at( 0 ), createLoad( builder.CreateStructGEP( type, map, EXO_MAP_SEED ), "seed" ) );
+				slot = findSlot( map, arguments.at( 0 ), hash );
+			}
+
+			if( methodName == "size" ) {
+				result = createLoad( builder.CreateStructGEP( type, map, EXO_MAP_SIZE ), "size" );
+			} else if( methodName == "has" ) {
+				result = builder.CreateICmpNE( slot, null, "has" );
+			} else if( methodName == "get" ) {
+				llvm::BasicBlock* lookup	= builder.GetInsertBlock();
+				llvm::BasicBlock* hit		= llvm::BasicBlock::Create( module->getContext(), "map-hit", scope );
+				llvm::BasicBlock* miss		= llvm::BasicBlock::Create( module->getContext(), "map-miss", scope );
+				llvm::BasicBlock* done		= llvm::BasicBlock::Create( module->getContext(), "map-get", scope );
+
+				hit->moveAfter( lookup );
+				miss->moveAfter( hit );
+				done->moveAfter( miss );
+
+				builder.CreateCondBr( builder.CreateICmpNE( slot, null ), hit, miss );
+
+				builder.SetInsertPoint( hit );
+				llvm::Value* value = createLoad( builder.CreateStructGEP( slotType, slot, 1 ), "value" );
+				builder.CreateBr( done );
+
+				builder.SetInsertPoint( miss );
+				llvm::Value* fallback = arguments.size() > 1 ? arguments.at( 1 ) : createDefault( slotType->getElementType( 1 ) );
+				miss = builder.GetInsertBlock();
+				builder.CreateBr( done );
+
+				builder.SetInsertPoint( stack->Join( done ) );
+				llvm::PHINode* phi = builder.CreatePHI( value->getType(), 2, "get" );
+				phi->addIncoming( value, hit );
+				phi->addIncoming( fallback, miss );
+				result = phi;
+			} else if( methodName == "put" || methodName == "add" ) {
+				llvm::BasicBlock* lookup	= builder.GetInsertBlock();
+				llvm::BasicBlock* insert	= llvm::BasicBlock::Create( module->getContext(), "map-insert", scope );
+				llvm::BasicBlock* done		= llvm::BasicBlock::Create( module->getContext(), "map-put", scope );
+
+				insert->moveAfter( lookup );
+				done->moveAfter( insert );
+
+				builder.CreateCondBr( builder.CreateICmpEQ( slot, null ), insert, done );
+
+				// the runtime grows the table if needed and marks the slot as taken, its key is up to us
+				builder.SetInsertPoint( insert );
+				llvm::Value* inserted = builder.CreateBitCast(
+					builder.CreateCall( getRuntimeFun( "exo_hash_insert", ptrType, { ptrType, intType } ), { builder.CreateBitCast( map, ptrType ), hash } ),
+					slotsType
+				);
+				createStore( arguments.at( 0 ), builder.CreateStructGEP( slotType, inserted, 0 ) );
+				builder.CreateBr( done );
+
+				builder.SetInsertPoint( stack->Join( done ) );
+				llvm::PHINode* target = builder.CreatePHI( slotsType, 2, "slot" );
+				target->addIncoming( slot, lookup );
+				target->addIncoming( inserted, insert );
+
+				if( isSet ) {
+					llvm::PHINode* added = builder.CreatePHI( boolType, 2, "added" );
+					added->addIncoming( builder.getFalse(), lookup );
+					added->addIncoming( builder.getTrue(), insert );
+					result = added;
+				} else {
+					createStore( promoteCallable( arguments.at( 1 ) ), builder.CreateStructGEP( slotType, target, 1 ) );
+				}
+			} else if( methodName == "remove" ) {
+				llvm::BasicBlock* lookup	= builder.GetInsertBlock();
+				llvm::BasicBlock* erase		= llvm::BasicBlock::Create( module->getContext(), "map-erase", scope );
+				llvm::BasicBlock* done		= llvm::BasicBlock::Create( module->getContext(), "map-remove", scope );
+
+				erase->moveAfter( lookup );
+				done->moveAfter( erase );
+
+				builder.CreateCondBr( builder.CreateICmpNE( slot, null ), erase, done );
+
+				builder.SetInsertPoint( erase );
+				builder.CreateCall(
+					getRuntimeFun( "exo_hash_erase", voidType, { ptrType, ptrType } ),
+					{ builder.CreateBitCast( map, ptrType ), builder.CreateBitCast( slot, ptrType ) }
+				);
+				builder.CreateBr( done );
+
+				builder.SetInsertPoint( stack->Join( done ) );
+				llvm::PHINode* removed = builder.CreatePHI( boolType, 2, "removed" );
+				removed->addIncoming( builder.getFalse(), lookup );
+				removed->addIncoming( builder.getTrue(), erase );
+				result = removed;
+			} else if( methodName == "clear" ) {
+				builder.CreateCall( getRuntimeFun( "exo_hash_clear", voidType, { ptrType } ), { builder.CreateBitCast( map, ptrType ) } );
+			} else if( methodName == "keys" || methodName == "values" ) {
+				unsigned field = methodName == "keys" ? 0 : 1;
+				llvm::Type* elementType = slotType->getElementType( field );
+
+				llvm::Value* array = builder.CreateCall(
+					getRuntimeFun( "exo_hash_collect", ptrType, { ptrType, intType, intType, intType } ),
+					{
+						builder.CreateBitCast( map, ptrType ),
+						llvm::ConstantInt::get( intType, module->getDataLayout().getStructLayout( slotType )->getElementOffset( field ) ),
+						llvm::ConstantInt::get( intType, module->getDataLayout().getTypeAllocSize( elementType ) ),
+						llvm::ConstantInt::get( intType, !containsPointers( elementType ) )
+					}
+				);
+				result = builder.CreateBitCast( array, getArrayType( elementType )->getPointerTo(), methodName );
+			}
+
+			if( !inMem || result == nullptr ) {
+				return( result );
+			}
+
+			llvm::AllocaInst* memory = allocateLocal( result->getType() );
+			builder.CreateStore( result, memory );
+			return( memory );
+		}
+
 		int Codegen::getPropPos( std::string className, std::string propName )
 		{
 			int position;
@@ -19,12 +19,25 @@
 #include "exo/exo.h"
 #include "exo/jit/llvm.h"
 #include "exo/jit/stack.h"
+#include "exo/jit/analysis.h"
 #include "exo/ast/nodes.h"
 
 namespace exo
 {
 	namespace jit
 	{
+		/**
+		 * a generator inlined into a for in loop. a yield assigns the loop variable, stores where to resume and runs the loop body
+		 */
+		struct InlinedGenerator
+		{
+			llvm::AllocaInst*				variable;
+			llvm::AllocaInst*				state;
+			llvm::BasicBlock*				body;
+			llvm::BasicBlock*				exit;
+			std::vector<llvm::BasicBlock*>	resumes;
+		};
+
 		class Codegen : public virtual exo::ast::Visitor
 		{
 			private:
@@ -60,6 +73,66 @@ namespace exo
 				 */
 				bool													generateInMem = false;
 
+				/**
+				 * counted for loops we are currently generating, used to elide array bounds checks
+				 */
+				std::vector<CountedLoop*>								countedLoops;
+
+				/**
+				 * closures that outlive the function creating them, their environment is allocated on the heap
+				 */
+				std::set<exo::ast::ExprClosure*>						escapingClosures;
+
+				/**
+				 * frame of the async function we are currently generating, and the blocks continuing after each of its awaits
+				 */
+				llvm::Value*											asyncFrame = nullptr;
+				std::vector<llvm::BasicBlock*>							asyncResumes;
+
+				/**
+				 * set right before generating an await that may suspend, i.e. as a statement or initializer
+				 */
+				bool													isSuspendable = false;
+
+				/**
+				 * generator functions by name, the one currently inlined and all those it is inlined into. used modules are kept, their
+				 * generators may be iterated later on
+				 */
+				std::unordered_map<std::string, exo::ast::DeclFun*>		generators;
+				InlinedGenerator*										generator = nullptr;
+				std::set<std::string>									inlinedGenerators;
+				std::vector<std::unique_ptr<exo::ast::Tree>>			modules;
+
+				/**
+				 * type based alias analysis tags, and the addresses that should be accessed with them
+				 */
+				llvm::MDNode*											tbaaRoot = nullptr;
+				std::unordered_map<std::string, llvm::MDNode*>			tbaaTags;
+				std::unordered_map<llvm::Value*, llvm::MDNode*>			accessTags;
+
+				/**
+				 * file name constants for runtime diagnostics
+				 */
+				std::unordered_map<std::string, llvm::Value*>			fileNames;
+
+				/**
+				 * string constants, equal ones share their header and characters
+				 */
+				std::unordered_map<std::string, llvm::Constant*>		strings;
+
+				/**
+				 * initial values of thread locals by name, the runtime copies them into the storage it keeps for each thread
+				 */
+				std::unordered_map<std::string, llvm::GlobalVariable*>	threadLocals;
+
+				/**
+				 * += statements appending to strings in place, the variables they append to and the one currently written,
+				 * which does not need to be finished
+				 */
+				std::set<exo::ast::OpBinaryAssignAdd*>					stringAppends;
+				std::set<std::string>									appendedStrings;
+				exo::ast::Expr*											overwritten = nullptr;
+
 			public:
 				std::unique_ptr<llvm::Module>	module;
 				llvm::IRBuilder<>				builder; // this needs to be defined after module due to how initializer list is used
@@ -72,9 +145,92 @@ namespace exo
 				std::string		toString( llvm::Value* value );
 				std::string		toString( llvm::Type* type );
 
-				llvm::Function* registerExternFun( std::string name, llvm::Type* retType, std::vector<llvm::Type*> fArgs );
+				llvm::Function* registerExternFun( std::string name, llvm::Type* retType, std::vector<llvm::Type*> fArgs, bool isVarArg = false );
+				llvm::Function* getRuntimeFun( std::string name, llvm::Type* retType, std::vector<llvm::Type*> fArgs, bool isVarArg = false );
+				bool			isRuntimeFun( std::string name );
+				llvm::Value*	getFileName();
+
+				llvm::AllocaInst*	allocateLocal( llvm::Type* type, std::string name = "" );
+				llvm::Value*		convertValue( llvm::Value* value, llvm::Type* type );
+				void				unifyTypes( llvm::Value*& lhs, llvm::Value*& rhs );
+				bool				isUnsigned( llvm::Type* type );
+				llvm::Value*		createArithmetic( llvm::Instruction::BinaryOps op, llvm::Value* lhs, llvm::Value* rhs, exo::ast::Node& node, std::string name );
+				llvm::Value*		createCompare( llvm::CmpInst::Predicate predicate, llvm::Value* lhs, llvm::Value* rhs, exo::ast::Node& node );
+				bool				containsPointers( llvm::Type* type );
+				llvm::MDNode*		getTBAA( std::string name );
+				llvm::Value*		createLoad( llvm::Value* address, std::string name = "" );
+				llvm::Value*		getAddress( llvm::Value* value );
+				llvm::Value*		createStore( llvm::Value* value, llvm::Value* address );
+
+				llvm::StructType*		getStringType();
+				bool					isString( llvm::Type* type );
+				llvm::Value*			getStringHeader( llvm::Value* string );
+				llvm::Constant*			createString( std::string value );
+				std::vector<llvm::Value*>	getStringParts( std::vector<llvm::Value*> strings );
+				llvm::Value*			createConcat( std::vector<llvm::Value*> strings );
+				llvm::Value*			createAppend( llvm::Value* string, llvm::Value* suffix );
+				bool					isAppended( std::string name, llvm::Value* variable );
+				llvm::Value*			finishString( llvm::Value* variable );
+				bool					isStruct( llvm::Type* type );
+				bool					isTuple( llvm::Type* type );
+				llvm::StructType*		getCallableType( llvm::FunctionType* type );
+				bool					isCallable( llvm::Type* type );
+				llvm::Value*			promoteCallable( llvm::Value* value );
+				llvm::StructType*		getTaskType( llvm::Type* resultType );
+				bool					isTask( llvm::Type* type );
+				llvm::StructType*		getFutureType( llvm::Type* resultType );
+				bool					isFuture( llvm::Type* type );
+				llvm::StructType*		getAtomicType( llvm::Type* valueType );
+				llvm::Type*				getAtomicValueType( llvm::Type* type );
+				bool					isAtomic( llvm::Type* type );
+				llvm::Value*			getTupleElement( llvm::Value* tuple, exo::ast::ExprIndex& expr, bool inMem );
+				llvm::Value*			createDefault( llvm::Type* type );
+				llvm::Value*			constructStruct( llvm::StructType* type, exo::ast::ExprList* expressions, exo::ast::Node& node, bool inMem );
+				bool					isStructABI( llvm::Type* type );
+				std::vector<llvm::Type*>	classifyStruct( llvm::Type* type );
+				llvm::Function*			createABIWrapper( llvm::FunctionType* type, std::string name );
+
+				llvm::StructType*	getArrayType( llvm::Type* elementType );
+				llvm::Type*			getArrayElementType( llvm::Type* type );
+				bool				isArray( llvm::Type* type );
+				uint64_t			getFixedLength( llvm::Type* type );
+				llvm::Value*		getArrayAddress( llvm::Value* value, exo::ast::Node& node );
+				llvm::Value*		getArrayField( llvm::Value* array, int field, std::string name );
+				void				setArrayField( llvm::Value* array, int field, llvm::Value* value );
+				llvm::Value*		getArrayElement( llvm::Value* array, llvm::Value* index, exo::ast::Node& node, bool isChecked );
+				void				createBoundsCheck( llvm::Value* index, llvm::Value* length, exo::ast::Node& node );
+				bool				isInBounds( exo::ast::ExprIndex& expr, llvm::Type* type );
+				bool				isLengthStable( CountedLoop& loop );
+				llvm::Value*		invokeArrayMethod( llvm::Value* array, std::string methodName, exo::ast::ExprList* expressions, exo::ast::Node& node, bool inMem );
+				llvm::Value*		invokeArrayAlgorithm( llvm::Value* array, std::string methodName, std::vector<llvm::Value*> arguments, exo::ast::Node& node, bool inMem );
+				llvm::Value*		createOrder( llvm::CmpInst::Predicate predicate, llvm::Value* lhs, llvm::Value* rhs, llvm::Value* function, llvm::Value* environment, exo::ast::Node& node );
+				void				createMergeSort( llvm::Value* array, llvm::Value* function, llvm::Value* environment, exo::ast::Node& node );
+				void				createSelect( llvm::Value* array, llvm::Value* nth, llvm::Value* function, llvm::Value* environment, exo::ast::Node& node );
+				llvm::Value*		createLowerBound( llvm::Value* array, llvm::Value* value, llvm::Value* function, llvm::Value* environment, exo::ast::Node& node );
+				llvm::Value*		createPartition( llvm::Value* array, llvm::Value* function, llvm::Value* environment );
+				llvm::Value*		createUnique( llvm::Value* array, llvm::Value* function, llvm::Value* environment, exo::ast::Node& node );
+				llvm::Value*		invokeVectorAccess( llvm::Value* array, std::string methodName, std::vector<llvm::Value*> arguments, exo::ast::Node& node, bool inMem );
+				llvm::Value*		invokeVectorMethod( llvm::Value* vector, std::string methodName, exo::ast::ExprList* expressions, exo::ast::Node& node, bool inMem );
+				llvm::Value*		createReduction( llvm::Value* vector, std::string operation, exo::ast::Node& node );
+				llvm::Value*		combineValues( std::string operation, llvm::Value* lhs, llvm::Value* rhs, exo::ast::Node& node );
+				llvm::Value*		invokeAtomicMethod( llvm::Value* atomic, std::string methodName, exo::ast::ExprList* expressions, exo::ast::Node& node, bool inMem );
+				llvm::AtomicOrdering	getOrdering( exo::ast::ExprList* expressions, size_t position, llvm::AtomicOrdering ordering, exo::ast::Node& node );
+				llvm::Value*		invokePrintf( llvm::Function* function, exo::ast::ExprCallFun& call, bool inMem );
+				llvm::Value*		invokeStringMethod( llvm::Value* string, std::string methodName, exo::ast::ExprList* expressions, exo::ast::Node& node, bool inMem );
+				llvm::StructType*	getMapType( llvm::Type* keyType, llvm::Type* valueType );
+				bool				isMap( llvm::Type* type );
+				llvm::Value*		createHash( llvm::Value* key, llvm::Value* seed );
+				llvm::Value*		findSlot( llvm::Value* map, llvm::Value* key, llvm::Value* hash );
+				llvm::Value*		invokeMapMethod( llvm::Value* map, std::string methodName, exo::ast::ExprList* expressions, exo::ast::Node& node, bool inMem );
 
+				void			generateFunction( exo::ast::DeclFun& decl, llvm::Function* function, unsigned firstArgument );
+				void			generateAsync( exo::ast::DeclFun& decl, std::vector<llvm::Type*> arguments );
+				void			generateParallelFor( exo::ast::StmtFor& stmt );
+				void			generateThreadLocal( exo::ast::DeclVar& decl, llvm::Type* type );
+				llvm::Value*	getThreadLocal( std::string name );
+				void			completeTask( llvm::Value* result );
 				llvm::Function*	getFunction( std::string functionName );
+				std::vector<llvm::Value*>	evaluateArguments( llvm::FunctionType* function, std::vector<llvm::Value*> arguments, exo::ast::ExprList* expressions );
 				llvm::Value* 	invokeFunction( llvm::Value* callee, llvm::FunctionType* function, std::vector<llvm::Value*> arguments, exo::ast::ExprList* expressions, bool inMem );
 				llvm::Value* 	invokeMethod( llvm::Value* callee, std::string methodName, exo::ast::ExprList* expressions, bool isOptional, bool inMem );
 				int				getPropPos( std::string className, std::string propName );
@@ -89,12 +245,18 @@ namespace exo
 				virtual void visit( exo::ast::DeclFunProto& );
 				virtual void visit( exo::ast::DeclFun& );
 				virtual void visit( exo::ast::DeclMod& );
+				virtual void visit( exo::ast::DeclTuple& );
 				virtual void visit( exo::ast::DeclVar& );
 				virtual void visit( exo::ast::DeclVarList& );
 				virtual void visit( exo::ast::ExprCallFun& );
 				virtual void visit( exo::ast::ExprCallMethod& );
+				virtual void visit( exo::ast::ExprCallValue& );
+				virtual void visit( exo::ast::ExprClosure& );
+				virtual void visit( exo::ast::ExprIndex& );
 				virtual void visit( exo::ast::ExprVar& );
 				virtual void visit( exo::ast::ExprProp& );
+				virtual void visit( exo::ast::ExprSlice& );
+				virtual void visit( exo::ast::ExprTuple& );
 				virtual void visit( exo::ast::Node& );
 				virtual void visit( exo::ast::OpBinaryAdd& );
 				virtual void visit( exo::ast::OpBinaryAssign& );
@@ -111,14 +273,20 @@ namespace exo
 				virtual void visit( exo::ast::OpBinaryMul& );
 				virtual void visit( exo::ast::OpBinaryNeq& );
 				virtual void visit( exo::ast::OpBinarySub& );
+				virtual void visit( exo::ast::OpUnaryAwait& );
 				virtual void visit( exo::ast::OpUnaryDel& );
+				virtual void visit( exo::ast::OpUnaryJoin& );
 				virtual void visit( exo::ast::OpUnaryNew& );
+				virtual void visit( exo::ast::OpUnaryNewArray& );
+				virtual void visit( exo::ast::OpUnaryNewMap& );
 				virtual void visit( exo::ast::OpUnaryRef& );
+				virtual void visit( exo::ast::OpUnarySpawn& );
 				virtual void visit( exo::ast::StmtBreak& );
 				virtual void visit( exo::ast::StmtCont& );
 				virtual void visit( exo::ast::StmtDo& );
 				virtual void visit( exo::ast::StmtExpr& );
 				virtual void visit( exo::ast::StmtFor& );
+				virtual void visit( exo::ast::StmtForIn& );
 				virtual void visit( exo::ast::StmtIf& );
 				virtual void visit( exo::ast::StmtImport& );
 				virtual void visit( exo::ast::StmtLabel& );
@@ -128,6 +296,7 @@ namespace exo
 				virtual void visit( exo::ast::StmtSwitch& );
 				virtual void visit( exo::ast::StmtUse& );
 				virtual void visit( exo::ast::StmtWhile& );
+				virtual void visit( exo::ast::StmtYield& );
 				virtual void visit( exo::ast::Tree& );
 		};
 	}
@@ -136,6 +305,50 @@ namespace exo
 #define EXO_CLASS(n)				( "__class_" + n )
 #define EXO_METHOD(c,m)				EXO_CLASS(c) + "_method_" + m
 #define EXO_VTABLE(n)				EXO_CLASS(n) + "_vtbl"
+#define EXO_STRUCT(n)				( "__struct_" + n )
+#define EXO_ABI(n)					( "__abi_" + n )
+#define EXO_ARRAY(t)				( "__array<" + t + ">" )
+#define EXO_CALLABLE(t)				( "__callable<" + t + ">" )
+#define EXO_CALLABLE_FUNCTION		0
+#define EXO_CALLABLE_ENV			1
+#define EXO_CALLABLE_SIZE			2
+#define EXO_TASK(t)					( "__task<" + t + ">" )
+#define EXO_TASK_STATE				0
+#define EXO_TASK_RESUME				1
+#define EXO_TASK_WAITER				2
+#define EXO_TASK_RESULT				3
+#define EXO_FUTURE(t)				( "__future<" + t + ">" )
+#define EXO_FUTURE_RUN				0
+#define EXO_FUTURE_STATE			1
+#define EXO_FUTURE_RESULT			2
+#define EXO_TASK_DONE				-1
+#define EXO_ASYNC_FRAME(n)			( "__frame_" + n )
+#define EXO_ASYNC_START(n)			( "__start_" + n )
+#define EXO_ASYNC_RESUME(n)			( "__resume_" + n )
+#define EXO_SPAWN(n)				( "__spawn_" + n )
+#define EXO_ATOMIC(t)				( "__atomic<" + t + ">" )
+#define EXO_MAP(t)					( "__map<" + t + ">" )
+#define EXO_SET(t)					( "__set<" + t + ">" )
+#define EXO_MAP_CONTROL				0
+#define EXO_MAP_SLOTS				1
+#define EXO_MAP_MASK				2
+#define EXO_MAP_SEED				3
+#define EXO_MAP_SIZE				4
+#define EXO_MAP_GROUP				16
+#define EXO_MAP_EMPTY				-128
+#define EXO_STRING					"__string"
+#define EXO_STRING_LENGTH			0
+#define EXO_STRING_HASH				1
+#define EXO_STRING_FLAGS			2
+#define EXO_STRING_DATA				3
+#define EXO_ARRAY_LENGTH			0
+#define EXO_ARRAY_CAPACITY			1
+#define EXO_ARRAY_DATA				2
+#define EXO_ARRAY_SORT_RUN			16
+#define EXO_SORT_INT				0
+#define EXO_SORT_FLOAT				1
+#define EXO_SORT_BYTE				2
+#define EXO_SORT_STRING				3
 #define EXO_CODEGEN_LOG(node,msg)	EXO_DEBUG_LOG(trace, msg << " in " << currentFile << "#" << node.lineNo << ":" << node.columnNo )
 
 #ifndef EXO_GC_DISABLE
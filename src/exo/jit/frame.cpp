@@ -24,7 +24,8 @@ namespace exo
 		Frame::Frame( llvm::BasicBlock* i, llvm::BasicBlock* b, llvm::BasicBlock* c ) :
 			insertBlock( i ),
 			breakBlock( b ),
-			conditionBlock( c )
+			conditionBlock( c ),
+			isFunction( false )
 		{
 		};
 
@@ -44,7 +45,7 @@ namespace exo
 				return( symbol->second.first );
 			}
 
-			Frame* pFrame = parent.get();
+			Frame* pFrame = isFunction ? nullptr : parent.get();
 			while( pFrame != nullptr ) { // check parenting scope
 				EXO_DEBUG_LOG( trace, "Lookup symbol $" << name << " in (" << pFrame->insertBlock->getName().str() << ")" );
 
@@ -54,7 +55,7 @@ namespace exo
 					return( symbol->second.first );
 				}
 
-				pFrame = pFrame->parent.get();
+				pFrame = pFrame->isFunction ? nullptr : pFrame->parent.get();
 			}
 
 			EXO_THROW( UnknownVar() << exo::exceptions::VariableName( name ) );
@@ -71,14 +72,14 @@ namespace exo
 				return;
 			}
 
-			Frame* pFrame = parent.get();
+			Frame* pFrame = isFunction ? nullptr : parent.get();
 			while( pFrame != nullptr ) { // check parenting scope
 				symbol = pFrame->symbols.find( name );
 				if( symbol != symbols.end() ) {
 					symbol->second.first = value;
 				}
 
-				pFrame = pFrame->parent.get();
+				pFrame = pFrame->isFunction ? nullptr : pFrame->parent.get();
 			}
 
 			// no symbol found
@@ -104,14 +105,14 @@ namespace exo
 				return( symbol->second.second );
 			}
 
-			Frame* pFrame = parent.get();
+			Frame* pFrame = isFunction ? nullptr : parent.get();
 			while( pFrame != nullptr ) { // check parenting scope
 				symbol = pFrame->symbols.find( name );
 				if( symbol != symbols.end() ) {
 					return( symbol->second.second );
 				}
 
-				pFrame = pFrame->parent.get();
+				pFrame = pFrame->isFunction ? nullptr : pFrame->parent.get();
 			}
 
 			EXO_THROW( UnknownVar() << exo::exceptions::VariableName( name ) );
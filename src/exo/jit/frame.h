@@ -31,6 +31,7 @@ namespace exo
 				llvm::BasicBlock*					insertBlock;
 				llvm::BasicBlock*					breakBlock;
 				llvm::BasicBlock*					conditionBlock;
+				bool								isFunction; // symbol lookups stop at function frames
 				std::shared_ptr<Frame>				parent;
 				std::unordered_map< std::string /* name */, std::pair< llvm::Value*/* LLVM memory address */, bool /* isReference */> >	symbols;
 
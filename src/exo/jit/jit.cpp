@@ -50,9 +50,18 @@ namespace exo
 			builder.OptLevel = target->codeGenOpt; // FIXME: this should be uint
 			builder.SizeLevel = 0;
 			builder.Inliner = llvm::createFunctionInliningPass();
+			builder.LibraryInfo = target->createLibraryInfo();
 			builder.LoopVectorize = true;
 			builder.SLPVectorize = true;
 
+			// nothing looks at errno, so math functions with vector variants don't touch memory and may be vectorized
+			for( auto &f : *module ) {
+				if( f.isDeclaration() && builder.LibraryInfo->isFunctionVectorizable( f.getName() ) ) {
+					f.setDoesNotAccessMemory();
+					f.setDoesNotThrow();
+				}
+			}
+
 			builder.populateFunctionPassManager( fpassManager );
 			builder.populateModulePassManager( passManager );
 
@@ -74,6 +83,32 @@ namespace exo
 
 		int JIT::Execute( std::string fName )
 		{
+			(void)Compile( fName );
+
+			EXO_LOG( trace, "Executing \"" + fName + "\"." );
+
+			std::vector<llvm::GenericValue> arguments;
+			llvm::GenericValue retval = engine->runFunction( engine->FindFunctionNamed( fName.c_str() ), arguments );
+
+			EXO_LOG( trace, "Finished." );
+
+			engine->runStaticConstructorsDestructors( true );
+
+			return( retval.IntVal.getZExtValue() );
+		}
+
+		uint64_t JIT::Compile( std::string fName )
+		{
+			if( engine != nullptr ) {
+				uint64_t address = engine->getFunctionAddress( fName );
+
+				if( address == 0 ) {
+					EXO_THROW( InvalidCall() << exo::exceptions::FunctionName( fName ) );
+				}
+
+				return( address );
+			}
+
 			std::string buffer;
 
 			if( !target->targetMachine->getTarget().hasJIT() ) {
@@ -82,9 +117,7 @@ namespace exo
 
 			passManager.run( *module );
 
-			llvm::Function* entry = module->getFunction( fName );
-
-			if( entry == nullptr ) {
+			if( module->getFunction( fName ) == nullptr ) {
 				EXO_THROW( InvalidCall() << exo::exceptions::FunctionName( fName ) );
 			}
 
@@ -97,17 +130,17 @@ namespace exo
 			builder.setEngineKind( llvm::EngineKind::JIT );
 			builder.setMCJITMemoryManager( std::unique_ptr<llvm::RTDyldMemoryManager>( memMgr ) );
 
-			std::unique_ptr<llvm::ExecutionEngine> jit( builder.create( target->targetMachine.release() ) );
+			engine = std::unique_ptr<llvm::ExecutionEngine>( builder.create( target->targetMachine.release() ) );
 
-			if( jit == nullptr ) {
+			if( engine == nullptr ) {
 				EXO_THROW_MSG( buffer );
 			}
 
 			/*
-			jit->DisableSymbolSearching( false );
-			EXO_DEBUG_LOG( trace, "Symbol searching: " << ( jit->isSymbolSearchingDisabled() ? "disabled" : "enabled" ) << "" );
-			jit->DisableGVCompilation ( false );
-			EXO_DEBUG_LOG( trace, "Symbol allocation: " << ( jit->isGVCompilationDisabled() ? "disabled" : "enabled" ) << "" );
+			engine->DisableSymbolSearching( false );
+			EXO_DEBUG_LOG( trace, "Symbol searching: " << ( engine->isSymbolSearchingDisabled() ? "disabled" : "enabled" ) << "" );
+			engine->DisableGVCompilation ( false );
+			EXO_DEBUG_LOG( trace, "Symbol allocation: " << ( engine->isGVCompilationDisabled() ? "disabled" : "enabled" ) << "" );
 			*/
 
 			std::string error;
@@ -119,29 +152,20 @@ namespace exo
 				}
 			}
 
-			jit->RegisterJITEventListener( llvm::JITEventListener::createOProfileJITEventListener() );
-			jit->RegisterJITEventListener( llvm::JITEventListener::createIntelJITEventListener() );
+			engine->RegisterJITEventListener( llvm::JITEventListener::createOProfileJITEventListener() );
+			engine->RegisterJITEventListener( llvm::JITEventListener::createIntelJITEventListener() );
 
-			jit->DisableLazyCompilation( false );
+			engine->DisableLazyCompilation( false );
 
-			jit->finalizeObject();
+			engine->finalizeObject();
 
-			jit->runStaticConstructorsDestructors( false );
+			engine->runStaticConstructorsDestructors( false );
 
-			EXO_LOG( trace, "Executing \"" + fName + "\"." );
-
-			(void)jit->getFunctionAddress( fName );
+			uint64_t address = engine->getFunctionAddress( fName );
 
 			static_cast<llvm::SectionMemoryManager*>(memMgr)->invalidateInstructionCache();
 
-			std::vector<llvm::GenericValue> arguments;
-			llvm::GenericValue retval = jit->runFunction( entry, arguments );
-
-			EXO_LOG( trace, "Finished." );
-
-			jit->runStaticConstructorsDestructors( true );
-
-			return( retval.IntVal.getZExtValue() );
+			return( address );
 		}
 
 		// llvm streams are pure evil
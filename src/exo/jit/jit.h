@@ -25,10 +25,11 @@ namespace exo
 	{
 		class JIT
 		{
-			std::unique_ptr<llvm::Module>	module;
-			std::shared_ptr<Target>			target;
-			llvm::legacy::PassManager		passManager;
-			std::set<std::string>			imports;
+			std::unique_ptr<llvm::Module>			module;
+			std::shared_ptr<Target>					target;
+			llvm::legacy::PassManager				passManager;
+			std::set<std::string>					imports;
+			std::unique_ptr<llvm::ExecutionEngine>	engine;
 
 			public:
 				JIT( std::unique_ptr<llvm::Module> m, std::shared_ptr<Target> t, std::set<std::string> i );
@@ -36,6 +37,13 @@ namespace exo
 
 				int Execute();
 				int Execute( std::string fName );
+
+				/**
+				 * Generates machine code for the whole module on first use, returns the address of the function. The code
+				 * lives as long as the JIT does
+				 */
+				uint64_t Compile( std::string fName );
+
 				int Emit( int type = 0, std::string fileName = "" );
 		};
 	}
@@ -31,6 +31,7 @@
 #include <llvm/LinkAllPasses.h>
 #include <llvm/Analysis/TargetLibraryInfo.h>
 #include <llvm/Analysis/TargetTransformInfo.h>
+#include <llvm/Analysis/ValueTracking.h>
 #include <llvm/MC/SubtargetFeature.h>
 
 #include <llvm/Support/raw_ostream.h>
@@ -43,6 +44,8 @@
 #include <llvm/Transforms/IPO/PassManagerBuilder.h>
 
 #include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/MDBuilder.h>
+#include <llvm/IR/Intrinsics.h>
 
 #include <llvm/Bitcode/ReaderWriter.h>
 
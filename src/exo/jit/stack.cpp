@@ -49,6 +49,17 @@ namespace exo
 			return( frames.top()->insertBlock );
 		}
 
+		// a function body can neither see the variables nor the loops of the code it was declared in
+		llvm::BasicBlock* Stack::PushFunction( llvm::BasicBlock* insertBlock, llvm::BasicBlock* returnBlock )
+		{
+			Push( insertBlock, returnBlock );
+
+			frames.top()->isFunction = true;
+			frames.top()->conditionBlock = nullptr;
+
+			return( frames.top()->insertBlock );
+		}
+
 		llvm::BasicBlock* Stack::Pop()
 		{
 			llvm::BasicBlock* insertBlock;
@@ -143,9 +154,19 @@ namespace exo
 			 return( frames.top()->insertBlock->getName().str() );
 		}
 
+		// globals are visible in every function, unless a local variable shadows them
 		llvm::Value* Stack::Get( std::string name )
 		{
-			return( frames.top()->Get( name ) );
+			auto global = globals.find( name );
+			if( global == globals.end() ) {
+				return( frames.top()->Get( name ) );
+			}
+
+			try {
+				return( frames.top()->Get( name ) );
+			} catch( exo::exceptions::UnknownVar &exception ) {
+				return( global->second );
+			}
 		}
 
 		void Stack::Set( std::string name, llvm::Value* value, bool isRef )
@@ -160,7 +181,32 @@ namespace exo
 
 		bool Stack::isRef( std::string name )
 		{
+			if( isGlobal( name ) ) {
+				return( false );
+			}
+
 			return( frames.top()->isRef( name ) );
 		}
+
+		void Stack::SetGlobal( std::string name, llvm::Value* value )
+		{
+			value->setName( name );
+			globals[ name ] = value;
+		}
+
+		bool Stack::isGlobal( std::string name )
+		{
+			if( globals.count( name ) == 0 ) {
+				return( false );
+			}
+
+			try {
+				frames.top()->Get( name );
+			} catch( exo::exceptions::UnknownVar &exception ) {
+				return( true );
+			}
+
+			return( false );
+		}
 	}
 }
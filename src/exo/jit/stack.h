@@ -27,9 +27,11 @@ namespace exo
 		{
 			private:
 				std::stack< std::shared_ptr<Frame> > frames;
+				std::unordered_map< std::string, llvm::Value* > globals;
 
 			public:
 				llvm::BasicBlock*	Push( llvm::BasicBlock* insertBlock, llvm::BasicBlock* breakBlock = nullptr, llvm::BasicBlock* conditionBlock = nullptr );
+				llvm::BasicBlock*	PushFunction( llvm::BasicBlock* insertBlock, llvm::BasicBlock* returnBlock );
 				llvm::BasicBlock*	Pop();
 				llvm::BasicBlock*	Join( llvm::BasicBlock* joinPoint );
 				llvm::BasicBlock*	Block();
@@ -42,6 +44,8 @@ namespace exo
 				void				Set( std::string name, llvm::Value* value, bool isRef = false );
 				void				Del( std::string name );
 				bool				isRef( std::string name );
+				void				SetGlobal( std::string name, llvm::Value* value );
+				bool				isGlobal( std::string name );
 		};
 	}
 }
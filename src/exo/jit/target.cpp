@@ -41,13 +41,13 @@ namespace exo
 			llvm::SubtargetFeatures subtargetFeatures;
 			subtargetFeatures.getDefaultSubtargetFeatures( llvm::Triple( cpu ) );
 
-			/*
-			if( llvm::sys::getHostCPUFeatures( hostFeatures ) ) {
+			// when compiling for the host, use what the host cpu actually supports (i.e. avx might be disabled by the os)
+			llvm::StringMap<bool> hostFeatures;
+			if( cpu == llvm::sys::getHostCPUName() && llvm::sys::getHostCPUFeatures( hostFeatures ) ) {
 				for( const auto &hf : hostFeatures ) {
-					subtargetFeatures.AddFeature( std::string( hf.second ? "+" : "-" ).append( hf.first() ) );
+					subtargetFeatures.AddFeature( std::string( hf.second ? "+" : "-" ).append( hf.first().str() ) );
 				}
 			}
-			*/
 
 			llvm::TargetOptions targetOptions;
 
@@ -67,6 +67,13 @@ namespace exo
 
 			llvm::Optional<llvm::Reloc::Model> relocModel;
 			targetMachine = std::unique_ptr<llvm::TargetMachine>( target->createTargetMachine( targetTriple.str(), cpu, subtargetFeatures.getString(), targetOptions, relocModel, llvm::CodeModel::JITDefault, codeGenOpt ) );
+
+			// ask the cost model of a scratch function how wide the vector registers are
+			llvm::Module scratch( "vector-width", context );
+			scratch.setDataLayout( targetMachine->createDataLayout() );
+			llvm::Function* function = llvm::Function::Create( llvm::FunctionType::get( llvm::Type::getVoidTy( context ), false ), llvm::GlobalValue::ExternalLinkage, "", &scratch );
+			llvm::FunctionAnalysisManager analysisManager;
+			vectorWidth = targetMachine->getTargetIRAnalysis().run( *function, analysisManager ).getRegisterBitWidth( true );
 		}
 
 		Target::~Target()
@@ -78,6 +85,48 @@ namespace exo
 			return( targetMachine->getTargetTriple().str() );
 		}
 
+		/*
+		 * targets without vector registers get 128 bit vectors, which the legalizer scalarizes
+		 */
+		unsigned Target::getVectorLanes( llvm::Type* elementType )
+		{
+			unsigned width = vectorWidth < 128 ? 128 : vectorWidth;
+			unsigned bits = elementType->getPrimitiveSizeInBits() < 8 ? 8 : elementType->getPrimitiveSizeInBits();
+
+			return( width / bits < 2 ? 2 : width / bits );
+		}
+
+		/*
+		 * loops calling these vectorize into calls of exo_vmath_* (see runtime/vmath.cpp), 2 lanes fit any vector
+		 * registers. the variants with 4 lanes are passed in avx registers
+		 */
+		llvm::TargetLibraryInfoImpl* Target::createLibraryInfo()
+		{
+			static const llvm::VecDesc pairs[] = {
+				{ "sin", "exo_vmath_sind2", 2 },
+				{ "cos", "exo_vmath_cosd2", 2 },
+				{ "exp", "exo_vmath_expd2", 2 },
+				{ "log", "exo_vmath_logd2", 2 },
+				{ "sqrt", "exo_vmath_sqrtd2", 2 }
+			};
+			static const llvm::VecDesc quads[] = {
+				{ "sin", "exo_vmath_sind4", 4 },
+				{ "cos", "exo_vmath_cosd4", 4 },
+				{ "exp", "exo_vmath_expd4", 4 },
+				{ "log", "exo_vmath_logd4", 4 },
+				{ "sqrt", "exo_vmath_sqrtd4", 4 }
+			};
+
+			llvm::TargetLibraryInfoImpl* libraryInfo = new llvm::TargetLibraryInfoImpl( targetMachine->getTargetTriple() );
+
+			libraryInfo->addVectorizableFunctions( pairs );
+			if( targetMachine->getTargetTriple().getArch() == llvm::Triple::x86_64 && vectorWidth >= 256 ) {
+				libraryInfo->addVectorizableFunctions( quads );
+			}
+
+			return( libraryInfo );
+		}
+
 		std::unique_ptr<llvm::Module> Target::createModule( std::string moduleName )
 		{
 			std::unique_ptr<llvm::Module> module = std::make_unique<llvm::Module>( moduleName, context );
@@ -43,6 +43,11 @@ namespace exo
 				 */
 				llvm::LLVMContext						context;
 
+				/**
+				 * Width of the widest vector register in bits, as reported by the target cost model
+				 */
+				unsigned								vectorWidth;
+
 				/**
 				 * Constructs the targetmachine (thru LLVM) based, based upon architecture, cpu type and optimizatzion level
 				 */
@@ -58,6 +63,17 @@ namespace exo
 				 * String representation/Name of our Target
 				 */
 				std::string						getName();
+
+				/**
+				 * Number of lanes a native vector of the given element type holds
+				 */
+				unsigned						getVectorLanes( llvm::Type* elementType );
+
+				/**
+				 * What the optimizer knows about libc and libm of our target, including the vector variants of math
+				 * functions the runtime brings along. ownership goes to the caller, usually a PassManagerBuilder
+				 */
+				llvm::TargetLibraryInfoImpl*	createLibraryInfo();
 		};
 	}
 }
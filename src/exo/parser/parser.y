@@ -75,8 +75,9 @@
 %right		T_AMP.
 %left		T_PLUS T_MINUS.
 %left		T_MUL T_DIV.
-%right		T_NEW T_DELETE.
-%left		T_PTR.
+%right		T_NEW T_DELETE T_AWAIT T_SPAWN T_JOIN.
+%left		T_PTR T_LSQUARE.
+%left		T_LANGLE.
 
 /* a program is build out of statements. or is empty */
 program ::= stmts(s). {
@@ -101,7 +102,8 @@ stmts(s) ::= stmts(a) stmt(b). {
 
 
 /*
- * a statement can be a break, do-while-loop, continue, declaration, expression, for-loop, if-else-elseif, import, label, return, scope, use or while-loop statement
+ * a statement can be a break, do-while-loop, continue, declaration, expression, for-loop, for-in-loop, parallel for-loop, if-else-elseif, import, label,
+ * return, scope, use, while-loop or yield statement
  * statements are terminated by a semicolon
  */
 %type stmt { std::unique_ptr<exo::ast::Stmt> }
@@ -123,6 +125,12 @@ stmt(s) ::= stmtexpr(e) T_SEMICOLON. {
 stmt(s) ::= stmtfor(f). { /* ends with a statement */
 	s = std::move(f);
 }
+stmt(s) ::= stmtforin(f). { /* ends with a statement */
+	s = std::move(f);
+}
+stmt(s) ::= stmtparallel(p). { /* ends with a statement */
+	s = std::move(p);
+}
 stmt(s) ::= stmtif(i). { /* ends with a statement */
 	s = std::move(i);
 }
@@ -147,6 +155,9 @@ stmt(s) ::= stmtuse(u) T_SEMICOLON. {
 stmt(s) ::= stmtwhile(w). { /* ends with a statement */
 	s = std::move(w);
 }
+stmt(s) ::= stmtyield(y) T_SEMICOLON. {
+	s = std::move(y);
+}
 
 /* break is a simple keyword */
 %type stmtbreak { std::unique_ptr<exo::ast::StmtBreak> }
@@ -183,6 +194,25 @@ stmtfor(f) ::= T_FOR T_LANGLE declvarlist(l) T_SEMICOLON expr(c) T_SEMICOLON exp
 	EXO_TRACK_NODE(f);
 }
 
+/* a parallel for loop, optionally declaring its reductions */
+%type stmtparallel { std::unique_ptr<exo::ast::StmtFor> }
+stmtparallel(p) ::= T_PARALLEL stmtfor(f). {
+	p = std::move(f);
+	p->isParallel = true;
+}
+stmtparallel(p) ::= T_PARALLEL T_REDUCE T_LANGLE exprlist(r) T_RANGLE stmtfor(f). {
+	p = std::move(f);
+	p->isParallel = true;
+	p->reductions = std::move(r);
+}
+
+/* a for-in block declares a variable taking the values yielded by a generator call */
+%type stmtforin { std::unique_ptr<exo::ast::StmtForIn> }
+stmtforin(f) ::= T_FOR T_LANGLE type(t) S_VAR(v) T_IN expr(e) T_RANGLE stmt(s). {
+	f = std::make_unique<exo::ast::StmtForIn>( std::make_unique<exo::ast::DeclVar>( TOKENSTR(v), std::move(t) ), std::move(e), std::move(s) );
+	EXO_TRACK_NODE(f);
+}
+
 /* an if or if-else block */
 %type stmtif { std::unique_ptr<exo::ast::StmtIf> }
 stmtif(i) ::= T_IF T_LANGLE expr(e) T_RANGLE stmt(t). {
@@ -266,10 +296,17 @@ stmtwhile(w) ::= T_WHILE T_LANGLE expr(e) T_RANGLE stmt(s). {
 	EXO_TRACK_NODE(w);
 }
 
+/* a yield has an expression, it makes the function a generator */
+%type stmtyield { std::unique_ptr<exo::ast::StmtYield> }
+stmtyield(y) ::= T_YIELD expr(e). {
+	y = std::make_unique<exo::ast::StmtYield>( std::move(e) );
+	EXO_TRACK_NODE(y);
+}
+
 
 /*
- * a declaration can be a class-, function prototype-, function-, module-, variable-, variable-list- declaration
- * a declaration is a statement.
+ * a declaration can be a class-, function prototype-, function-, module-, thread local variable-, variable-, variable-list-
+ * declaration. a declaration is a statement.
  */
 %type decl { std::unique_ptr<exo::ast::Stmt> }
 decl(d) ::= declclass(c). {
@@ -287,6 +324,14 @@ decl(d) ::= declmod(m). {
 decl(d) ::= declvarlist(v). { /* also catches variable declarations */
 	d = std::move(v);
 }
+decl(d) ::= T_THREADLOCAL declvar(v). {
+	v->isThreadLocal = true;
+	d = std::move(v);
+}
+decl(d) ::= T_LSQUARE declvarlist(v) T_RSQUARE T_ASSIGN expr(e). { /* destructures a tuple */
+	d = std::make_unique<exo::ast::DeclTuple>( std::move(v), std::move(e) );
+	EXO_TRACK_NODE(d);
+}
 
 /* a class declaration block contains the declarations properties and methods */
 %type declclassblock { std::unique_ptr<exo::ast::DeclClass> }
@@ -332,6 +377,20 @@ declclass(c) ::= T_CLASS id(i) T_LBRACKET T_RBRACKET. {
 	c->setId( std::move(i) );
 }
 
+/* a struct is declared like a class, but can not extend and is handled as a value */
+declclass(c) ::= T_STRUCT id(i) T_LBRACKET declclassblock(b) T_RBRACKET. {
+	c = std::move(b);
+	EXO_TRACK_NODE(c);
+	c->setId( std::move(i) );
+	c->isValue = true;
+}
+declclass(c) ::= T_STRUCT id(i) T_LBRACKET T_RBRACKET. {
+	c = std::make_unique<exo::ast::DeclClass>();
+	EXO_TRACK_NODE(c);
+	c->setId( std::move(i) );
+	c->isValue = true;
+}
+
 /*
  * a function prototype declaration can have a type identifier followed by the keyword function a function identifier and a variaböe decleration
  */
@@ -390,6 +449,28 @@ declfun(f) ::= access(a) T_FUNCTION id(i) T_LANGLE declvarlist(l) T_VARG T_RANGL
 	EXO_TRACK_NODE(f);
 }
 
+/* async functions return a task of their return type and have no variable arguments */
+declfun(f) ::= T_ASYNC T_FUNCTION id(i) T_LANGLE declvarlist(l) T_RANGLE stmtscope(b). {
+	f = std::make_unique<exo::ast::DeclFun>( std::move(i), std::make_unique<exo::ast::Type>( std::make_unique<exo::ast::Id>( "null" ), true ), std::move(l), std::move(b), false );
+	f->isAsync = true;
+	EXO_TRACK_NODE(f);
+}
+declfun(f) ::= T_ASYNC type(t) T_FUNCTION id(i) T_LANGLE declvarlist(l) T_RANGLE stmtscope(b). {
+	f = std::make_unique<exo::ast::DeclFun>( std::move(i), std::move(t), std::move(l), std::move(b), false );
+	f->isAsync = true;
+	EXO_TRACK_NODE(f);
+}
+declfun(f) ::= access(a) T_ASYNC type(t) T_FUNCTION id(i) T_LANGLE declvarlist(l) T_RANGLE stmtscope(b). {
+	f = std::make_unique<exo::ast::DeclFun>( std::move(i), std::move(a), std::move(t), std::move(l), std::move(b), false );
+	f->isAsync = true;
+	EXO_TRACK_NODE(f);
+}
+declfun(f) ::= access(a) T_ASYNC T_FUNCTION id(i) T_LANGLE declvarlist(l) T_RANGLE stmtscope(b). {
+	f = std::make_unique<exo::ast::DeclFun>( std::move(i), std::move(a), std::make_unique<exo::ast::Type>( std::make_unique<exo::ast::Id>( "null" ), true ), std::move(l), std::move(b), false );
+	f->isAsync = true;
+	EXO_TRACK_NODE(f);
+}
+
 
 /* a module declaration is a module identifier */
 %type declmod { std::unique_ptr<exo::ast::DeclMod> }
@@ -454,12 +535,24 @@ id(i) ::= S_ID(s). {
 }
 
 
-/* a type may be a primitive (bool, integer, float, string, auto, callable, null) or an identifier for a complex */
+/*
+ * a type may be a primitive (bool, byte, integer, float, string, auto, callable, null) or an identifier for a complex
+ * any type followed by square brackets is a growable array, or a fixed size array if the brackets contain the element count
+ * vec<type, lanes> is a simd vector, vec<type> a vector as wide as the targets vector registers
+ * tuple<type, ...> holds multiple values, i.e. to return them in registers
+ * callable<type, ...> is a closure with the return type followed by its parameter types, callable alone neither takes nor returns anything
+ * task<type> is the handle of an async function, task alone yields nothing
+ * map<type, type> and set<type> are hash tables, keyed by primitives, strings or object identity
+ */
 %type type { std::unique_ptr<exo::ast::Type> }
 type(t) ::= T_TBOOL. {
 	t = std::make_unique<exo::ast::Type>( std::make_unique<exo::ast::Id>( "bool" ), true );
 	EXO_TRACK_NODE(t);
 }
+type(t) ::= T_TBYTE. {
+	t = std::make_unique<exo::ast::Type>( std::make_unique<exo::ast::Id>( "byte" ), true );
+	EXO_TRACK_NODE(t);
+}
 type(t) ::= T_TINT. {
 	t = std::make_unique<exo::ast::Type>( std::make_unique<exo::ast::Id>( "int" ), true );
 	EXO_TRACK_NODE(t);
@@ -477,10 +570,30 @@ type(t) ::= T_TAUTO. {
 	EXO_TRACK_NODE(t);
 }
 type(t) ::= T_TCALLABLE. {
-	t = std::make_unique<exo::ast::Type>( std::make_unique<exo::ast::Id>( "callable" ) );
+	t = std::make_unique<exo::ast::Type>( std::make_unique<exo::ast::Id>( "callable" ), true );
+	EXO_TRACK_NODE(t);
+}
+type(t) ::= T_TTASK. {
+	t = std::make_unique<exo::ast::Type>( std::make_unique<exo::ast::Id>( "task" ), true );
+	EXO_TRACK_NODE(t);
+}
+type(t) ::= T_TTASK T_LT type(e) T_GT. {
+	t = std::make_unique<exo::ast::Type>( std::make_unique<exo::ast::Id>( "task" ), std::move(e) );
+	EXO_TRACK_NODE(t);
+}
+type(t) ::= T_TFUTURE. {
+	t = std::make_unique<exo::ast::Type>( std::make_unique<exo::ast::Id>( "future" ), true );
+	EXO_TRACK_NODE(t);
+}
+type(t) ::= T_TFUTURE T_LT type(e) T_GT. {
+	t = std::make_unique<exo::ast::Type>( std::make_unique<exo::ast::Id>( "future" ), std::move(e) );
+	EXO_TRACK_NODE(t);
+}
+type(t) ::= T_TATOMIC T_LT type(e) T_GT. {
+	t = std::make_unique<exo::ast::Type>( std::make_unique<exo::ast::Id>( "atomic" ), std::move(e) );
 	EXO_TRACK_NODE(t);
 }
-type(t) ::= T_VNULL. {
+type(t) ::= T_VNULL. [T_COMMA] { /* null[] is rather an indexed constant than an array type */
 	t = std::make_unique<exo::ast::Type>( std::make_unique<exo::ast::Id>( "null" ), true );
 	EXO_TRACK_NODE(t);
 }
@@ -488,6 +601,62 @@ type(t) ::= id(i). {
 	t = std::make_unique<exo::ast::Type>( std::move(i) );
 	EXO_TRACK_NODE(t);
 }
+type(t) ::= type(e) T_LSQUARE T_RSQUARE. {
+	t = std::make_unique<exo::ast::Type>( std::make_unique<exo::ast::Id>( "array" ), std::move(e) );
+	EXO_TRACK_NODE(t);
+}
+type(t) ::= type(e) T_LSQUARE S_INT(s) T_RSQUARE. {
+	t = std::make_unique<exo::ast::Type>( std::make_unique<exo::ast::Id>( "array" ), std::move(e), boost::lexical_cast<long long>( TOKENSTR(s) ) );
+	EXO_TRACK_NODE(t);
+}
+type(t) ::= T_TVEC T_LT type(e) T_GT. {
+	t = std::make_unique<exo::ast::Type>( std::make_unique<exo::ast::Id>( "vec" ), std::move(e) );
+	EXO_TRACK_NODE(t);
+}
+type(t) ::= T_TVEC T_LT type(e) T_COMMA S_INT(s) T_GT. {
+	t = std::make_unique<exo::ast::Type>( std::make_unique<exo::ast::Id>( "vec" ), std::move(e), boost::lexical_cast<long long>( TOKENSTR(s) ) );
+	EXO_TRACK_NODE(t);
+}
+type(t) ::= typetuple(l) T_GT. {
+	t = std::move(l);
+}
+type(t) ::= typemap(m). {
+	t = std::move(m);
+}
+
+%type typemap { std::unique_ptr<exo::ast::Type> }
+typemap(t) ::= T_TMAP T_LT type(k) T_COMMA type(v) T_GT. {
+	t = std::make_unique<exo::ast::Type>( std::make_unique<exo::ast::Id>( "map" ), std::move(k) );
+	t->addParameter( std::move(v) );
+	EXO_TRACK_NODE(t);
+}
+typemap(t) ::= T_TSET T_LT type(k) T_GT. {
+	t = std::make_unique<exo::ast::Type>( std::make_unique<exo::ast::Id>( "set" ), std::move(k) );
+	EXO_TRACK_NODE(t);
+}
+
+%type typetuple { std::unique_ptr<exo::ast::Type> }
+typetuple(t) ::= T_TTUPLE T_LT type(e). {
+	t = std::make_unique<exo::ast::Type>( std::make_unique<exo::ast::Id>( "tuple" ), std::move(e) );
+	EXO_TRACK_NODE(t);
+}
+typetuple(t) ::= typetuple(l) T_COMMA type(e). {
+	t = std::move(l);
+	t->addParameter( std::move(e) );
+}
+type(t) ::= typecallable(l) T_GT. {
+	t = std::move(l);
+}
+
+%type typecallable { std::unique_ptr<exo::ast::Type> }
+typecallable(t) ::= T_TCALLABLE T_LT type(e). {
+	t = std::make_unique<exo::ast::Type>( std::make_unique<exo::ast::Id>( "callable" ), std::move(e) );
+	EXO_TRACK_NODE(t);
+}
+typecallable(t) ::= typecallable(l) T_COMMA type(e). {
+	t = std::move(l);
+	t->addParameter( std::move(e) );
+}
 
 
 /* an expression list may be empty or expressions delimited by a colon */
@@ -507,17 +676,25 @@ exprlist(f) ::= exprlist(l) T_COMMA expr(e). {
 }
 
 
-/* an expression may be delimited/grouped by brackets, binary operation, call, constant, unary operation, variable */
+/* an expression may be delimited/grouped by brackets, binary operation, call, closure, constant, unary operation, variable, an array slice or a tuple */
 %type expr { std::unique_ptr<exo::ast::Expr> }
 expr(e) ::= T_LANGLE expr(a) T_RANGLE. {
 	e = std::move(a);
 }
+expr(e) ::= T_LANGLE expr(a) T_COMMA exprlist(l) T_RANGLE. { /* a tuple */
+	l->list.insert( l->list.begin(), std::move(a) );
+	e = std::make_unique<exo::ast::ExprTuple>( std::move(l) );
+	EXO_TRACK_NODE(e);
+}
 expr(e) ::= binop(b). {
 	e = std::move(b);
 }
 expr(e) ::= call(c). {
 	e = std::move(c);
 }
+expr(e) ::= closure(c). {
+	e = std::move(c);
+}
 expr(e) ::= constant(c). {
 	e = std::move(c);
 }
@@ -527,6 +704,10 @@ expr(e) ::= unop(b). {
 expr(e) ::= var(v). {
 	e = std::move(v);
 }
+expr(e) ::= expr(a) T_LSQUARE expr(l) T_COLON expr(u) T_RSQUARE. {
+	e = std::make_unique<exo::ast::ExprSlice>( std::move(a), std::move(l), std::move(u) );
+	EXO_TRACK_NODE(e);
+}
 
 /* binary operations ( + - * / == != < <= > >= = ) */
 %type binop { std::unique_ptr<exo::ast::OpBinary> }
@@ -602,6 +783,23 @@ call(c) ::= expr(v) T_PTR S_ID(i) T_LANGLE exprlist(a) T_RANGLE. {
 	c = std::make_unique<exo::ast::ExprCallMethod>( std::make_unique<exo::ast::Id>( TOKENSTR(i) ), std::move(v), std::move(a) );
 	EXO_TRACK_NODE(c);
 }
+call(c) ::= expr(v) T_LANGLE exprlist(a) T_RANGLE. {
+	c = std::make_unique<exo::ast::ExprCallValue>( std::move(v), std::move(a) );
+	EXO_TRACK_NODE(c);
+}
+
+/* a closure is an anonymous function declaration */
+%type closure { std::unique_ptr<exo::ast::ExprClosure> }
+closure(c) ::= T_FUNCTION T_LANGLE declvarlist(l) T_RANGLE stmtscope(b). {
+	c = std::make_unique<exo::ast::ExprClosure>( std::make_unique<exo::ast::DeclFun>( std::make_unique<exo::ast::Id>( "closure" ), std::make_unique<exo::ast::Type>( std::make_unique<exo::ast::Id>( "null" ), true ), std::move(l), std::move(b) ) );
+	EXO_TRACK_NODE(c);
+	EXO_TRACK_NODE(c->function);
+}
+closure(c) ::= type(t) T_FUNCTION T_LANGLE declvarlist(l) T_RANGLE stmtscope(b). {
+	c = std::make_unique<exo::ast::ExprClosure>( std::make_unique<exo::ast::DeclFun>( std::make_unique<exo::ast::Id>( "closure" ), std::move(t), std::move(l), std::move(b) ) );
+	EXO_TRACK_NODE(c);
+	EXO_TRACK_NODE(c->function);
+}
 
 /* a constant can be a builtin (null, true, false, __*__), number or string */
 %type constant { std::unique_ptr<exo::ast::ConstExpr> }
@@ -625,7 +823,7 @@ constant(c) ::= T_CONST_VERSION. {
 	c = std::make_unique<exo::ast::ConstStr>( EXO_VERSION );
 	EXO_TRACK_NODE(c);
 }
-constant(c) ::= T_VNULL. {
+constant(c) ::= T_VNULL. [T_LSQUARE] {
 	c = std::make_unique<exo::ast::ConstNull>();
 	EXO_TRACK_NODE(c);
 }
@@ -672,8 +870,20 @@ string(s) ::= T_QUOTE S_STRING(q) T_QUOTE. {
 	EXO_TRACK_NODE(s);
 }
 
-/* unary operation may be a delete, new or reference */
+/* unary operation may be an await, spawn, join, delete, new (object or array with its initial length) or reference */
 %type unop { std::unique_ptr<exo::ast::OpUnary> }
+unop(u) ::= T_AWAIT expr(e). {
+	u = std::make_unique<exo::ast::OpUnaryAwait>( std::move(e) );
+	EXO_TRACK_NODE(u);
+}
+unop(u) ::= T_SPAWN expr(e). {
+	u = std::make_unique<exo::ast::OpUnarySpawn>( std::move(e) );
+	EXO_TRACK_NODE(u);
+}
+unop(u) ::= T_JOIN expr(e). {
+	u = std::make_unique<exo::ast::OpUnaryJoin>( std::move(e) );
+	EXO_TRACK_NODE(u);
+}
 unop(u) ::= T_DELETE expr(e). {
 	u = std::make_unique<exo::ast::OpUnaryDel>( std::move(e) );
 	EXO_TRACK_NODE(u);
@@ -682,17 +892,33 @@ unop(u) ::= T_NEW expr(e). {
 	u = std::make_unique<exo::ast::OpUnaryNew>( std::move(e) );
 	EXO_TRACK_NODE(u);
 }
+unop(u) ::= T_NEW type(t) T_LSQUARE T_RSQUARE T_LANGLE expr(e) T_RANGLE. {
+	u = std::make_unique<exo::ast::OpUnaryNewArray>( std::move(t), std::move(e) );
+	EXO_TRACK_NODE(u);
+}
+unop(u) ::= T_NEW typemap(t) T_LANGLE T_RANGLE. {
+	u = std::make_unique<exo::ast::OpUnaryNewMap>( std::move(t), std::make_unique<exo::ast::ConstInt>( 0 ) );
+	EXO_TRACK_NODE(u);
+}
+unop(u) ::= T_NEW typemap(t) T_LANGLE expr(e) T_RANGLE. {
+	u = std::make_unique<exo::ast::OpUnaryNewMap>( std::move(t), std::move(e) );
+	EXO_TRACK_NODE(u);
+}
 unop(u) ::= T_AMP expr(e). {
 	u = std::make_unique<exo::ast::OpUnaryRef>( std::move(e) );
 	EXO_TRACK_NODE(u);
 }
 
-/* a variable begins with dollar sign and may be a class property */
+/* a variable begins with dollar sign and may be a class property or an array element */
 %type var { std::unique_ptr<exo::ast::ExprVar> }
 var(v) ::= expr(e) T_PTR S_ID(n). {
 	v = std::make_unique<exo::ast::ExprProp>( TOKENSTR(n), std::move(e) );
 	EXO_TRACK_NODE(v);
 }
+var(v) ::= expr(e) T_LSQUARE expr(i) T_RSQUARE. {
+	v = std::make_unique<exo::ast::ExprIndex>( std::move(e), std::move(i) );
+	EXO_TRACK_NODE(v);
+}
 var(v) ::= S_VAR(n). {
 	v = std::make_unique<exo::ast::ExprVar>( TOKENSTR(n) );
 	EXO_TRACK_NODE(v);
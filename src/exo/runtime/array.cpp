@@ -0,0 +1,101 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "exo/exo.h"
+#include "exo/runtime/runtime.h"
+
+using exo::runtime::Runtime;
+
+extern "C"
+{
+	void exo_array_bounds( const char* file, int64_t line, int64_t index, int64_t length )
+	{
+		EXO_LOG( fatal, "Array index " << index << " out of bounds (length " << length << ") in " << file << "#" << line );
+		std::fflush( stdout );
+		std::exit( EXIT_FAILURE );
+	}
+
+	exo_array* exo_array_new( const char* file, int64_t line, int64_t length, int64_t elementSize, int64_t isAtomic )
+	{
+		int64_t maximum = elementSize > 0 ? INT64_MAX / elementSize : INT64_MAX;
+		if( length < 0 || length >= maximum ) {
+			exo_array_bounds( file, line, length, maximum );
+		}
+
+		exo_array* array = static_cast<exo_array*>( Runtime::Allocate( sizeof( exo_array ), false ) );
+		array->length = length;
+		array->capacity = length;
+		array->data = Runtime::Allocate( length * elementSize, isAtomic );
+
+		return( array );
+	}
+
+	// a header for memory we do not own, i.e. a fixed array. capacity equals length, so growing always copies
+	exo_array* exo_array_wrap( void* data, int64_t length )
+	{
+		exo_array* array = static_cast<exo_array*>( Runtime::Allocate( sizeof( exo_array ), false ) );
+		array->length = length;
+		array->capacity = length;
+		array->data = data;
+
+		return( array );
+	}
+
+	exo_array* exo_array_slice( const char* file, int64_t line, exo_array* array, int64_t elementSize, int64_t lower, int64_t upper )
+	{
+		if( lower < 0 || lower > upper ) {
+			exo_array_bounds( file, line, lower, upper );
+		}
+		if( upper > array->length ) {
+			exo_array_bounds( file, line, upper, array->length );
+		}
+
+		return( exo_array_wrap( static_cast<char*>( array->data ) + lower * elementSize, upper - lower ) );
+	}
+
+	/*
+	 * grows geometrically. we never reallocate in place, since the data might be shared with a slice or not be owned by us
+	 */
+	void exo_array_reserve( exo_array* array, int64_t capacity, int64_t elementSize, int64_t isAtomic )
+	{
+		if( capacity <= array->capacity ) {
+			return;
+		}
+
+		int64_t grown = std::max<int64_t>( array->capacity * 2, 4 );
+		capacity = std::max( capacity, grown );
+
+		void* data = Runtime::Allocate( capacity * elementSize, isAtomic );
+		std::memcpy( data, array->data, array->length * elementSize );
+
+		array->data = data;
+		array->capacity = capacity;
+	}
+
+	void exo_array_resize( const char* file, int64_t line, exo_array* array, int64_t length, int64_t elementSize, int64_t isAtomic )
+	{
+		if( length < 0 ) {
+			exo_array_bounds( file, line, length, array->length );
+		}
+
+		if( length > array->capacity ) {
+			exo_array_reserve( array, length, elementSize, isAtomic );
+		} else if( length > array->length ) { // elements beyond our length may be stale
+			std::memset( static_cast<char*>( array->data ) + array->length * elementSize, 0, ( length - array->length ) * elementSize );
+		}
+
+		array->length = length;
+	}
+}
@@ -0,0 +1,219 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "exo/exo.h"
+#include "exo/runtime/runtime.h"
+
+#include <climits>
+#include <zlib.h>
+
+#define EXO_ZLIB_ZLIB			0
+#define EXO_ZLIB_GZIP			1
+#define EXO_ZLIB_RAW			2
+#define EXO_ZLIB_AUTO			3
+
+using exo::runtime::Runtime;
+
+/*
+ * zlib reads straight from the input array and writes straight into the output array, both belong to the caller. the
+ * input is kept referenced until it is replaced, so the collector does not take it away while zlib still points into it
+ */
+namespace
+{
+	z_stream* getStream( exo_zlib* zlib )
+	{
+		return( static_cast<z_stream*>( zlib->stream ) );
+	}
+
+	int getWindowBits( int64_t format )
+	{
+		switch( format ) {
+			case EXO_ZLIB_GZIP:
+				return( MAX_WBITS + 16 );
+			case EXO_ZLIB_RAW:
+				return( -MAX_WBITS );
+			case EXO_ZLIB_AUTO:
+				return( MAX_WBITS + 32 );
+			default:
+				return( MAX_WBITS );
+		}
+	}
+
+	exo_zlib* create( bool isDeflate, int64_t format )
+	{
+		exo_zlib* zlib = static_cast<exo_zlib*>( Runtime::Allocate( sizeof( exo_zlib ), false ) );
+		zlib->stream = Runtime::Allocate( sizeof( z_stream ), true );
+		zlib->isDeflate = isDeflate;
+		zlib->format = format;
+		return( zlib );
+	}
+
+	void end( exo_zlib* zlib )
+	{
+		if( zlib->stream == nullptr ) {
+			return;
+		}
+
+		if( zlib->isDeflate ) {
+			deflateEnd( getStream( zlib ) );
+		} else {
+			inflateEnd( getStream( zlib ) );
+		}
+
+		zlib->stream = nullptr;
+		zlib->input = nullptr;
+		zlib->isDone = true;
+	}
+
+#ifndef EXO_GC_DISABLE
+	void finalize( void* zlib, void* )
+	{
+		end( static_cast<exo_zlib*>( zlib ) );
+	}
+#endif
+
+	exo_zlib* initialize( exo_zlib* zlib, int result )
+	{
+		if( result != Z_OK ) {
+			return( nullptr );
+		}
+
+#ifndef EXO_GC_DISABLE
+		GC_register_finalizer( zlib, finalize, nullptr, nullptr, nullptr );
+#endif
+
+		return( zlib );
+	}
+}
+
+extern "C"
+{
+	/*
+	 * formats are zlib 0, gzip 1 and raw deflate 2. inflating may detect zlib or gzip with 3. null for invalid levels
+	 */
+	exo_zlib* exo_zlib_deflate( int64_t level, int64_t format )
+	{
+		exo_zlib* zlib = create( true, format );
+		return( initialize( zlib, deflateInit2( getStream( zlib ), static_cast<int>( level ), Z_DEFLATED, getWindowBits( format ), 8, Z_DEFAULT_STRATEGY ) ) );
+	}
+
+	exo_zlib* exo_zlib_inflate( int64_t format )
+	{
+		exo_zlib* zlib = create( false, format );
+		return( initialize( zlib, inflateInit2( getStream( zlib ), getWindowBits( format ) ) ) );
+	}
+
+	// the input is consumed in place, it has to stay unchanged until nothing of it is pending anymore
+	void exo_zlib_input( exo_zlib* zlib, exo_array* input )
+	{
+		if( zlib == nullptr || zlib->stream == nullptr ) {
+			return;
+		}
+
+		zlib->input = input;
+		getStream( zlib )->next_in = static_cast<Bytef*>( input->data );
+		getStream( zlib )->avail_in = static_cast<uInt>( std::min<int64_t>( input->length, UINT_MAX ) );
+		zlib->remaining = input->length - getStream( zlib )->avail_in;
+	}
+
+	/*
+	 * compresses or decompresses as much of the input as fits into the output from the offset on, and returns how many
+	 * bytes were written or a negative zlib error. deflating flushes everything left once finishing, which takes as many
+	 * calls as it takes until it is done. concatenated gzip members are inflated one after the other
+	 */
+	int64_t exo_zlib_process( exo_zlib* zlib, exo_array* output, int64_t offset, bool isFinishing )
+	{
+		if( zlib == nullptr || zlib->stream == nullptr ) {
+			return( Z_STREAM_ERROR );
+		} else if( offset < 0 || offset > output->length ) {
+			return( Z_BUF_ERROR );
+		}
+
+		z_stream* stream = getStream( zlib );
+		int64_t available = std::min<int64_t>( output->length - offset, UINT_MAX );
+		stream->next_out = static_cast<Bytef*>( output->data ) + offset;
+		stream->avail_out = static_cast<uInt>( available );
+
+		int result;
+		do {
+			// inputs beyond 4 GiB are handed over piece by piece
+			if( stream->avail_in == 0 && zlib->remaining > 0 ) {
+				stream->avail_in = static_cast<uInt>( std::min<int64_t>( zlib->remaining, UINT_MAX ) );
+				zlib->remaining -= stream->avail_in;
+			}
+
+			if( zlib->isDeflate ) {
+				result = deflate( stream, isFinishing && zlib->remaining == 0 ? Z_FINISH : Z_NO_FLUSH );
+			} else {
+				result = inflate( stream, Z_NO_FLUSH );
+				if( result == Z_STREAM_END && stream->avail_in > 0 && zlib->format != EXO_ZLIB_ZLIB && zlib->format != EXO_ZLIB_RAW ) {
+					result = inflateReset( stream );
+				}
+			}
+		} while( result == Z_OK && stream->avail_out > 0 && ( stream->avail_in > 0 || zlib->remaining > 0 ) );
+
+		if( result == Z_STREAM_END ) {
+			zlib->isDone = true;
+		} else if( result == Z_NEED_DICT ) {
+			return( Z_DATA_ERROR );
+		} else if( result < 0 && result != Z_BUF_ERROR ) {
+			return( result );
+		}
+
+		// no progress is possible without more input or room, which is not an error
+		return( available - stream->avail_out );
+	}
+
+	int64_t exo_zlib_pending( exo_zlib* zlib )
+	{
+		if( zlib == nullptr || zlib->stream == nullptr ) {
+			return( 0 );
+		}
+
+		return( getStream( zlib )->avail_in + zlib->remaining );
+	}
+
+	bool exo_zlib_is_done( exo_zlib* zlib )
+	{
+		return( zlib == nullptr || zlib->isDone );
+	}
+
+	// starts over with the next stream, without allocating the state once more
+	bool exo_zlib_reset( exo_zlib* zlib )
+	{
+		if( zlib == nullptr || zlib->stream == nullptr ) {
+			return( false );
+		}
+
+		zlib->input = nullptr;
+		zlib->remaining = 0;
+		zlib->isDone = false;
+
+		return( ( zlib->isDeflate ? deflateReset( getStream( zlib ) ) : inflateReset( getStream( zlib ) ) ) == Z_OK );
+	}
+
+	void exo_zlib_end( exo_zlib* zlib )
+	{
+		if( zlib == nullptr ) {
+			return;
+		}
+
+#ifndef EXO_GC_DISABLE
+		GC_register_finalizer( zlib, nullptr, nullptr, nullptr, nullptr );
+#endif
+
+		end( zlib );
+	}
+}
@@ -0,0 +1,310 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "exo/exo.h"
+#include "exo/runtime/runtime.h"
+
+#include <new>
+
+#define EXO_CACHE_LINE			64
+
+using exo::runtime::Runtime;
+
+/*
+ * indices written by producers and consumers live on cache lines of their own, so they do not invalidate each other
+ */
+struct exo_queue
+{
+	struct Cell
+	{
+		std::atomic<int64_t>	sequence;
+		int64_t					value;
+	};
+
+	alignas( EXO_CACHE_LINE ) std::atomic<int64_t>	enqueue;
+	alignas( EXO_CACHE_LINE ) std::atomic<int64_t>	dequeue;
+	alignas( EXO_CACHE_LINE ) int64_t				mask;
+	Cell*											cells;
+};
+
+struct exo_ring
+{
+	// the consumer keeps the last tail it saw and the producer the last head, so most calls touch no shared line
+	alignas( EXO_CACHE_LINE ) std::atomic<int64_t>	head;
+	int64_t											cachedTail;
+	alignas( EXO_CACHE_LINE ) std::atomic<int64_t>	tail;
+	int64_t											cachedHead;
+	alignas( EXO_CACHE_LINE ) int64_t				mask;
+	int64_t*										slots;
+};
+
+struct exo_map
+{
+	struct Slot
+	{
+		std::atomic<int64_t>	state;
+		int64_t					key;
+		std::atomic<int64_t>	value;
+		std::atomic<int64_t>	isPresent;
+	};
+
+	alignas( EXO_CACHE_LINE ) std::atomic<int64_t>	size;
+	alignas( EXO_CACHE_LINE ) int64_t				mask;
+	Slot*											slots;
+};
+
+namespace
+{
+	enum SlotState : int64_t
+	{
+		EMPTY = 0,
+		CLAIMED,
+		KEYED
+	};
+
+	// a power of two, so positions wrap with a mask
+	int64_t getCapacity( int64_t capacity )
+	{
+		int64_t size = 2;
+		while( size < capacity ) {
+			size *= 2;
+		}
+
+		return( size );
+	}
+
+	/*
+	 * the collector only aligns to two words, over allocate to start on a cache line. interior pointers keep it alive and
+	 * it is scanned for the elements it points to
+	 */
+	template<typename T> T* create()
+	{
+		uintptr_t memory = reinterpret_cast<uintptr_t>( Runtime::Allocate( sizeof( T ) + EXO_CACHE_LINE - 1, false ) );
+		memory = ( memory + EXO_CACHE_LINE - 1 ) & ~static_cast<uintptr_t>( EXO_CACHE_LINE - 1 );
+
+		return( new( reinterpret_cast<void*>( memory ) ) T() );
+	}
+
+	uint64_t hash( int64_t key )
+	{
+		uint64_t value = static_cast<uint64_t>( key );
+		value ^= value >> 33;
+		value *= 0xff51afd7ed558ccdull;
+		value ^= value >> 33;
+		value *= 0xc4ceb9fe1a85ec53ull;
+		value ^= value >> 33;
+
+		return( value );
+	}
+
+	/*
+	 * linear probing, a key is claimed once and keeps its slot. get and remove return nullptr for unknown keys, put when the
+	 * table is full
+	 */
+	exo_map::Slot* find( exo_map* map, int64_t key, bool isInserting )
+	{
+		for( int64_t i = 0; i <= map->mask; i++ ) {
+			exo_map::Slot& slot = map->slots[ ( hash( key ) + i ) & map->mask ];
+			int64_t state = slot.state.load( std::memory_order_acquire );
+
+			if( state == EMPTY ) {
+				if( !isInserting ) {
+					return( nullptr );
+				}
+
+				if( slot.state.compare_exchange_strong( state, CLAIMED, std::memory_order_acquire ) ) {
+					slot.key = key;
+					slot.state.store( KEYED, std::memory_order_release );
+					return( &slot );
+				}
+			}
+
+			// the claiming thread is between two stores
+			while( state == CLAIMED ) {
+				state = slot.state.load( std::memory_order_acquire );
+			}
+
+			if( slot.key == key ) {
+				return( &slot );
+			}
+		}
+
+		return( nullptr );
+	}
+}
+
+extern "C"
+{
+	exo_queue* exo_queue_create( int64_t capacity )
+	{
+		exo_queue* queue = create<exo_queue>();
+		queue->mask = getCapacity( capacity ) - 1;
+		queue->cells = static_cast<exo_queue::Cell*>( Runtime::Allocate( sizeof( exo_queue::Cell ) * ( queue->mask + 1 ), true ) );
+
+		for( int64_t i = 0; i <= queue->mask; i++ ) {
+			queue->cells[ i ].sequence.store( i, std::memory_order_relaxed );
+		}
+
+		return( queue );
+	}
+
+	/*
+	 * a cell is free for the enqueue at position while its sequence equals position, and holds the value for the dequeue
+	 * at position once it is position + 1. the sequence is only written by whoever claimed the position
+	 */
+	bool exo_queue_push( exo_queue* queue, int64_t value )
+	{
+		int64_t position = queue->enqueue.load( std::memory_order_relaxed );
+
+		for( ;; ) {
+			exo_queue::Cell& cell = queue->cells[ position & queue->mask ];
+			int64_t difference = cell.sequence.load( std::memory_order_acquire ) - position;
+
+			if( difference == 0 ) {
+				if( queue->enqueue.compare_exchange_weak( position, position + 1, std::memory_order_relaxed ) ) {
+					cell.value = value;
+					cell.sequence.store( position + 1, std::memory_order_release );
+					return( true );
+				}
+			} else if( difference < 0 ) { // full, the cell still holds a value from one lap ago
+				return( false );
+			} else {
+				position = queue->enqueue.load( std::memory_order_relaxed );
+			}
+		}
+	}
+
+	bool exo_queue_pop( exo_queue* queue, int64_t* value )
+	{
+		int64_t position = queue->dequeue.load( std::memory_order_relaxed );
+
+		for( ;; ) {
+			exo_queue::Cell& cell = queue->cells[ position & queue->mask ];
+			int64_t difference = cell.sequence.load( std::memory_order_acquire ) - ( position + 1 );
+
+			if( difference == 0 ) {
+				if( queue->dequeue.compare_exchange_weak( position, position + 1, std::memory_order_relaxed ) ) {
+					*value = cell.value;
+					cell.sequence.store( position + queue->mask + 1, std::memory_order_release );
+					return( true );
+				}
+			} else if( difference < 0 ) { // empty
+				return( false );
+			} else {
+				position = queue->dequeue.load( std::memory_order_relaxed );
+			}
+		}
+	}
+
+	exo_ring* exo_ring_create( int64_t capacity )
+	{
+		exo_ring* ring = create<exo_ring>();
+		ring->mask = getCapacity( capacity ) - 1;
+		ring->slots = static_cast<int64_t*>( Runtime::Allocate( sizeof( int64_t ) * ( ring->mask + 1 ), true ) );
+
+		return( ring );
+	}
+
+	/*
+	 * wait free as long as there is one producer and one consumer, each only writes its own index
+	 */
+	bool exo_ring_push( exo_ring* ring, int64_t value )
+	{
+		int64_t tail = ring->tail.load( std::memory_order_relaxed );
+
+		if( tail - ring->cachedHead > ring->mask ) {
+			ring->cachedHead = ring->head.load( std::memory_order_acquire );
+			if( tail - ring->cachedHead > ring->mask ) {
+				return( false );
+			}
+		}
+
+		ring->slots[ tail & ring->mask ] = value;
+		ring->tail.store( tail + 1, std::memory_order_release );
+
+		return( true );
+	}
+
+	bool exo_ring_pop( exo_ring* ring, int64_t* value )
+	{
+		int64_t head = ring->head.load( std::memory_order_relaxed );
+
+		if( head == ring->cachedTail ) {
+			ring->cachedTail = ring->tail.load( std::memory_order_acquire );
+			if( head == ring->cachedTail ) {
+				return( false );
+			}
+		}
+
+		*value = ring->slots[ head & ring->mask ];
+		ring->head.store( head + 1, std::memory_order_release );
+
+		return( true );
+	}
+
+	exo_map* exo_map_create( int64_t capacity )
+	{
+		exo_map* map = create<exo_map>();
+
+		// probe sequences stay short while the table is at most half full
+		map->mask = getCapacity( capacity * 2 ) - 1;
+		map->slots = static_cast<exo_map::Slot*>( Runtime::Allocate( sizeof( exo_map::Slot ) * ( map->mask + 1 ), true ) );
+
+		return( map );
+	}
+
+	bool exo_map_put( exo_map* map, int64_t key, int64_t value )
+	{
+		exo_map::Slot* slot = find( map, key, true );
+		if( slot == nullptr ) {
+			return( false );
+		}
+
+		slot->value.store( value, std::memory_order_relaxed );
+		if( slot->isPresent.exchange( 1, std::memory_order_acq_rel ) == 0 ) {
+			map->size.fetch_add( 1, std::memory_order_relaxed );
+		}
+
+		return( true );
+	}
+
+	bool exo_map_get( exo_map* map, int64_t key, int64_t* value )
+	{
+		exo_map::Slot* slot = find( map, key, false );
+		if( slot == nullptr || slot->isPresent.load( std::memory_order_acquire ) == 0 ) {
+			return( false );
+		}
+
+		*value = slot->value.load( std::memory_order_relaxed );
+		return( true );
+	}
+
+	// the slot stays claimed by its key, putting it again reuses it
+	bool exo_map_remove( exo_map* map, int64_t key )
+	{
+		exo_map::Slot* slot = find( map, key, false );
+		if( slot == nullptr || slot->isPresent.exchange( 0, std::memory_order_acq_rel ) == 0 ) {
+			return( false );
+		}
+
+		map->size.fetch_sub( 1, std::memory_order_relaxed );
+		return( true );
+	}
+
+	int64_t exo_map_size( exo_map* map )
+	{
+		return( map->size.load( std::memory_order_relaxed ) );
+	}
+}
@@ -0,0 +1,452 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "exo/exo.h"
+#include "exo/runtime/runtime.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifdef __linux__
+# include <sys/epoll.h>
+# include <sys/timerfd.h>
+#endif
+
+#define EXO_EVENT_READABLE		1
+#define EXO_EVENT_WRITABLE		2
+#define EXO_EVENT_CLOSED		4
+
+using exo::runtime::Runtime;
+
+/*
+ * file descriptors are watched edge triggered, an event is only reported once after they got ready. whoever handles it
+ * has to read, write or accept until that fails with -EAGAIN, or it is not reported again. epoll and timerfd are linux
+ * only, elsewhere no loop or timer can be created
+ */
+namespace
+{
+	int64_t getResult( int64_t result )
+	{
+		return( result < 0 ? -errno : result );
+	}
+
+	// other systems lack the flags to create sockets non-blocking right away
+	int64_t createSocket( int domain )
+	{
+#ifdef __linux__
+		return( getResult( ::socket( domain, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0 ) ) );
+#else
+		int file = ::socket( domain, SOCK_STREAM, 0 );
+		if( file >= 0 ) {
+			::fcntl( file, F_SETFL, ::fcntl( file, F_GETFL ) | O_NONBLOCK );
+			::fcntl( file, F_SETFD, FD_CLOEXEC );
+		}
+
+		return( getResult( file ) );
+#endif
+	}
+
+	bool setUnixAddress( sockaddr_un& address, const char* path )
+	{
+		std::memset( &address, 0, sizeof( address ) );
+		address.sun_family = AF_UNIX;
+
+		if( path == nullptr || std::strlen( path ) >= sizeof( address.sun_path ) ) {
+			return( false );
+		}
+
+		std::strcpy( address.sun_path, path );
+		return( true );
+	}
+
+	void setLoopbackAddress( sockaddr_in& address, int64_t port )
+	{
+		std::memset( &address, 0, sizeof( address ) );
+		address.sin_family = AF_INET;
+		address.sin_port = htons( static_cast<uint16_t>( port ) );
+		address.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+	}
+
+	int64_t listen( int64_t file, const sockaddr* address, socklen_t length, int64_t backlog )
+	{
+		if( file < 0 ) {
+			return( file );
+		}
+
+		if( ::bind( file, address, length ) < 0 || ::listen( file, backlog ) < 0 ) {
+			int error = errno;
+			::close( file );
+			return( -error );
+		}
+
+		return( file );
+	}
+
+	// non-blocking connects are still in progress when they return, the socket gets writable once they are done
+	int64_t connect( int64_t file, const sockaddr* address, socklen_t length )
+	{
+		if( file < 0 ) {
+			return( file );
+		}
+
+		if( ::connect( file, address, length ) < 0 && errno != EINPROGRESS ) {
+			int error = errno;
+			::close( file );
+			return( -error );
+		}
+
+		return( file );
+	}
+
+	void close( exo_epoll* loop )
+	{
+		if( loop->file >= 0 ) {
+			::close( loop->file );
+		}
+
+		loop->file = -1;
+		loop->count = 0;
+		loop->index = 0;
+	}
+
+#ifndef EXO_GC_DISABLE
+	void finalize( void* loop, void* )
+	{
+		close( static_cast<exo_epoll*>( loop ) );
+	}
+#endif
+}
+
+extern "C"
+{
+	exo_epoll* exo_epoll_create( int64_t capacity )
+	{
+#ifdef __linux__
+		int file = ::epoll_create1( EPOLL_CLOEXEC );
+		if( file < 0 ) {
+			return( nullptr );
+		}
+
+		exo_epoll* loop = static_cast<exo_epoll*>( Runtime::Allocate( sizeof( exo_epoll ), false ) );
+		loop->file = file;
+		loop->capacity = std::max<int64_t>( capacity, 1 );
+		loop->events = Runtime::Allocate( loop->capacity * sizeof( epoll_event ), true );
+
+#ifndef EXO_GC_DISABLE
+		GC_register_finalizer( loop, finalize, nullptr, nullptr, nullptr );
+#endif
+
+		return( loop );
+#else
+		return( nullptr );
+#endif
+	}
+
+	/*
+	 * watches a file descriptor for the given events, or changes what an already watched one is watched for. hangups and
+	 * errors are always reported
+	 */
+	bool exo_epoll_watch( exo_epoll* loop, int64_t file, bool isReadable, bool isWritable, int64_t data )
+	{
+#ifdef __linux__
+		if( loop == nullptr || loop->file < 0 ) {
+			return( false );
+		}
+
+		epoll_event event;
+		event.events = EPOLLET | EPOLLRDHUP;
+		event.data.u64 = data;
+
+		if( isReadable ) {
+			event.events |= EPOLLIN;
+		}
+		if( isWritable ) {
+			event.events |= EPOLLOUT;
+		}
+
+		if( ::epoll_ctl( loop->file, EPOLL_CTL_ADD, file, &event ) == 0 ) {
+			return( true );
+		}
+
+		return( errno == EEXIST && ::epoll_ctl( loop->file, EPOLL_CTL_MOD, file, &event ) == 0 );
+#else
+		return( false );
+#endif
+	}
+
+	// closing a file descriptor stops watching it as well
+	bool exo_epoll_unwatch( exo_epoll* loop, int64_t file )
+	{
+#ifdef __linux__
+		return( loop != nullptr && loop->file >= 0 && ::epoll_ctl( loop->file, EPOLL_CTL_DEL, file, nullptr ) == 0 );
+#else
+		return( false );
+#endif
+	}
+
+	/*
+	 * waits up to the timeout in milliseconds, or forever if it is negative, and returns the number of events. the events
+	 * buffer is reused by every wait, they are taken one after the other
+	 */
+	int64_t exo_epoll_wait( exo_epoll* loop, int64_t timeout )
+	{
+#ifdef __linux__
+		if( loop == nullptr || loop->file < 0 ) {
+			return( -EBADF );
+		}
+
+		int count = ::epoll_wait( loop->file, static_cast<epoll_event*>( loop->events ), loop->capacity, static_cast<int>( timeout ) );
+		if( count < 0 && errno != EINTR ) {
+			return( -errno );
+		}
+
+		loop->count = std::max( count, 0 );
+		loop->index = 0;
+		return( loop->count );
+#else
+		return( -ENOSYS );
+#endif
+	}
+
+	bool exo_epoll_next( exo_epoll* loop )
+	{
+#ifdef __linux__
+		if( loop == nullptr || loop->index >= loop->count ) {
+			return( false );
+		}
+
+		epoll_event& event = static_cast<epoll_event*>( loop->events )[ loop->index++ ];
+		loop->data = event.data.u64;
+		loop->flags = 0;
+		loop->flags |= ( event.events & EPOLLIN ) ? EXO_EVENT_READABLE : 0;
+		loop->flags |= ( event.events & EPOLLOUT ) ? EXO_EVENT_WRITABLE : 0;
+		loop->flags |= ( event.events & ( EPOLLRDHUP | EPOLLHUP | EPOLLERR ) ) ? EXO_EVENT_CLOSED : 0;
+		return( true );
+#else
+		return( false );
+#endif
+	}
+
+	int64_t exo_epoll_data( exo_epoll* loop )
+	{
+		return( loop == nullptr ? 0 : loop->data );
+	}
+
+	bool exo_epoll_is_readable( exo_epoll* loop )
+	{
+		return( loop != nullptr && ( loop->flags & EXO_EVENT_READABLE ) );
+	}
+
+	bool exo_epoll_is_writable( exo_epoll* loop )
+	{
+		return( loop != nullptr && ( loop->flags & EXO_EVENT_WRITABLE ) );
+	}
+
+	// the other side hung up or the descriptor failed, whatever is left can still be read
+	bool exo_epoll_is_closed( exo_epoll* loop )
+	{
+		return( loop != nullptr && ( loop->flags & EXO_EVENT_CLOSED ) );
+	}
+
+	// the loop itself gets readable once there are events, so async functions can await it like any other descriptor
+	int64_t exo_epoll_file( exo_epoll* loop )
+	{
+		return( loop == nullptr ? -1 : loop->file );
+	}
+
+	void exo_epoll_close( exo_epoll* loop )
+	{
+		if( loop == nullptr ) {
+			return;
+		}
+
+#ifndef EXO_GC_DISABLE
+		GC_register_finalizer( loop, nullptr, nullptr, nullptr, nullptr );
+#endif
+
+		close( loop );
+	}
+
+	/*
+	 * listening sockets, stale socket files left behind by a previous run are removed. a port of 0 picks a free one
+	 */
+	int64_t exo_socket_listen_unix( const char* path, int64_t backlog )
+	{
+		sockaddr_un address;
+		if( !setUnixAddress( address, path ) ) {
+			return( -ENAMETOOLONG );
+		}
+
+		::unlink( path );
+		return( listen( createSocket( AF_UNIX ), reinterpret_cast<sockaddr*>( &address ), sizeof( address ), backlog ) );
+	}
+
+	int64_t exo_socket_listen_tcp( int64_t port, int64_t backlog )
+	{
+		sockaddr_in address;
+		setLoopbackAddress( address, port );
+
+		int64_t file = createSocket( AF_INET );
+		if( file >= 0 ) {
+			int isEnabled = 1;
+			::setsockopt( file, SOL_SOCKET, SO_REUSEADDR, &isEnabled, sizeof( isEnabled ) );
+		}
+
+		return( listen( file, reinterpret_cast<sockaddr*>( &address ), sizeof( address ), backlog ) );
+	}
+
+	int64_t exo_socket_connect_unix( const char* path )
+	{
+		sockaddr_un address;
+		if( !setUnixAddress( address, path ) ) {
+			return( -ENAMETOOLONG );
+		}
+
+		return( connect( createSocket( AF_UNIX ), reinterpret_cast<sockaddr*>( &address ), sizeof( address ) ) );
+	}
+
+	int64_t exo_socket_connect_tcp( int64_t port )
+	{
+		sockaddr_in address;
+		setLoopbackAddress( address, port );
+
+		int64_t file = connect( createSocket( AF_INET ), reinterpret_cast<sockaddr*>( &address ), sizeof( address ) );
+		if( file >= 0 ) {
+			int isEnabled = 1;
+			::setsockopt( file, IPPROTO_TCP, TCP_NODELAY, &isEnabled, sizeof( isEnabled ) );
+		}
+
+		return( file );
+	}
+
+	int64_t exo_socket_port( int64_t file )
+	{
+		sockaddr_in address;
+		socklen_t length = sizeof( address );
+
+		if( ::getsockname( file, reinterpret_cast<sockaddr*>( &address ), &length ) < 0 ) {
+			return( -errno );
+		}
+
+		return( address.sin_family == AF_INET ? ntohs( address.sin_port ) : 0 );
+	}
+
+	// the next pending connection, non-blocking as well. -EAGAIN once there are no more
+	int64_t exo_socket_accept( int64_t file )
+	{
+		int64_t result;
+		do {
+#ifdef __linux__
+			result = ::accept4( file, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC );
+#else
+			result = ::accept( file, nullptr, nullptr );
+			if( result >= 0 ) {
+				::fcntl( result, F_SETFL, ::fcntl( result, F_GETFL ) | O_NONBLOCK );
+				::fcntl( result, F_SETFD, FD_CLOEXEC );
+			}
+#endif
+		} while( result < 0 && errno == EINTR );
+
+		return( getResult( result ) );
+	}
+
+	/*
+	 * reads into the buffer from the offset up to its length, so one buffer serves all reads of a connection. returns the
+	 * number of bytes read, 0 once the other side is done or -EAGAIN if there is nothing to read right now
+	 */
+	int64_t exo_socket_read( int64_t file, exo_array* buffer, int64_t offset )
+	{
+		if( offset < 0 || offset >= buffer->length ) {
+			return( -EINVAL );
+		}
+
+		int64_t result;
+		do {
+			result = ::read( file, static_cast<char*>( buffer->data ) + offset, buffer->length - offset );
+		} while( result < 0 && errno == EINTR );
+
+		return( getResult( result ) );
+	}
+
+	// writes the given part of the buffer, peers that went away result in -EPIPE instead of a signal
+	int64_t exo_socket_write( int64_t file, exo_array* buffer, int64_t offset, int64_t length )
+	{
+		if( offset < 0 || length < 0 || offset + length > buffer->length ) {
+			return( -EINVAL );
+		}
+
+		int64_t result;
+		do {
+			result = ::send( file, static_cast<char*>( buffer->data ) + offset, length, MSG_NOSIGNAL );
+		} while( result < 0 && errno == EINTR );
+
+		return( getResult( result ) );
+	}
+
+	int64_t exo_socket_close( int64_t file )
+	{
+		return( getResult( ::close( file ) ) );
+	}
+
+	/*
+	 * timers are file descriptors getting readable whenever they expired, watched like sockets. reading them returns how
+	 * often they expired since the last read
+	 */
+	int64_t exo_timer_create( int64_t milliseconds, bool isRepeating )
+	{
+#ifdef __linux__
+		int file = ::timerfd_create( CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC );
+		if( file < 0 ) {
+			return( -errno );
+		}
+
+		// a zero expiration would disarm it
+		milliseconds = std::max<int64_t>( milliseconds, 0 );
+		itimerspec time;
+		std::memset( &time, 0, sizeof( time ) );
+		time.it_value.tv_sec = milliseconds / 1000;
+		time.it_value.tv_nsec = milliseconds > 0 ? milliseconds % 1000 * 1000000 : 1;
+		if( isRepeating ) {
+			time.it_interval = time.it_value;
+		}
+
+		if( ::timerfd_settime( file, 0, &time, nullptr ) < 0 ) {
+			int error = errno;
+			::close( file );
+			return( -error );
+		}
+
+		return( file );
+#else
+		return( -ENOSYS );
+#endif
+	}
+
+	int64_t exo_timer_read( int64_t file )
+	{
+		uint64_t expirations;
+		int64_t result;
+		do {
+			result = ::read( file, &expirations, sizeof( expirations ) );
+		} while( result < 0 && errno == EINTR );
+
+		return( result < 0 ? -errno : static_cast<int64_t>( expirations ) );
+	}
+}
@@ -0,0 +1,206 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "exo/exo.h"
+#include "exo/runtime/runtime.h"
+
+#include <random>
+
+#define EXO_HASH_GROUP			16
+#define EXO_HASH_EMPTY			0x80
+#define EXO_HASH_DELETED		0xFE
+
+using exo::runtime::Runtime;
+
+/*
+ * a control byte per slot, either empty, deleted or the lower 7 bits of the hash of its key. the first group of control
+ * bytes is repeated after the last, so a group starting at any slot can be loaded at once. lookups and the insertion of
+ * new keys are generated inline, they have to match what is done here
+ */
+namespace
+{
+	uint64_t mix( uint64_t bits, uint64_t seed )
+	{
+		uint64_t hash = ( bits ^ seed ) * 0x9E3779B97F4A7C15ull;
+		return( hash ^ ( hash >> 32 ) );
+	}
+
+	uint64_t hash( exo_hash* map, void* slot )
+	{
+		if( map->keySize == 0 ) {
+			return( exo_hash_string( *static_cast<const char**>( slot ), map->seed ) );
+		} else if( map->keySize == 1 ) {
+			return( mix( *static_cast<uint8_t*>( slot ), map->seed ) );
+		}
+
+		uint64_t bits;
+		std::memcpy( &bits, slot, sizeof( bits ) );
+		return( mix( bits, map->seed ) );
+	}
+
+	void* getSlot( exo_hash* map, int64_t index )
+	{
+		return( static_cast<char*>( map->slots ) + index * map->slotSize );
+	}
+
+	void setControl( exo_hash* map, int64_t index, uint8_t control )
+	{
+		map->control[ index ] = control;
+		map->control[ ( ( index - ( EXO_HASH_GROUP - 1 ) ) & map->mask ) + EXO_HASH_GROUP - 1 ] = control;
+	}
+
+	// at most 7/8 of the slots are taken, so every probe sequence ends at an empty one
+	int64_t getGrowth( int64_t capacity )
+	{
+		return( capacity - capacity / 8 );
+	}
+
+	/*
+	 * the first empty or deleted slot along the probe sequence, both have their upper bit set
+	 */
+	int64_t findFree( exo_hash* map, uint64_t hash )
+	{
+		int64_t position = static_cast<int64_t>( hash >> 7 ) & map->mask;
+
+		for( int64_t stride = EXO_HASH_GROUP; ; stride += EXO_HASH_GROUP ) {
+			for( int64_t i = 0; i < EXO_HASH_GROUP; i++ ) {
+				if( map->control[ position + i ] & EXO_HASH_EMPTY ) {
+					return( ( position + i ) & map->mask );
+				}
+			}
+
+			position = ( position + stride ) & map->mask;
+		}
+	}
+
+	void allocate( exo_hash* map, int64_t capacity )
+	{
+		map->control = static_cast<uint8_t*>( Runtime::Allocate( capacity + EXO_HASH_GROUP, true ) );
+		map->slots = Runtime::Allocate( capacity * map->slotSize, map->isAtomic );
+		map->mask = capacity - 1;
+		map->growthLeft = getGrowth( capacity ) - map->size;
+
+		std::memset( map->control, EXO_HASH_EMPTY, capacity + EXO_HASH_GROUP );
+	}
+
+	/*
+	 * moves all keys into a new table, twice as large unless most of the used slots only hold deleted keys
+	 */
+	void rehash( exo_hash* map )
+	{
+		int64_t capacity = map->mask + 1;
+		uint8_t* control = map->control;
+		void* slots = map->slots;
+
+		allocate( map, map->size > getGrowth( capacity ) / 2 ? capacity * 2 : capacity );
+
+		for( int64_t i = 0; i < capacity; i++ ) {
+			if( control[ i ] & EXO_HASH_EMPTY ) {
+				continue;
+			}
+
+			void* slot = static_cast<char*>( slots ) + i * map->slotSize;
+			uint64_t hashed = hash( map, slot );
+			int64_t index = findFree( map, hashed );
+
+			setControl( map, index, hashed & 0x7F );
+			std::memcpy( getSlot( map, index ), slot, map->slotSize );
+		}
+	}
+}
+
+extern "C"
+{
+	exo_hash* exo_hash_new( int64_t capacity, int64_t slotSize, int64_t keySize, int64_t isAtomic )
+	{
+		static const uint64_t seed = std::random_device()();
+
+		exo_hash* map = static_cast<exo_hash*>( Runtime::Allocate( sizeof( exo_hash ), false ) );
+		map->seed = mix( reinterpret_cast<uintptr_t>( map ), seed );
+		map->size = 0;
+		map->slotSize = slotSize;
+		map->keySize = keySize;
+		map->isAtomic = isAtomic;
+
+		// room for the expected keys without growing, in whole groups
+		int64_t size = EXO_HASH_GROUP;
+		while( getGrowth( size ) < capacity ) {
+			size *= 2;
+		}
+
+		allocate( map, size );
+		return( map );
+	}
+
+	// strings cache the hash of their contents, it is mixed with the seed like all other keys
+	uint64_t exo_hash_string( const char* string, uint64_t seed )
+	{
+		return( mix( exo_string_hash( string ), seed ) );
+	}
+
+	// only called for keys not in the table yet
+	void* exo_hash_insert( exo_hash* map, uint64_t hash )
+	{
+		int64_t index = findFree( map, hash );
+
+		// reusing a deleted slot does not use up an empty one
+		if( map->control[ index ] == EXO_HASH_EMPTY ) {
+			if( map->growthLeft == 0 ) {
+				rehash( map );
+				index = findFree( map, hash );
+			}
+
+			map->growthLeft--;
+		}
+
+		setControl( map, index, hash & 0x7F );
+		map->size++;
+
+		return( getSlot( map, index ) );
+	}
+
+	/*
+	 * the slot is cleared, so the collector does not keep what it pointed to alive
+	 */
+	void exo_hash_erase( exo_hash* map, void* slot )
+	{
+		int64_t index = ( static_cast<char*>( slot ) - static_cast<char*>( map->slots ) ) / map->slotSize;
+
+		setControl( map, index, EXO_HASH_DELETED );
+		std::memset( slot, 0, map->slotSize );
+		map->size--;
+	}
+
+	void exo_hash_clear( exo_hash* map )
+	{
+		map->size = 0;
+		allocate( map, map->mask + 1 );
+	}
+
+	exo_array* exo_hash_collect( exo_hash* map, int64_t offset, int64_t size, int64_t isAtomic )
+	{
+		exo_array* array = exo_array_new( nullptr, 0, map->size, size, isAtomic );
+		char* element = static_cast<char*>( array->data );
+
+		for( int64_t i = 0; i <= map->mask; i++ ) {
+			if( ( map->control[ i ] & EXO_HASH_EMPTY ) == 0 ) {
+				std::memcpy( element, static_cast<char*>( getSlot( map, i ) ) + offset, size );
+				element += size;
+			}
+		}
+
+		return( array );
+	}
+}
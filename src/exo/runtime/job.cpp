@@ -0,0 +1,369 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "exo/exo.h"
+#include "exo/runtime/runtime.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#define EXO_JOB_DEQUE_SIZE		64
+#define EXO_JOB_SPINS			64
+#define EXO_LOOP_GRAINS			32
+#define EXO_LOOP_SPLITS			64
+
+using exo::runtime::Runtime;
+
+namespace
+{
+	/*
+	 * ring of a deque, only its owner grows it. thieves may still read the old one, it is left to the garbage collector
+	 */
+	struct Buffer
+	{
+		int64_t					mask;
+		std::atomic<exo_job*>	jobs[1];
+	};
+
+	/*
+	 * Chase-Lev deque, the owner pushes and pops at the bottom while thieves take from the top
+	 */
+	struct Worker
+	{
+		std::atomic<int64_t>	top;
+		std::atomic<int64_t>	bottom;
+		std::atomic<Buffer*>	buffer;
+	};
+
+	/*
+	 * iterations of a parallel loop split off for others to take, followed by their partial reductions
+	 */
+	struct Range
+	{
+		exo_job		job;
+		exo_loop*	loop;
+		int64_t		from;
+		int64_t		to;
+		int64_t		grain;
+		void*		partials;
+	};
+
+	// one worker per cpu, the thread spawning first is worker 0 and only works while joining
+	Worker*					workers = nullptr;
+	size_t					count = 0;
+	std::once_flag			started;
+	thread_local Worker*	current = nullptr;
+	thread_local uint64_t	seed = 0;
+
+	// never destroyed, detached workers may still sleep on them at exit
+	std::atomic<int64_t>		sleeping( 0 );
+	std::mutex*					lock = nullptr;
+	std::condition_variable*	wakeup = nullptr;
+
+	Buffer* createBuffer( int64_t size )
+	{
+		Buffer* buffer = static_cast<Buffer*>( Runtime::Allocate( sizeof( Buffer ) + ( size - 1 ) * sizeof( std::atomic<exo_job*> ), false ) );
+		buffer->mask = size - 1;
+
+		return( buffer );
+	}
+
+	void push( Worker& worker, exo_job* job )
+	{
+		int64_t bottom = worker.bottom.load( std::memory_order_relaxed );
+		int64_t top = worker.top.load( std::memory_order_acquire );
+		Buffer* buffer = worker.buffer.load( std::memory_order_relaxed );
+
+		if( bottom - top > buffer->mask ) {
+			Buffer* grown = createBuffer( ( buffer->mask + 1 ) * 2 );
+			for( int64_t i = top; i < bottom; i++ ) {
+				grown->jobs[ i & grown->mask ].store( buffer->jobs[ i & buffer->mask ].load( std::memory_order_relaxed ), std::memory_order_relaxed );
+			}
+
+			buffer = grown;
+			worker.buffer.store( buffer, std::memory_order_release );
+		}
+
+		buffer->jobs[ bottom & buffer->mask ].store( job, std::memory_order_relaxed );
+		std::atomic_thread_fence( std::memory_order_release );
+		worker.bottom.store( bottom + 1, std::memory_order_relaxed );
+	}
+
+	exo_job* pop( Worker& worker )
+	{
+		int64_t bottom = worker.bottom.load( std::memory_order_relaxed ) - 1;
+		Buffer* buffer = worker.buffer.load( std::memory_order_relaxed );
+
+		worker.bottom.store( bottom, std::memory_order_relaxed );
+		std::atomic_thread_fence( std::memory_order_seq_cst );
+		int64_t top = worker.top.load( std::memory_order_relaxed );
+
+		if( top > bottom ) {
+			worker.bottom.store( bottom + 1, std::memory_order_relaxed );
+			return( nullptr );
+		}
+
+		exo_job* job = buffer->jobs[ bottom & buffer->mask ].load( std::memory_order_relaxed );
+
+		// the last job, thieves may be after it as well
+		if( top == bottom ) {
+			if( !worker.top.compare_exchange_strong( top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) ) {
+				job = nullptr;
+			}
+
+			worker.bottom.store( bottom + 1, std::memory_order_relaxed );
+		}
+
+		return( job );
+	}
+
+	exo_job* steal( Worker& worker )
+	{
+		int64_t top = worker.top.load( std::memory_order_acquire );
+		std::atomic_thread_fence( std::memory_order_seq_cst );
+		int64_t bottom = worker.bottom.load( std::memory_order_acquire );
+
+		if( top >= bottom ) {
+			return( nullptr );
+		}
+
+		Buffer* buffer = worker.buffer.load( std::memory_order_acquire );
+		exo_job* job = buffer->jobs[ top & buffer->mask ].load( std::memory_order_relaxed );
+
+		if( !worker.top.compare_exchange_strong( top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) ) {
+			return( nullptr );
+		}
+
+		return( job );
+	}
+
+	/*
+	 * our own latest job first, it is the one still in cache. otherwise steal the oldest job of a random victim
+	 */
+	exo_job* find()
+	{
+		exo_job* job = pop( *current );
+
+		// xorshift, seeded by our worker so no two threads pick the same victims
+		if( seed == 0 ) {
+			seed = reinterpret_cast<uintptr_t>( current ) | 1;
+		}
+		seed ^= seed << 13;
+		seed ^= seed >> 7;
+		seed ^= seed << 17;
+
+		for( size_t i = 0; job == nullptr && i < count; i++ ) {
+			Worker& victim = workers[ ( seed + i ) % count ];
+			if( &victim != current ) {
+				job = steal( victim );
+			}
+		}
+
+		return( job );
+	}
+
+	bool isEmpty( Worker& worker )
+	{
+		return( worker.bottom.load( std::memory_order_relaxed ) <= worker.top.load( std::memory_order_relaxed ) );
+	}
+
+	bool isIdle()
+	{
+		for( size_t i = 0; i < count; i++ ) {
+			if( !isEmpty( workers[ i ] ) ) {
+				return( false );
+			}
+		}
+
+		return( true );
+	}
+
+	void run( exo_job* job )
+	{
+		job->run( job );
+		job->state.store( EXO_JOB_DONE, std::memory_order_release );
+	}
+
+	void work( Worker* worker )
+	{
+#ifndef EXO_GC_DISABLE
+		// allocations stay thread local, collections have to stop and scan us as well
+		GC_stack_base base;
+		GC_get_stack_base( &base );
+		GC_register_my_thread( &base );
+#endif
+		current = worker;
+
+		for( int spins = 0; ; ) {
+			exo_job* job = find();
+			if( job != nullptr ) {
+				run( job );
+				spins = 0;
+				continue;
+			}
+
+			// jobs tend to come in bursts, so look again for a while before going to sleep
+			if( ++spins < EXO_JOB_SPINS ) {
+				std::this_thread::yield();
+				continue;
+			}
+			spins = 0;
+
+			std::unique_lock<std::mutex> guard( *lock );
+			sleeping.fetch_add( 1, std::memory_order_seq_cst );
+			std::atomic_thread_fence( std::memory_order_seq_cst );
+
+			if( isIdle() ) {
+				wakeup->wait( guard );
+			}
+
+			sleeping.fetch_sub( 1, std::memory_order_relaxed );
+		}
+	}
+
+	void start()
+	{
+		count = std::max( std::thread::hardware_concurrency(), 1u );
+		workers = static_cast<Worker*>( Runtime::Allocate( sizeof( Worker ) * count, false ) );
+
+		for( size_t i = 0; i < count; i++ ) {
+			workers[ i ].top.store( 0, std::memory_order_relaxed );
+			workers[ i ].bottom.store( 0, std::memory_order_relaxed );
+			workers[ i ].buffer.store( createBuffer( EXO_JOB_DEQUE_SIZE ), std::memory_order_relaxed );
+		}
+
+		lock = new std::mutex();
+		wakeup = new std::condition_variable();
+
+		current = &workers[ 0 ];
+		for( size_t i = 1; i < count; i++ ) {
+			std::thread( work, &workers[ i ] ).detach();
+		}
+	}
+
+	// false for threads we do not know, i.e. calling back from native code
+	bool enter()
+	{
+		if( current == nullptr ) {
+			std::call_once( started, start );
+		}
+
+		return( current != nullptr );
+	}
+
+	void schedule( exo_job* job )
+	{
+		push( *current, job );
+
+		// pairs with the fence of a worker going to sleep, either it sees our job or we see it sleeping
+		std::atomic_thread_fence( std::memory_order_seq_cst );
+		if( sleeping.load( std::memory_order_relaxed ) > 0 ) {
+			std::lock_guard<std::mutex> guard( *lock );
+			wakeup->notify_one();
+		}
+	}
+
+	void iterate( exo_loop* loop, int64_t from, int64_t to, int64_t grain, void* partials );
+
+	void runRange( exo_job* job )
+	{
+		Range* range = reinterpret_cast<Range*>( job );
+		iterate( range->loop, range->from, range->to, range->grain, range->partials );
+	}
+
+	/*
+	 * lazy binary splitting, the second half of what is left is only handed out while our deque is empty, i.e. all we
+	 * split off before has been taken. otherwise we keep going a grain at a time, so the parts adapt to how busy the
+	 * workers are instead of being fixed up front
+	 */
+	void iterate( exo_loop* loop, int64_t from, int64_t to, int64_t grain, void* partials )
+	{
+		Range* ranges[ EXO_LOOP_SPLITS ];
+		int splits = 0;
+
+		while( from < to ) {
+			if( to - from > grain && splits < EXO_LOOP_SPLITS && isEmpty( *current ) ) {
+				Range* range = static_cast<Range*>( Runtime::Allocate( sizeof( Range ) + loop->size, false ) );
+				range->job.run = runRange;
+				range->job.state.store( 0, std::memory_order_relaxed );
+				range->loop = loop;
+				range->from = from + ( to - from ) / 2;
+				range->to = to;
+				range->grain = grain;
+				range->partials = range + 1;
+				std::memcpy( range->partials, loop->identity, loop->size );
+
+				schedule( &range->job );
+				ranges[ splits++ ] = range;
+				to = range->from;
+				continue;
+			}
+
+			int64_t end = std::min( from + grain, to );
+			loop->body( loop->context, partials, from, end );
+			from = end;
+		}
+
+		// the range split off last continues right after ours
+		while( splits > 0 ) {
+			Range* range = ranges[ --splits ];
+			exo_job_join( &range->job );
+
+			if( loop->size > 0 ) {
+				loop->combine( partials, range->partials );
+			}
+		}
+	}
+}
+
+extern "C"
+{
+	void exo_job_spawn( exo_job* job )
+	{
+		if( !enter() ) {
+			run( job );
+			return;
+		}
+
+		schedule( job );
+	}
+
+	void exo_job_join( exo_job* job )
+	{
+		// rather than blocking, run other jobs until ours is done. more often than not we end up running it ourselves
+		while( job->state.load( std::memory_order_acquire ) != EXO_JOB_DONE ) {
+			exo_job* next = current != nullptr ? find() : nullptr;
+
+			if( next != nullptr ) {
+				run( next );
+			} else {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	void exo_parallel_for( exo_loop* loop, int64_t iterations, void* partials )
+	{
+		if( !enter() ) {
+			loop->body( loop->context, partials, 0, iterations );
+			return;
+		}
+
+		// small enough to balance the load, large enough to keep the checks for idle workers cheap
+		int64_t grain = std::max<int64_t>( iterations / static_cast<int64_t>( count * EXO_LOOP_GRAINS ), 1 );
+		iterate( loop, 0, iterations, grain, partials );
+	}
+}
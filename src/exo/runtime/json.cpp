@@ -0,0 +1,1126 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "exo/exo.h"
+#include "exo/runtime/runtime.h"
+
+#include <climits>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef __SSE2__
+# include <emmintrin.h>
+#endif
+#if defined( __x86_64__ ) && defined( __GNUC__ )
+# include <wmmintrin.h>
+# define EXO_JSON_PCLMUL
+#endif
+
+#define EXO_JSON_BLOCK			64
+
+#define EXO_JSON_NULL			0
+#define EXO_JSON_BOOL			1
+#define EXO_JSON_NUMBER			2
+#define EXO_JSON_STRING			3
+#define EXO_JSON_ARRAY			4
+#define EXO_JSON_OBJECT			5
+
+#define EXO_JSON_END			0
+#define EXO_JSON_OBJECT_START	1
+#define EXO_JSON_OBJECT_END		2
+#define EXO_JSON_ARRAY_START	3
+#define EXO_JSON_ARRAY_END		4
+#define EXO_JSON_KEY			5
+#define EXO_JSON_STRING_VALUE	6
+#define EXO_JSON_NUMBER_VALUE	7
+#define EXO_JSON_TRUE			8
+#define EXO_JSON_FALSE			9
+#define EXO_JSON_NULL_VALUE		10
+
+using exo::runtime::Runtime;
+
+/*
+ * documents are parsed in two stages like simdjson does. the first classifies 64 bytes at a time into bit masks and
+ * collects the positions of all structural characters, the opening quotes of strings and the first characters of other
+ * scalars into an index. the second only walks that index, checks the grammar and links every bracket to its match.
+ * values are the positions in the index, nothing of them is converted until it is asked for, and skipping a container
+ * is a single lookup
+ */
+namespace
+{
+	struct Masks
+	{
+		uint64_t	quotes;
+		uint64_t	backslashes;
+		uint64_t	operators;
+		uint64_t	whitespace;
+		uint64_t	controls;
+	};
+
+	// what one block leaves for the next
+	struct Carry
+	{
+		uint64_t	isEscaped;
+		uint64_t	inString;
+		uint64_t	isBoundary;
+	};
+
+	enum State
+	{
+		EXPECT_VALUE,
+		EXPECT_VALUE_OR_CLOSE,
+		EXPECT_KEY,
+		EXPECT_KEY_OR_CLOSE,
+		EXPECT_COLON,
+		EXPECT_COMMA_OR_CLOSE
+	};
+
+#ifdef __SSE2__
+	uint64_t getMask( __m128i matches, int part )
+	{
+		return( static_cast<uint64_t>( static_cast<uint32_t>( _mm_movemask_epi8( matches ) ) ) << ( part * 16 ) );
+	}
+
+	Masks classify( const char* block )
+	{
+		Masks masks = { 0, 0, 0, 0, 0 };
+
+		for( int part = 0; part < 4; part++ ) {
+			__m128i characters = _mm_loadu_si128( reinterpret_cast<const __m128i*>( block + part * 16 ) );
+
+			// brackets and braces only differ in one bit
+			__m128i lowered = _mm_or_si128( characters, _mm_set1_epi8( 0x20 ) );
+			__m128i operators = _mm_or_si128(
+				_mm_or_si128( _mm_cmpeq_epi8( lowered, _mm_set1_epi8( '{' ) ), _mm_cmpeq_epi8( lowered, _mm_set1_epi8( '}' ) ) ),
+				_mm_or_si128( _mm_cmpeq_epi8( characters, _mm_set1_epi8( ':' ) ), _mm_cmpeq_epi8( characters, _mm_set1_epi8( ',' ) ) ) );
+			__m128i whitespace = _mm_or_si128(
+				_mm_or_si128( _mm_cmpeq_epi8( characters, _mm_set1_epi8( ' ' ) ), _mm_cmpeq_epi8( characters, _mm_set1_epi8( '\t' ) ) ),
+				_mm_or_si128( _mm_cmpeq_epi8( characters, _mm_set1_epi8( '\n' ) ), _mm_cmpeq_epi8( characters, _mm_set1_epi8( '\r' ) ) ) );
+
+			masks.quotes |= getMask( _mm_cmpeq_epi8( characters, _mm_set1_epi8( '"' ) ), part );
+			masks.backslashes |= getMask( _mm_cmpeq_epi8( characters, _mm_set1_epi8( '\\' ) ), part );
+			masks.operators |= getMask( operators, part );
+			masks.whitespace |= getMask( whitespace, part );
+			masks.controls |= getMask( _mm_cmpeq_epi8( _mm_max_epu8( characters, _mm_set1_epi8( 0x1F ) ), _mm_set1_epi8( 0x1F ) ), part );
+		}
+
+		return( masks );
+	}
+#else
+	Masks classify( const char* block )
+	{
+		Masks masks = { 0, 0, 0, 0, 0 };
+
+		for( int i = 0; i < EXO_JSON_BLOCK; i++ ) {
+			uint64_t bit = 1ull << i;
+
+			switch( block[ i ] ) {
+				case '"':
+					masks.quotes |= bit;
+					break;
+				case '\\':
+					masks.backslashes |= bit;
+					break;
+				case '{': case '}': case '[': case ']': case ':': case ',':
+					masks.operators |= bit;
+					break;
+				case ' ': case '\t': case '\n': case '\r':
+					masks.whitespace |= bit;
+					break;
+			}
+
+			if( static_cast<uint8_t>( block[ i ] ) < 0x20 ) {
+				masks.controls |= bit;
+			}
+		}
+
+		return( masks );
+	}
+#endif
+
+#ifdef EXO_JSON_PCLMUL
+	// a carry-less multiplication with all ones xors every bit into all bits above it
+	__attribute__(( target( "pclmul" ) )) uint64_t getPrefixXorMultiplied( uint64_t bits )
+	{
+		return( _mm_cvtsi128_si64( _mm_clmulepi64_si128( _mm_set_epi64x( 0, bits ), _mm_set1_epi8( -1 ), 0 ) ) );
+	}
+
+	bool hasCarrylessMultiply()
+	{
+		static bool isSupported = ( __builtin_cpu_init(), __builtin_cpu_supports( "pclmul" ) );
+		return( isSupported );
+	}
+#endif
+
+	// every bit becomes the parity of itself and all bits below it, i.e. whether it is between an odd number of quotes
+	uint64_t getPrefixXor( uint64_t bits )
+	{
+#ifdef EXO_JSON_PCLMUL
+		if( hasCarrylessMultiply() ) {
+			return( getPrefixXorMultiplied( bits ) );
+		}
+#endif
+
+		bits ^= bits << 1;
+		bits ^= bits << 2;
+		bits ^= bits << 4;
+		bits ^= bits << 8;
+		bits ^= bits << 16;
+		bits ^= bits << 32;
+		return( bits );
+	}
+
+	/*
+	 * characters following an odd run of backslashes are escaped. backslashes are rare enough to simply go through them
+	 * one by one, a backslash escaped itself escapes nothing
+	 */
+	uint64_t getEscaped( uint64_t backslashes, Carry& carry )
+	{
+		uint64_t isEscaped = carry.isEscaped;
+		carry.isEscaped = 0;
+
+		while( backslashes != 0 ) {
+			int bit = __builtin_ctzll( backslashes );
+			backslashes &= backslashes - 1;
+
+			if( ( isEscaped >> bit ) & 1 ) {
+				continue;
+			} else if( bit == EXO_JSON_BLOCK - 1 ) {
+				carry.isEscaped = 1;
+			} else {
+				isEscaped |= 2ull << bit;
+			}
+		}
+
+		return( isEscaped );
+	}
+
+	bool isDigit( char character )
+	{
+		return( character >= '0' && character <= '9' );
+	}
+
+	int getHexDigit( char character )
+	{
+		if( isDigit( character ) ) {
+			return( character - '0' );
+		} else if( ( character | 0x20 ) >= 'a' && ( character | 0x20 ) <= 'f' ) {
+			return( ( character | 0x20 ) - 'a' + 10 );
+		}
+
+		return( -1 );
+	}
+
+	// the characters following a backslash, \u takes four hex digits. returns where an invalid one is, or -1
+	int64_t checkEscapes( exo_json* json, int64_t position, uint64_t isEscaped )
+	{
+		while( isEscaped != 0 ) {
+			int64_t escape = position + __builtin_ctzll( isEscaped );
+			isEscaped &= isEscaped - 1;
+
+			switch( json->text[ escape ] ) {
+				case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+					break;
+				case 'u':
+					for( int64_t i = escape + 1; i <= escape + 4; i++ ) {
+						if( i >= json->length || getHexDigit( json->text[ i ] ) < 0 ) {
+							return( escape );
+						}
+					}
+					break;
+				default:
+					return( escape );
+			}
+		}
+
+		return( -1 );
+	}
+
+	void reserve( exo_json* json, int64_t count )
+	{
+		if( count <= json->capacity ) {
+			return;
+		}
+
+		int64_t capacity = std::max<int64_t>( count, json->capacity * 2 );
+		uint32_t* index = static_cast<uint32_t*>( Runtime::Allocate( capacity * sizeof( uint32_t ), true ) );
+		uint32_t* links = static_cast<uint32_t*>( Runtime::Allocate( capacity * sizeof( uint32_t ), true ) );
+
+		if( json->count > 0 ) {
+			std::memcpy( index, json->index, json->count * sizeof( uint32_t ) );
+		}
+
+		json->index = index;
+		json->links = links;
+		json->capacity = capacity;
+	}
+
+	/*
+	 * the first stage. returns false for unterminated strings or control characters in them
+	 */
+	bool index( exo_json* json )
+	{
+		Carry carry = { 0, 0, 1 };
+		char padded[ EXO_JSON_BLOCK ];
+
+		for( int64_t position = 0; position < json->length; position += EXO_JSON_BLOCK ) {
+			const char* block = json->text + position;
+
+			// the last block is padded with whitespace, which never is structural
+			if( json->length - position < EXO_JSON_BLOCK ) {
+				std::memset( padded, ' ', EXO_JSON_BLOCK );
+				std::memcpy( padded, block, json->length - position );
+				block = padded;
+			}
+
+			Masks masks = classify( block );
+			uint64_t isEscaped = getEscaped( masks.backslashes, carry );
+			uint64_t quotes = masks.quotes & ~isEscaped;
+			uint64_t inString = getPrefixXor( quotes ) ^ carry.inString;
+			carry.inString = static_cast<uint64_t>( static_cast<int64_t>( inString ) >> 63 );
+
+			if( masks.controls & inString ) {
+				json->error = position + __builtin_ctzll( masks.controls & inString );
+				return( false );
+			} else if( isEscaped != 0 && ( json->error = checkEscapes( json, position, isEscaped & inString ) ) >= 0 ) {
+				return( false );
+			}
+
+			// scalars start after whitespace, operators or the end of a string
+			uint64_t operators = masks.operators & ~inString;
+			uint64_t boundaries = masks.whitespace | operators | ( quotes & ~inString );
+			uint64_t starts = ~( masks.whitespace | masks.operators | masks.quotes | inString ) & ( ( boundaries << 1 ) | carry.isBoundary );
+			uint64_t structurals = operators | ( quotes & inString ) | starts;
+			carry.isBoundary = boundaries >> 63;
+
+			reserve( json, json->count + __builtin_popcountll( structurals ) + 1 );
+			while( structurals != 0 ) {
+				json->index[ json->count++ ] = static_cast<uint32_t>( position + __builtin_ctzll( structurals ) );
+				structurals &= structurals - 1;
+			}
+		}
+
+		if( carry.inString ) {
+			json->error = json->length;
+			return( false );
+		}
+
+		// the end of the text follows the last entry, so every entry has a next one
+		reserve( json, json->count + 1 );
+		json->index[ json->count ] = static_cast<uint32_t>( json->length );
+		return( true );
+	}
+
+	char getCharacter( exo_json* json, int64_t entry )
+	{
+		return( entry >= 0 && entry < json->count ? json->text[ json->index[ entry ] ] : '\0' );
+	}
+
+	int64_t getTokenEnd( exo_json* json, int64_t position )
+	{
+		while( position < json->length ) {
+			switch( json->text[ position ] ) {
+				case ' ': case '\t': case '\n': case '\r': case ',': case ':': case ']': case '}': case '"':
+					return( position );
+			}
+
+			position++;
+		}
+
+		return( position );
+	}
+
+	bool isNumber( const char* token, int64_t length )
+	{
+		int64_t i = token[ 0 ] == '-' ? 1 : 0;
+		int64_t start = i;
+
+		if( i < length && token[ i ] == '0' ) {
+			i++;
+		} else {
+			while( i < length && isDigit( token[ i ] ) ) {
+				i++;
+			}
+		}
+		if( i == start ) {
+			return( false );
+		}
+
+		if( i < length && token[ i ] == '.' ) {
+			start = ++i;
+			while( i < length && isDigit( token[ i ] ) ) {
+				i++;
+			}
+			if( i == start ) {
+				return( false );
+			}
+		}
+
+		if( i < length && ( token[ i ] == 'e' || token[ i ] == 'E' ) ) {
+			i++;
+			if( i < length && ( token[ i ] == '+' || token[ i ] == '-' ) ) {
+				i++;
+			}
+
+			start = i;
+			while( i < length && isDigit( token[ i ] ) ) {
+				i++;
+			}
+			if( i == start ) {
+				return( false );
+			}
+		}
+
+		return( i == length );
+	}
+
+	bool isScalar( exo_json* json, int64_t entry )
+	{
+		const char* token = json->text + json->index[ entry ];
+		int64_t length = getTokenEnd( json, json->index[ entry ] ) - json->index[ entry ];
+
+		switch( token[ 0 ] ) {
+			case 't':
+				return( length == 4 && std::memcmp( token, "true", 4 ) == 0 );
+			case 'f':
+				return( length == 5 && std::memcmp( token, "false", 5 ) == 0 );
+			case 'n':
+				return( length == 4 && std::memcmp( token, "null", 4 ) == 0 );
+			default:
+				return( isNumber( token, length ) );
+		}
+	}
+
+	/*
+	 * the second stage. open containers form a stack through the links, every container links to its match once closed
+	 */
+	bool validate( exo_json* json )
+	{
+		State state = EXPECT_VALUE;
+		int64_t open = -1;
+
+		for( int64_t entry = 0; entry < json->count; entry++ ) {
+			char character = json->text[ json->index[ entry ] ];
+			bool isValid = true;
+
+			switch( state ) {
+				case EXPECT_VALUE_OR_CLOSE:
+					if( character == ']' ) {
+						state = EXPECT_COMMA_OR_CLOSE;
+						entry--;
+						break;
+					}
+					// fall through
+				case EXPECT_VALUE:
+					if( character == '{' || character == '[' ) {
+						json->links[ entry ] = static_cast<uint32_t>( open );
+						open = entry;
+						state = character == '{' ? EXPECT_KEY_OR_CLOSE : EXPECT_VALUE_OR_CLOSE;
+					} else if( character == '"' || isScalar( json, entry ) ) {
+						state = EXPECT_COMMA_OR_CLOSE;
+					} else {
+						isValid = false;
+					}
+					break;
+				case EXPECT_KEY_OR_CLOSE:
+				case EXPECT_KEY:
+					if( character == '"' ) {
+						state = EXPECT_COLON;
+					} else if( character == '}' && state == EXPECT_KEY_OR_CLOSE ) {
+						state = EXPECT_COMMA_OR_CLOSE;
+						entry--;
+					} else {
+						isValid = false;
+					}
+					break;
+				case EXPECT_COLON:
+					isValid = character == ':';
+					state = EXPECT_VALUE;
+					break;
+				case EXPECT_COMMA_OR_CLOSE:
+					if( open < 0 ) {
+						isValid = false;
+					} else if( character == ',' ) {
+						state = json->text[ json->index[ open ] ] == '{' ? EXPECT_KEY : EXPECT_VALUE;
+					} else if( character == ( json->text[ json->index[ open ] ] == '{' ? '}' : ']' ) ) {
+						int64_t parent = static_cast<int32_t>( json->links[ open ] );
+						json->links[ open ] = static_cast<uint32_t>( entry );
+						open = parent;
+					} else {
+						isValid = false;
+					}
+					break;
+			}
+
+			if( !isValid ) {
+				json->error = json->index[ entry ];
+				return( false );
+			}
+		}
+
+		if( json->count == 0 || open >= 0 || state != EXPECT_COMMA_OR_CLOSE ) {
+			json->error = json->length;
+			return( false );
+		}
+
+		return( true );
+	}
+
+	bool isContainer( exo_json* json, int64_t value )
+	{
+		char character = getCharacter( json, value );
+		return( character == '{' || character == '[' );
+	}
+
+	bool isValue( exo_json* json, int64_t value )
+	{
+		return( json != nullptr && json->error < 0 && value >= 0 && value < json->count );
+	}
+
+	// the entry right after a value
+	int64_t skip( exo_json* json, int64_t value )
+	{
+		return( isContainer( json, value ) ? json->links[ value ] + 1 : value + 1 );
+	}
+
+	// the end of the string starting at the quote, after a backslash comes at least one more character
+	int64_t getStringEnd( exo_json* json, int64_t position, bool& hasEscapes )
+	{
+		hasEscapes = false;
+
+		for( position++; json->text[ position ] != '"'; position++ ) {
+			if( json->text[ position ] == '\\' ) {
+				hasEscapes = true;
+				position++;
+			}
+		}
+
+		return( position );
+	}
+
+	int64_t getHex( const char* digits, const char* end )
+	{
+		if( end - digits < 4 ) {
+			return( -1 );
+		}
+
+		int64_t code = 0;
+		for( int i = 0; i < 4; i++ ) {
+			int digit = getHexDigit( digits[ i ] );
+			if( digit < 0 ) {
+				return( -1 );
+			}
+
+			code = code * 16 + digit;
+		}
+
+		return( code );
+	}
+
+	/*
+	 * unescapes the characters between start and end into destination, which has room for as many. escapes never take
+	 * more room than they are written in, invalid ones are replaced by U+FFFD
+	 */
+	int64_t unescape( const char* start, const char* end, char* destination )
+	{
+		char* written = destination;
+
+		while( start < end ) {
+			if( *start != '\\' ) {
+				*written++ = *start++;
+				continue;
+			}
+
+			char escape = start[ 1 ];
+			start += 2;
+
+			int64_t code = 0xFFFD;
+			switch( escape ) {
+				case 'b': code = '\b'; break;
+				case 'f': code = '\f'; break;
+				case 'n': code = '\n'; break;
+				case 'r': code = '\r'; break;
+				case 't': code = '\t'; break;
+				case '"': case '\\': case '/': code = escape; break;
+				case 'u':
+					code = getHex( start, end );
+					if( code < 0 ) {
+						code = 0xFFFD;
+						break;
+					}
+
+					start += 4;
+					if( code >= 0xD800 && code < 0xDC00 && end - start >= 6 && start[ 0 ] == '\\' && start[ 1 ] == 'u' ) {
+						int64_t low = getHex( start + 2, end );
+						if( low >= 0xDC00 && low < 0xE000 ) {
+							code = 0x10000 + ( ( code - 0xD800 ) << 10 ) + ( low - 0xDC00 );
+							start += 6;
+						}
+					}
+					if( code >= 0xD800 && code < 0xE000 ) {
+						code = 0xFFFD;
+					}
+					break;
+			}
+
+			if( code < 0x80 ) {
+				*written++ = static_cast<char>( code );
+			} else if( code < 0x800 ) {
+				*written++ = static_cast<char>( 0xC0 | ( code >> 6 ) );
+				*written++ = static_cast<char>( 0x80 | ( code & 0x3F ) );
+			} else if( code < 0x10000 ) {
+				*written++ = static_cast<char>( 0xE0 | ( code >> 12 ) );
+				*written++ = static_cast<char>( 0x80 | ( ( code >> 6 ) & 0x3F ) );
+				*written++ = static_cast<char>( 0x80 | ( code & 0x3F ) );
+			} else {
+				*written++ = static_cast<char>( 0xF0 | ( code >> 18 ) );
+				*written++ = static_cast<char>( 0x80 | ( ( code >> 12 ) & 0x3F ) );
+				*written++ = static_cast<char>( 0x80 | ( ( code >> 6 ) & 0x3F ) );
+				*written++ = static_cast<char>( 0x80 | ( code & 0x3F ) );
+			}
+		}
+
+		return( written - destination );
+	}
+
+	int64_t getStringLength( const char* string )
+	{
+		return( reinterpret_cast<const exo_string*>( string - offsetof( exo_string, data ) )->length );
+	}
+
+	// where the text of a value ends
+	int64_t getValueEnd( exo_json* json, int64_t value )
+	{
+		bool hasEscapes;
+
+		if( isContainer( json, value ) ) {
+			return( json->index[ json->links[ value ] ] + 1 );
+		} else if( getCharacter( json, value ) == '"' ) {
+			return( getStringEnd( json, json->index[ value ], hasEscapes ) + 1 );
+		}
+
+		return( getTokenEnd( json, json->index[ value ] ) );
+	}
+
+	// keys without escapes are compared where they are
+	bool isKey( exo_json* json, int64_t entry, const char* key, int64_t length )
+	{
+		bool hasEscapes;
+		int64_t start = json->index[ entry ] + 1;
+		int64_t end = getStringEnd( json, json->index[ entry ], hasEscapes );
+
+		if( !hasEscapes ) {
+			return( end - start == length && std::memcmp( json->text + start, key, length ) == 0 );
+		} else if( end - start < length ) {
+			return( false );
+		}
+
+		char* unescaped = static_cast<char*>( Runtime::Allocate( end - start, true ) );
+		return( unescape( json->text + start, json->text + end, unescaped ) == length && std::memcmp( unescaped, key, length ) == 0 );
+	}
+
+	int64_t parse( exo_json* json, const void* source, const char* text, int64_t length )
+	{
+		json->source = source;
+		json->text = text;
+		json->length = length;
+		json->count = 0;
+		json->error = -1;
+		json->cursor = 0;
+		json->current = -1;
+
+		if( text == nullptr || length >= UINT32_MAX ) {
+			json->error = 0;
+		} else if( index( json ) ) {
+			validate( json );
+		}
+
+		return( json->error < 0 );
+	}
+
+	/*
+	 * the writer builds a string in place, it only ever copies it to grow
+	 */
+	void grow( exo_json_writer* writer, int64_t length )
+	{
+		if( writer->string != nullptr && writer->length + length <= writer->capacity ) {
+			return;
+		}
+
+		int64_t capacity = std::max( std::max( writer->capacity * 2, writer->initial ), writer->length + length );
+		exo_string* string = static_cast<exo_string*>( Runtime::Allocate( offsetof( exo_string, data ) + capacity + 1, true ) );
+		if( writer->string != nullptr ) {
+			std::memcpy( string->data, writer->string->data, writer->length );
+		}
+
+		writer->string = string;
+		writer->capacity = capacity;
+	}
+
+	void write( exo_json_writer* writer, const char* data, int64_t length )
+	{
+		grow( writer, length );
+		std::memcpy( writer->string->data + writer->length, data, length );
+		writer->length += length;
+	}
+
+	void writeCharacter( exo_json_writer* writer, char character )
+	{
+		grow( writer, 1 );
+		writer->string->data[ writer->length++ ] = character;
+	}
+
+	// the separator in front of a value, unless it follows a key or is the first one in its container
+	void separate( exo_json_writer* writer )
+	{
+		if( writer->isAfterKey ) {
+			writer->isAfterKey = false;
+			return;
+		}
+
+		if( writer->depth < EXO_JSON_WRITER_DEPTH ) {
+			uint64_t bit = 1ull << ( writer->depth % 64 );
+			if( writer->hasElements[ writer->depth / 64 ] & bit ) {
+				writeCharacter( writer, ',' );
+			}
+
+			writer->hasElements[ writer->depth / 64 ] |= bit;
+		}
+	}
+
+	void open( exo_json_writer* writer, char bracket )
+	{
+		separate( writer );
+		writeCharacter( writer, bracket );
+
+		writer->depth++;
+		if( writer->depth < EXO_JSON_WRITER_DEPTH ) {
+			writer->hasElements[ writer->depth / 64 ] &= ~( 1ull << ( writer->depth % 64 ) );
+		}
+	}
+
+	void close( exo_json_writer* writer, char bracket )
+	{
+		writeCharacter( writer, bracket );
+		writer->depth = std::max<int64_t>( writer->depth - 1, 0 );
+		writer->isAfterKey = false;
+	}
+
+	// runs of characters that need no escaping are copied at once
+	void writeString( exo_json_writer* writer, const char* string )
+	{
+		static const char hex[] = "0123456789abcdef";
+
+		int64_t length = string == nullptr ? 0 : getStringLength( string );
+		grow( writer, length + 2 );
+		writeCharacter( writer, '"' );
+
+		int64_t start = 0;
+		for( int64_t i = 0; i < length; i++ ) {
+			uint8_t character = static_cast<uint8_t>( string[ i ] );
+			if( character >= 0x20 && character != '"' && character != '\\' ) {
+				continue;
+			}
+
+			write( writer, string + start, i - start );
+			start = i + 1;
+
+			char escape[ 6 ] = { '\\', 'u', '0', '0', hex[ character >> 4 ], hex[ character & 0xF ] };
+			switch( character ) {
+				case '"': case '\\': escape[ 1 ] = character; write( writer, escape, 2 ); break;
+				case '\n': escape[ 1 ] = 'n'; write( writer, escape, 2 ); break;
+				case '\r': escape[ 1 ] = 'r'; write( writer, escape, 2 ); break;
+				case '\t': escape[ 1 ] = 't'; write( writer, escape, 2 ); break;
+				case '\b': escape[ 1 ] = 'b'; write( writer, escape, 2 ); break;
+				case '\f': escape[ 1 ] = 'f'; write( writer, escape, 2 ); break;
+				default: write( writer, escape, 6 ); break;
+			}
+		}
+
+		write( writer, string + start, length - start );
+		writeCharacter( writer, '"' );
+	}
+}
+
+extern "C"
+{
+	exo_json* exo_json_create()
+	{
+		exo_json* json = static_cast<exo_json*>( Runtime::Allocate( sizeof( exo_json ), false ) );
+		json->error = 0;
+		return( json );
+	}
+
+	/*
+	 * parses the string or bytes, reusing the index of the previous document. strings and bytes are not copied, they have
+	 * to stay unchanged while the document is used
+	 */
+	bool exo_json_parse( exo_json* json, const char* text )
+	{
+		return( parse( json, text, text, text == nullptr ? 0 : getStringLength( text ) ) );
+	}
+
+	bool exo_json_parse_bytes( exo_json* json, exo_array* bytes )
+	{
+		return( parse( json, bytes, static_cast<const char*>( bytes->data ), bytes->length ) );
+	}
+
+	// where parsing failed, -1 if the document is valid
+	int64_t exo_json_error( exo_json* json )
+	{
+		return( json->error );
+	}
+
+	int64_t exo_json_root( exo_json* json )
+	{
+		return( json->error < 0 ? 0 : -1 );
+	}
+
+	int64_t exo_json_type( exo_json* json, int64_t value )
+	{
+		if( !isValue( json, value ) ) {
+			return( -1 );
+		}
+
+		switch( getCharacter( json, value ) ) {
+			case 'n': return( EXO_JSON_NULL );
+			case 't': case 'f': return( EXO_JSON_BOOL );
+			case '"': return( EXO_JSON_STRING );
+			case '[': return( EXO_JSON_ARRAY );
+			case '{': return( EXO_JSON_OBJECT );
+			default: return( EXO_JSON_NUMBER );
+		}
+	}
+
+	/*
+	 * the first element of an array or the value of the first member of an object, -1 if it is empty
+	 */
+	int64_t exo_json_first( exo_json* json, int64_t value )
+	{
+		if( !isValue( json, value ) || !isContainer( json, value ) || json->links[ value ] == value + 1 ) {
+			return( -1 );
+		}
+
+		return( getCharacter( json, value ) == '{' ? value + 3 : value + 1 );
+	}
+
+	// in objects a key and a colon follow the comma, in arrays a string is never followed by one
+	int64_t exo_json_next( exo_json* json, int64_t value )
+	{
+		if( !isValue( json, value ) ) {
+			return( -1 );
+		}
+
+		int64_t next = skip( json, value );
+		if( getCharacter( json, next ) != ',' ) {
+			return( -1 );
+		}
+
+		return( getCharacter( json, next + 2 ) == ':' && getCharacter( json, next + 1 ) == '"' ? next + 3 : next + 1 );
+	}
+
+	// the key of a member, null for elements of arrays
+	const char* exo_json_key( exo_json* json, int64_t value )
+	{
+		if( !isValue( json, value ) || value < 3 || getCharacter( json, value - 1 ) != ':' ) {
+			return( nullptr );
+		}
+
+		return( exo_json_string( json, value - 2 ) );
+	}
+
+	int64_t exo_json_field( exo_json* json, int64_t value, const char* key )
+	{
+		if( !isValue( json, value ) || getCharacter( json, value ) != '{' || key == nullptr ) {
+			return( -1 );
+		}
+
+		int64_t length = getStringLength( key );
+		for( int64_t member = exo_json_first( json, value ); member >= 0; member = exo_json_next( json, member ) ) {
+			if( isKey( json, member - 2, key, length ) ) {
+				return( member );
+			}
+		}
+
+		return( -1 );
+	}
+
+	int64_t exo_json_at( exo_json* json, int64_t value, int64_t position )
+	{
+		int64_t element = exo_json_first( json, value );
+		while( element >= 0 && position-- > 0 ) {
+			element = exo_json_next( json, element );
+		}
+
+		return( position < 0 ? element : -1 );
+	}
+
+	int64_t exo_json_length( exo_json* json, int64_t value )
+	{
+		int64_t length = 0;
+		for( int64_t element = exo_json_first( json, value ); element >= 0; element = exo_json_next( json, element ) ) {
+			length++;
+		}
+
+		return( length );
+	}
+
+	const char* exo_json_string( exo_json* json, int64_t value )
+	{
+		if( !isValue( json, value ) || getCharacter( json, value ) != '"' ) {
+			return( nullptr );
+		}
+
+		bool hasEscapes;
+		int64_t start = json->index[ value ] + 1;
+		int64_t end = getStringEnd( json, json->index[ value ], hasEscapes );
+
+		if( !hasEscapes ) {
+			return( exo_string_new( json->text + start, end - start ) );
+		}
+
+		exo_string* string = static_cast<exo_string*>( Runtime::Allocate( offsetof( exo_string, data ) + end - start + 1, true ) );
+		string->length = unescape( json->text + start, json->text + end, string->data );
+		return( string->data );
+	}
+
+	/*
+	 * numbers are converted from a copy of their token, the text needs no terminating NUL. integers out of range and
+	 * fractions are converted through a double
+	 */
+	double exo_json_float( exo_json* json, int64_t value )
+	{
+		if( exo_json_type( json, value ) != EXO_JSON_NUMBER ) {
+			return( 0.0 );
+		}
+
+		char token[ 512 ];
+		int64_t length = std::min<int64_t>( getTokenEnd( json, json->index[ value ] ) - json->index[ value ], sizeof( token ) - 1 );
+		std::memcpy( token, json->text + json->index[ value ], length );
+		token[ length ] = '\0';
+
+		return( std::strtod( token, nullptr ) );
+	}
+
+	int64_t exo_json_int( exo_json* json, int64_t value )
+	{
+		if( exo_json_type( json, value ) != EXO_JSON_NUMBER ) {
+			return( 0 );
+		}
+
+		const char* token = json->text + json->index[ value ];
+		int64_t length = getTokenEnd( json, json->index[ value ] ) - json->index[ value ];
+		bool isNegative = token[ 0 ] == '-';
+		uint64_t result = 0;
+
+		uint64_t limit = isNegative ? static_cast<uint64_t>( INT64_MAX ) + 1 : INT64_MAX;
+
+		for( int64_t i = isNegative ? 1 : 0; i < length; i++ ) {
+			if( !isDigit( token[ i ] ) || result > ( limit - ( token[ i ] - '0' ) ) / 10 ) {
+				double number = exo_json_float( json, value );
+				return( number >= 9223372036854775808.0 ? INT64_MAX : number < -9223372036854775808.0 ? INT64_MIN : static_cast<int64_t>( number ) );
+			}
+
+			result = result * 10 + ( token[ i ] - '0' );
+		}
+
+		return( static_cast<int64_t>( isNegative ? 0 - result : result ) );
+	}
+
+	bool exo_json_bool( exo_json* json, int64_t value )
+	{
+		return( isValue( json, value ) && getCharacter( json, value ) == 't' );
+	}
+
+	bool exo_json_is_null( exo_json* json, int64_t value )
+	{
+		return( !isValue( json, value ) || getCharacter( json, value ) == 'n' );
+	}
+
+	// the text of a value as it is written in the document
+	const char* exo_json_raw( exo_json* json, int64_t value )
+	{
+		if( !isValue( json, value ) ) {
+			return( nullptr );
+		}
+
+		return( exo_string_new( json->text + json->index[ value ], getValueEnd( json, value ) - json->index[ value ] ) );
+	}
+
+	/*
+	 * streams through the document one event after the other, without looking at values until they are asked for. the
+	 * current value is the key, string or scalar of the event, or the container it opened
+	 */
+	int64_t exo_json_event( exo_json* json )
+	{
+		if( json->error >= 0 ) {
+			return( EXO_JSON_END );
+		}
+
+		while( json->cursor < json->count && ( getCharacter( json, json->cursor ) == ',' || getCharacter( json, json->cursor ) == ':' ) ) {
+			json->cursor++;
+		}
+		if( json->cursor >= json->count ) {
+			return( EXO_JSON_END );
+		}
+
+		json->current = json->cursor++;
+		switch( getCharacter( json, json->current ) ) {
+			case '{': return( EXO_JSON_OBJECT_START );
+			case '}': return( EXO_JSON_OBJECT_END );
+			case '[': return( EXO_JSON_ARRAY_START );
+			case ']': return( EXO_JSON_ARRAY_END );
+			case '"': return( getCharacter( json, json->cursor ) == ':' ? EXO_JSON_KEY : EXO_JSON_STRING_VALUE );
+			case 't': return( EXO_JSON_TRUE );
+			case 'f': return( EXO_JSON_FALSE );
+			case 'n': return( EXO_JSON_NULL_VALUE );
+			default: return( EXO_JSON_NUMBER_VALUE );
+		}
+	}
+
+	int64_t exo_json_current( exo_json* json )
+	{
+		return( json->current );
+	}
+
+	// the stream continues after the container the current event opened
+	void exo_json_skip( exo_json* json )
+	{
+		if( isValue( json, json->current ) && isContainer( json, json->current ) ) {
+			json->cursor = json->links[ json->current ] + 1;
+		}
+	}
+
+	/*
+	 * writes JSON into a string built in place, separators are added where they belong. the text is handed over without
+	 * copying it, the writer then starts a new one
+	 */
+	exo_json_writer* exo_json_writer_create( int64_t capacity )
+	{
+		exo_json_writer* writer = static_cast<exo_json_writer*>( Runtime::Allocate( sizeof( exo_json_writer ), false ) );
+		writer->initial = std::max<int64_t>( capacity, 16 );
+		return( writer );
+	}
+
+	void exo_json_writer_object( exo_json_writer* writer )
+	{
+		open( writer, '{' );
+	}
+
+	void exo_json_writer_object_end( exo_json_writer* writer )
+	{
+		close( writer, '}' );
+	}
+
+	void exo_json_writer_array( exo_json_writer* writer )
+	{
+		open( writer, '[' );
+	}
+
+	void exo_json_writer_array_end( exo_json_writer* writer )
+	{
+		close( writer, ']' );
+	}
+
+	void exo_json_writer_key( exo_json_writer* writer, const char* key )
+	{
+		separate( writer );
+		writeString( writer, key );
+		writeCharacter( writer, ':' );
+		writer->isAfterKey = true;
+	}
+
+	void exo_json_writer_string( exo_json_writer* writer, const char* string )
+	{
+		separate( writer );
+		if( string == nullptr ) {
+			write( writer, "null", 4 );
+		} else {
+			writeString( writer, string );
+		}
+	}
+
+	void exo_json_writer_int( exo_json_writer* writer, int64_t value )
+	{
+		char digits[ 24 ];
+		separate( writer );
+		write( writer, digits, std::snprintf( digits, sizeof( digits ), "%lld", static_cast<long long>( value ) ) );
+	}
+
+	// the shortest precision that reads back as the same double, JSON has no infinities or NaN
+	void exo_json_writer_float( exo_json_writer* writer, double value )
+	{
+		separate( writer );
+		if( !std::isfinite( value ) ) {
+			write( writer, "null", 4 );
+			return;
+		}
+
+		char digits[ 32 ];
+		int length = 0;
+		for( int precision = 15; precision <= 17; precision++ ) {
+			length = std::snprintf( digits, sizeof( digits ), "%.*g", precision, value );
+			if( std::strtod( digits, nullptr ) == value ) {
+				break;
+			}
+		}
+
+		write( writer, digits, length );
+	}
+
+	void exo_json_writer_bool( exo_json_writer* writer, bool value )
+	{
+		separate( writer );
+		write( writer, value ? "true" : "false", value ? 4 : 5 );
+	}
+
+	void exo_json_writer_null( exo_json_writer* writer )
+	{
+		separate( writer );
+		write( writer, "null", 4 );
+	}
+
+	// a value of a document as it is written there, e.g. to pass parts of the input through unchanged
+	void exo_json_writer_value( exo_json_writer* writer, exo_json* json, int64_t value )
+	{
+		separate( writer );
+
+		if( !isValue( json, value ) ) {
+			write( writer, "null", 4 );
+		} else {
+			write( writer, json->text + json->index[ value ], getValueEnd( json, value ) - json->index[ value ] );
+		}
+	}
+
+	const char* exo_json_writer_text( exo_json_writer* writer )
+	{
+		grow( writer, 0 );
+
+		exo_string* string = writer->string;
+		string->length = writer->length;
+		string->data[ writer->length ] = '\0';
+
+		writer->string = nullptr;
+		writer->capacity = 0;
+		writer->length = 0;
+		writer->depth = 0;
+		writer->isAfterKey = false;
+		writer->hasElements[ 0 ] = 0;
+
+		return( string->data );
+	}
+}
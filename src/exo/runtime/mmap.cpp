@@ -0,0 +1,143 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "exo/exo.h"
+#include "exo/runtime/runtime.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define EXO_MMAP_NORMAL			0
+#define EXO_MMAP_SEQUENTIAL		1
+#define EXO_MMAP_RANDOM			2
+#define EXO_MMAP_WILLNEED		3
+#define EXO_MMAP_HUGEPAGE		4
+
+using exo::runtime::Runtime;
+
+namespace
+{
+	/*
+	 * the byte array points right into the mapping. once unmapped it is emptied, so later accesses fail their bounds
+	 * check, slices taken from it are not
+	 */
+	void unmap( exo_mapping* mapping )
+	{
+		if( mapping->data != nullptr ) {
+			::munmap( mapping->data, mapping->length );
+		}
+
+		mapping->data = nullptr;
+		mapping->length = 0;
+		mapping->bytes->data = nullptr;
+		mapping->bytes->length = 0;
+		mapping->bytes->capacity = 0;
+	}
+}
+
+extern "C"
+{
+	/*
+	 * writable files are mapped shared, writes go to the file. read only ones are mapped private, so writing their bytes
+	 * copies the page instead of faulting. empty files are not mapped at all, they have no bytes. slices don't keep the
+	 * mapping reachable, which is why it is never unmapped once collected, only by closing it
+	 */
+	exo_mapping* exo_mmap_open( const char* path, bool isWritable )
+	{
+		int file = ::open( path, isWritable ? O_RDWR : O_RDONLY );
+		if( file < 0 ) {
+			return( nullptr );
+		}
+
+		struct stat status;
+		void* data = nullptr;
+		if( ::fstat( file, &status ) == 0 && status.st_size > 0 ) {
+			data = ::mmap( nullptr, status.st_size, PROT_READ | PROT_WRITE, isWritable ? MAP_SHARED : MAP_PRIVATE, file, 0 );
+		}
+		::close( file );
+
+		if( data == MAP_FAILED ) {
+			return( nullptr );
+		}
+
+		exo_mapping* mapping = static_cast<exo_mapping*>( Runtime::Allocate( sizeof( exo_mapping ), false ) );
+		mapping->data = data;
+		mapping->length = data != nullptr ? status.st_size : 0;
+		mapping->bytes = exo_array_wrap( data, mapping->length );
+
+		return( mapping );
+	}
+
+	exo_array* exo_mmap_bytes( exo_mapping* mapping )
+	{
+		if( mapping == nullptr ) {
+			return( exo_array_wrap( nullptr, 0 ) );
+		}
+
+		return( mapping->bytes );
+	}
+
+	bool exo_mmap_advise( exo_mapping* mapping, int64_t advice )
+	{
+		if( mapping == nullptr || mapping->data == nullptr ) {
+			return( false );
+		}
+
+		int hint;
+		switch( advice ) {
+			case EXO_MMAP_SEQUENTIAL:
+				hint = MADV_SEQUENTIAL;
+				break;
+			case EXO_MMAP_RANDOM:
+				hint = MADV_RANDOM;
+				break;
+			case EXO_MMAP_WILLNEED:
+				hint = MADV_WILLNEED;
+				break;
+#ifdef MADV_HUGEPAGE
+			case EXO_MMAP_HUGEPAGE:
+				hint = MADV_HUGEPAGE;
+				break;
+#endif
+			case EXO_MMAP_NORMAL:
+				hint = MADV_NORMAL;
+				break;
+			default:
+				return( false );
+		}
+
+		return( ::madvise( mapping->data, mapping->length, hint ) == 0 );
+	}
+
+	bool exo_mmap_sync( exo_mapping* mapping )
+	{
+		if( mapping == nullptr || mapping->data == nullptr ) {
+			return( mapping != nullptr );
+		}
+
+		return( ::msync( mapping->data, mapping->length, MS_SYNC ) == 0 );
+	}
+
+	void exo_mmap_close( exo_mapping* mapping )
+	{
+		if( mapping == nullptr ) {
+			return;
+		}
+
+		unmap( mapping );
+	}
+}
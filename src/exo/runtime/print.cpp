@@ -0,0 +1,118 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "exo/exo.h"
+#include "exo/runtime/runtime.h"
+
+#include <cstdio>
+#include <vector>
+
+/*
+ * the pieces of a specialized printf go into the buffer of stdout, so they stay in order with everything else written
+ * to it. the generated code holds its lock around them
+ */
+namespace
+{
+	int64_t write( const char* data, size_t length )
+	{
+#ifdef __GLIBC__
+		return( fwrite_unlocked( data, 1, length, stdout ) );
+#else
+		return( std::fwrite( data, 1, length, stdout ) );
+#endif
+	}
+
+	// digits are produced from the end of the buffer
+	int64_t writeUnsigned( uint64_t value, uint64_t base, const char* digits, bool isNegative )
+	{
+		char buffer[ 24 ];
+		char* end = buffer + sizeof( buffer );
+		char* begin = end;
+
+		do {
+			*--begin = digits[ value % base ];
+			value /= base;
+		} while( value != 0 );
+
+		if( isNegative ) {
+			*--begin = '-';
+		}
+
+		return( write( begin, end - begin ) );
+	}
+}
+
+extern "C"
+{
+	void exo_print_lock()
+	{
+		flockfile( stdout );
+	}
+
+	void exo_print_unlock()
+	{
+		funlockfile( stdout );
+	}
+
+	int64_t exo_print_text( const char* text, int64_t length )
+	{
+		return( write( text, length ) );
+	}
+
+	// up to the first NUL like printf, which prints null as (null)
+	int64_t exo_print_string( const char* string )
+	{
+		if( string == nullptr ) {
+			return( write( "(null)", 6 ) );
+		}
+
+		return( write( string, std::strlen( string ) ) );
+	}
+
+	int64_t exo_print_char( int64_t character )
+	{
+		char value = static_cast<char>( character );
+		return( write( &value, 1 ) );
+	}
+
+	int64_t exo_print_int( int64_t value )
+	{
+		return( writeUnsigned( value < 0 ? 0 - static_cast<uint64_t>( value ) : value, 10, "0123456789", value < 0 ) );
+	}
+
+	int64_t exo_print_unsigned( uint64_t value, int64_t base, int64_t isUpper )
+	{
+		return( writeUnsigned( value, base, isUpper ? "0123456789ABCDEF" : "0123456789abcdef", false ) );
+	}
+
+	/*
+	 * rounding has to match printf exactly, so the digits still come from the C library. a negative precision is the
+	 * default one
+	 */
+	int64_t exo_print_float( double value, int64_t precision, int64_t conversion )
+	{
+		const char format[] = { '%', '.', '*', static_cast<char>( conversion ), '\0' };
+
+		char buffer[ 64 ];
+		int length = std::snprintf( buffer, sizeof( buffer ), format, static_cast<int>( precision ), value );
+		if( length < static_cast<int>( sizeof( buffer ) ) ) {
+			return( write( buffer, length ) );
+		}
+
+		std::vector<char> large( length + 1 );
+		std::snprintf( large.data(), large.size(), format, static_cast<int>( precision ), value );
+		return( write( large.data(), length ) );
+	}
+}
@@ -0,0 +1,179 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "exo/exo.h"
+#include "exo/runtime/runtime.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define EXO_READER_BUFFER		( 1 << 20 )
+
+using exo::runtime::Runtime;
+
+namespace
+{
+	void setRecord( exo_reader* reader, int64_t start, int64_t end )
+	{
+		reader->record->data = reader->buffer + start;
+		reader->record->length = end - start;
+		reader->record->capacity = end - start;
+
+		reader->buffer[ end ] = '\0';
+		reader->start = end;
+	}
+
+	/*
+	 * a full buffer first drops the records already returned, only a single record filling all of it makes it grow. there
+	 * is always room for a terminating NUL after the bytes read
+	 */
+	void fill( exo_reader* reader )
+	{
+		if( reader->end == reader->capacity && reader->start > 0 ) {
+			std::memmove( reader->buffer, reader->buffer + reader->start, reader->end - reader->start );
+			reader->end -= reader->start;
+			reader->start = 0;
+		} else if( reader->end == reader->capacity ) {
+			char* buffer = static_cast<char*>( Runtime::Allocate( reader->capacity * 2 + 1, true ) );
+			std::memcpy( buffer, reader->buffer, reader->end );
+			reader->buffer = buffer;
+			reader->capacity *= 2;
+		}
+
+		ssize_t length;
+		do {
+			length = ::read( reader->file, reader->buffer + reader->end, reader->capacity - reader->end );
+		} while( length < 0 && errno == EINTR );
+
+		if( length <= 0 ) {
+			reader->isDone = true;
+		} else {
+			reader->end += length;
+		}
+	}
+
+	void close( exo_reader* reader )
+	{
+		if( reader->file > STDIN_FILENO ) {
+			::close( reader->file );
+		}
+
+		reader->file = -1;
+		reader->isDone = true;
+	}
+
+#ifndef EXO_GC_DISABLE
+	void finalize( void* reader, void* )
+	{
+		close( static_cast<exo_reader*>( reader ) );
+	}
+#endif
+}
+
+extern "C"
+{
+	exo_reader* exo_reader_open( const char* path )
+	{
+		int file = STDIN_FILENO;
+		if( std::strcmp( path, "-" ) != 0 ) {
+			file = ::open( path, O_RDONLY );
+			if( file < 0 ) {
+				return( nullptr );
+			}
+
+#ifdef POSIX_FADV_SEQUENTIAL
+			::posix_fadvise( file, 0, 0, POSIX_FADV_SEQUENTIAL );
+#endif
+		}
+
+		exo_reader* reader = static_cast<exo_reader*>( Runtime::Allocate( sizeof( exo_reader ), false ) );
+		reader->file = file;
+		reader->buffer = static_cast<char*>( Runtime::Allocate( EXO_READER_BUFFER + 1, true ) );
+		reader->capacity = EXO_READER_BUFFER;
+		reader->record = exo_array_wrap( nullptr, 0 );
+
+#ifndef EXO_GC_DISABLE
+		GC_register_finalizer( reader, finalize, nullptr, nullptr, nullptr );
+#endif
+
+		return( reader );
+	}
+
+	/*
+	 * memchr compares whole vectors of bytes at once, only the bytes read since the last scan are looked at. the record
+	 * does not include its delimiter, the last one does not need one
+	 */
+	bool exo_reader_next( exo_reader* reader, int64_t delimiter )
+	{
+		if( reader == nullptr ) {
+			return( false );
+		}
+
+		int64_t scanned = reader->start;
+		for( ;; ) {
+			const char* found = static_cast<const char*>( std::memchr( reader->buffer + scanned, static_cast<int>( delimiter ), reader->end - scanned ) );
+			if( found != nullptr ) {
+				setRecord( reader, reader->start, found - reader->buffer );
+				reader->start++;
+				return( true );
+			}
+
+			if( reader->isDone ) {
+				if( reader->start == reader->end ) {
+					reader->record->data = nullptr;
+					reader->record->length = 0;
+					reader->record->capacity = 0;
+					return( false );
+				}
+
+				setRecord( reader, reader->start, reader->end );
+				return( true );
+			}
+
+			// the record may move, the bytes of it scanned already are not scanned again
+			int64_t offset = reader->end - reader->start;
+			fill( reader );
+			scanned = reader->start + offset;
+		}
+	}
+
+	exo_array* exo_reader_record( exo_reader* reader )
+	{
+		return( reader != nullptr ? reader->record : exo_array_wrap( nullptr, 0 ) );
+	}
+
+	// a string of its own, the record is overwritten by the next one
+	const char* exo_reader_text( exo_reader* reader )
+	{
+		if( reader == nullptr || reader->record->data == nullptr ) {
+			return( exo_string_new( "", 0 ) );
+		}
+
+		return( exo_string_new( static_cast<const char*>( reader->record->data ), reader->record->length ) );
+	}
+
+	void exo_reader_close( exo_reader* reader )
+	{
+		if( reader == nullptr ) {
+			return;
+		}
+
+#ifndef EXO_GC_DISABLE
+		GC_register_finalizer( reader, nullptr, nullptr, nullptr, nullptr );
+#endif
+		close( reader );
+	}
+}
@@ -0,0 +1,1002 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "exo/exo.h"
+#include "exo/jit/jit.h"
+#include "exo/runtime/runtime.h"
+
+#include <bitset>
+#include <cstddef>
+#include <mutex>
+
+#ifdef __SSE2__
+# include <emmintrin.h>
+#endif
+
+#define EXO_REGEX_REPEAT_LIMIT	1000
+#define EXO_REGEX_NFA_LIMIT		100000
+#define EXO_REGEX_DFA_LIMIT		10000
+#define EXO_REGEX_OPTIMIZE_LIMIT	64
+
+#define EXO_REGEX_ACCEPT		0
+
+using exo::runtime::Runtime;
+
+/*
+ * patterns are parsed into expressions, expanded into a Thompson NFA and turned into DFAs by subset construction over
+ * classes of bytes that are never told apart. every DFA state becomes a basic block that switches on the next byte, so
+ * matching is a jump per byte without any tables. there are two automatons, the pattern itself to match from a given
+ * start, and the pattern behind .* to find where the earliest match ends. matches are leftmost longest like POSIX
+ * wants them, and as the DFA has no captures there are no groups to report either. patterns that start with a literal
+ * look for it with SSE2 first and only run the automaton where it occurs
+ */
+namespace
+{
+	typedef std::bitset<256> Bytes;
+
+	struct Expression
+	{
+		enum Kind { BYTES, CONCATENATE, ALTERNATE, REPEAT };
+
+		Kind					kind;
+		Bytes					bytes;
+		std::vector<Expression>	parts;
+		int64_t					minimum;
+		int64_t					maximum; // -1 if unbounded
+	};
+
+	struct Parser
+	{
+		const char*	current;
+		const char*	end;
+		bool		isValid;
+	};
+
+	/*
+	 * nodes with a next one consume a byte of the set, any others only lead to their epsilons. the first node accepts
+	 */
+	struct Node
+	{
+		Bytes				bytes;
+		int64_t				next;
+		std::vector<int64_t>	epsilons;
+	};
+
+	struct Automaton
+	{
+		std::vector<int64_t>	classes;
+		int64_t					classCount;
+		std::vector<int64_t>	transitions; // by state and class, -1 for none
+		std::vector<bool>		accepting;
+	};
+
+	Expression createBytes( Bytes bytes )
+	{
+		Expression expression;
+		expression.kind = Expression::BYTES;
+		expression.bytes = bytes;
+		return( expression );
+	}
+
+	Expression createExpression( Expression::Kind kind )
+	{
+		Expression expression;
+		expression.kind = kind;
+		return( expression );
+	}
+
+	Bytes getRange( int low, int high )
+	{
+		Bytes bytes;
+		for( int i = low; i <= high; i++ ) {
+			bytes.set( i );
+		}
+
+		return( bytes );
+	}
+
+	int getByte( const Bytes& bytes )
+	{
+		int byte = 0;
+		while( byte < 255 && !bytes.test( byte ) ) {
+			byte++;
+		}
+
+		return( byte );
+	}
+
+	int getHexDigit( char c )
+	{
+		if( c >= '0' && c <= '9' ) {
+			return( c - '0' );
+		} else if( c >= 'a' && c <= 'f' ) {
+			return( c - 'a' + 10 );
+		} else if( c >= 'A' && c <= 'F' ) {
+			return( c - 'A' + 10 );
+		}
+
+		return( -1 );
+	}
+
+	bool isDone( Parser& parser )
+	{
+		return( !parser.isValid || parser.current == parser.end );
+	}
+
+	/*
+	 * the shorthand classes and control characters, other letters and digits are reserved, anything else stands for itself
+	 */
+	Bytes parseEscape( Parser& parser )
+	{
+		if( isDone( parser ) ) {
+			parser.isValid = false;
+			return( Bytes() );
+		}
+
+		char c = *parser.current++;
+		switch( c ) {
+			case 'd':
+			case 'D':
+				return( c == 'd' ? getRange( '0', '9' ) : ~getRange( '0', '9' ) );
+			case 'w':
+			case 'W': {
+				Bytes word = getRange( '0', '9' ) | getRange( 'a', 'z' ) | getRange( 'A', 'Z' );
+				word.set( '_' );
+				return( c == 'w' ? word : ~word );
+			}
+			case 's':
+			case 'S': {
+				Bytes space = getRange( '\t', '\r' );
+				space.set( ' ' );
+				return( c == 's' ? space : ~space );
+			}
+			case 't':
+				return( getRange( '\t', '\t' ) );
+			case 'n':
+				return( getRange( '\n', '\n' ) );
+			case 'r':
+				return( getRange( '\r', '\r' ) );
+			case 'f':
+				return( getRange( '\f', '\f' ) );
+			case 'v':
+				return( getRange( '\v', '\v' ) );
+			case 'x':
+				if( parser.end - parser.current >= 2 && getHexDigit( parser.current[0] ) >= 0 && getHexDigit( parser.current[1] ) >= 0 ) {
+					int byte = getHexDigit( parser.current[0] ) * 16 + getHexDigit( parser.current[1] );
+					parser.current += 2;
+					return( getRange( byte, byte ) );
+				}
+			break;
+			default:
+				if( !std::isalnum( static_cast<unsigned char>( c ) ) ) {
+					return( getRange( static_cast<unsigned char>( c ), static_cast<unsigned char>( c ) ) );
+				}
+		}
+
+		parser.isValid = false;
+		return( Bytes() );
+	}
+
+	// a single byte or -1 for a whole set
+	int parseClassMember( Parser& parser, Bytes& bytes )
+	{
+		if( *parser.current != '\\' ) {
+			unsigned char byte = *parser.current++;
+			bytes.set( byte );
+			return( byte );
+		}
+
+		parser.current++;
+		Bytes escaped = parseEscape( parser );
+		bytes |= escaped;
+
+		return( escaped.count() == 1 ? getByte( escaped ) : -1 );
+	}
+
+	Expression parseClass( Parser& parser )
+	{
+		Bytes bytes;
+		bool isNegated = !isDone( parser ) && *parser.current == '^';
+		if( isNegated ) {
+			parser.current++;
+		}
+
+		// a bracket right at the start is a member
+		for( bool isFirst = true; !isDone( parser ) && ( isFirst || *parser.current != ']' ); isFirst = false ) {
+			Bytes member;
+			int low = parseClassMember( parser, member );
+
+			if( low >= 0 && parser.end - parser.current >= 2 && parser.current[0] == '-' && parser.current[1] != ']' ) {
+				parser.current++;
+				int high = parseClassMember( parser, member );
+				if( high < low ) {
+					parser.isValid = false;
+				}
+
+				member = getRange( low, high < low ? low : high );
+			}
+
+			bytes |= member;
+		}
+
+		if( isDone( parser ) ) {
+			parser.isValid = false;
+		} else {
+			parser.current++;
+		}
+
+		return( createBytes( isNegated ? ~bytes : bytes ) );
+	}
+
+	// {n}, {n,} or {n,m}, braces that are none of these are literals
+	bool parseBounds( Parser& parser, int64_t& minimum, int64_t& maximum )
+	{
+		const char* current = parser.current + 1;
+		int64_t bounds[2] = { -1, -1 };
+		bool hasComma = false;
+
+		for( ; current < parser.end && *current != '}'; current++ ) {
+			int64_t& bound = bounds[ hasComma ? 1 : 0 ];
+
+			if( *current == ',' && !hasComma && bounds[0] >= 0 ) {
+				hasComma = true;
+			} else if( *current >= '0' && *current <= '9' && bound <= EXO_REGEX_REPEAT_LIMIT ) {
+				bound = ( bound < 0 ? 0 : bound * 10 ) + ( *current - '0' );
+			} else {
+				return( false );
+			}
+		}
+
+		if( current == parser.end || bounds[0] < 0 ) {
+			return( false );
+		}
+
+		parser.current = current + 1;
+		minimum = bounds[0];
+		maximum = hasComma ? bounds[1] : bounds[0];
+		return( true );
+	}
+
+	Expression parseAlternation( Parser& parser );
+
+	Expression parseAtom( Parser& parser )
+	{
+		char c = *parser.current++;
+		switch( c ) {
+			case '(':
+				if( parser.end - parser.current >= 2 && parser.current[0] == '?' && parser.current[1] == ':' ) {
+					parser.current += 2;
+				} else if( !isDone( parser ) && *parser.current == '?' ) {
+					break;
+				}
+
+				{
+					Expression group = parseAlternation( parser );
+					if( isDone( parser ) || *parser.current != ')' ) {
+						break;
+					}
+
+					parser.current++;
+					return( group );
+				}
+			case '[':
+				return( parseClass( parser ) );
+			case '.':
+				return( createBytes( ~getRange( '\n', '\n' ) ) );
+			case '\\':
+				return( createBytes( parseEscape( parser ) ) );
+			case '*':
+			case '+':
+			case '?':
+			case '^':
+			case '$':
+			break;
+			default:
+				return( createBytes( getRange( static_cast<unsigned char>( c ), static_cast<unsigned char>( c ) ) ) );
+		}
+
+		parser.isValid = false;
+		return( createExpression( Expression::CONCATENATE ) );
+	}
+
+	Expression parseRepetition( Parser& parser )
+	{
+		Expression expression = parseAtom( parser );
+
+		while( !isDone( parser ) ) {
+			int64_t minimum, maximum;
+			char c = *parser.current;
+
+			if( c == '*' || c == '+' || c == '?' ) {
+				parser.current++;
+				minimum = c == '+' ? 1 : 0;
+				maximum = c == '?' ? 1 : -1;
+			} else if( c != '{' || !parseBounds( parser, minimum, maximum ) ) {
+				break;
+			}
+
+			if( minimum > EXO_REGEX_REPEAT_LIMIT || maximum > EXO_REGEX_REPEAT_LIMIT || ( maximum >= 0 && maximum < minimum ) ) {
+				parser.isValid = false;
+			}
+
+			Expression repetition = createExpression( Expression::REPEAT );
+			repetition.parts.push_back( std::move( expression ) );
+			repetition.minimum = minimum;
+			repetition.maximum = maximum;
+			expression = std::move( repetition );
+		}
+
+		return( expression );
+	}
+
+	// groups are spliced in, so a literal at the start of one still counts as prefix
+	Expression parseConcatenation( Parser& parser )
+	{
+		Expression concatenation = createExpression( Expression::CONCATENATE );
+
+		while( !isDone( parser ) && *parser.current != '|' && *parser.current != ')' ) {
+			Expression part = parseRepetition( parser );
+
+			if( part.kind == Expression::CONCATENATE ) {
+				std::move( part.parts.begin(), part.parts.end(), std::back_inserter( concatenation.parts ) );
+			} else {
+				concatenation.parts.push_back( std::move( part ) );
+			}
+		}
+
+		return( concatenation );
+	}
+
+	Expression parseAlternation( Parser& parser )
+	{
+		Expression alternation = createExpression( Expression::ALTERNATE );
+		alternation.parts.push_back( parseConcatenation( parser ) );
+
+		while( !isDone( parser ) && *parser.current == '|' ) {
+			parser.current++;
+			alternation.parts.push_back( parseConcatenation( parser ) );
+		}
+
+		if( alternation.parts.size() == 1 ) {
+			return( std::move( alternation.parts.front() ) );
+		}
+
+		return( alternation );
+	}
+
+	/*
+	 * appends the literal every match starts with, true as long as nothing but literals came so far
+	 */
+	bool getPrefix( const Expression& expression, std::string& prefix )
+	{
+		switch( expression.kind ) {
+			case Expression::BYTES:
+				if( expression.bytes.count() != 1 ) {
+					return( false );
+				}
+
+				prefix.push_back( static_cast<char>( getByte( expression.bytes ) ) );
+				return( true );
+
+			case Expression::CONCATENATE:
+				for( auto &part : expression.parts ) {
+					if( !getPrefix( part, prefix ) ) {
+						return( false );
+					}
+				}
+
+				return( true );
+
+			case Expression::REPEAT:
+				for( int64_t i = 0; i < expression.minimum; i++ ) {
+					if( !getPrefix( expression.parts.front(), prefix ) ) {
+						return( false );
+					}
+				}
+
+				return( expression.minimum == expression.maximum );
+
+			default:
+				return( false );
+		}
+	}
+
+	int64_t addNode( std::vector<Node>& nodes, Bytes bytes, int64_t next )
+	{
+		nodes.push_back( Node() );
+		nodes.back().bytes = bytes;
+		nodes.back().next = next;
+		return( nodes.size() - 1 );
+	}
+
+	int64_t addEpsilons( std::vector<Node>& nodes, int64_t first, int64_t second )
+	{
+		int64_t node = addNode( nodes, Bytes(), -1 );
+		nodes[ node ].epsilons = { first, second };
+		return( node );
+	}
+
+	/*
+	 * built back to front, every expression gets the node to continue with and returns the node it starts with. bounded
+	 * repetitions are copied as often as they may occur, the optional copies nested so each can skip the rest
+	 */
+	int64_t build( std::vector<Node>& nodes, const Expression& expression, int64_t next )
+	{
+		if( nodes.size() > EXO_REGEX_NFA_LIMIT ) {
+			return( next );
+		}
+
+		switch( expression.kind ) {
+			case Expression::BYTES:
+				return( addNode( nodes, expression.bytes, next ) );
+
+			case Expression::CONCATENATE:
+				for( auto part = expression.parts.rbegin(); part != expression.parts.rend(); ++part ) {
+					next = build( nodes, *part, next );
+				}
+
+				return( next );
+
+			case Expression::ALTERNATE: {
+				int64_t alternatives = build( nodes, expression.parts.back(), next );
+				for( auto part = expression.parts.rbegin() + 1; part != expression.parts.rend(); ++part ) {
+					alternatives = addEpsilons( nodes, build( nodes, *part, next ), alternatives );
+				}
+
+				return( alternatives );
+			}
+
+			case Expression::REPEAT: {
+				const Expression& part = expression.parts.front();
+				int64_t start = next;
+
+				if( expression.maximum < 0 ) {
+					start = addEpsilons( nodes, -1, next );
+					int64_t body = build( nodes, part, start );
+					nodes[ start ].epsilons.front() = body;
+				} else {
+					for( int64_t i = expression.minimum; i < expression.maximum && nodes.size() <= EXO_REGEX_NFA_LIMIT; i++ ) {
+						start = addEpsilons( nodes, build( nodes, part, start ), next );
+					}
+				}
+
+				for( int64_t i = 0; i < expression.minimum && nodes.size() <= EXO_REGEX_NFA_LIMIT; i++ ) {
+					start = build( nodes, part, start );
+				}
+
+				return( start );
+			}
+		}
+
+		return( next );
+	}
+
+	/*
+	 * adds the nodes that consume or accept reachable from the given one, marks tell which ones are already there
+	 */
+	void close( const std::vector<Node>& nodes, int64_t node, std::vector<int64_t>& marks, int64_t mark, std::vector<int64_t>& set )
+	{
+		std::vector<int64_t> pending( 1, node );
+
+		while( !pending.empty() ) {
+			node = pending.back();
+			pending.pop_back();
+
+			if( marks[ node ] == mark ) {
+				continue;
+			}
+
+			marks[ node ] = mark;
+			if( node == EXO_REGEX_ACCEPT || nodes[ node ].next >= 0 ) {
+				set.push_back( node );
+			} else {
+				pending.insert( pending.end(), nodes[ node ].epsilons.rbegin(), nodes[ node ].epsilons.rend() );
+			}
+		}
+	}
+
+	// bytes that are in the same sets everywhere share a class
+	std::vector<int64_t> classify( const std::vector<Node>& nodes, int64_t& count )
+	{
+		std::vector<int64_t> classes( 256, 0 );
+		count = 1;
+
+		for( auto &node : nodes ) {
+			if( node.next < 0 ) {
+				continue;
+			}
+
+			std::vector<int64_t> renumbered( count * 2, -1 );
+			count = 0;
+			for( int byte = 0; byte < 256; byte++ ) {
+				int64_t& renumber = renumbered[ classes[ byte ] * 2 + node.bytes.test( byte ) ];
+				if( renumber < 0 ) {
+					renumber = count++;
+				}
+
+				classes[ byte ] = renumber;
+			}
+		}
+
+		return( classes );
+	}
+
+	// false once there are too many states
+	bool determinize( const std::vector<Node>& nodes, int64_t start, Automaton& automaton )
+	{
+		automaton.classes = classify( nodes, automaton.classCount );
+
+		std::vector<int> representatives( automaton.classCount );
+		for( int byte = 255; byte >= 0; byte-- ) {
+			representatives[ automaton.classes[ byte ] ] = byte;
+		}
+
+		std::vector<int64_t> marks( nodes.size(), -1 );
+		int64_t mark = 0;
+
+		std::vector<std::vector<int64_t>> sets( 1 );
+		close( nodes, start, marks, mark++, sets.front() );
+		std::sort( sets.front().begin(), sets.front().end() );
+
+		std::map<std::vector<int64_t>, int64_t> states;
+		states.emplace( sets.front(), 0 );
+
+		for( size_t state = 0; state < sets.size(); state++ ) {
+			std::vector<int64_t> current = sets[ state ];
+			automaton.accepting.push_back( !current.empty() && current.front() == EXO_REGEX_ACCEPT );
+
+			for( int64_t byteClass = 0; byteClass < automaton.classCount; byteClass++ ) {
+				std::vector<int64_t> set;
+				for( int64_t node : current ) {
+					if( node != EXO_REGEX_ACCEPT && nodes[ node ].bytes.test( representatives[ byteClass ] ) ) {
+						close( nodes, nodes[ node ].next, marks, mark, set );
+					}
+				}
+				mark++;
+
+				if( set.empty() ) {
+					automaton.transitions.push_back( -1 );
+					continue;
+				}
+
+				std::sort( set.begin(), set.end() );
+				auto existing = states.find( set );
+				if( existing != states.end() ) {
+					automaton.transitions.push_back( existing->second );
+					continue;
+				}
+
+				if( sets.size() >= EXO_REGEX_DFA_LIMIT ) {
+					return( false );
+				}
+
+				states.emplace( set, sets.size() );
+				automaton.transitions.push_back( sets.size() );
+				sets.push_back( std::move( set ) );
+			}
+		}
+
+		return( true );
+	}
+
+	int64_t getTransition( const Automaton& automaton, int64_t state, int byte )
+	{
+		return( automaton.transitions[ state * automaton.classCount + automaton.classes[ byte ] ] );
+	}
+
+	/*
+	 * a function of the data, its length and whether the earliest match will do, with a block per state that switches on
+	 * the class of the next byte. that keeps the switches small enough for large automatons to compile quickly. else the
+	 * longest match is taken once the automaton gets stuck. at the end of the input only accepts in the last state
+	 */
+	void createMatcher( llvm::Module* module, const Automaton& automaton, std::string name, bool isAtEnd )
+	{
+		llvm::LLVMContext& context = module->getContext();
+		llvm::IntegerType* intType = llvm::Type::getInt64Ty( context );
+		llvm::IntegerType* byteType = llvm::Type::getInt8Ty( context );
+
+		llvm::FunctionType* type = llvm::FunctionType::get( intType, { byteType->getPointerTo(), intType, byteType }, false );
+		llvm::Function* function = llvm::Function::Create( type, llvm::GlobalValue::ExternalLinkage, name, module );
+		function->addFnAttr( llvm::Attribute::NoUnwind );
+
+		llvm::Function::arg_iterator argument = function->arg_begin();
+		llvm::Value* data = &*argument++;
+		llvm::Value* length = &*argument++;
+		llvm::Value* isEarliest = &*argument;
+
+		llvm::ArrayType* tableType = llvm::ArrayType::get( byteType, 256 );
+		std::vector<llvm::Constant*> classes;
+		for( int value = 0; value < 256; value++ ) {
+			classes.push_back( llvm::ConstantInt::get( byteType, automaton.classes[ value ] ) );
+		}
+		llvm::Value* table = new llvm::GlobalVariable( *module, tableType, true, llvm::GlobalValue::PrivateLinkage, llvm::ConstantArray::get( tableType, classes ), name + ".classes" );
+
+		llvm::IRBuilder<> builder( llvm::BasicBlock::Create( context, "entry", function ) );
+		llvm::Value* position = builder.CreateAlloca( intType, nullptr, "position" );
+		llvm::Value* last = builder.CreateAlloca( intType, nullptr, "last" );
+		builder.CreateStore( llvm::ConstantInt::get( intType, 0 ), position );
+		builder.CreateStore( llvm::ConstantInt::get( intType, -1 ), last );
+		llvm::Value* isReturning = builder.CreateICmpNE( isEarliest, llvm::ConstantInt::get( byteType, 0 ) );
+
+		std::vector<llvm::BasicBlock*> blocks;
+		for( size_t state = 0; state < automaton.accepting.size(); state++ ) {
+			blocks.push_back( llvm::BasicBlock::Create( context, "state", function ) );
+		}
+		builder.CreateBr( blocks.front() );
+
+		llvm::BasicBlock* stuck = llvm::BasicBlock::Create( context, "stuck", function );
+		builder.SetInsertPoint( stuck );
+		builder.CreateRet( builder.CreateLoad( last ) );
+
+		llvm::BasicBlock* accepted = llvm::BasicBlock::Create( context, "accepted", function );
+		builder.SetInsertPoint( accepted );
+		builder.CreateRet( length );
+
+		for( size_t state = 0; state < blocks.size(); state++ ) {
+			builder.SetInsertPoint( blocks[ state ] );
+			llvm::Value* current = builder.CreateLoad( position );
+
+			if( automaton.accepting[ state ] && !isAtEnd ) {
+				builder.CreateStore( current, last );
+
+				llvm::BasicBlock* onward = llvm::BasicBlock::Create( context, "onward", function );
+				builder.CreateCondBr( isReturning, stuck, onward );
+				builder.SetInsertPoint( onward );
+			}
+
+			llvm::BasicBlock* next = llvm::BasicBlock::Create( context, "next", function );
+			builder.CreateCondBr( builder.CreateICmpSLT( current, length ), next, automaton.accepting[ state ] && isAtEnd ? accepted : stuck );
+
+			builder.SetInsertPoint( next );
+			llvm::Value* byte = builder.CreateZExt( builder.CreateLoad( builder.CreateInBoundsGEP( data, current ) ), intType );
+			llvm::Value* byteClass = builder.CreateLoad( builder.CreateInBoundsGEP( table, { llvm::ConstantInt::get( intType, 0 ), byte } ), "class" );
+			builder.CreateStore( builder.CreateAdd( current, llvm::ConstantInt::get( intType, 1 ) ), position );
+
+			// the most frequent successor is the default, usually getting stuck or staying
+			const int64_t* transitions = &automaton.transitions[ state * automaton.classCount ];
+			std::map<int64_t, int64_t> frequencies;
+			for( int64_t i = 0; i < automaton.classCount; i++ ) {
+				frequencies[ transitions[ i ] ]++;
+			}
+
+			int64_t common = std::max_element( frequencies.begin(), frequencies.end(), []( const std::pair<const int64_t, int64_t>& lhs, const std::pair<const int64_t, int64_t>& rhs ) {
+				return( lhs.second < rhs.second );
+			} )->first;
+
+			llvm::SwitchInst* dispatcher = builder.CreateSwitch( byteClass, common < 0 ? stuck : blocks[ common ], automaton.classCount - frequencies[ common ] );
+			for( int64_t i = 0; i < automaton.classCount; i++ ) {
+				if( transitions[ i ] != common ) {
+					dispatcher->addCase( llvm::ConstantInt::get( byteType, i ), transitions[ i ] < 0 ? stuck : blocks[ transitions[ i ] ] );
+				}
+			}
+		}
+	}
+
+	typedef int64_t (*Matcher)( const char* data, int64_t length, bool isEarliest );
+
+	int64_t getLength( const char* string )
+	{
+		return( reinterpret_cast<const exo_string*>( string - offsetof( exo_string, data ) )->length );
+	}
+
+	exo_regex* compile( const char* pattern )
+	{
+		Parser parser = { pattern, pattern + getLength( pattern ), true };
+		bool isAnchored = false, isAtEnd = false;
+
+		// anchors are only known at the ends
+		if( parser.current < parser.end && *parser.current == '^' ) {
+			isAnchored = true;
+			parser.current++;
+		}
+
+		if( parser.current < parser.end && parser.end[-1] == '$' ) {
+			const char* escape = parser.end - 1;
+			while( escape > parser.current && escape[-1] == '\\' ) {
+				escape--;
+			}
+
+			if( ( parser.end - 1 - escape ) % 2 == 0 ) {
+				isAtEnd = true;
+				parser.end--;
+			}
+		}
+
+		Expression expression = parseAlternation( parser );
+		if( !parser.isValid || parser.current != parser.end ) {
+			return( nullptr );
+		}
+
+		std::vector<Node> nodes( 1 );
+		nodes.front().next = -1;
+		int64_t start = build( nodes, expression, EXO_REGEX_ACCEPT );
+
+		// anywhere is the pattern behind any bytes, which anchored patterns have no use for
+		int64_t anywhere = addEpsilons( nodes, start, -1 );
+		int64_t any = addNode( nodes, ~Bytes(), anywhere );
+		nodes[ anywhere ].epsilons.back() = any;
+
+		Automaton automaton, search;
+		if( nodes.size() > EXO_REGEX_NFA_LIMIT || !determinize( nodes, start, automaton ) ) {
+			return( nullptr );
+		}
+
+		// too large to search with, every start is tried instead
+		bool isSearching = !isAnchored && determinize( nodes, anywhere, search );
+		if( !isSearching ) {
+			search.accepting.clear();
+		}
+
+		// optimizing takes longer than it is worth for large automatons
+		int optimizeLvl = automaton.accepting.size() + search.accepting.size() <= EXO_REGEX_OPTIMIZE_LIMIT ? 2 : 0;
+		std::shared_ptr<exo::jit::Target> target = std::make_shared<exo::jit::Target>( llvm::sys::getDefaultTargetTriple(), llvm::sys::getHostCPUName(), optimizeLvl );
+		std::unique_ptr<llvm::Module> module = target->createModule( "regex" );
+		createMatcher( module.get(), automaton, "anchored", isAtEnd );
+
+		// the code has to stay for as long as the pattern is cached, which is forever
+		if( isSearching ) {
+			createMatcher( module.get(), search, "search", isAtEnd );
+		}
+
+		exo::jit::JIT* jit = new exo::jit::JIT( std::move( module ), target, std::set<std::string>() );
+
+		exo_regex* regex = static_cast<exo_regex*>( Runtime::Allocate( sizeof( exo_regex ), false ) );
+		regex->anchored = reinterpret_cast<Matcher>( jit->Compile( "anchored" ) );
+		regex->search = isSearching ? reinterpret_cast<Matcher>( jit->Compile( "search" ) ) : nullptr;
+		regex->isAnchored = isAnchored;
+
+		std::string prefix;
+		getPrefix( expression, prefix );
+		if( !isAnchored && !prefix.empty() ) {
+			regex->prefix = exo_string_new( prefix.data(), prefix.size() );
+			regex->prefixLength = prefix.size();
+		}
+
+		for( int byte = 0; byte < 256; byte++ ) {
+			regex->starts[ byte ] = automaton.accepting.front() || getTransition( automaton, 0, byte ) >= 0;
+		}
+
+		return( regex );
+	}
+
+	/*
+	 * the next occurrence of the prefix, its first and last byte are compared at 16 positions at once and only where both
+	 * fit the rest of it
+	 */
+	const char* findPrefix( const exo_regex* regex, const char* data, const char* end )
+	{
+		int64_t length = regex->prefixLength;
+
+#ifdef __SSE2__
+		const __m128i first = _mm_set1_epi8( regex->prefix[0] );
+		const __m128i last = _mm_set1_epi8( regex->prefix[ length - 1 ] );
+
+		for( ; end - data >= length + 15; data += 16 ) {
+			__m128i head = _mm_loadu_si128( reinterpret_cast<const __m128i*>( data ) );
+			__m128i tail = _mm_loadu_si128( reinterpret_cast<const __m128i*>( data + length - 1 ) );
+
+			for( unsigned mask = _mm_movemask_epi8( _mm_and_si128( _mm_cmpeq_epi8( head, first ), _mm_cmpeq_epi8( tail, last ) ) ); mask != 0; mask &= mask - 1 ) {
+				const char* candidate = data + __builtin_ctz( mask );
+				if( std::memcmp( candidate, regex->prefix, length ) == 0 ) {
+					return( candidate );
+				}
+			}
+		}
+#endif
+
+		for( ; end - data >= length; data++ ) {
+			data = static_cast<const char*>( std::memchr( data, regex->prefix[0], end - data - length + 1 ) );
+			if( data == nullptr ) {
+				return( nullptr );
+			} else if( std::memcmp( data, regex->prefix, length ) == 0 ) {
+				return( data );
+			}
+		}
+
+		return( nullptr );
+	}
+
+	/*
+	 * where the earliest match ends, or one that starts first without an automaton for searching
+	 */
+	int64_t search( const exo_regex* regex, const char* data, int64_t length )
+	{
+		if( regex->search != nullptr ) {
+			return( regex->search( data, length, true ) );
+		}
+
+		for( int64_t start = 0; start <= ( regex->isAnchored ? 0 : length ); start++ ) {
+			if( start < length && !regex->starts[ static_cast<unsigned char>( data[ start ] ) ] ) {
+				continue;
+			}
+
+			int64_t end = regex->anchored( data + start, length - start, true );
+			if( end >= 0 ) {
+				return( start + end );
+			}
+		}
+
+		return( -1 );
+	}
+
+	bool isMatch( const exo_regex* regex, const char* data, int64_t length )
+	{
+		// no match starts before the prefix does
+		if( regex->prefix != nullptr ) {
+			const char* candidate = findPrefix( regex, data, data + length );
+			if( candidate == nullptr ) {
+				return( false );
+			}
+
+			length -= candidate - data;
+			data = candidate;
+		}
+
+		return( search( regex, data, length ) >= 0 );
+	}
+
+	/*
+	 * the leftmost match has to start before the earliest one ends, so only the starts up to there are tried. the
+	 * longest match is taken from the first of them that matches at all
+	 */
+	int64_t find( const exo_regex* regex, const char* data, int64_t length, int64_t offset, int64_t& end )
+	{
+		if( offset < 0 || offset > length || ( regex->isAnchored && offset > 0 ) ) {
+			return( -1 );
+		}
+
+		int64_t start = offset;
+		if( regex->prefix != nullptr ) {
+			const char* candidate = findPrefix( regex, data + offset, data + length );
+			if( candidate == nullptr ) {
+				return( -1 );
+			}
+
+			start = candidate - data;
+		}
+
+		int64_t earliest = regex->isAnchored ? 0 : search( regex, data + start, length - start );
+		if( earliest < 0 ) {
+			return( -1 );
+		}
+
+		for( int64_t limit = start + earliest; start <= limit; start++ ) {
+			if( start < length && !regex->starts[ static_cast<unsigned char>( data[ start ] ) ] ) {
+				continue;
+			}
+
+			int64_t matched = regex->anchored( data + start, length - start, false );
+			if( matched >= 0 ) {
+				end = start + matched;
+				return( start );
+			}
+		}
+
+		return( -1 );
+	}
+
+	int64_t report( exo_array* match, int64_t start, int64_t end )
+	{
+		if( match != nullptr && match->length >= 2 ) {
+			static_cast<int64_t*>( match->data )[0] = start;
+			static_cast<int64_t*>( match->data )[1] = start < 0 ? -1 : end;
+		}
+
+		return( start );
+	}
+
+	/*
+	 * compiled patterns are never freed, the table is allocated by the collector so it keeps them alive. patterns are
+	 * interned, so they are looked up by pointer
+	 */
+#ifndef EXO_GC_DISABLE
+	typedef gc_allocator<std::pair<const char* const, exo_regex*>>	Allocator;
+#else
+	typedef std::allocator<std::pair<const char* const, exo_regex*>>	Allocator;
+#endif
+
+	std::mutex																				lock;
+	std::unordered_map<const char*, exo_regex*, std::hash<const char*>, std::equal_to<const char*>, Allocator>	compiled;
+}
+
+extern "C"
+{
+	/*
+	 * null for invalid patterns and for those whose automaton grows too large. the same pattern is only compiled once
+	 */
+	exo_regex* exo_regex_compile( const char* pattern )
+	{
+		if( pattern == nullptr ) {
+			return( nullptr );
+		}
+
+		pattern = exo_string_intern( pattern );
+		std::lock_guard<std::mutex> guard( lock );
+
+		auto existing = compiled.find( pattern );
+		if( existing != compiled.end() ) {
+			return( existing->second );
+		}
+
+		exo_regex* regex = compile( pattern );
+		compiled.emplace( pattern, regex );
+		return( regex );
+	}
+
+	// whether it matches anywhere in the string
+	bool exo_regex_match( exo_regex* regex, const char* string )
+	{
+		return( regex != nullptr && string != nullptr && isMatch( regex, string, getLength( string ) ) );
+	}
+
+	/*
+	 * the start of the leftmost longest match from the offset on, or -1. its start and end are stored in the first two
+	 * elements of match. the next match is found from the end on, or one after an empty match
+	 */
+	int64_t exo_regex_find( exo_regex* regex, const char* string, int64_t offset, exo_array* match )
+	{
+		int64_t end = -1;
+		int64_t start = regex == nullptr || string == nullptr ? -1 : find( regex, string, getLength( string ), offset, end );
+		return( report( match, start, end ) );
+	}
+
+	int64_t exo_regex_find_bytes( exo_regex* regex, exo_array* bytes, int64_t offset, exo_array* match )
+	{
+		int64_t end = -1;
+		int64_t start = regex == nullptr ? -1 : find( regex, static_cast<const char*>( bytes->data ), bytes->length, offset, end );
+		return( report( match, start, end ) );
+	}
+
+	/*
+	 * how many lines match, each on its own so anchors are at its ends. with a prefix, lines without it are not looked at
+	 */
+	int64_t exo_regex_count( exo_regex* regex, exo_array* bytes )
+	{
+		if( regex == nullptr ) {
+			return( 0 );
+		}
+
+		const char* data = static_cast<const char*>( bytes->data );
+		const char* end = data + bytes->length;
+		int64_t count = 0;
+
+		while( data < end ) {
+			if( regex->prefix != nullptr ) {
+				const char* candidate = findPrefix( regex, data, end );
+				if( candidate == nullptr ) {
+					break;
+				}
+
+				while( candidate > data && candidate[-1] != '\n' ) {
+					candidate--;
+				}
+				data = candidate;
+			}
+
+			const char* line = static_cast<const char*>( std::memchr( data, '\n', end - data ) );
+			if( line == nullptr ) {
+				line = end;
+			}
+
+			if( isMatch( regex, data, line - data ) ) {
+				count++;
+			}
+
+			data = line + 1;
+		}
+
+		return( count );
+	}
+}
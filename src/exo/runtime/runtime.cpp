@@ -0,0 +1,252 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "exo/exo.h"
+#include "exo/jit/llvm.h"
+#include "exo/runtime/runtime.h"
+
+#define EXO_RUNTIME_SYMBOL(s)	llvm::sys::DynamicLibrary::AddSymbol( #s, reinterpret_cast<void*>( &s ) )
+
+namespace exo
+{
+	namespace runtime
+	{
+		void Runtime::Register()
+		{
+			// arrays
+			EXO_RUNTIME_SYMBOL( exo_array_bounds );
+			EXO_RUNTIME_SYMBOL( exo_array_new );
+			EXO_RUNTIME_SYMBOL( exo_array_wrap );
+			EXO_RUNTIME_SYMBOL( exo_array_slice );
+			EXO_RUNTIME_SYMBOL( exo_array_reserve );
+			EXO_RUNTIME_SYMBOL( exo_array_resize );
+			EXO_RUNTIME_SYMBOL( exo_array_sort );
+			EXO_RUNTIME_SYMBOL( exo_array_select );
+
+			// strings
+			EXO_RUNTIME_SYMBOL( exo_string_new );
+			EXO_RUNTIME_SYMBOL( exo_string_wrap );
+			EXO_RUNTIME_SYMBOL( exo_string_hash );
+			EXO_RUNTIME_SYMBOL( exo_string_equals );
+			EXO_RUNTIME_SYMBOL( exo_string_compare );
+			EXO_RUNTIME_SYMBOL( exo_string_intern );
+			EXO_RUNTIME_SYMBOL( exo_string_concat );
+			EXO_RUNTIME_SYMBOL( exo_string_append );
+			EXO_RUNTIME_SYMBOL( exo_string_finish );
+
+			// memory mapped files
+			EXO_RUNTIME_SYMBOL( exo_mmap_open );
+			EXO_RUNTIME_SYMBOL( exo_mmap_bytes );
+			EXO_RUNTIME_SYMBOL( exo_mmap_advise );
+			EXO_RUNTIME_SYMBOL( exo_mmap_sync );
+			EXO_RUNTIME_SYMBOL( exo_mmap_close );
+
+			// buffered readers
+			EXO_RUNTIME_SYMBOL( exo_reader_open );
+			EXO_RUNTIME_SYMBOL( exo_reader_next );
+			EXO_RUNTIME_SYMBOL( exo_reader_record );
+			EXO_RUNTIME_SYMBOL( exo_reader_text );
+			EXO_RUNTIME_SYMBOL( exo_reader_close );
+
+			// io_uring
+			EXO_RUNTIME_SYMBOL( exo_uring_create );
+			EXO_RUNTIME_SYMBOL( exo_uring_read );
+			EXO_RUNTIME_SYMBOL( exo_uring_write );
+			EXO_RUNTIME_SYMBOL( exo_uring_open );
+			EXO_RUNTIME_SYMBOL( exo_uring_stat );
+			EXO_RUNTIME_SYMBOL( exo_uring_close );
+			EXO_RUNTIME_SYMBOL( exo_uring_register );
+			EXO_RUNTIME_SYMBOL( exo_uring_read_fixed );
+			EXO_RUNTIME_SYMBOL( exo_uring_write_fixed );
+			EXO_RUNTIME_SYMBOL( exo_uring_submit );
+			EXO_RUNTIME_SYMBOL( exo_uring_next );
+			EXO_RUNTIME_SYMBOL( exo_uring_data );
+			EXO_RUNTIME_SYMBOL( exo_uring_result );
+			EXO_RUNTIME_SYMBOL( exo_uring_is_kernel );
+			EXO_RUNTIME_SYMBOL( exo_uring_destroy );
+
+			// event loops
+			EXO_RUNTIME_SYMBOL( exo_epoll_create );
+			EXO_RUNTIME_SYMBOL( exo_epoll_watch );
+			EXO_RUNTIME_SYMBOL( exo_epoll_unwatch );
+			EXO_RUNTIME_SYMBOL( exo_epoll_wait );
+			EXO_RUNTIME_SYMBOL( exo_epoll_next );
+			EXO_RUNTIME_SYMBOL( exo_epoll_data );
+			EXO_RUNTIME_SYMBOL( exo_epoll_is_readable );
+			EXO_RUNTIME_SYMBOL( exo_epoll_is_writable );
+			EXO_RUNTIME_SYMBOL( exo_epoll_is_closed );
+			EXO_RUNTIME_SYMBOL( exo_epoll_file );
+			EXO_RUNTIME_SYMBOL( exo_epoll_close );
+
+			// sockets
+			EXO_RUNTIME_SYMBOL( exo_socket_listen_unix );
+			EXO_RUNTIME_SYMBOL( exo_socket_listen_tcp );
+			EXO_RUNTIME_SYMBOL( exo_socket_connect_unix );
+			EXO_RUNTIME_SYMBOL( exo_socket_connect_tcp );
+			EXO_RUNTIME_SYMBOL( exo_socket_port );
+			EXO_RUNTIME_SYMBOL( exo_socket_accept );
+			EXO_RUNTIME_SYMBOL( exo_socket_read );
+			EXO_RUNTIME_SYMBOL( exo_socket_write );
+			EXO_RUNTIME_SYMBOL( exo_socket_close );
+
+			// timers
+			EXO_RUNTIME_SYMBOL( exo_timer_create );
+			EXO_RUNTIME_SYMBOL( exo_timer_read );
+
+			// compression
+			EXO_RUNTIME_SYMBOL( exo_zlib_deflate );
+			EXO_RUNTIME_SYMBOL( exo_zlib_inflate );
+			EXO_RUNTIME_SYMBOL( exo_zlib_input );
+			EXO_RUNTIME_SYMBOL( exo_zlib_process );
+			EXO_RUNTIME_SYMBOL( exo_zlib_pending );
+			EXO_RUNTIME_SYMBOL( exo_zlib_is_done );
+			EXO_RUNTIME_SYMBOL( exo_zlib_reset );
+			EXO_RUNTIME_SYMBOL( exo_zlib_end );
+
+			// json
+			EXO_RUNTIME_SYMBOL( exo_json_create );
+			EXO_RUNTIME_SYMBOL( exo_json_parse );
+			EXO_RUNTIME_SYMBOL( exo_json_parse_bytes );
+			EXO_RUNTIME_SYMBOL( exo_json_error );
+			EXO_RUNTIME_SYMBOL( exo_json_root );
+			EXO_RUNTIME_SYMBOL( exo_json_type );
+			EXO_RUNTIME_SYMBOL( exo_json_first );
+			EXO_RUNTIME_SYMBOL( exo_json_next );
+			EXO_RUNTIME_SYMBOL( exo_json_key );
+			EXO_RUNTIME_SYMBOL( exo_json_field );
+			EXO_RUNTIME_SYMBOL( exo_json_at );
+			EXO_RUNTIME_SYMBOL( exo_json_length );
+			EXO_RUNTIME_SYMBOL( exo_json_string );
+			EXO_RUNTIME_SYMBOL( exo_json_float );
+			EXO_RUNTIME_SYMBOL( exo_json_int );
+			EXO_RUNTIME_SYMBOL( exo_json_bool );
+			EXO_RUNTIME_SYMBOL( exo_json_is_null );
+			EXO_RUNTIME_SYMBOL( exo_json_raw );
+			EXO_RUNTIME_SYMBOL( exo_json_event );
+			EXO_RUNTIME_SYMBOL( exo_json_current );
+			EXO_RUNTIME_SYMBOL( exo_json_skip );
+			EXO_RUNTIME_SYMBOL( exo_json_writer_create );
+			EXO_RUNTIME_SYMBOL( exo_json_writer_object );
+			EXO_RUNTIME_SYMBOL( exo_json_writer_object_end );
+			EXO_RUNTIME_SYMBOL( exo_json_writer_array );
+			EXO_RUNTIME_SYMBOL( exo_json_writer_array_end );
+			EXO_RUNTIME_SYMBOL( exo_json_writer_key );
+			EXO_RUNTIME_SYMBOL( exo_json_writer_string );
+			EXO_RUNTIME_SYMBOL( exo_json_writer_int );
+			EXO_RUNTIME_SYMBOL( exo_json_writer_float );
+			EXO_RUNTIME_SYMBOL( exo_json_writer_bool );
+			EXO_RUNTIME_SYMBOL( exo_json_writer_null );
+			EXO_RUNTIME_SYMBOL( exo_json_writer_value );
+			EXO_RUNTIME_SYMBOL( exo_json_writer_text );
+
+			// regular expressions
+			EXO_RUNTIME_SYMBOL( exo_regex_compile );
+			EXO_RUNTIME_SYMBOL( exo_regex_match );
+			EXO_RUNTIME_SYMBOL( exo_regex_find );
+			EXO_RUNTIME_SYMBOL( exo_regex_find_bytes );
+			EXO_RUNTIME_SYMBOL( exo_regex_count );
+
+			// printing
+			EXO_RUNTIME_SYMBOL( exo_print_lock );
+			EXO_RUNTIME_SYMBOL( exo_print_unlock );
+			EXO_RUNTIME_SYMBOL( exo_print_text );
+			EXO_RUNTIME_SYMBOL( exo_print_string );
+			EXO_RUNTIME_SYMBOL( exo_print_char );
+			EXO_RUNTIME_SYMBOL( exo_print_int );
+			EXO_RUNTIME_SYMBOL( exo_print_unsigned );
+			EXO_RUNTIME_SYMBOL( exo_print_float );
+
+			// tasks
+			EXO_RUNTIME_SYMBOL( exo_task_complete );
+			EXO_RUNTIME_SYMBOL( exo_task_await );
+			EXO_RUNTIME_SYMBOL( exo_task_run );
+			EXO_RUNTIME_SYMBOL( exo_sleep );
+			EXO_RUNTIME_SYMBOL( exo_readable );
+			EXO_RUNTIME_SYMBOL( exo_writable );
+
+			// jobs
+			EXO_RUNTIME_SYMBOL( exo_job_spawn );
+			EXO_RUNTIME_SYMBOL( exo_job_join );
+			EXO_RUNTIME_SYMBOL( exo_parallel_for );
+
+			// concurrent containers
+			EXO_RUNTIME_SYMBOL( exo_queue_create );
+			EXO_RUNTIME_SYMBOL( exo_queue_push );
+			EXO_RUNTIME_SYMBOL( exo_queue_pop );
+			EXO_RUNTIME_SYMBOL( exo_ring_create );
+			EXO_RUNTIME_SYMBOL( exo_ring_push );
+			EXO_RUNTIME_SYMBOL( exo_ring_pop );
+			EXO_RUNTIME_SYMBOL( exo_map_create );
+			EXO_RUNTIME_SYMBOL( exo_map_put );
+			EXO_RUNTIME_SYMBOL( exo_map_get );
+			EXO_RUNTIME_SYMBOL( exo_map_remove );
+			EXO_RUNTIME_SYMBOL( exo_map_size );
+
+			// hash maps and sets
+			EXO_RUNTIME_SYMBOL( exo_hash_new );
+			EXO_RUNTIME_SYMBOL( exo_hash_string );
+			EXO_RUNTIME_SYMBOL( exo_hash_insert );
+			EXO_RUNTIME_SYMBOL( exo_hash_erase );
+			EXO_RUNTIME_SYMBOL( exo_hash_clear );
+			EXO_RUNTIME_SYMBOL( exo_hash_collect );
+
+			// synchronization
+			EXO_RUNTIME_SYMBOL( exo_futex_wait );
+			EXO_RUNTIME_SYMBOL( exo_futex_wake );
+			EXO_RUNTIME_SYMBOL( exo_mutex_lock );
+			EXO_RUNTIME_SYMBOL( exo_mutex_unlock );
+			EXO_RUNTIME_SYMBOL( exo_thread_local );
+
+			// vector math
+			EXO_RUNTIME_SYMBOL( exo_vmath_sind2 );
+			EXO_RUNTIME_SYMBOL( exo_vmath_cosd2 );
+			EXO_RUNTIME_SYMBOL( exo_vmath_expd2 );
+			EXO_RUNTIME_SYMBOL( exo_vmath_logd2 );
+			EXO_RUNTIME_SYMBOL( exo_vmath_sqrtd2 );
+#ifdef EXO_VMATH_AVX
+			EXO_RUNTIME_SYMBOL( exo_vmath_sind4 );
+			EXO_RUNTIME_SYMBOL( exo_vmath_cosd4 );
+			EXO_RUNTIME_SYMBOL( exo_vmath_expd4 );
+			EXO_RUNTIME_SYMBOL( exo_vmath_logd4 );
+			EXO_RUNTIME_SYMBOL( exo_vmath_sqrtd4 );
+#endif
+		}
+
+		void* Runtime::Allocate( size_t size, bool isAtomic )
+		{
+			void* memory;
+
+#ifndef EXO_GC_DISABLE
+			if( isAtomic ) {
+				memory = GC_malloc_atomic( size );
+				if( memory != nullptr ) {
+					std::memset( memory, 0, size );
+				}
+			} else {
+				memory = GC_malloc( size );
+			}
+#else
+			memory = std::calloc( 1, size ? size : 1 );
+#endif
+
+			if( memory == nullptr ) {
+				EXO_LOG( fatal, "Out of memory while allocating " << size << " bytes" );
+				std::exit( EXIT_FAILURE );
+			}
+
+			return( memory );
+		}
+	}
+}
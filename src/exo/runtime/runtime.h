@@ -0,0 +1,584 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUNTIME_H_
+#define RUNTIME_H_
+
+#include "exo/exo.h"
+
+#include <atomic>
+
+#define EXO_TASK_DONE			-1
+#define EXO_JOB_DONE			1
+#define EXO_STRING_INTERNED		1
+#define EXO_STRING_BUILDER		2
+#define EXO_URING_BUFFERS		64
+#define EXO_JSON_WRITER_DEPTH	1024
+
+#define EXO_SORT_INT			0
+#define EXO_SORT_FLOAT			1
+#define EXO_SORT_BYTE			2
+#define EXO_SORT_STRING			3
+
+#if defined( __x86_64__ ) && defined( __GNUC__ )
+# define EXO_VMATH_AVX			__attribute__(( target( "avx" ) ))
+#endif
+
+namespace exo
+{
+	namespace runtime
+	{
+		/**
+		 * native helpers called by generated code, exported with C linkage
+		 */
+		class Runtime
+		{
+			public:
+				/**
+				 * Makes the runtime symbols resolvable for the JIT.
+				 */
+				static void Register();
+
+				/**
+				 * Allocates zeroed memory, atomic memory is never scanned for pointers by the garbage collector.
+				 */
+				static void* Allocate( size_t size, bool isAtomic );
+		};
+	}
+}
+
+extern "C"
+{
+	/**
+	 * header of a growable array, the layout matches __array<T> in the code generator
+	 */
+	struct exo_array
+	{
+		int64_t	length;
+		int64_t	capacity;
+		void*	data;
+	};
+
+	/**
+	 * reports an out of bounds array access and terminates, never returns
+	 */
+	[[noreturn]] void exo_array_bounds( const char* file, int64_t line, int64_t index, int64_t length );
+
+	exo_array* exo_array_new( const char* file, int64_t line, int64_t length, int64_t elementSize, int64_t isAtomic );
+	exo_array* exo_array_wrap( void* data, int64_t length );
+	exo_array* exo_array_slice( const char* file, int64_t line, exo_array* array, int64_t elementSize, int64_t lower, int64_t upper );
+	void exo_array_reserve( exo_array* array, int64_t capacity, int64_t elementSize, int64_t isAtomic );
+	void exo_array_resize( const char* file, int64_t line, exo_array* array, int64_t length, int64_t elementSize, int64_t isAtomic );
+
+	/**
+	 * sorts integers, floats, bytes or strings by their natural order, see EXO_SORT_*. floats order negative zero before
+	 * zero and nan last. large arrays are sorted in parallel on the job scheduler
+	 */
+	void exo_array_sort( exo_array* array, int64_t kind );
+
+	/**
+	 * moves the element which would be at nth once sorted there, with none greater before and none lower after it
+	 */
+	void exo_array_select( exo_array* array, int64_t kind, int64_t nth );
+
+	/**
+	 * header of a string, the layout matches __string in the code generator. strings point at their characters, which
+	 * follow it NUL terminated, so C gets them as they are. hash is 0 until it is first needed
+	 */
+	struct exo_string
+	{
+		int64_t					length;
+		std::atomic<uint64_t>	hash;
+		int64_t					flags;
+		char					data[1];
+	};
+
+	/**
+	 * strings returned by C get a header by copying them
+	 */
+	const char* exo_string_new( const char* data, int64_t length );
+	const char* exo_string_wrap( const char* string );
+	uint64_t exo_string_hash( const char* string );
+	bool exo_string_equals( const char* lhs, const char* rhs );
+	int64_t exo_string_compare( const char* lhs, const char* rhs );
+
+	/**
+	 * the one string with these contents shared by all interned ones, they compare by pointer
+	 */
+	const char* exo_string_intern( const char* string );
+
+	/**
+	 * the parts of a chain of + in one allocation
+	 */
+	const char* exo_string_concat( int64_t count, ... );
+
+	/**
+	 * appends the parts in place while the string has room, else continues in a builder twice the size. strings appended
+	 * to this way are finished before anything else gets to see them
+	 */
+	const char* exo_string_append( const char* string, int64_t count, ... );
+	const char* exo_string_finish( const char* string );
+
+	/**
+	 * a file mapped into memory, its bytes are a growable array pointing into the mapping
+	 */
+	struct exo_mapping
+	{
+		void*		data;
+		int64_t		length;
+		exo_array*	bytes;
+	};
+
+	/**
+	 * maps a whole file, null if it can not be opened. until it is closed its bytes are read and written in place, writes to
+	 * read only files stay in memory
+	 */
+	exo_mapping* exo_mmap_open( const char* path, bool isWritable );
+	exo_array* exo_mmap_bytes( exo_mapping* mapping );
+	bool exo_mmap_advise( exo_mapping* mapping, int64_t advice );
+	bool exo_mmap_sync( exo_mapping* mapping );
+	void exo_mmap_close( exo_mapping* mapping );
+
+	/**
+	 * reads records separated by a delimiter into a buffer reused for all of them. the record is an array pointing into it,
+	 * only valid until the next one is read
+	 */
+	struct exo_reader
+	{
+		int			file;
+		char*		buffer;
+		int64_t		capacity;
+		int64_t		start;
+		int64_t		end;
+		bool		isDone;
+		exo_array*	record;
+	};
+
+	/**
+	 * a reader of the file, or of stdin for "-". null if the file can not be opened
+	 */
+	exo_reader* exo_reader_open( const char* path );
+	bool exo_reader_next( exo_reader* reader, int64_t delimiter );
+	exo_array* exo_reader_record( exo_reader* reader );
+	const char* exo_reader_text( exo_reader* reader );
+	void exo_reader_close( exo_reader* reader );
+
+	/**
+	 * an io_uring, or the requests to run on submission where there is none. see exo/runtime/uring.cpp
+	 */
+	struct exo_uring_request;
+	struct exo_uring
+	{
+		int64_t				file;
+		void*				rings;
+		size_t				size;
+		void*				entries;
+		unsigned*			submitHead;
+		unsigned*			submitTail;
+		unsigned			submitMask;
+		unsigned*			submitArray;
+		unsigned*			completeHead;
+		unsigned*			completeTail;
+		unsigned			completeMask;
+		void*				completions;
+		int64_t				capacity;
+		int64_t				pending;
+
+		exo_uring_request*	requests;
+		int64_t				count;
+		int64_t				free;
+		int64_t				queued;
+		int64_t				queuedLast;
+		int64_t				completed;
+		int64_t				completedLast;
+
+		int64_t				data;
+		int64_t				result;
+		exo_array*			registered[ EXO_URING_BUFFERS ];
+		int64_t				buffers;
+	};
+
+	/**
+	 * requests are queued with some data to identify them by, false if there is no room. once completed the data and the
+	 * result, as returned by the system call or a negative errno, are taken one after the other. stats result in the size
+	 */
+	exo_uring* exo_uring_create( int64_t entries );
+	bool exo_uring_read( exo_uring* ring, int64_t file, exo_array* buffer, int64_t offset, int64_t data );
+	bool exo_uring_write( exo_uring* ring, int64_t file, exo_array* buffer, int64_t offset, int64_t data );
+	bool exo_uring_open( exo_uring* ring, const char* path, bool isWritable, int64_t data );
+	bool exo_uring_stat( exo_uring* ring, const char* path, int64_t data );
+	bool exo_uring_close( exo_uring* ring, int64_t file, int64_t data );
+	int64_t exo_uring_register( exo_uring* ring, exo_array* buffer );
+	bool exo_uring_read_fixed( exo_uring* ring, int64_t file, int64_t index, int64_t offset, int64_t data );
+	bool exo_uring_write_fixed( exo_uring* ring, int64_t file, int64_t index, int64_t offset, int64_t data );
+	int64_t exo_uring_submit( exo_uring* ring, int64_t wait );
+	bool exo_uring_next( exo_uring* ring );
+	int64_t exo_uring_data( exo_uring* ring );
+	int64_t exo_uring_result( exo_uring* ring );
+	bool exo_uring_is_kernel( exo_uring* ring );
+	void exo_uring_destroy( exo_uring* ring );
+
+	/**
+	 * an epoll instance and the events of its last wait, see exo/runtime/event.cpp
+	 */
+	struct exo_epoll
+	{
+		int64_t		file;
+		void*		events;
+		int64_t		capacity;
+		int64_t		count;
+		int64_t		index;
+		int64_t		data;
+		int64_t		flags;
+	};
+
+	/**
+	 * file descriptors are watched edge triggered with some data to tell them apart, the events of a wait are taken one after
+	 * the other
+	 */
+	exo_epoll* exo_epoll_create( int64_t capacity );
+	bool exo_epoll_watch( exo_epoll* loop, int64_t file, bool isReadable, bool isWritable, int64_t data );
+	bool exo_epoll_unwatch( exo_epoll* loop, int64_t file );
+	int64_t exo_epoll_wait( exo_epoll* loop, int64_t timeout );
+	bool exo_epoll_next( exo_epoll* loop );
+	int64_t exo_epoll_data( exo_epoll* loop );
+	bool exo_epoll_is_readable( exo_epoll* loop );
+	bool exo_epoll_is_writable( exo_epoll* loop );
+	bool exo_epoll_is_closed( exo_epoll* loop );
+	int64_t exo_epoll_file( exo_epoll* loop );
+	void exo_epoll_close( exo_epoll* loop );
+
+	/**
+	 * non-blocking sockets on the local machine, i.e. UNIX sockets and loopback TCP. they return the file descriptor or the
+	 * number of bytes, or a negative errno
+	 */
+	int64_t exo_socket_listen_unix( const char* path, int64_t backlog );
+	int64_t exo_socket_listen_tcp( int64_t port, int64_t backlog );
+	int64_t exo_socket_connect_unix( const char* path );
+	int64_t exo_socket_connect_tcp( int64_t port );
+	int64_t exo_socket_port( int64_t file );
+	int64_t exo_socket_accept( int64_t file );
+	int64_t exo_socket_read( int64_t file, exo_array* buffer, int64_t offset );
+	int64_t exo_socket_write( int64_t file, exo_array* buffer, int64_t offset, int64_t length );
+	int64_t exo_socket_close( int64_t file );
+
+	int64_t exo_timer_create( int64_t milliseconds, bool isRepeating );
+	int64_t exo_timer_read( int64_t file );
+
+	/**
+	 * a zlib stream, compressing or decompressing from one caller owned array into another. see exo/runtime/compress.cpp
+	 */
+	struct exo_zlib
+	{
+		void*		stream;
+		bool		isDeflate;
+		bool		isDone;
+		int64_t		format;
+		int64_t		remaining;
+		exo_array*	input;
+	};
+
+	/**
+	 * null if the level or format is invalid. processing returns the number of bytes written into the output or a negative
+	 * zlib error
+	 */
+	exo_zlib* exo_zlib_deflate( int64_t level, int64_t format );
+	exo_zlib* exo_zlib_inflate( int64_t format );
+	void exo_zlib_input( exo_zlib* zlib, exo_array* input );
+	int64_t exo_zlib_process( exo_zlib* zlib, exo_array* output, int64_t offset, bool isFinishing );
+	int64_t exo_zlib_pending( exo_zlib* zlib );
+	bool exo_zlib_is_done( exo_zlib* zlib );
+	bool exo_zlib_reset( exo_zlib* zlib );
+	void exo_zlib_end( exo_zlib* zlib );
+
+	/**
+	 * a JSON document indexed by the positions of its structural characters, see exo/runtime/json.cpp. values are
+	 * positions in the index, -1 for none
+	 */
+	struct exo_json
+	{
+		const void*	source;
+		const char*	text;
+		int64_t		length;
+		uint32_t*	index;
+		uint32_t*	links;
+		int64_t		count;
+		int64_t		capacity;
+		int64_t		error;
+		int64_t		cursor;
+		int64_t		current;
+	};
+
+	exo_json* exo_json_create();
+	bool exo_json_parse( exo_json* json, const char* text );
+	bool exo_json_parse_bytes( exo_json* json, exo_array* bytes );
+	int64_t exo_json_error( exo_json* json );
+	int64_t exo_json_root( exo_json* json );
+	int64_t exo_json_type( exo_json* json, int64_t value );
+	int64_t exo_json_first( exo_json* json, int64_t value );
+	int64_t exo_json_next( exo_json* json, int64_t value );
+	const char* exo_json_key( exo_json* json, int64_t value );
+	int64_t exo_json_field( exo_json* json, int64_t value, const char* key );
+	int64_t exo_json_at( exo_json* json, int64_t value, int64_t position );
+	int64_t exo_json_length( exo_json* json, int64_t value );
+	const char* exo_json_string( exo_json* json, int64_t value );
+	double exo_json_float( exo_json* json, int64_t value );
+	int64_t exo_json_int( exo_json* json, int64_t value );
+	bool exo_json_bool( exo_json* json, int64_t value );
+	bool exo_json_is_null( exo_json* json, int64_t value );
+	const char* exo_json_raw( exo_json* json, int64_t value );
+
+	/**
+	 * events of the streaming interface, from 0 for the end on: object start and end, array start and end, key, string,
+	 * number, true, false and null
+	 */
+	int64_t exo_json_event( exo_json* json );
+	int64_t exo_json_current( exo_json* json );
+	void exo_json_skip( exo_json* json );
+
+	/**
+	 * writes JSON into a string built in place, which is handed over as it is
+	 */
+	struct exo_json_writer
+	{
+		exo_string*	string;
+		int64_t		capacity;
+		int64_t		length;
+		int64_t		initial;
+		int64_t		depth;
+		bool		isAfterKey;
+		uint64_t	hasElements[ EXO_JSON_WRITER_DEPTH / 64 ];
+	};
+
+	exo_json_writer* exo_json_writer_create( int64_t capacity );
+	void exo_json_writer_object( exo_json_writer* writer );
+	void exo_json_writer_object_end( exo_json_writer* writer );
+	void exo_json_writer_array( exo_json_writer* writer );
+	void exo_json_writer_array_end( exo_json_writer* writer );
+	void exo_json_writer_key( exo_json_writer* writer, const char* key );
+	void exo_json_writer_string( exo_json_writer* writer, const char* string );
+	void exo_json_writer_int( exo_json_writer* writer, int64_t value );
+	void exo_json_writer_float( exo_json_writer* writer, double value );
+	void exo_json_writer_bool( exo_json_writer* writer, bool value );
+	void exo_json_writer_null( exo_json_writer* writer );
+	void exo_json_writer_value( exo_json_writer* writer, exo_json* json, int64_t value );
+	const char* exo_json_writer_text( exo_json_writer* writer );
+
+	/**
+	 * a pattern compiled into native code, cached for as long as the program runs. search returns where a match ends
+	 * anywhere, anchored where one from the start ends, the earliest or the longest one, or -1 if there is none. search
+	 * is null for anchored patterns and those too large for it. every match of an unanchored one starts with the prefix
+	 */
+	struct exo_regex
+	{
+		int64_t		(*search)( const char* data, int64_t length, bool isEarliest );
+		int64_t		(*anchored)( const char* data, int64_t length, bool isEarliest );
+		const char*	prefix;
+		int64_t		prefixLength;
+		bool		isAnchored;
+		bool		starts[256];
+	};
+
+	exo_regex* exo_regex_compile( const char* pattern );
+	bool exo_regex_match( exo_regex* regex, const char* string );
+	int64_t exo_regex_find( exo_regex* regex, const char* string, int64_t offset, exo_array* match );
+	int64_t exo_regex_find_bytes( exo_regex* regex, exo_array* bytes, int64_t offset, exo_array* match );
+	int64_t exo_regex_count( exo_regex* regex, exo_array* bytes );
+
+	/**
+	 * the conversions of printf calls with a constant format, written to stdout while holding its lock. they return the
+	 * number of characters written
+	 */
+	void exo_print_lock();
+	void exo_print_unlock();
+	int64_t exo_print_text( const char* text, int64_t length );
+	int64_t exo_print_string( const char* string );
+	int64_t exo_print_char( int64_t character );
+	int64_t exo_print_int( int64_t value );
+	int64_t exo_print_unsigned( uint64_t value, int64_t base, int64_t isUpper );
+	int64_t exo_print_float( double value, int64_t precision, int64_t conversion );
+
+	/**
+	 * header of an async function frame or a native task, the layout matches __task<T> in the code generator.
+	 * state is 0 before the first resume, the await point to continue at while suspended or EXO_TASK_DONE
+	 */
+	struct exo_task
+	{
+		int64_t	state;
+		void	(*resume)( exo_task* task );
+		exo_task*	waiter;
+	};
+
+	/**
+	 * marks a task as done and schedules the task awaiting it
+	 */
+	void exo_task_complete( exo_task* task );
+
+	/**
+	 * registers the suspended waiter to be resumed once task is done, a task has at most one waiter
+	 */
+	void exo_task_await( exo_task* task, exo_task* waiter );
+
+	/**
+	 * resumes ready tasks and waits for timers and file descriptors until task is done
+	 */
+	void exo_task_run( exo_task* task );
+
+	/**
+	 * native tasks, done after the given milliseconds or once the file descriptor is readable/writable
+	 */
+	exo_task* exo_sleep( int64_t milliseconds );
+	exo_task* exo_readable( int64_t fd );
+	exo_task* exo_writable( int64_t fd );
+
+	/**
+	 * header of a spawned call, the layout matches __future<T> in the code generator.
+	 * run is called by whichever worker takes the job, state becomes EXO_JOB_DONE once it returned
+	 */
+	struct exo_job
+	{
+		void					(*run)( exo_job* job );
+		std::atomic<int64_t>	state;
+	};
+
+	/**
+	 * pushes the job onto the deque of the calling worker, idle workers steal it from there
+	 */
+	void exo_job_spawn( exo_job* job );
+
+	/**
+	 * runs pending jobs, own ones first, until job is done
+	 */
+	void exo_job_join( exo_job* job );
+
+	/**
+	 * a parallel for loop outlined by the code generator. body runs the iterations from up to to, accumulating into
+	 * partial reductions of size bytes. partials start as a copy of identity and are merged by combine in iteration order
+	 */
+	struct exo_loop
+	{
+		void	(*body)( void* context, void* partials, int64_t from, int64_t to );
+		void	(*combine)( void* partials, void* other );
+		void*	context;
+		void*	identity;
+		int64_t	size;
+	};
+
+	/**
+	 * runs the iterations 0 up to count of loop on the workers, returns once all are done and merged into partials
+	 */
+	void exo_parallel_for( exo_loop* loop, int64_t count, void* partials );
+
+	/**
+	 * bounded multi producer multi consumer queue, push fails while it is full and pop while it is empty
+	 */
+	struct exo_queue;
+
+	exo_queue* exo_queue_create( int64_t capacity );
+	bool exo_queue_push( exo_queue* queue, int64_t value );
+	bool exo_queue_pop( exo_queue* queue, int64_t* value );
+
+	/**
+	 * bounded single producer single consumer ring buffer
+	 */
+	struct exo_ring;
+
+	exo_ring* exo_ring_create( int64_t capacity );
+	bool exo_ring_push( exo_ring* ring, int64_t value );
+	bool exo_ring_pop( exo_ring* ring, int64_t* value );
+
+	/**
+	 * hash map of a fixed capacity, put fails once all slots are taken. removed keys keep their slot
+	 */
+	struct exo_map;
+
+	exo_map* exo_map_create( int64_t capacity );
+	bool exo_map_put( exo_map* map, int64_t key, int64_t value );
+	bool exo_map_get( exo_map* map, int64_t key, int64_t* value );
+	bool exo_map_remove( exo_map* map, int64_t key );
+	int64_t exo_map_size( exo_map* map );
+
+	/**
+	 * header of a hash map or set, the layout matches __map<T> and __set<T> in the code generator. slots hold the key
+	 * followed by the value, keySize is 0 for strings which hash their contents
+	 */
+	struct exo_hash
+	{
+		uint8_t*	control;
+		void*		slots;
+		int64_t		mask;
+		uint64_t	seed;
+		int64_t		size;
+		int64_t		growthLeft;
+		int64_t		slotSize;
+		int64_t		keySize;
+		int64_t		isAtomic;
+	};
+
+	exo_hash* exo_hash_new( int64_t capacity, int64_t slotSize, int64_t keySize, int64_t isAtomic );
+	uint64_t exo_hash_string( const char* string, uint64_t seed );
+
+	/**
+	 * slow paths of the inlined lookups. insert claims a slot for a key that is not in the table yet and returns it
+	 */
+	void* exo_hash_insert( exo_hash* map, uint64_t hash );
+	void exo_hash_erase( exo_hash* map, void* slot );
+	void exo_hash_clear( exo_hash* map );
+
+	/**
+	 * copies size bytes at offset of each slot into a new array, i.e. the keys or values
+	 */
+	exo_array* exo_hash_collect( exo_hash* map, int64_t offset, int64_t size, int64_t isAtomic );
+
+	/**
+	 * blocks while address still holds expected, or until woken. wake wakes up to count waiters
+	 */
+	void exo_futex_wait( std::atomic<int64_t>* address, int64_t expected );
+	void exo_futex_wake( std::atomic<int64_t>* address, int64_t count );
+
+	/**
+	 * slow paths of mutexes, the uncontended lock and unlock are inlined by the generated code
+	 */
+	void exo_mutex_lock( std::atomic<int64_t>* state );
+	void exo_mutex_unlock( std::atomic<int64_t>* state );
+
+	/**
+	 * the calling thread's copy of a thread local, initialized with size bytes of initial on its first access
+	 */
+	void* exo_thread_local( std::atomic<int64_t>* slot, const void* initial, int64_t size );
+
+	/**
+	 * vector variants of sin, cos, exp, log and sqrt for vectorized loops, in the registers LLVM passes <2 x double> and
+	 * <4 x double> in. the latter only exist for x86-64 and need avx
+	 */
+	typedef double exo_double2 __attribute__(( vector_size( 16 ) ));
+	typedef double exo_double4 __attribute__(( vector_size( 32 ) ));
+
+	exo_double2 exo_vmath_sind2( exo_double2 x );
+	exo_double2 exo_vmath_cosd2( exo_double2 x );
+	exo_double2 exo_vmath_expd2( exo_double2 x );
+	exo_double2 exo_vmath_logd2( exo_double2 x );
+	exo_double2 exo_vmath_sqrtd2( exo_double2 x );
+
+#ifdef EXO_VMATH_AVX
+	EXO_VMATH_AVX exo_double4 exo_vmath_sind4( exo_double4 x );
+	EXO_VMATH_AVX exo_double4 exo_vmath_cosd4( exo_double4 x );
+	EXO_VMATH_AVX exo_double4 exo_vmath_expd4( exo_double4 x );
+	EXO_VMATH_AVX exo_double4 exo_vmath_logd4( exo_double4 x );
+	EXO_VMATH_AVX exo_double4 exo_vmath_sqrtd4( exo_double4 x );
+#endif
+}
+
+#endif /* RUNTIME_H_ */
@@ -0,0 +1,497 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "exo/exo.h"
+#include "exo/runtime/runtime.h"
+
+#include <algorithm>
+#include <thread>
+
+#if defined( __x86_64__ ) && defined( __GNUC__ )
+# include <immintrin.h>
+# define EXO_SORT_AVX2
+#endif
+
+#define EXO_SORT_SMALL			16
+#define EXO_SORT_PARALLEL		65536
+#define EXO_SORT_MERGE			16384
+#define EXO_SORT_LEAVES			4
+
+using exo::runtime::Runtime;
+
+/*
+ * arrays are sorted in place by the natural order of their elements, which is the only one there is for primitives, so
+ * stable and unstable sorts are the same. each element type gets an introsort of its own with the comparison inlined.
+ * partitions of up to 16 integers end in a sorting network in AVX2 registers where the cpu has them. large arrays are
+ * merge sorted on the workers of the job scheduler
+ */
+namespace
+{
+	struct IntOrder
+	{
+		bool operator()( int64_t lhs, int64_t rhs ) const
+		{
+			return( lhs < rhs );
+		}
+	};
+
+	struct StringOrder
+	{
+		bool operator()( const char* lhs, const char* rhs ) const
+		{
+			return( exo_string_compare( lhs, rhs ) < 0 );
+		}
+	};
+
+	// the bits of a float as an integer in the same order, negative zero before zero and nan last. its own inverse
+	int64_t getOrderedBits( int64_t bits )
+	{
+		return( bits ^ ( ( bits >> 63 ) & INT64_MAX ) );
+	}
+
+	template<typename T, typename Less> void insertionSort( T* data, int64_t length, Less less )
+	{
+		for( int64_t i = 1; i < length; i++ ) {
+			T value = data[ i ];
+			int64_t j = i;
+
+			for( ; j > 0 && less( value, data[ j - 1 ] ); j-- ) {
+				data[ j ] = data[ j - 1 ];
+			}
+
+			data[ j ] = value;
+		}
+	}
+
+	template<typename T, typename Less> void sortSmall( T* data, int64_t length, Less less )
+	{
+		insertionSort( data, length, less );
+	}
+
+#ifdef EXO_SORT_AVX2
+	__attribute__(( target( "avx2" ) )) inline void exchange( __m256i& lower, __m256i& upper )
+	{
+		__m256i isGreater = _mm256_cmpgt_epi64( lower, upper );
+		__m256i minimum = _mm256_blendv_epi8( lower, upper, isGreater );
+
+		upper = _mm256_blendv_epi8( upper, lower, isGreater );
+		lower = minimum;
+	}
+
+	// sorts the four lanes of a bitonic sequence, comparing lanes two and then one apart
+	__attribute__(( target( "avx2" ) )) inline __m256i sortBitonic( __m256i values )
+	{
+		__m256i other = _mm256_permute4x64_epi64( values, _MM_SHUFFLE( 1, 0, 3, 2 ) );
+		exchange( values, other );
+		values = _mm256_blend_epi32( values, other, 0xF0 );
+
+		other = _mm256_permute4x64_epi64( values, _MM_SHUFFLE( 2, 3, 0, 1 ) );
+		exchange( values, other );
+		return( _mm256_blend_epi32( values, other, 0xCC ) );
+	}
+
+	__attribute__(( target( "avx2" ) )) inline __m256i reverse( __m256i values )
+	{
+		return( _mm256_permute4x64_epi64( values, _MM_SHUFFLE( 0, 1, 2, 3 ) ) );
+	}
+
+	/*
+	 * pads up to 16 integers with the largest one into four registers. a network sorts the columns, which become rows of
+	 * four once transposed. bitonic merges join them into two runs of eight and those into one run
+	 */
+	__attribute__(( target( "avx2" ) )) void sortNetwork( int64_t* data, int64_t length )
+	{
+		alignas( 32 ) int64_t padded[ EXO_SORT_SMALL ];
+		std::fill( padded + length, padded + EXO_SORT_SMALL, INT64_MAX );
+		std::copy( data, data + length, padded );
+
+		__m256i a = _mm256_load_si256( reinterpret_cast<__m256i*>( padded ) );
+		__m256i b = _mm256_load_si256( reinterpret_cast<__m256i*>( padded + 4 ) );
+		__m256i c = _mm256_load_si256( reinterpret_cast<__m256i*>( padded + 8 ) );
+		__m256i d = _mm256_load_si256( reinterpret_cast<__m256i*>( padded + 12 ) );
+
+		exchange( a, b );
+		exchange( c, d );
+		exchange( a, c );
+		exchange( b, d );
+		exchange( b, c );
+
+		__m256i low01 = _mm256_unpacklo_epi64( a, b );
+		__m256i high01 = _mm256_unpackhi_epi64( a, b );
+		__m256i low23 = _mm256_unpacklo_epi64( c, d );
+		__m256i high23 = _mm256_unpackhi_epi64( c, d );
+		a = _mm256_permute2x128_si256( low01, low23, 0x20 );
+		b = _mm256_permute2x128_si256( high01, high23, 0x20 );
+		c = _mm256_permute2x128_si256( low01, low23, 0x31 );
+		d = _mm256_permute2x128_si256( high01, high23, 0x31 );
+
+		b = reverse( b );
+		exchange( a, b );
+		a = sortBitonic( a );
+		b = sortBitonic( b );
+
+		d = reverse( d );
+		exchange( c, d );
+		c = sortBitonic( c );
+		d = sortBitonic( d );
+
+		__m256i e = reverse( d );
+		__m256i f = reverse( c );
+		exchange( a, e );
+		exchange( b, f );
+
+		exchange( a, b );
+		exchange( e, f );
+
+		_mm256_store_si256( reinterpret_cast<__m256i*>( padded ), sortBitonic( a ) );
+		_mm256_store_si256( reinterpret_cast<__m256i*>( padded + 4 ), sortBitonic( b ) );
+		_mm256_store_si256( reinterpret_cast<__m256i*>( padded + 8 ), sortBitonic( e ) );
+		_mm256_store_si256( reinterpret_cast<__m256i*>( padded + 12 ), sortBitonic( f ) );
+
+		std::copy( padded, padded + length, data );
+	}
+
+	bool hasNetwork()
+	{
+		static bool isSupported = ( __builtin_cpu_init(), __builtin_cpu_supports( "avx2" ) );
+		return( isSupported );
+	}
+
+	void sortSmall( int64_t* data, int64_t length, IntOrder less )
+	{
+		if( length > 4 && hasNetwork() ) {
+			sortNetwork( data, length );
+		} else {
+			insertionSort( data, length, less );
+		}
+	}
+#endif
+
+	int getDepth( int64_t length )
+	{
+		int depth = 0;
+		for( ; length > 1; length >>= 1 ) {
+			depth += 2;
+		}
+
+		return( depth );
+	}
+
+	/*
+	 * partitions around the median of the elements at a quarter, half and three quarters into the elements lower than it, the
+	 * ones equal to it from lower up to upper and the rest. every element is swapped with the first one not known to be lower, which
+	 * only moves on past lower ones, so no branch depends on a comparison. copies of the pivot are only gathered once it is
+	 * the minimum, which is how runs of equal elements end up
+	 */
+	template<typename T, typename Less> void partition( T* data, int64_t length, Less less, int64_t& lower, int64_t& upper )
+	{
+		// the ends are avoided, partitioning leaves the largest upper element first
+		T* first = data + length / 4;
+		T* middle = data + length / 2;
+		T* last = data + length - length / 4;
+
+		if( less( *middle, *first ) ) {
+			std::swap( *middle, *first );
+		}
+		if( less( *last, *middle ) ) {
+			std::swap( *last, *middle );
+			if( less( *middle, *first ) ) {
+				std::swap( *middle, *first );
+			}
+		}
+		std::swap( *middle, *data );
+
+		T pivot = *data;
+		upper = 1;
+
+		for( int64_t i = 1; i < length; i++ ) {
+			T value = data[ i ];
+			bool isLower = less( value, pivot );
+			data[ i ] = data[ upper ];
+			data[ upper ] = value;
+			upper += isLower;
+		}
+
+		lower = upper - 1;
+		std::swap( data[ 0 ], data[ lower ] );
+
+		if( lower > 0 ) {
+			return;
+		}
+
+		for( int64_t i = 1; i < length; i++ ) {
+			T value = data[ i ];
+			bool isEqual = !less( pivot, value );
+			data[ i ] = data[ upper ];
+			data[ upper ] = value;
+			upper += isEqual;
+		}
+	}
+
+	// recurses into the smaller part only and falls back to heap sort when partitions keep being lopsided
+	template<typename T, typename Less> void sort( T* data, int64_t length, int depth, Less less )
+	{
+		while( length > EXO_SORT_SMALL ) {
+			if( depth-- == 0 ) {
+				std::make_heap( data, data + length, less );
+				std::sort_heap( data, data + length, less );
+				return;
+			}
+
+			int64_t lower, upper;
+			partition( data, length, less, lower, upper );
+
+			if( lower < length - upper ) {
+				sort( data, lower, depth, less );
+				data += upper;
+				length -= upper;
+			} else {
+				sort( data + upper, length - upper, depth, less );
+				length = lower;
+			}
+		}
+
+		sortSmall( data, length, less );
+	}
+
+	// only keeps partitioning the part holding nth
+	template<typename T, typename Less> void selectNth( T* data, int64_t length, int64_t nth, Less less )
+	{
+		int depth = getDepth( length );
+
+		while( length > EXO_SORT_SMALL ) {
+			if( depth-- == 0 ) {
+				sort( data, length, 0, less );
+				return;
+			}
+
+			int64_t lower, upper;
+			partition( data, length, less, lower, upper );
+
+			if( nth < lower ) {
+				length = lower;
+			} else if( nth >= upper ) {
+				data += upper;
+				length -= upper;
+				nth -= upper;
+			} else {
+				return;
+			}
+		}
+
+		sortSmall( data, length, less );
+	}
+
+	// there are only 256 bytes, so counting them beats comparing them. selecting counts as well
+	void countingSort( uint8_t* data, int64_t length )
+	{
+		int64_t counts[ 256 ] = {};
+		for( int64_t i = 0; i < length; i++ ) {
+			counts[ data[ i ] ]++;
+		}
+
+		for( int value = 0; value < 256; value++ ) {
+			std::memset( data, value, counts[ value ] );
+			data += counts[ value ];
+		}
+	}
+
+	template<typename T, typename Less> struct Merge
+	{
+		exo_job		job;
+		const T*	left;
+		int64_t		leftLength;
+		const T*	right;
+		int64_t		rightLength;
+		T*			output;
+		Less		less;
+	};
+
+	template<typename T, typename Less> void merge( const T* left, int64_t leftLength, const T* right, int64_t rightLength, T* output, Less less );
+
+	template<typename T, typename Less> void runMerge( exo_job* job )
+	{
+		Merge<T, Less>* part = reinterpret_cast<Merge<T, Less>*>( job );
+		merge( part->left, part->leftLength, part->right, part->rightLength, part->output, part->less );
+	}
+
+	/*
+	 * large merges split the longer run in half and the other one where that half ends, both pairs are merged on their own.
+	 * equal elements are indistinguishable, so it does not matter which run they are taken from
+	 */
+	template<typename T, typename Less> void merge( const T* left, int64_t leftLength, const T* right, int64_t rightLength, T* output, Less less )
+	{
+		if( leftLength + rightLength <= EXO_SORT_MERGE ) {
+			std::merge( left, left + leftLength, right, right + rightLength, output, less );
+			return;
+		}
+
+		if( leftLength < rightLength ) {
+			std::swap( left, right );
+			std::swap( leftLength, rightLength );
+		}
+
+		int64_t leftHalf = leftLength / 2;
+		int64_t rightHalf = std::lower_bound( right, right + rightLength, left[ leftHalf ], less ) - right;
+
+		Merge<T, Less> first;
+		first.job.run = runMerge<T, Less>;
+		first.job.state.store( 0, std::memory_order_relaxed );
+		first.left = left;
+		first.leftLength = leftHalf;
+		first.right = right;
+		first.rightLength = rightHalf;
+		first.output = output;
+		first.less = less;
+		exo_job_spawn( &first.job );
+
+		merge( left + leftHalf, leftLength - leftHalf, right + rightHalf, rightLength - rightHalf, output + leftHalf + rightHalf, less );
+		exo_job_join( &first.job );
+	}
+
+	template<typename T, typename Less> struct Sort
+	{
+		exo_job	job;
+		T*		data;
+		T*		buffer;
+		int64_t	length;
+		int64_t	grain;
+		bool	isIntoBuffer;
+		Less	less;
+	};
+
+	template<typename T, typename Less> void sortParallel( T* data, T* buffer, int64_t length, int64_t grain, bool isIntoBuffer, Less less );
+
+	template<typename T, typename Less> void runSort( exo_job* job )
+	{
+		Sort<T, Less>* part = reinterpret_cast<Sort<T, Less>*>( job );
+		sortParallel( part->data, part->buffer, part->length, part->grain, part->isIntoBuffer, part->less );
+	}
+
+	/*
+	 * both halves are sorted into the other array than ours and merged from there into ours, so the elements move once per
+	 * level instead of being copied back after each merge
+	 */
+	template<typename T, typename Less> void sortParallel( T* data, T* buffer, int64_t length, int64_t grain, bool isIntoBuffer, Less less )
+	{
+		if( length <= grain ) {
+			sort( data, length, getDepth( length ), less );
+			if( isIntoBuffer ) {
+				std::copy( data, data + length, buffer );
+			}
+			return;
+		}
+
+		int64_t half = length / 2;
+
+		Sort<T, Less> first;
+		first.job.run = runSort<T, Less>;
+		first.job.state.store( 0, std::memory_order_relaxed );
+		first.data = data;
+		first.buffer = buffer;
+		first.length = half;
+		first.grain = grain;
+		first.isIntoBuffer = !isIntoBuffer;
+		first.less = less;
+		exo_job_spawn( &first.job );
+
+		sortParallel( data + half, buffer + half, length - half, grain, !isIntoBuffer, less );
+		exo_job_join( &first.job );
+
+		if( isIntoBuffer ) {
+			merge<T, Less>( data, half, data + half, length - half, buffer, less );
+		} else {
+			merge<T, Less>( buffer, half, buffer + half, length - half, data, less );
+		}
+	}
+
+	// a few leaves per worker, so the ones finishing early can steal. a single worker would only add merges
+	template<typename T, typename Less> void sortAll( T* data, int64_t length, bool isAtomic, Less less )
+	{
+		// sorted or reversed input is common, anything else is told apart after a few elements
+		if( std::is_sorted( data, data + length, less ) ) {
+			return;
+		} else if( std::is_sorted( data, data + length, [less]( const T& lhs, const T& rhs ) { return( less( rhs, lhs ) ); } ) ) {
+			std::reverse( data, data + length );
+			return;
+		}
+
+		int64_t workers = std::thread::hardware_concurrency();
+		if( workers < 2 || length < 2 * EXO_SORT_PARALLEL ) {
+			sort( data, length, getDepth( length ), less );
+			return;
+		}
+
+		int64_t grain = std::max<int64_t>( length / ( workers * EXO_SORT_LEAVES ), EXO_SORT_PARALLEL );
+		T* buffer = static_cast<T*>( Runtime::Allocate( length * sizeof( T ), isAtomic ) );
+
+		sortParallel( data, buffer, length, grain, false, less );
+	}
+
+	// floats are sorted as integers with the same order
+	void mapFloats( int64_t* data, int64_t length )
+	{
+		for( int64_t i = 0; i < length; i++ ) {
+			data[ i ] = getOrderedBits( data[ i ] );
+		}
+	}
+}
+
+extern "C"
+{
+	void exo_array_sort( exo_array* array, int64_t kind )
+	{
+		switch( kind ) {
+			case EXO_SORT_INT:
+				sortAll( static_cast<int64_t*>( array->data ), array->length, true, IntOrder() );
+				break;
+			case EXO_SORT_FLOAT:
+				mapFloats( static_cast<int64_t*>( array->data ), array->length );
+				sortAll( static_cast<int64_t*>( array->data ), array->length, true, IntOrder() );
+				mapFloats( static_cast<int64_t*>( array->data ), array->length );
+				break;
+			case EXO_SORT_BYTE:
+				countingSort( static_cast<uint8_t*>( array->data ), array->length );
+				break;
+			case EXO_SORT_STRING:
+				sortAll( static_cast<const char**>( array->data ), array->length, false, StringOrder() );
+				break;
+		}
+	}
+
+	void exo_array_select( exo_array* array, int64_t kind, int64_t nth )
+	{
+		if( nth < 0 || nth >= array->length ) {
+			return;
+		}
+
+		switch( kind ) {
+			case EXO_SORT_INT:
+				selectNth( static_cast<int64_t*>( array->data ), array->length, nth, IntOrder() );
+				break;
+			case EXO_SORT_FLOAT:
+				mapFloats( static_cast<int64_t*>( array->data ), array->length );
+				selectNth( static_cast<int64_t*>( array->data ), array->length, nth, IntOrder() );
+				mapFloats( static_cast<int64_t*>( array->data ), array->length );
+				break;
+			case EXO_SORT_BYTE:
+				countingSort( static_cast<uint8_t*>( array->data ), array->length );
+				break;
+			case EXO_SORT_STRING:
+				selectNth( static_cast<const char**>( array->data ), array->length, nth, StringOrder() );
+				break;
+		}
+	}
+}
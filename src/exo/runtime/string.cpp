@@ -0,0 +1,329 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "exo/exo.h"
+#include "exo/runtime/runtime.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstddef>
+#include <mutex>
+#include <unordered_set>
+
+#ifndef EXO_GC_DISABLE
+# include <gc/gc_allocator.h>
+#endif
+
+#define EXO_BUILDER_MINIMUM		64
+#define EXO_BUILDER_CHUNK		( 1 << 20 )
+
+using exo::runtime::Runtime;
+
+namespace
+{
+	exo_string* getHeader( const char* string )
+	{
+		return( reinterpret_cast<exo_string*>( const_cast<char*>( string ) - offsetof( exo_string, data ) ) );
+	}
+
+	int64_t getLength( const char* string )
+	{
+		return( string == nullptr ? 0 : getHeader( string )->length );
+	}
+
+	exo_string* allocate( int64_t length )
+	{
+		exo_string* string = static_cast<exo_string*>( Runtime::Allocate( offsetof( exo_string, data ) + length + 1, true ) );
+		string->length = length;
+		return( string );
+	}
+
+	/*
+	 * in front of the header of strings being appended to. past a chunk builders stop moving their characters, a new chunk
+	 * links the filled ones, which form a rope copied only once when it is finished
+	 */
+	struct Builder
+	{
+		int64_t		capacity;
+		const char*	previous;
+	};
+
+	Builder* getBuilder( const char* string )
+	{
+		return( reinterpret_cast<Builder*>( getHeader( string ) ) - 1 );
+	}
+
+	// chunks linking filled ones have to be scanned by the collector
+	char* createBuilder( int64_t capacity, const char* previous )
+	{
+		Builder* builder = static_cast<Builder*>( Runtime::Allocate( sizeof( Builder ) + offsetof( exo_string, data ) + capacity + 1, previous == nullptr ) );
+		builder->capacity = capacity;
+		builder->previous = previous;
+
+		exo_string* string = reinterpret_cast<exo_string*>( builder + 1 );
+		string->flags = EXO_STRING_BUILDER;
+		return( string->data );
+	}
+
+	int64_t measure( int64_t count, va_list parts )
+	{
+		va_list copy;
+		va_copy( copy, parts );
+
+		int64_t length = 0;
+		for( int64_t i = 0; i < count; i++ ) {
+			length += getLength( va_arg( copy, const char* ) );
+		}
+
+		va_end( copy );
+		return( length );
+	}
+
+	char* copy( char* destination, int64_t count, va_list parts )
+	{
+		for( int64_t i = 0; i < count; i++ ) {
+			const char* part = va_arg( parts, const char* );
+			if( part != nullptr ) {
+				std::memcpy( destination, part, getLength( part ) );
+				destination += getLength( part );
+			}
+		}
+
+		return( destination );
+	}
+
+	struct Hash
+	{
+		size_t operator()( const char* string ) const
+		{
+			return( exo_string_hash( string ) );
+		}
+	};
+
+	struct Equal
+	{
+		bool operator()( const char* lhs, const char* rhs ) const
+		{
+			return( exo_string_equals( lhs, rhs ) );
+		}
+	};
+
+	/*
+	 * interned strings are never freed, the table is allocated by the collector so it keeps them alive
+	 */
+#ifndef EXO_GC_DISABLE
+	typedef gc_allocator<const char*>	Allocator;
+#else
+	typedef std::allocator<const char*>	Allocator;
+#endif
+
+	std::mutex												lock;
+	std::unordered_set<const char*, Hash, Equal, Allocator>	interned;
+}
+
+extern "C"
+{
+	const char* exo_string_new( const char* data, int64_t length )
+	{
+		exo_string* string = allocate( length );
+		std::memcpy( string->data, data, length );
+
+		return( string->data );
+	}
+
+	const char* exo_string_wrap( const char* string )
+	{
+		if( string == nullptr ) {
+			return( nullptr );
+		}
+
+		return( exo_string_new( string, std::strlen( string ) ) );
+	}
+
+	/*
+	 * FNV-1a of the characters, cached in the header. constants come with it, so it is only ever stored into strings
+	 * allocated at run time
+	 */
+	uint64_t exo_string_hash( const char* string )
+	{
+		if( string == nullptr ) {
+			return( 0 );
+		}
+
+		exo_string* header = getHeader( string );
+		uint64_t hash = header->hash.load( std::memory_order_relaxed );
+		if( hash != 0 ) {
+			return( hash );
+		}
+
+		hash = 0xcbf29ce484222325ull;
+		for( int64_t i = 0; i < header->length; i++ ) {
+			hash ^= static_cast<uint8_t>( string[ i ] );
+			hash *= 0x100000001b3ull;
+		}
+
+		if( hash != 0 ) {
+			header->hash.store( hash, std::memory_order_relaxed );
+		}
+
+		return( hash );
+	}
+
+	/*
+	 * the generated code already checked for the same pointer. two distinct interned strings always differ, and so do
+	 * strings of different lengths or hashes
+	 */
+	bool exo_string_equals( const char* lhs, const char* rhs )
+	{
+		if( lhs == rhs ) {
+			return( true );
+		} else if( lhs == nullptr || rhs == nullptr ) {
+			return( false );
+		}
+
+		exo_string* left = getHeader( lhs );
+		exo_string* right = getHeader( rhs );
+
+		if( left->length != right->length || ( left->flags & right->flags & EXO_STRING_INTERNED ) ) {
+			return( false );
+		}
+
+		uint64_t leftHash = left->hash.load( std::memory_order_relaxed );
+		uint64_t rightHash = right->hash.load( std::memory_order_relaxed );
+		if( leftHash != 0 && rightHash != 0 && leftHash != rightHash ) {
+			return( false );
+		}
+
+		return( std::memcmp( lhs, rhs, left->length ) == 0 );
+	}
+
+	// negative, zero or positive like strcmp, but NUL characters count as well. null sorts first
+	int64_t exo_string_compare( const char* lhs, const char* rhs )
+	{
+		if( lhs == rhs ) {
+			return( 0 );
+		} else if( lhs == nullptr || rhs == nullptr ) {
+			return( lhs == nullptr ? -1 : 1 );
+		}
+
+		int64_t leftLength = getHeader( lhs )->length;
+		int64_t rightLength = getHeader( rhs )->length;
+
+		int result = std::memcmp( lhs, rhs, std::min( leftLength, rightLength ) );
+		if( result != 0 ) {
+			return( result );
+		}
+
+		return( leftLength < rightLength ? -1 : leftLength > rightLength );
+	}
+
+	/*
+	 * the first string interned with some contents is copied, so constants and strings still being built on are never
+	 * flagged. any later one returns that copy
+	 */
+	const char* exo_string_intern( const char* string )
+	{
+		if( string == nullptr || ( getHeader( string )->flags & EXO_STRING_INTERNED ) ) {
+			return( string );
+		}
+
+		std::lock_guard<std::mutex> guard( lock );
+
+		auto existing = interned.find( string );
+		if( existing != interned.end() ) {
+			return( *existing );
+		}
+
+		const char* copy = exo_string_new( string, getHeader( string )->length );
+		getHeader( copy )->hash.store( exo_string_hash( string ), std::memory_order_relaxed );
+		getHeader( copy )->flags = EXO_STRING_INTERNED;
+
+		interned.insert( copy );
+		return( copy );
+	}
+
+	const char* exo_string_concat( int64_t count, ... )
+	{
+		va_list parts;
+		va_start( parts, count );
+
+		exo_string* string = allocate( measure( count, parts ) );
+		copy( string->data, count, parts );
+
+		va_end( parts );
+		return( string->data );
+	}
+
+	/*
+	 * anything but a builder is copied into a new one. below a chunk a full builder moves into twice the room, so appending
+	 * takes amortized constant time. larger ones keep their characters where they are and continue in a new chunk
+	 */
+	const char* exo_string_append( const char* string, int64_t count, ... )
+	{
+		va_list parts;
+		va_start( parts, count );
+
+		int64_t current = getLength( string );
+		int64_t length = current + measure( count, parts );
+		char* builder = const_cast<char*>( string );
+
+		if( string == nullptr || ( getHeader( string )->flags & EXO_STRING_BUILDER ) == 0 ) {
+			builder = createBuilder( std::max<int64_t>( length * 2, EXO_BUILDER_MINIMUM ), nullptr );
+			if( string != nullptr ) {
+				std::memcpy( builder, string, current );
+			}
+		} else if( length > getBuilder( string )->capacity && length < EXO_BUILDER_CHUNK ) {
+			builder = createBuilder( length * 2, getBuilder( string )->previous );
+			std::memcpy( builder, string, current );
+		} else if( length > getBuilder( string )->capacity ) {
+			builder = createBuilder( std::max<int64_t>( length - current, EXO_BUILDER_CHUNK ), string );
+			length -= current;
+			current = 0;
+		}
+
+		copy( builder + current, count, parts );
+		getHeader( builder )->length = length;
+
+		va_end( parts );
+		return( builder );
+	}
+
+	/*
+	 * builders simply lose their flag, ropes are copied into one string
+	 */
+	const char* exo_string_finish( const char* string )
+	{
+		if( string == nullptr || ( getHeader( string )->flags & EXO_STRING_BUILDER ) == 0 ) {
+			return( string );
+		} else if( getBuilder( string )->previous == nullptr ) {
+			getHeader( string )->flags &= ~EXO_STRING_BUILDER;
+			return( string );
+		}
+
+		int64_t length = 0;
+		for( const char* chunk = string; chunk != nullptr; chunk = getBuilder( chunk )->previous ) {
+			length += getLength( chunk );
+		}
+
+		exo_string* result = allocate( length );
+		char* end = result->data + length;
+		for( const char* chunk = string; chunk != nullptr; chunk = getBuilder( chunk )->previous ) {
+			end -= getLength( chunk );
+			std::memcpy( end, chunk, getLength( chunk ) );
+		}
+
+		return( result->data );
+	}
+}
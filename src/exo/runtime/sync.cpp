@@ -0,0 +1,161 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "exo/exo.h"
+#include "exo/runtime/runtime.h"
+
+#include <climits>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+# include <linux/futex.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+#endif
+
+#ifndef EXO_GC_DISABLE
+# include <gc/gc_allocator.h>
+#endif
+
+using exo::runtime::Runtime;
+
+#define EXO_MUTEX_SPINS			100
+#define EXO_MUTEX_UNLOCKED		0
+#define EXO_MUTEX_LOCKED		1
+#define EXO_MUTEX_CONTENDED		2
+
+namespace
+{
+	/*
+	 * copies of thread locals are only referenced from here, every thread's have to stay visible to the garbage collector
+	 */
+#ifndef EXO_GC_DISABLE
+	template<typename T> using Allocator = gc_allocator<T>;
+#else
+	template<typename T> using Allocator = std::allocator<T>;
+#endif
+
+	typedef std::vector<void*, Allocator<void*>> Slots;
+
+	std::atomic<int64_t>					slotCount( 0 );
+	std::mutex								threadsMutex;
+	std::list<Slots, Allocator<Slots>>		threads;
+
+	// registers the copies of a thread on its first access and drops them when it exits
+	struct ThreadSlots
+	{
+		std::list<Slots, Allocator<Slots>>::iterator	slots;
+
+		ThreadSlots()
+		{
+			std::lock_guard<std::mutex> lock( threadsMutex );
+			slots = threads.emplace( threads.end() );
+		}
+
+		~ThreadSlots()
+		{
+			std::lock_guard<std::mutex> lock( threadsMutex );
+			threads.erase( slots );
+		}
+	};
+
+	thread_local ThreadSlots threadSlots;
+
+	// futexes are 32 bit, the states and counters waited on only change in their lower half
+	int* getWord( std::atomic<int64_t>* address )
+	{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+		return( reinterpret_cast<int*>( address ) + 1 );
+#else
+		return( reinterpret_cast<int*>( address ) );
+#endif
+	}
+}
+
+extern "C"
+{
+	void exo_futex_wait( std::atomic<int64_t>* address, int64_t expected )
+	{
+#ifdef __linux__
+		::syscall( SYS_futex, getWord( address ), FUTEX_WAIT_PRIVATE, static_cast<int>( expected ), nullptr, nullptr, 0 );
+#else
+		if( address->load( std::memory_order_relaxed ) == expected ) {
+			std::this_thread::yield();
+		}
+#endif
+	}
+
+	void exo_futex_wake( std::atomic<int64_t>* address, int64_t count )
+	{
+#ifdef __linux__
+		::syscall( SYS_futex, getWord( address ), FUTEX_WAKE_PRIVATE, static_cast<int>( std::min<int64_t>( count, INT_MAX ) ), nullptr, nullptr, 0 );
+#endif
+	}
+
+	/*
+	 * the inlined compare-exchange failed. spin a little, the owner is likely about to release it, then mark the mutex
+	 * contended so its release wakes us up. whoever takes it from here on keeps it marked, there may be others waiting
+	 */
+	void exo_mutex_lock( std::atomic<int64_t>* state )
+	{
+		for( int spins = 0; spins < EXO_MUTEX_SPINS; spins++ ) {
+			int64_t expected = EXO_MUTEX_UNLOCKED;
+			if( state->load( std::memory_order_relaxed ) == EXO_MUTEX_UNLOCKED && state->compare_exchange_weak( expected, EXO_MUTEX_LOCKED, std::memory_order_acquire, std::memory_order_relaxed ) ) {
+				return;
+			}
+		}
+
+		while( state->exchange( EXO_MUTEX_CONTENDED, std::memory_order_acquire ) != EXO_MUTEX_UNLOCKED ) {
+			exo_futex_wait( state, EXO_MUTEX_CONTENDED );
+		}
+	}
+
+	// only called while the mutex was contended, the inlined decrement left it locked
+	void exo_mutex_unlock( std::atomic<int64_t>* state )
+	{
+		state->store( EXO_MUTEX_UNLOCKED, std::memory_order_release );
+		exo_futex_wake( state, 1 );
+	}
+
+	// slots start out at -1 and get the next free index on the first access of any thread
+	void* exo_thread_local( std::atomic<int64_t>* slot, const void* initial, int64_t size )
+	{
+		int64_t index = slot->load( std::memory_order_acquire );
+		if( index < 0 ) {
+			int64_t next = slotCount.fetch_add( 1, std::memory_order_relaxed );
+			if( slot->compare_exchange_strong( index, next, std::memory_order_acq_rel ) ) {
+				index = next;
+			}
+		}
+
+		Slots& slots = *threadSlots.slots;
+		if( slots.size() <= static_cast<size_t>( index ) ) {
+			std::lock_guard<std::mutex> lock( threadsMutex );
+			slots.resize( index + 1, nullptr );
+		}
+
+		void*& copy = slots[ index ];
+		if( copy == nullptr ) {
+			copy = Runtime::Allocate( size, false );
+			std::memcpy( copy, initial, size );
+		}
+
+		return( copy );
+	}
+}
@@ -0,0 +1,171 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "exo/exo.h"
+#include "exo/runtime/runtime.h"
+
+#include <chrono>
+#include <deque>
+#include <queue>
+#include <cerrno>
+#include <poll.h>
+
+#ifndef EXO_GC_DISABLE
+# include <gc/gc_allocator.h>
+#endif
+
+using exo::runtime::Runtime;
+
+namespace
+{
+	/*
+	 * tasks only referenced by the executor have to stay visible to the garbage collector. the executor is thread local,
+	 * which the collector doesn't scan, so its memory is traced like a root
+	 */
+#ifndef EXO_GC_DISABLE
+	template<typename T> using Allocator = traceable_allocator<T>;
+#else
+	template<typename T> using Allocator = std::allocator<T>;
+#endif
+
+	typedef std::pair<int64_t, exo_task*>	Timer;
+
+	struct Wait
+	{
+		pollfd		descriptor;
+		exo_task*	task;
+	};
+
+	// every thread has its own executor, tasks are resumed by whoever drives exo_task_run on the thread starting them
+	thread_local std::deque<exo_task*, Allocator<exo_task*>>										ready;
+	thread_local std::priority_queue<Timer, std::vector<Timer, Allocator<Timer>>, std::greater<Timer>>	timers;
+	thread_local std::vector<Wait, Allocator<Wait>>												waits;
+
+	int64_t now()
+	{
+		return( std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count() );
+	}
+
+	exo_task* createTask()
+	{
+		return( static_cast<exo_task*>( Runtime::Allocate( sizeof( exo_task ), false ) ) );
+	}
+
+	exo_task* watch( int64_t fd, short events )
+	{
+		exo_task* task = createTask();
+		waits.push_back( { { static_cast<int>( fd ), events, 0 }, task } );
+
+		return( task );
+	}
+
+	/*
+	 * blocks until the next timer expires or a file descriptor gets ready, then completes the tasks waiting for them
+	 */
+	void waitForEvents()
+	{
+		int timeout = -1;
+		if( !timers.empty() ) {
+			timeout = static_cast<int>( std::max<int64_t>( timers.top().first - now(), 0 ) );
+		}
+
+		std::vector<pollfd> descriptors;
+		for( auto &wait : waits ) {
+			descriptors.push_back( wait.descriptor );
+		}
+
+		if( ::poll( descriptors.data(), descriptors.size(), timeout ) < 0 && errno != EINTR ) {
+			EXO_LOG( fatal, "Waiting for tasks failed: " << std::strerror( errno ) );
+			std::exit( EXIT_FAILURE );
+		}
+
+		// errors and hangups complete the task as well, the following read or write reports them
+		for( size_t i = descriptors.size(); i-- > 0; ) {
+			if( descriptors.at( i ).revents ) {
+				exo_task* task = waits.at( i ).task;
+				waits.erase( waits.begin() + i );
+				exo_task_complete( task );
+			}
+		}
+
+		int64_t time = now();
+		while( !timers.empty() && timers.top().first <= time ) {
+			exo_task* task = timers.top().second;
+			timers.pop();
+			exo_task_complete( task );
+		}
+	}
+}
+
+extern "C"
+{
+	void exo_task_complete( exo_task* task )
+	{
+		task->state = EXO_TASK_DONE;
+
+		// resuming the waiter right away could nest arbitrarily deep
+		if( task->waiter != nullptr ) {
+			ready.push_back( task->waiter );
+			task->waiter = nullptr;
+		}
+	}
+
+	void exo_task_await( exo_task* task, exo_task* waiter )
+	{
+		if( task->waiter != nullptr && task->waiter != waiter ) {
+			EXO_LOG( fatal, "Task is already awaited" );
+			std::exit( EXIT_FAILURE );
+		}
+
+		task->waiter = waiter;
+	}
+
+	void exo_task_run( exo_task* task )
+	{
+		while( task->state != EXO_TASK_DONE ) {
+			if( !ready.empty() ) {
+				exo_task* next = ready.front();
+				ready.pop_front();
+				next->resume( next );
+				continue;
+			}
+
+			if( timers.empty() && waits.empty() ) {
+				EXO_LOG( fatal, "Awaiting a task that never completes" );
+				std::exit( EXIT_FAILURE );
+			}
+
+			waitForEvents();
+		}
+	}
+
+	exo_task* exo_sleep( int64_t milliseconds )
+	{
+		exo_task* task = createTask();
+		timers.push( { now() + std::max<int64_t>( milliseconds, 0 ), task } );
+
+		return( task );
+	}
+
+	exo_task* exo_readable( int64_t fd )
+	{
+		return( watch( fd, POLLIN ) );
+	}
+
+	exo_task* exo_writable( int64_t fd )
+	{
+		return( watch( fd, POLLOUT ) );
+	}
+}
@@ -0,0 +1,535 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "exo/exo.h"
+#include "exo/runtime/runtime.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <vector>
+
+#if defined( __linux__ ) && __has_include( <linux/io_uring.h> )
+# define EXO_URING_KERNEL
+# include <linux/io_uring.h>
+# include <sys/syscall.h>
+#endif
+
+#define EXO_URING_READ			0
+#define EXO_URING_WRITE			1
+#define EXO_URING_OPEN			2
+#define EXO_URING_STAT			3
+#define EXO_URING_CLOSE			4
+#define EXO_URING_READ_FIXED	5
+#define EXO_URING_WRITE_FIXED	6
+
+using exo::runtime::Runtime;
+
+/*
+ * requests live in a pool of the ring until they completed, so their buffers and paths stay alive for the kernel. the
+ * kernel only gets their index. without io_uring, i.e. on other systems, before linux 5.6 or where it is not permitted,
+ * requests are run one after the other when they are submitted
+ */
+struct exo_uring_request
+{
+	int64_t		data;
+	int64_t		operation;
+	int64_t		file;
+	const void*	buffer;
+	int64_t		length;
+	int64_t		offset;
+	int64_t		index;
+	int64_t		result;
+	int64_t		next;
+#ifdef EXO_URING_KERNEL
+	struct statx	status;
+#endif
+};
+
+namespace
+{
+	int64_t acquire( exo_uring* ring )
+	{
+		int64_t request = ring->free;
+		if( request >= 0 ) {
+			ring->free = ring->requests[ request ].next;
+		}
+
+		return( request );
+	}
+
+	void release( exo_uring* ring, int64_t request )
+	{
+		ring->requests[ request ].next = ring->free;
+		ring->free = request;
+	}
+
+	// runs a request right away, with the result the kernel would give
+	int64_t run( exo_uring_request& request )
+	{
+		int64_t result = 0;
+		char* buffer = const_cast<char*>( static_cast<const char*>( request.buffer ) );
+		struct stat status;
+
+		switch( request.operation ) {
+			case EXO_URING_READ:
+			case EXO_URING_READ_FIXED:
+				result = ::pread( request.file, buffer, request.length, request.offset );
+				break;
+			case EXO_URING_WRITE:
+			case EXO_URING_WRITE_FIXED:
+				result = ::pwrite( request.file, buffer, request.length, request.offset );
+				break;
+			case EXO_URING_OPEN:
+				result = ::open( buffer, request.index, 0644 );
+				break;
+			case EXO_URING_STAT:
+				result = ::stat( buffer, &status ) == 0 ? status.st_size : -1;
+				break;
+			case EXO_URING_CLOSE:
+				result = ::close( request.file );
+				break;
+		}
+
+		return( result < 0 ? -errno : result );
+	}
+
+#ifdef EXO_URING_KERNEL
+	/*
+	 * read, write, openat, statx and close only came with 5.6, earlier kernels set up the ring but fail every one of them.
+	 * so does probing, which came with them as well
+	 */
+	bool isSupported( int file )
+	{
+		std::vector<char> memory( sizeof( io_uring_probe ) + ( IORING_OP_LAST + 1 ) * sizeof( io_uring_probe_op ), 0 );
+		io_uring_probe* probe = reinterpret_cast<io_uring_probe*>( memory.data() );
+		if( ::syscall( __NR_io_uring_register, file, IORING_REGISTER_PROBE, probe, IORING_OP_LAST + 1 ) < 0 ) {
+			return( false );
+		}
+
+		for( int operation : { IORING_OP_READ, IORING_OP_WRITE, IORING_OP_READ_FIXED, IORING_OP_WRITE_FIXED, IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_CLOSE } ) {
+			if( operation > probe->last_op || !( probe->ops[ operation ].flags & IO_URING_OP_SUPPORTED ) ) {
+				return( false );
+			}
+		}
+
+		return( true );
+	}
+
+	void setup( exo_uring* ring, int64_t entries )
+	{
+		io_uring_params parameters;
+		std::memset( &parameters, 0, sizeof( parameters ) );
+
+		ring->file = ::syscall( __NR_io_uring_setup, static_cast<unsigned>( entries ), &parameters );
+		if( ring->file < 0 ) {
+			return;
+		}
+		if( !isSupported( ring->file ) ) {
+			::close( ring->file );
+			ring->file = -1;
+			return;
+		}
+
+		// both rings share one mapping on all kernels we care about
+		size_t submissions = parameters.sq_off.array + parameters.sq_entries * sizeof( unsigned );
+		size_t completions = parameters.cq_off.cqes + parameters.cq_entries * sizeof( io_uring_cqe );
+		ring->size = std::max( submissions, completions );
+
+		void* memory = ::mmap( nullptr, ring->size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->file, IORING_OFF_SQ_RING );
+		void* entriesMemory = ::mmap( nullptr, parameters.sq_entries * sizeof( io_uring_sqe ), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->file, IORING_OFF_SQES );
+		if( !( parameters.features & IORING_FEAT_SINGLE_MMAP ) || memory == MAP_FAILED || entriesMemory == MAP_FAILED ) {
+			if( memory != MAP_FAILED ) {
+				::munmap( memory, ring->size );
+			}
+			if( entriesMemory != MAP_FAILED ) {
+				::munmap( entriesMemory, parameters.sq_entries * sizeof( io_uring_sqe ) );
+			}
+			::close( ring->file );
+			ring->file = -1;
+			return;
+		}
+
+		char* rings = static_cast<char*>( memory );
+		ring->rings = memory;
+		ring->entries = entriesMemory;
+		ring->submitHead = reinterpret_cast<unsigned*>( rings + parameters.sq_off.head );
+		ring->submitTail = reinterpret_cast<unsigned*>( rings + parameters.sq_off.tail );
+		ring->submitMask = *reinterpret_cast<unsigned*>( rings + parameters.sq_off.ring_mask );
+		ring->submitArray = reinterpret_cast<unsigned*>( rings + parameters.sq_off.array );
+		ring->completeHead = reinterpret_cast<unsigned*>( rings + parameters.cq_off.head );
+		ring->completeTail = reinterpret_cast<unsigned*>( rings + parameters.cq_off.tail );
+		ring->completeMask = *reinterpret_cast<unsigned*>( rings + parameters.cq_off.ring_mask );
+		ring->completions = rings + parameters.cq_off.cqes;
+		ring->capacity = parameters.sq_entries;
+	}
+
+	bool prepare( exo_uring* ring, exo_uring_request& request, int64_t index )
+	{
+		unsigned tail = *ring->submitTail;
+		if( tail - __atomic_load_n( ring->submitHead, __ATOMIC_ACQUIRE ) >= ring->capacity ) {
+			return( false );
+		}
+
+		io_uring_sqe* entry = static_cast<io_uring_sqe*>( ring->entries ) + ( tail & ring->submitMask );
+		std::memset( entry, 0, sizeof( io_uring_sqe ) );
+		entry->user_data = index;
+		entry->fd = request.file;
+		entry->addr = reinterpret_cast<uintptr_t>( request.buffer );
+		entry->len = request.length;
+		entry->off = request.offset;
+
+		switch( request.operation ) {
+			case EXO_URING_READ:
+				entry->opcode = IORING_OP_READ;
+				break;
+			case EXO_URING_WRITE:
+				entry->opcode = IORING_OP_WRITE;
+				break;
+			case EXO_URING_READ_FIXED:
+				entry->opcode = IORING_OP_READ_FIXED;
+				entry->buf_index = request.index;
+				break;
+			case EXO_URING_WRITE_FIXED:
+				entry->opcode = IORING_OP_WRITE_FIXED;
+				entry->buf_index = request.index;
+				break;
+			case EXO_URING_OPEN:
+				entry->opcode = IORING_OP_OPENAT;
+				entry->fd = AT_FDCWD;
+				entry->len = 0644;
+				entry->open_flags = request.index;
+				break;
+			case EXO_URING_STAT:
+				entry->opcode = IORING_OP_STATX;
+				entry->fd = AT_FDCWD;
+				entry->len = STATX_SIZE;
+				entry->off = reinterpret_cast<uintptr_t>( &request.status );
+				break;
+			case EXO_URING_CLOSE:
+				entry->opcode = IORING_OP_CLOSE;
+				break;
+		}
+
+		ring->submitArray[ tail & ring->submitMask ] = tail & ring->submitMask;
+		__atomic_store_n( ring->submitTail, tail + 1, __ATOMIC_RELEASE );
+		return( true );
+	}
+#endif
+
+	void destroy( exo_uring* ring )
+	{
+#ifdef EXO_URING_KERNEL
+		if( ring->file >= 0 ) {
+			::munmap( ring->entries, ring->capacity * sizeof( io_uring_sqe ) );
+			::munmap( ring->rings, ring->size );
+			::close( ring->file );
+		}
+#endif
+
+		ring->file = -1;
+		ring->count = 0;
+		ring->free = -1;
+		ring->queued = -1;
+		ring->queuedLast = -1;
+		ring->completed = -1;
+		ring->completedLast = -1;
+	}
+
+#ifndef EXO_GC_DISABLE
+	void finalize( void* ring, void* )
+	{
+		destroy( static_cast<exo_uring*>( ring ) );
+	}
+#endif
+
+	bool queue( exo_uring* ring, int64_t operation, int64_t file, const void* buffer, int64_t length, int64_t offset, int64_t index, int64_t data )
+	{
+		if( ring == nullptr ) {
+			return( false );
+		}
+
+		int64_t request = acquire( ring );
+		if( request < 0 ) {
+			return( false );
+		}
+
+		exo_uring_request& entry = ring->requests[ request ];
+		entry.data = data;
+		entry.operation = operation;
+		entry.file = file;
+		entry.buffer = buffer;
+		entry.length = length;
+		entry.offset = offset;
+		entry.index = index;
+
+#ifdef EXO_URING_KERNEL
+		if( ring->file >= 0 ) {
+			if( !prepare( ring, entry, request ) ) {
+				release( ring, request );
+				return( false );
+			}
+
+			ring->pending++;
+			return( true );
+		}
+#endif
+
+		// runs once submitted, in order
+		entry.next = -1;
+		if( ring->queuedLast >= 0 ) {
+			ring->requests[ ring->queuedLast ].next = request;
+		} else {
+			ring->queued = request;
+		}
+		ring->queuedLast = request;
+		ring->pending++;
+		return( true );
+	}
+
+	void finish( exo_uring* ring, int64_t request, int64_t result )
+	{
+		exo_uring_request& entry = ring->requests[ request ];
+
+#ifdef EXO_URING_KERNEL
+		if( entry.operation == EXO_URING_STAT && result >= 0 && ring->file >= 0 ) {
+			result = entry.status.stx_size;
+		}
+#endif
+
+		ring->data = entry.data;
+		ring->result = result;
+		entry.buffer = nullptr;
+		release( ring, request );
+	}
+}
+
+extern "C"
+{
+	exo_uring* exo_uring_create( int64_t entries )
+	{
+		exo_uring* ring = static_cast<exo_uring*>( Runtime::Allocate( sizeof( exo_uring ), false ) );
+		ring->file = -1;
+		ring->capacity = entries;
+		ring->queued = -1;
+		ring->queuedLast = -1;
+		ring->completed = -1;
+		ring->completedLast = -1;
+
+#ifdef EXO_URING_KERNEL
+		setup( ring, entries );
+#endif
+
+		// as many requests in flight as there are completions, which is twice the submissions
+		ring->count = ring->capacity * 2;
+		ring->requests = static_cast<exo_uring_request*>( Runtime::Allocate( ring->count * sizeof( exo_uring_request ), false ) );
+		ring->free = -1;
+		for( int64_t i = ring->count - 1; i >= 0; i-- ) {
+			release( ring, i );
+		}
+
+#ifndef EXO_GC_DISABLE
+		GC_register_finalizer( ring, finalize, nullptr, nullptr, nullptr );
+#endif
+
+		return( ring );
+	}
+
+	bool exo_uring_read( exo_uring* ring, int64_t file, exo_array* buffer, int64_t offset, int64_t data )
+	{
+		return( queue( ring, EXO_URING_READ, file, buffer->data, buffer->length, offset, 0, data ) );
+	}
+
+	bool exo_uring_write( exo_uring* ring, int64_t file, exo_array* buffer, int64_t offset, int64_t data )
+	{
+		return( queue( ring, EXO_URING_WRITE, file, buffer->data, buffer->length, offset, 0, data ) );
+	}
+
+	bool exo_uring_open( exo_uring* ring, const char* path, bool isWritable, int64_t data )
+	{
+		return( queue( ring, EXO_URING_OPEN, -1, path, 0, 0, ( isWritable ? O_RDWR | O_CREAT : O_RDONLY ) | O_CLOEXEC, data ) );
+	}
+
+	bool exo_uring_stat( exo_uring* ring, const char* path, int64_t data )
+	{
+		return( queue( ring, EXO_URING_STAT, -1, path, 0, 0, 0, data ) );
+	}
+
+	bool exo_uring_close( exo_uring* ring, int64_t file, int64_t data )
+	{
+		return( queue( ring, EXO_URING_CLOSE, file, nullptr, 0, 0, 0, data ) );
+	}
+
+	/*
+	 * the kernel keeps registered buffers mapped, all of them are registered again whenever one is added
+	 */
+	int64_t exo_uring_register( exo_uring* ring, exo_array* buffer )
+	{
+		if( ring == nullptr || ring->buffers >= EXO_URING_BUFFERS ) {
+			return( -1 );
+		}
+
+		ring->registered[ ring->buffers ] = buffer;
+
+#ifdef EXO_URING_KERNEL
+		if( ring->file >= 0 ) {
+			struct iovec vectors[ EXO_URING_BUFFERS ];
+			for( int64_t i = 0; i <= ring->buffers; i++ ) {
+				vectors[ i ].iov_base = ring->registered[ i ]->data;
+				vectors[ i ].iov_len = ring->registered[ i ]->length;
+			}
+
+			if( ring->buffers > 0 ) {
+				::syscall( __NR_io_uring_register, ring->file, IORING_UNREGISTER_BUFFERS, nullptr, 0 );
+			}
+			if( ::syscall( __NR_io_uring_register, ring->file, IORING_REGISTER_BUFFERS, vectors, ring->buffers + 1 ) < 0 ) {
+				return( -1 );
+			}
+		}
+#endif
+
+		return( ring->buffers++ );
+	}
+
+	bool exo_uring_read_fixed( exo_uring* ring, int64_t file, int64_t index, int64_t offset, int64_t data )
+	{
+		if( ring == nullptr || index < 0 || index >= ring->buffers ) {
+			return( false );
+		}
+
+		return( queue( ring, EXO_URING_READ_FIXED, file, ring->registered[ index ]->data, ring->registered[ index ]->length, offset, index, data ) );
+	}
+
+	bool exo_uring_write_fixed( exo_uring* ring, int64_t file, int64_t index, int64_t offset, int64_t data )
+	{
+		if( ring == nullptr || index < 0 || index >= ring->buffers ) {
+			return( false );
+		}
+
+		return( queue( ring, EXO_URING_WRITE_FIXED, file, ring->registered[ index ]->data, ring->registered[ index ]->length, offset, index, data ) );
+	}
+
+	/*
+	 * hands all queued requests over in one system call, and waits for at least the given number of completions
+	 */
+	int64_t exo_uring_submit( exo_uring* ring, int64_t wait )
+	{
+		if( ring == nullptr ) {
+			return( -EINVAL );
+		}
+
+		int64_t submitted = ring->pending;
+		ring->pending = 0;
+
+#ifdef EXO_URING_KERNEL
+		if( ring->file >= 0 ) {
+			// the kernel takes no more than there is queued, so interrupted waits are simply repeated
+			int64_t result;
+			do {
+				result = ::syscall( __NR_io_uring_enter, ring->file, static_cast<unsigned>( submitted ), static_cast<unsigned>( wait ), wait > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0 );
+			} while( result < 0 && errno == EINTR );
+
+			return( result < 0 ? -errno : submitted );
+		}
+#endif
+
+		for( int64_t request = ring->queued; request >= 0; ) {
+			int64_t next = ring->requests[ request ].next;
+			ring->requests[ request ].result = run( ring->requests[ request ] );
+			ring->requests[ request ].next = -1;
+
+			if( ring->completedLast >= 0 ) {
+				ring->requests[ ring->completedLast ].next = request;
+			} else {
+				ring->completed = request;
+			}
+			ring->completedLast = request;
+			request = next;
+		}
+		ring->queued = -1;
+		ring->queuedLast = -1;
+
+		return( submitted );
+	}
+
+	/*
+	 * takes the next completion, its data and result are kept in the ring until the following one
+	 */
+	bool exo_uring_next( exo_uring* ring )
+	{
+		if( ring == nullptr ) {
+			return( false );
+		}
+
+#ifdef EXO_URING_KERNEL
+		if( ring->file >= 0 ) {
+			unsigned head = *ring->completeHead;
+			if( head == __atomic_load_n( ring->completeTail, __ATOMIC_ACQUIRE ) ) {
+				return( false );
+			}
+
+			io_uring_cqe* completion = static_cast<io_uring_cqe*>( ring->completions ) + ( head & ring->completeMask );
+			finish( ring, completion->user_data, completion->res );
+			__atomic_store_n( ring->completeHead, head + 1, __ATOMIC_RELEASE );
+			return( true );
+		}
+#endif
+
+		int64_t request = ring->completed;
+		if( request < 0 ) {
+			return( false );
+		}
+
+		ring->completed = ring->requests[ request ].next;
+		if( ring->completed < 0 ) {
+			ring->completedLast = -1;
+		}
+
+		finish( ring, request, ring->requests[ request ].result );
+		return( true );
+	}
+
+	int64_t exo_uring_data( exo_uring* ring )
+	{
+		return( ring != nullptr ? ring->data : 0 );
+	}
+
+	int64_t exo_uring_result( exo_uring* ring )
+	{
+		return( ring != nullptr ? ring->result : -EINVAL );
+	}
+
+	// whether requests go to the kernel, otherwise they run on submission
+	bool exo_uring_is_kernel( exo_uring* ring )
+	{
+		return( ring != nullptr && ring->file >= 0 );
+	}
+
+	// requests still in flight are abandoned
+	void exo_uring_destroy( exo_uring* ring )
+	{
+		if( ring == nullptr ) {
+			return;
+		}
+
+#ifndef EXO_GC_DISABLE
+		GC_register_finalizer( ring, nullptr, nullptr, nullptr, nullptr );
+#endif
+		destroy( ring );
+	}
+}
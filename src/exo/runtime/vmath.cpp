@@ -0,0 +1,223 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "exo/exo.h"
+#include "exo/runtime/runtime.h"
+
+#include <cfloat>
+#include <cmath>
+
+#ifdef EXO_VMATH_AVX
+# include <immintrin.h>
+// the algorithms are always inlined into the avx variants, how they would return vectors doesn't matter
+# pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+#define EXO_VMATH_INLINE		inline __attribute__(( always_inline ))
+
+/*
+ * vector variants of libm functions, loops calling sin, cos, exp, log or sqrt are vectorized into calls of these (see
+ * Target::createLibraryInfo). every lane runs the algorithm of fdlibm without branches, so results are within 1 ulp,
+ * sqrt is exact. lanes sin and cos can't reduce in double precision, |x| above 2^20 * pi/2, inf and nan, go to libm.
+ * unlike libm errno is never set. the 4 lane variants take avx registers, which is all they are compiled for
+ */
+namespace
+{
+	typedef int64_t IntVector2 __attribute__(( vector_size( 16 ) ));
+	typedef int64_t IntVector4 __attribute__(( vector_size( 32 ) ));
+	typedef uint64_t UintVector2 __attribute__(( vector_size( 16 ) ));
+	typedef uint64_t UintVector4 __attribute__(( vector_size( 32 ) ));
+
+	// 1.5 * 2^52, adding it rounds to an integer which ends up in the low bits of the mantissa
+	constexpr double roundingShift = 6755399441055744.0;
+
+	// 2^54, which takes subnormals into the normal range
+	constexpr double subnormalScale = 18014398509481984.0;
+
+	// 2^20 * pi/2, up to where sin and cos reduce exactly
+	constexpr double reductionLimit = 1048576.0 * 1.57079632679489661923;
+
+	// vectors are taken by reference, gcc notes the ABI of passing 4 lanes by value changed regardless of the pragma
+	template<typename Vector, typename Scalar> EXO_VMATH_INLINE Vector splat( Scalar value )
+	{
+		return( Vector{} + value );
+	}
+
+	// e^x = 2^k * e^r with |r| <= ln(2)/2. 2^k is applied in halves, so both stay normal down to the subnormal results
+	template<typename Double, typename Int, typename Uint> EXO_VMATH_INLINE Double exponential( const Double& value )
+	{
+		const double ln2Hi = 6.93147180369123816490e-01;
+		const double ln2Lo = 1.90821492927058770002e-10;
+
+		// anything beyond over- or underflows anyway, nan stays nan
+		Double x = value < -746.0 ? splat<Double>( -746.0 ) : value;
+		x = x > 710.0 ? splat<Double>( 710.0 ) : x;
+
+		Double shifted = x * 1.44269504088896338700e+00 + roundingShift;
+		Double k = shifted - roundingShift;
+		Uint n = (Uint)shifted - (Uint)splat<Double>( roundingShift );
+
+		Double r = ( x - k * ln2Hi ) - k * ln2Lo;
+		Double p = splat<Double>( 1.0 / 6227020800.0 );
+		p = p * r + 1.0 / 479001600.0;
+		p = p * r + 1.0 / 39916800.0;
+		p = p * r + 1.0 / 3628800.0;
+		p = p * r + 1.0 / 362880.0;
+		p = p * r + 1.0 / 40320.0;
+		p = p * r + 1.0 / 5040.0;
+		p = p * r + 1.0 / 720.0;
+		p = p * r + 1.0 / 120.0;
+		p = p * r + 1.0 / 24.0;
+		p = p * r + 1.0 / 6.0;
+		p = p * r + 0.5;
+		p = 1.0 + ( r + r * r * p );
+
+		Uint half = (Uint)( (Int)n >> 1 );
+		return( p * (Double)( ( half + 1023 ) << 52 ) * (Double)( ( n - half + 1023 ) << 52 ) );
+	}
+
+	// log(x) = k * ln(2) + log(1 + f) with sqrt(2)/2 <= 1 + f < sqrt(2), the latter from the odd series of s = f / (2 + f)
+	template<typename Double, typename Int, typename Uint> EXO_VMATH_INLINE Double logarithm( const Double& x )
+	{
+		const double ln2Hi = 6.93147180369123816490e-01;
+		const double ln2Lo = 1.90821492927058770002e-10;
+
+		// subnormals are scaled into the normal range first
+		Int isSubnormal = x < DBL_MIN;
+		Double normal = isSubnormal ? x * subnormalScale : x;
+
+		Uint bits = (Uint)normal + ( 0x3ff0000000000000 - 0x3fe6a09e00000000 );
+		Int exponent = (Int)( bits >> 52 ) - 0x3ff + ( isSubnormal & -54 );
+		bits = ( bits & 0x000fffffffffffff ) + 0x3fe6a09e00000000;
+
+		Double f = (Double)bits - 1.0;
+		Double k = __builtin_convertvector( exponent, Double );
+		Double halfSquare = 0.5 * f * f;
+		Double s = f / ( 2.0 + f );
+		Double z = s * s;
+		Double w = z * z;
+		Double even = w * ( 3.999999999940941908e-01 + w * ( 2.222219843214978396e-01 + w * 1.531383769920937332e-01 ) );
+		Double odd = z * ( 6.666666666666735130e-01 + w * ( 2.857142874366239149e-01 + w * ( 1.818357216161805012e-01 + w * 1.479819860511658591e-01 ) ) );
+		Double result = s * ( halfSquare + even + odd ) + k * ln2Lo - halfSquare + f + k * ln2Hi;
+
+		// log(0) is -inf, log(inf) inf and negative numbers or nan have none
+		Double special = x == 0.0 ? splat<Double>( -HUGE_VAL ) : splat<Double>( NAN );
+		special = x == HUGE_VAL ? x : special;
+		return( x > 0.0 && x < HUGE_VAL ? result : special );
+	}
+
+	/*
+	 * sin(x) of the quadrant, cos(x) is sin of the next. x is reduced to y0 + y1 in [-pi/4, pi/4] by subtracting n times
+	 * pi/2 in 33 bit parts like fdlibm does, keeping what each step rounds off. that is exact up to 2^20 * pi/2
+	 */
+	template<typename Double, typename Uint> EXO_VMATH_INLINE Double sine( const Double& x, uint64_t quadrant )
+	{
+		Double shifted = x * 6.36619772367581382433e-01 + roundingShift;
+		Double n = shifted - roundingShift;
+
+		Double r = x - n * 1.57079632673412561417e+00;
+		Double t = r;
+		Double w = n * 6.07710050630396597660e-11;
+		r = t - w;
+		Double lost = ( t - r ) - w;
+		t = r;
+		w = n * 2.02226624871116645580e-21;
+		r = t - w;
+		w = n * 8.47842766036889956997e-32 - ( ( t - r ) - w ) - lost;
+		Double y0 = r - w;
+		Double y1 = ( r - y0 ) - w;
+
+		Double z = y0 * y0;
+		Double z2 = z * z;
+
+		Double s = 8.33333333332248946124e-03 + z * ( -1.98412698298579493134e-04 + z * 2.75573137070700676789e-06 ) + z * z2 * ( -2.50507602534068634195e-08 + z * 1.58969099521155010221e-10 );
+		Double v = z * y0;
+		Double sin = y0 - ( ( z * ( 0.5 * y1 - v * s ) - y1 ) - v * -1.66666666666666324348e-01 );
+
+		Double c = z * ( 4.16666666666666019037e-02 + z * ( -1.38888888888741095749e-03 + z * 2.48015872894767294178e-05 ) ) + z2 * z2 * ( -2.75573143513906633035e-07 + z * ( 2.08757232129817482790e-09 + z * -1.13596475577881948265e-11 ) );
+		Double halfZ = 0.5 * z;
+		Double oneMinus = 1.0 - halfZ;
+		Double cos = oneMinus + ( ( ( 1.0 - oneMinus ) - halfZ ) + ( z * c - y0 * y1 ) );
+
+		// odd quadrants take the cosine, the upper two flip the sign
+		Uint q = (Uint)shifted + quadrant;
+		Double result = ( q & 1 ) != 0 ? cos : sin;
+		result = (Double)( (Uint)result ^ ( ( q & 2 ) << 62 ) );
+
+		for( size_t i = 0; i < sizeof( Double ) / sizeof( double ); i++ ) {
+			if( !( std::fabs( x[i] ) <= reductionLimit ) ) {
+				result[i] = quadrant ? std::cos( x[i] ) : std::sin( x[i] );
+			}
+		}
+
+		return( result );
+	}
+}
+
+exo_double2 exo_vmath_sind2( exo_double2 x )
+{
+	return( sine<exo_double2, UintVector2>( x, 0 ) );
+}
+
+exo_double2 exo_vmath_cosd2( exo_double2 x )
+{
+	return( sine<exo_double2, UintVector2>( x, 1 ) );
+}
+
+exo_double2 exo_vmath_expd2( exo_double2 x )
+{
+	return( exponential<exo_double2, IntVector2, UintVector2>( x ) );
+}
+
+exo_double2 exo_vmath_logd2( exo_double2 x )
+{
+	return( logarithm<exo_double2, IntVector2, UintVector2>( x ) );
+}
+
+exo_double2 exo_vmath_sqrtd2( exo_double2 x )
+{
+#ifdef EXO_VMATH_AVX
+	return( _mm_sqrt_pd( x ) );
+#else
+	return( exo_double2{ std::sqrt( x[0] ), std::sqrt( x[1] ) } );
+#endif
+}
+
+#ifdef EXO_VMATH_AVX
+EXO_VMATH_AVX exo_double4 exo_vmath_sind4( exo_double4 x )
+{
+	return( sine<exo_double4, UintVector4>( x, 0 ) );
+}
+
+EXO_VMATH_AVX exo_double4 exo_vmath_cosd4( exo_double4 x )
+{
+	return( sine<exo_double4, UintVector4>( x, 1 ) );
+}
+
+EXO_VMATH_AVX exo_double4 exo_vmath_expd4( exo_double4 x )
+{
+	return( exponential<exo_double4, IntVector4, UintVector4>( x ) );
+}
+
+EXO_VMATH_AVX exo_double4 exo_vmath_logd4( exo_double4 x )
+{
+	return( logarithm<exo_double4, IntVector4, UintVector4>( x ) );
+}
+
+EXO_VMATH_AVX exo_double4 exo_vmath_sqrtd4( exo_double4 x )
+{
+	return( _mm256_sqrt_pd( x ) );
+}
+#endif